@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+
+/**
+ * @brief Size of the benchmark data in bytes
+ *
+ */
+static constexpr size_t BENCHMARK_DATA_SIZE{1U << 20};
+
+/**
+ * @brief Minimum duration of a single benchmark
+ *
+ */
+static constexpr std::chrono::milliseconds BENCHMARK_DURATION{200};
+
+/**
+ * @brief Sink for the calculated values so the calculation is not optimized away
+ *
+ */
+static volatile uint64_t benchmarkSink{0};
+
+/**
+ * @brief Measure the throughput of a CRC function
+ *
+ * @tparam Function CRC function type
+ * @param function CRC function
+ * @param data Data
+ * @return double Throughput in MiB/s
+ */
+template<typename Function>
+static double measure(Function function, const std::vector<char>& data)
+{
+    const auto start{std::chrono::steady_clock::now()};
+    auto now{start};
+    size_t size{0};
+    while ((now - start) < BENCHMARK_DURATION)
+    {
+        benchmarkSink = benchmarkSink + function(data.data(), data.size());
+        size += data.size();
+        now = std::chrono::steady_clock::now();
+    }
+    return (static_cast<double>(size) / (1024.0 * 1024.0) / std::chrono::duration<double>(now - start).count());
+}
+
+/**
+ * @brief Benchmark a CRC type against its bitwise reference implementation
+ *
+ * @tparam CrcType CRC type
+ * @param name CRC name
+ * @param data Data
+ */
+template<typename CrcType>
+static void benchmark(const std::string& name, const std::vector<char>& data)
+{
+    const auto bitwise{measure(CrcType::calculateBitwise, data)};
+    const auto table{measure([](const char* buffer, size_t size)
+        {
+            return CrcType::finalize(CrcType::updateTable(CrcType::initialize(), buffer, size));
+        }, data)};
+    const auto selected{measure(CrcType::calculate, data)};
+
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(12) << bitwise << std::setw(14) << table << std::setw(14) << selected
+        << std::setw(10) << (selected / bitwise) << "x" << std::endl;
+}
+
+int main()
+{
+    using namespace LibSerial;
+
+    std::vector<char> data(BENCHMARK_DATA_SIZE);
+    for (size_t index{0}; index < data.size(); ++index)
+        data[index] = static_cast<char>((index * 2654435761U) >> 13);
+
+    const auto hardware{getCrcImplementation() == CrcImplementation::CRC_HARDWARE};
+    std::cout << "CRC throughput in MiB/s (CRC-32/CRC-32C hardware support: " << (hardware ? "yes" : "no") << ")" << std::endl;
+    std::cout << std::left << std::setw(18) << "CRC" << std::right << std::setw(12) << "bitwise"
+        << std::setw(14) << "slicing-by-8" << std::setw(14) << "selected" << std::setw(11) << "speedup" << std::endl;
+
+    benchmark<Crc8>("CRC-8/SMBUS", data);
+    benchmark<Crc16Modbus>("CRC-16/MODBUS", data);
+    benchmark<Crc16CcittFalse>("CRC-16/CCITT", data);
+    benchmark<Crc16X25>("CRC-16/X-25", data);
+    benchmark<Crc32>("CRC-32", data);
+    benchmark<Crc32c>("CRC-32C", data);
+    benchmark<Crc64Xz>("CRC-64/XZ", data);
+    return 0;
+}
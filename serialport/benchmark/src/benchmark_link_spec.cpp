@@ -0,0 +1,93 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+
+/**
+ * @brief Number of link specifications parsed by the benchmark
+ *
+ */
+static constexpr size_t BENCHMARK_SPEC_COUNT{1000000};
+
+/**
+ * @brief Sink for the parsed values so the parsing is not optimized away
+ *
+ */
+static volatile unsigned long benchmarkSink{0};
+
+int main()
+{
+    using namespace LibSerial;
+
+    // Prepare formatted specifications of every baud rate, frame and flow control
+    std::vector<std::string> specs{};
+    char buffer[MAX_LINK_SPEC_SIZE];
+    for (auto baudRate{static_cast<unsigned char>(BaudRate::BAUD_RATE_50)}; baudRate <= static_cast<unsigned char>(BaudRate::BAUD_RATE_MAX); ++baudRate)
+    {
+        for (auto parity{static_cast<unsigned char>(Parity::PARITY_TYPE_MIN)}; parity <= static_cast<unsigned char>(Parity::PARITY_TYPE_MAX); ++parity)
+        {
+            for (auto flowControl{static_cast<unsigned char>(FlowControl::FLOW_CONTROL_MIN)}; flowControl <= static_cast<unsigned char>(FlowControl::FLOW_CONTROL_MAX); ++flowControl)
+            {
+                const LinkSpec linkSpec{static_cast<BaudRate>(baudRate), CharacterSize::CHARACTER_SIZE_8,
+                    static_cast<Parity>(parity), StopBit::STOP_BIT_ONE, static_cast<FlowControl>(flowControl)};
+                specs.emplace_back(buffer, formatLinkSpec(linkSpec, buffer, sizeof(buffer)));
+            }
+        }
+    }
+
+    // Parse
+    auto start{std::chrono::steady_clock::now()};
+    size_t failures{0};
+    for (size_t index{0}; index < BENCHMARK_SPEC_COUNT; ++index)
+    {
+        LinkSpec linkSpec{};
+        if (!parseLinkSpec(specs[index % specs.size()], linkSpec))
+            ++failures;
+        benchmarkSink = benchmarkSink + static_cast<unsigned long>(linkSpec.baudRate) + static_cast<unsigned long>(linkSpec.parity);
+    }
+    const auto parseTime{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    // Format
+    start = std::chrono::steady_clock::now();
+    for (size_t index{0}; index < BENCHMARK_SPEC_COUNT; ++index)
+    {
+        const LinkSpec linkSpec{static_cast<BaudRate>(1U + (index % static_cast<size_t>(BaudRate::BAUD_RATE_MAX))),
+            CharacterSize::CHARACTER_SIZE_8, static_cast<Parity>(index % 5U), StopBit::STOP_BIT_ONE, FlowControl::FLOW_CONTROL_HARDWARE};
+        benchmarkSink = benchmarkSink + formatLinkSpec(linkSpec, buffer, sizeof(buffer));
+    }
+    const auto formatTime{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    std::cout << "Link specifications: " << BENCHMARK_SPEC_COUNT << " (" << specs.size() << " distinct, "
+        << failures << " failures)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << std::left << std::setw(8) << "parse" << std::right << std::setw(10) << (parseTime * 1e9 / BENCHMARK_SPEC_COUNT) << " ns/spec"
+        << std::setw(12) << (parseTime * 1e3) << " ms" << std::endl
+        << std::left << std::setw(8) << "format" << std::right << std::setw(10) << (formatTime * 1e9 / BENCHMARK_SPEC_COUNT) << " ns/spec"
+        << std::setw(12) << (formatTime * 1e3) << " ms" << std::endl;
+    return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_server.hpp>
+
+/**
+ * @brief Number of back-to-back requests
+ *
+ */
+static constexpr size_t BENCHMARK_REQUEST_COUNT{1000};
+
+/**
+ * @brief Unit address of the benchmarked server
+ *
+ */
+static constexpr uint8_t BENCHMARK_UNIT{1};
+
+/**
+ * @brief Size of a response reading the maximum number of holding registers
+ *
+ */
+static constexpr size_t BENCHMARK_RESPONSE_SIZE{5U + (2U * LibSerial::MODBUS_MAX_READ_REGISTERS)};
+
+/**
+ * @brief Open the master side of a raw pseudo-terminal
+ *
+ * @param slaveName Name of the slave side
+ * @return int Master file descriptor or INVALID_FILE_DESCRIPTOR on failure
+ */
+static int openPseudoTerminal(std::string& slaveName)
+{
+    using namespace LibSerial;
+
+    const auto master{systemCall(::posix_openpt, O_RDWR | O_NOCTTY)};
+    if (master == INVALID_FILE_DESCRIPTOR)
+        return INVALID_FILE_DESCRIPTOR;
+
+    struct termios settings{};
+    if ((grantpt(master) != 0) || (unlockpt(master) != 0) || (systemCall(tcgetattr, master, &settings) != 0))
+    {
+        systemCall(::close, master);
+        return INVALID_FILE_DESCRIPTOR;
+    }
+    cfmakeraw(&settings);
+    systemCall(tcsetattr, master, TCSANOW, &settings);
+    slaveName = ptsname(master);
+    return master;
+}
+
+int main()
+{
+    using namespace LibSerial;
+
+    std::string slaveName{};
+    const auto master{openPseudoTerminal(slaveName)};
+    if (master == INVALID_FILE_DESCRIPTOR)
+    {
+        std::cerr << "Unable to open pseudo-terminal" << std::endl;
+        return 1;
+    }
+
+    SerialPort serverPort{slaveName, BaudRate::BAUD_RATE_115200};
+    serverPort.open();
+    ModbusServer server{serverPort, BENCHMARK_UNIT, 0, 0, MODBUS_MAX_READ_REGISTERS, 0};
+    std::thread thread{[&server]() { server.run(); }};
+
+    // Back-to-back reads of the maximum number of holding registers
+    char request[MODBUS_MAX_FRAME_SIZE]{static_cast<char>(BENCHMARK_UNIT),
+        static_cast<char>(ModbusFunction::MODBUS_READ_HOLDING_REGISTERS), 0, 0, 0,
+        static_cast<char>(MODBUS_MAX_READ_REGISTERS)};
+    const auto requestSize{appendModbusCrc(request, 6)};
+    char response[BENCHMARK_RESPONSE_SIZE];
+    size_t responseCount{0};
+    const auto start{std::chrono::steady_clock::now()};
+    for (size_t index{0}; index < BENCHMARK_REQUEST_COUNT; ++index)
+    {
+        if (systemCall(::write, master, request, requestSize) != static_cast<ssize_t>(requestSize))
+            break;
+
+        size_t size{0};
+        while (size < sizeof(response))
+        {
+            const auto count{systemCall(::read, master, response + size, sizeof(response) - size)};
+            if (count <= 0)
+                break;
+            size += static_cast<size_t>(count);
+        }
+        if (size < sizeof(response))
+            break;
+        ++responseCount;
+    }
+    const auto roundTripTime{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    server.stop();
+    thread.join();
+    systemCall(::close, master);
+
+    // Server latency is measured from the end of the request to the transmitted response
+    const auto statistics{server.getStatistics()};
+    const auto characterTime{std::chrono::duration<double>(server.getLink().getTiming().characterTime).count()};
+    const auto meanLatency{std::chrono::duration<double>(statistics.totalResponseLatency).count() /
+        std::max<size_t>(statistics.responseCount, 1)};
+    const auto maxLatency{std::chrono::duration<double>(statistics.maxResponseLatency).count()};
+
+    std::cout << "Requests: " << BENCHMARK_REQUEST_COUNT << ", responses: " << responseCount
+        << " (server " << statistics.responseCount << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << std::left << std::setw(12) << "round trip" << std::right << std::setw(10) << (roundTripTime * 1e6 / BENCHMARK_REQUEST_COUNT) << " us" << std::endl
+        << std::left << std::setw(12) << "mean" << std::right << std::setw(10) << (meanLatency * 1e6) << " us" << std::endl
+        << std::left << std::setw(12) << "max" << std::right << std::setw(10) << (maxLatency * 1e6) << " us" << std::endl
+        << std::left << std::setw(12) << "character" << std::right << std::setw(10) << (characterTime * 1e6) << " us" << std::endl;
+    return (responseCount == BENCHMARK_REQUEST_COUNT) ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/timer_wheel.hpp>
+
+/**
+ * @brief Number of ports with an armed inter-byte timeout
+ *
+ */
+static constexpr size_t BENCHMARK_PORT_COUNT{1000};
+
+/**
+ * @brief Number of received bytes, each re-arming the timeout of its port
+ *
+ */
+static constexpr size_t BENCHMARK_BYTE_COUNT{10000000};
+
+/**
+ * @brief Sink for the expired timers so the expiry is not optimized away
+ *
+ */
+static volatile uint64_t benchmarkSink{0};
+
+int main()
+{
+    using namespace LibSerial;
+
+    // Inter-byte timeouts of 10 ms, a transaction timeout of 10 s per port
+    TimerWheel wheel{};
+    std::vector<TimerId> timers(BENCHMARK_PORT_COUNT, INVALID_TIMER_ID);
+    auto now{std::chrono::steady_clock::now()};
+    for (size_t port{0}; port < BENCHMARK_PORT_COUNT; ++port)
+    {
+        timers[port] = wheel.arm(now + std::chrono::milliseconds{10}, port);
+        wheel.arm(now + std::chrono::seconds{10}, port);
+    }
+
+    // Re-arm on every byte while the time advances by a microsecond per byte
+    const auto start{std::chrono::steady_clock::now()};
+    size_t expiredCount{0};
+    for (size_t byte{0}; byte < BENCHMARK_BYTE_COUNT; ++byte)
+    {
+        const auto port{(byte * 7919U) % BENCHMARK_PORT_COUNT};
+        wheel.cancel(timers[port]);
+        timers[port] = wheel.arm(now + std::chrono::milliseconds{10}, port);
+        now += std::chrono::microseconds{1};
+        if ((byte % 1000) == 0)
+        {
+            expiredCount += wheel.advance(now, [](TimerId, uint64_t data)
+            {
+                benchmarkSink = benchmarkSink + data;
+            });
+        }
+    }
+    const auto rearmTime{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    std::cout << "Ports: " << BENCHMARK_PORT_COUNT << ", bytes: " << BENCHMARK_BYTE_COUNT << " ("
+        << expiredCount << " expired, " << wheel.getActiveCount() << " armed)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << std::left << std::setw(8) << "rearm" << std::right << std::setw(10) << (rearmTime * 1e9 / BENCHMARK_BYTE_COUNT) << " ns/byte"
+        << std::setw(12) << (rearmTime * 1e3) << " ms" << std::endl;
+    return 0;
+}
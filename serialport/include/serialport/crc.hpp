@@ -0,0 +1,442 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <serialport/namespace.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief CRC implementation
+ *
+ */
+enum class CrcImplementation
+{
+    /**
+     * @brief Portable slicing-by-8 tables
+     *
+     */
+    CRC_SLICING_BY_8,
+
+    /**
+     * @brief Processor instructions, SSE4.2 for CRC-32C and PCLMULQDQ for CRC-32
+     *
+     */
+    CRC_HARDWARE,
+};
+
+/**
+ * @brief Get the CRC implementation in use for CRC-32 and CRC-32C
+ *
+ * @return CrcImplementation CRC implementation
+ * @note The fastest implementation supported by the processor is selected at startup
+ */
+CrcImplementation getCrcImplementation();
+
+/**
+ * @brief Set the CRC implementation for CRC-32 and CRC-32C
+ *
+ * @param crcImplementation CRC implementation
+ * @return true CRC implementation selected
+ * @return false CRC implementation not supported by the processor
+ */
+bool setCrcImplementation(CrcImplementation crcImplementation);
+
+/**
+ * @brief Check whether a CRC implementation is supported by the processor
+ *
+ * @param crcImplementation CRC implementation
+ * @return true CRC implementation is supported
+ * @return false CRC implementation is not supported
+ */
+bool isCrcImplementationSupported(CrcImplementation crcImplementation);
+
+/**
+ * @brief Update a CRC-32 register using the selected implementation
+ *
+ * @param crc Reflected CRC register
+ * @param data Data
+ * @param size Size of the data
+ * @return uint32_t Updated CRC register
+ */
+uint32_t updateCrc32(uint32_t crc, const char* data, size_t size);
+
+/**
+ * @brief Update a CRC-32C register using the selected implementation
+ *
+ * @param crc Reflected CRC register
+ * @param data Data
+ * @param size Size of the data
+ * @return uint32_t Updated CRC register
+ */
+uint32_t updateCrc32c(uint32_t crc, const char* data, size_t size);
+
+/**
+ * @brief Crc class template
+ *
+ * Cyclic redundancy check described by the Rocksoft model parameters. Lookup
+ * tables are generated at compile time and data is processed eight bytes at
+ * a time (slicing-by-8). CRC-32 and CRC-32C use processor instructions when
+ * available.
+ *
+ * The register may be updated incrementally:
+ * finalize(update(update(initialize(), first, firstSize), second, secondSize)).
+ *
+ * @tparam Width Width in bits (1 to 64)
+ * @tparam Polynomial Polynomial without the leading term
+ * @tparam Initial Initial value
+ * @tparam ReflectIn Input bytes are reflected
+ * @tparam ReflectOut Result is reflected
+ * @tparam XorOut Value applied to the result using exclusive or
+ */
+template<unsigned Width, uint64_t Polynomial, uint64_t Initial, bool ReflectIn, bool ReflectOut, uint64_t XorOut>
+class Crc final
+{
+    static_assert((Width > 0) && (Width <= 64), "CRC width must be between 1 and 64 bits");
+public:
+    /**
+     * @brief CRC value, the smallest unsigned type holding the width
+     *
+     */
+    typedef std::conditional_t<(Width <= 8), uint8_t,
+        std::conditional_t<(Width <= 16), uint16_t,
+        std::conditional_t<(Width <= 32), uint32_t, uint64_t>>> Value;
+
+    /**
+     * @brief CRC register, reflected in the low bits or left-aligned in 64 bits
+     *
+     */
+    typedef std::conditional_t<ReflectIn, Value, uint64_t> Register;
+
+    /**
+     * @brief Slicing-by-8 lookup tables
+     *
+     */
+    typedef std::array<std::array<Register, 256>, 8> Tables;
+
+    /**
+     * @brief Mask of the CRC width
+     *
+     */
+    static constexpr uint64_t MASK{(Width == 64) ? ~uint64_t{0} : ((uint64_t{1} << Width) - 1)};
+
+    /**
+     * @brief Reflect the lowest bits of a value
+     *
+     * @param value Value
+     * @param bits Number of bits to reflect
+     * @return uint64_t Reflected value
+     */
+    static constexpr uint64_t reflect(uint64_t value, unsigned bits)
+    {
+        uint64_t result{0};
+        for (unsigned bit{0}; bit < bits; ++bit)
+        {
+            result = (result << 1) | (value & 1U);
+            value >>= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Get the initial register value
+     *
+     * @return Register Initial register value
+     */
+    static constexpr Register initialize()
+    {
+        if constexpr (ReflectIn)
+            return static_cast<Register>(reflect(Initial & MASK, Width));
+        else
+            return static_cast<Register>((Initial & MASK) << (64 - Width));
+    }
+
+    /**
+     * @brief Update the register with data
+     *
+     * @param crc Register
+     * @param data Data
+     * @param size Size of the data
+     * @return Register Updated register
+     */
+    static Register update(Register crc, const char* data, size_t size)
+    {
+        if constexpr (ReflectIn && (Width == 32) && (Polynomial == 0x04C11DB7U))
+            return updateCrc32(crc, data, size);
+        else if constexpr (ReflectIn && (Width == 32) && (Polynomial == 0x1EDC6F41U))
+            return updateCrc32c(crc, data, size);
+        else
+            return updateTable(crc, data, size);
+    }
+
+    /**
+     * @brief Update the register with data using the slicing-by-8 tables
+     *
+     * @param crc Register
+     * @param data Data
+     * @param size Size of the data
+     * @return Register Updated register
+     */
+    static Register updateTable(Register crc, const char* data, size_t size)
+    {
+        auto bytes{reinterpret_cast<const unsigned char*>(data)};
+        for (; size >= 8; size -= 8, bytes += 8)
+        {
+            if constexpr (ReflectIn)
+            {
+                const auto value{static_cast<uint64_t>(crc) ^ loadLittleEndian(bytes)};
+                crc = TABLES[7][value & 0xFF] ^ TABLES[6][(value >> 8) & 0xFF] ^
+                    TABLES[5][(value >> 16) & 0xFF] ^ TABLES[4][(value >> 24) & 0xFF] ^
+                    TABLES[3][(value >> 32) & 0xFF] ^ TABLES[2][(value >> 40) & 0xFF] ^
+                    TABLES[1][(value >> 48) & 0xFF] ^ TABLES[0][value >> 56];
+            }
+            else
+            {
+                const auto value{crc ^ loadBigEndian(bytes)};
+                crc = TABLES[7][value >> 56] ^ TABLES[6][(value >> 48) & 0xFF] ^
+                    TABLES[5][(value >> 40) & 0xFF] ^ TABLES[4][(value >> 32) & 0xFF] ^
+                    TABLES[3][(value >> 24) & 0xFF] ^ TABLES[2][(value >> 16) & 0xFF] ^
+                    TABLES[1][(value >> 8) & 0xFF] ^ TABLES[0][value & 0xFF];
+            }
+        }
+
+        for (; size > 0; --size, ++bytes)
+        {
+            if constexpr (ReflectIn)
+                crc = static_cast<Register>(TABLES[0][(crc ^ *bytes) & 0xFF] ^ shiftRight(crc));
+            else
+                crc = TABLES[0][(crc >> 56) ^ *bytes] ^ (crc << 8);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief Get the CRC value of a register
+     *
+     * @param crc Register
+     * @return Value CRC value
+     */
+    static constexpr Value finalize(Register crc)
+    {
+        uint64_t result{0};
+        if constexpr (ReflectIn)
+            result = ReflectOut ? static_cast<uint64_t>(crc) : reflect(crc, Width);
+        else
+            result = ReflectOut ? reflect(crc >> (64 - Width), Width) : (crc >> (64 - Width));
+        return static_cast<Value>((result ^ XorOut) & MASK);
+    }
+
+    /**
+     * @brief Calculate the CRC value of data
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return Value CRC value
+     */
+    static Value calculate(const char* data, size_t size)
+    {
+        return finalize(update(initialize(), data, size));
+    }
+
+    /**
+     * @brief Calculate the CRC value of data a bit at a time
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return Value CRC value
+     * @note Reference implementation, slow
+     */
+    static constexpr Value calculateBitwise(const char* data, size_t size)
+    {
+        uint64_t crc{Initial & MASK};
+        for (size_t index{0}; index < size; ++index)
+        {
+            const auto byte{static_cast<uint64_t>(static_cast<unsigned char>(data[index]))};
+            const auto value{ReflectIn ? reflect(byte, 8) : byte};
+            for (int bit{7}; bit >= 0; --bit)
+            {
+                // Top bit is extracted by a shift, GCC 12 miscompiles a 64-bit mask test at -O1 and above
+                const bool feedback{(((crc >> (Width - 1)) ^ (value >> bit)) & 1U) != 0};
+                crc = (crc << 1) & MASK;
+                if (feedback)
+                    crc ^= (Polynomial & MASK);
+            }
+        }
+        return static_cast<Value>(((ReflectOut ? reflect(crc, Width) : crc) ^ XorOut) & MASK);
+    }
+protected:
+    /**
+     * @brief Shift a reflected register by a byte
+     *
+     * @param crc Register
+     * @return Register Shifted register
+     */
+    static constexpr Register shiftRight(Register crc)
+    {
+        if constexpr (sizeof(Register) == 1)
+            return 0;
+        else
+            return static_cast<Register>(crc >> 8);
+    }
+
+    /**
+     * @brief Generate the slicing-by-8 lookup tables
+     *
+     * @return Tables Lookup tables
+     */
+    static constexpr Tables generateTables()
+    {
+        Tables result{};
+        for (uint64_t index{0}; index < 256; ++index)
+        {
+            if constexpr (ReflectIn)
+            {
+                auto value{index};
+                const auto polynomial{reflect(Polynomial & MASK, Width)};
+                for (int bit{0}; bit < 8; ++bit)
+                    value = ((value & 1U) != 0) ? ((value >> 1) ^ polynomial) : (value >> 1);
+                result[0][index] = static_cast<Register>(value);
+            }
+            else
+            {
+                auto value{index << 56};
+                const auto polynomial{(Polynomial & MASK) << (64 - Width)};
+                for (int bit{0}; bit < 8; ++bit)
+                    value = ((value >> 63) != 0) ? ((value << 1) ^ polynomial) : (value << 1);
+                result[0][index] = value;
+            }
+        }
+
+        // Each table advances the previous one by another zero byte
+        for (size_t table{1}; table < result.size(); ++table)
+        {
+            for (size_t index{0}; index < 256; ++index)
+            {
+                const auto value{result[table - 1][index]};
+                if constexpr (ReflectIn)
+                    result[table][index] = static_cast<Register>(shiftRight(value) ^ result[0][value & 0xFF]);
+                else
+                    result[table][index] = (value << 8) ^ result[0][value >> 56];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Load a little endian 64-bit value
+     *
+     * @param data Data
+     * @return uint64_t Value
+     */
+    static uint64_t loadLittleEndian(const unsigned char* data)
+    {
+        uint64_t result{0};
+        for (int index{7}; index >= 0; --index)
+            result = (result << 8) | data[index];
+        return result;
+    }
+
+    /**
+     * @brief Load a big endian 64-bit value
+     *
+     * @param data Data
+     * @return uint64_t Value
+     */
+    static uint64_t loadBigEndian(const unsigned char* data)
+    {
+        uint64_t result{0};
+        for (int index{0}; index < 8; ++index)
+            result = (result << 8) | data[index];
+        return result;
+    }
+
+    /**
+     * @brief Slicing-by-8 lookup tables
+     *
+     */
+    static constexpr Tables TABLES{generateTables()};
+};
+
+/**
+ * @brief CRC-8/SMBUS
+ *
+ */
+typedef Crc<8, 0x07, 0x00, false, false, 0x00> Crc8;
+
+/**
+ * @brief CRC-8/MAXIM (Dallas 1-Wire)
+ *
+ */
+typedef Crc<8, 0x31, 0x00, true, true, 0x00> Crc8Maxim;
+
+/**
+ * @brief CRC-16/MODBUS
+ *
+ */
+typedef Crc<16, 0x8005, 0xFFFF, true, true, 0x0000> Crc16Modbus;
+
+/**
+ * @brief CRC-16/CCITT-FALSE (CRC-16/IBM-3740)
+ *
+ */
+typedef Crc<16, 0x1021, 0xFFFF, false, false, 0x0000> Crc16CcittFalse;
+
+/**
+ * @brief CRC-16/KERMIT (CRC-16/CCITT)
+ *
+ */
+typedef Crc<16, 0x1021, 0x0000, true, true, 0x0000> Crc16Kermit;
+
+/**
+ * @brief CRC-16/X-25 (HDLC and PPP frame check sequence)
+ *
+ */
+typedef Crc<16, 0x1021, 0xFFFF, true, true, 0xFFFF> Crc16X25;
+
+/**
+ * @brief CRC-32 (ISO-HDLC, Ethernet, zlib)
+ *
+ */
+typedef Crc<32, 0x04C11DB7, 0xFFFFFFFF, true, true, 0xFFFFFFFF> Crc32;
+
+/**
+ * @brief CRC-32C (Castagnoli, iSCSI)
+ *
+ */
+typedef Crc<32, 0x1EDC6F41, 0xFFFFFFFF, true, true, 0xFFFFFFFF> Crc32c;
+
+/**
+ * @brief CRC-32/BZIP2 (CRC-32/AAL5)
+ *
+ */
+typedef Crc<32, 0x04C11DB7, 0xFFFFFFFF, false, false, 0xFFFFFFFF> Crc32Bzip2;
+
+/**
+ * @brief CRC-64/XZ
+ *
+ */
+typedef Crc<64, 0x42F0E1EBA9EA3693, 0xFFFFFFFFFFFFFFFF, true, true, 0xFFFFFFFFFFFFFFFF> Crc64Xz;
+
+END_NAMESPACE_LIBSERIAL
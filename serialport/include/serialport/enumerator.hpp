@@ -26,6 +26,119 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+/**
+ * @brief Serial port information
+ *
+ * @note Fields which are not available for a serial port (e.g. USB
+ *   descriptors of a built-in UART) are left empty or zero.
+ */
+struct PortInfo
+{
+    /**
+     * @brief Serial port name (e.g. ttyUSB0 or COM1)
+     *
+     */
+    std::string portName;
+
+    /**
+     * @brief Serial port file name (e.g. /dev/ttyUSB0)
+     *
+     */
+    std::string fileName;
+
+    /**
+     * @brief USB vendor identifier
+     *
+     */
+    unsigned short vendorId{0};
+
+    /**
+     * @brief USB product identifier
+     *
+     */
+    unsigned short productId{0};
+
+    /**
+     * @brief USB serial number
+     *
+     */
+    std::string serialNumber;
+
+    /**
+     * @brief USB manufacturer name
+     *
+     */
+    std::string manufacturer;
+
+    /**
+     * @brief USB product name
+     *
+     */
+    std::string product;
+
+    /**
+     * @brief USB interface number or -1 when not available
+     *
+     */
+    int interfaceNumber{-1};
+
+    /**
+     * @brief Kernel driver name
+     *
+     */
+    std::string driver;
+
+    /**
+     * @brief Persistent /dev/serial/by-id path
+     *
+     */
+    std::string byIdPath;
+
+    /**
+     * @brief Get the USB device status
+     *
+     * @return true Serial port is a USB device
+     * @return false Serial port is not a USB device
+     */
+    bool isUsb() const;
+
+    /**
+     * @brief Get the stable identity status
+     *
+     * @return true Serial port can be identified regardless of its name
+     * @return false Serial port can only be identified by its name
+     */
+    bool hasStableIdentity() const;
+
+    /**
+     * @brief Compare the stable identity of two serial ports
+     *
+     * @param portInfo Serial port information to compare with
+     * @return true Both serial ports belong to the same device
+     * @return false Serial ports belong to different devices or have no stable identity
+     * @note Serial port names (e.g. ttyUSB0) are not part of the stable identity
+     */
+    bool isSameDevice(const PortInfo& portInfo) const;
+
+    /**
+     * @brief Equal-to operator
+     *
+     * @param portInfo Serial port information to compare with
+     * @return true Serial port information is equal
+     * @return false Serial port information is not equal
+     */
+    bool operator==(const PortInfo& portInfo) const;
+
+    /**
+     * @brief Not-equal-to operator
+     *
+     * @param portInfo Serial port information to compare with
+     * @return true Serial port information is not equal
+     * @return false Serial port information is equal
+     */
+    bool operator!=(const PortInfo& portInfo) const;
+};
+
 /**
  * @brief Enumerator class
  *
@@ -57,6 +170,64 @@ public:
      * @return std::string Serial port name
      */
     static std::string fileNameToSerialPort(const std::string& fileName);
+
+    /**
+     * @brief Update the serial port information list
+     *
+     * @param list List of the serial port information to update
+     * @return true Successfully updated the serial port information list
+     * @return false Failed to update the serial port information list
+     * @note The list is collected directly from the system and bypasses the cache
+     */
+    static bool updatePortInfoList(std::vector<PortInfo>& list);
+
+#ifdef __linux__
+    /**
+     * @brief Update the serial port information list from a given sysfs tree
+     *
+     * @param list List of the serial port information to update
+     * @param ttyClassDirectory Sysfs tty class directory including the trailing slash
+     * @param byIdDirectory Persistent by-id link directory including the trailing slash
+     * @return true Successfully updated the serial port information list
+     * @return false Failed to update the serial port information list
+     * @note Allows collecting from a copy of the sysfs tree, the file names still refer to /dev
+     */
+    static bool updatePortInfoList(std::vector<PortInfo>& list, const std::string& ttyClassDirectory,
+        const std::string& byIdDirectory);
+#endif // __linux__
+
+    /**
+     * @brief Refresh the cached serial port information list
+     *
+     * @return unsigned long Generation of the cached list
+     * @note Generation is incremented only when the list has changed
+     */
+    static unsigned long refreshPortInfoCache();
+
+    /**
+     * @brief Get the cached serial port information list
+     *
+     * @return std::vector<PortInfo> Cached serial port information list
+     * @note The cache is collected on the first call if it was never refreshed
+     */
+    static std::vector<PortInfo> getPortInfoCache();
+
+    /**
+     * @brief Get the generation of the cached serial port information list
+     *
+     * @return unsigned long Generation of the cached list or 0 if never collected
+     */
+    static unsigned long getPortInfoGeneration();
+
+    /**
+     * @brief Find the cached serial port information
+     *
+     * @param serialPort Serial port name or file name
+     * @param portInfo Serial port information
+     * @return true Serial port information found
+     * @return false Serial port information not found
+     */
+    static bool findPortInfo(const std::string& serialPort, PortInfo& portInfo);
 };
 
 END_NAMESPACE_LIBSERIAL
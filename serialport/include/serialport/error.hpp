@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <system_error>
+#include <type_traits>
+#include <serialport/namespace.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Serial port error
+ *
+ * Conditions reported by the non-throwing serial port API besides the
+ * operating system errors, which are reported in the system category.
+ */
+enum class SerialError : int
+{
+    /**
+     * @brief Operation would block, no data available or output buffer full
+     *
+     * @note Equivalent to std::errc::operation_would_block
+     */
+    SERIAL_ERROR_WOULD_BLOCK = 1,
+
+    /**
+     * @brief End of file, the device hung up or disappeared
+     *
+     */
+    SERIAL_ERROR_HANGUP = 2,
+
+    /**
+     * @brief Serial port is not open
+     *
+     * @note Equivalent to std::errc::bad_file_descriptor
+     */
+    SERIAL_ERROR_NOT_OPEN = 3,
+
+    /**
+     * @brief Property or open mode is invalid or not supported
+     *
+     * @note Equivalent to std::errc::invalid_argument
+     */
+    SERIAL_ERROR_NOT_SUPPORTED = 4,
+};
+
+/**
+ * @brief Get the serial port error category
+ *
+ * @return const std::error_category& Serial port error category
+ */
+const std::error_category& getSerialErrorCategory() noexcept;
+
+/**
+ * @brief Make an error code of a serial port error
+ *
+ * @param serialError Serial port error
+ * @return std::error_code Error code
+ */
+std::error_code make_error_code(SerialError serialError) noexcept;
+
+/**
+ * @brief Get the error code of the last failed system call
+ *
+ * @return std::error_code Error code in the system category
+ */
+std::error_code getLastError() noexcept;
+
+END_NAMESPACE_LIBSERIAL
+
+namespace std
+{
+
+/**
+ * @brief Serial port errors convert to std::error_code
+ *
+ */
+template<>
+struct is_error_code_enum<LibSerial::SerialError> : true_type
+{
+
+};
+
+} // namespace std
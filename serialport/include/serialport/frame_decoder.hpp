@@ -0,0 +1,342 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default frame decoder buffer size in bytes
+ *
+ */
+static constexpr size_t DEFAULT_FRAME_DECODER_SIZE{1U << 16};
+
+/**
+ * @brief Byte order of a multi-byte field
+ *
+ */
+enum class Endianness : unsigned char
+{
+    /**
+     * @brief Least significant byte first
+     *
+     */
+    ENDIANNESS_LITTLE = 0U,
+
+    /**
+     * @brief Most significant byte first
+     *
+     */
+    ENDIANNESS_BIG = 1U,
+};
+
+/**
+ * @brief Header layout of a length-prefixed binary frame
+ *
+ * The size of a whole frame, including the sync pattern, header and any
+ * trailer, is the value of the length field plus the length adjustment.
+ */
+struct FrameLayout
+{
+    /**
+     * @brief Frame validator function, e.g. a checksum check of the whole frame
+     *
+     */
+    typedef std::function<bool(std::string_view frame)> Validator;
+
+    /**
+     * @brief Sync pattern at the start of every frame, empty if not used
+     *
+     */
+    std::string syncPattern{};
+
+    /**
+     * @brief Offset of the length field from the start of the frame
+     *
+     */
+    size_t lengthOffset{0};
+
+    /**
+     * @brief Size of the length field in bytes (1 to 8)
+     *
+     */
+    size_t lengthSize{1};
+
+    /**
+     * @brief Byte order of the length field
+     *
+     */
+    Endianness lengthEndianness{Endianness::ENDIANNESS_LITTLE};
+
+    /**
+     * @brief Value added to the length field to get the frame size
+     *
+     */
+    long lengthAdjustment{0};
+
+    /**
+     * @brief Maximum frame size in bytes
+     *
+     */
+    size_t maxFrameSize{4096};
+
+    /**
+     * @brief Optional frame validator
+     *
+     */
+    Validator validator{};
+
+    /**
+     * @brief Get the size of the header needed to determine the frame size
+     *
+     * @return size_t Header size
+     */
+    size_t getHeaderSize() const;
+};
+
+/**
+ * @brief FrameDecoder class
+ *
+ * Splits data received on a serial port into length-prefixed binary frames
+ * described by a FrameLayout. Frames are returned as views into the internal
+ * buffer, so decoding does not allocate. A frame with an invalid length or
+ * failing validation is skipped one byte at a time until the next sync
+ * pattern.
+ */
+class FrameDecoder final
+{
+public:
+    /**
+     * @brief Construct a new FrameDecoder object
+     *
+     * @param serialPort Serial port
+     * @param frameLayout Frame layout
+     * @param bufferSize Buffer size, at least the maximum frame size
+     * @throw std::runtime_error Invalid length field size
+     * @throw std::runtime_error Invalid maximum frame size
+     */
+    explicit FrameDecoder(SerialPort& serialPort, const FrameLayout& frameLayout,
+        size_t bufferSize = DEFAULT_FRAME_DECODER_SIZE);
+
+    /**
+     * @brief Copy-construct a new FrameDecoder object
+     *
+     * @param frameDecoder Frame decoder
+     */
+    FrameDecoder(const FrameDecoder& frameDecoder) = delete;
+
+    /**
+     * @brief Move-construct a new FrameDecoder object
+     *
+     * @param frameDecoder Frame decoder
+     */
+    FrameDecoder(FrameDecoder&& frameDecoder) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param frameDecoder Frame decoder to copy-assign
+     * @return FrameDecoder& Assigned frame decoder
+     */
+    FrameDecoder& operator=(const FrameDecoder& frameDecoder) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param frameDecoder Frame decoder to move-assign
+     * @return FrameDecoder& Assigned frame decoder
+     */
+    FrameDecoder& operator=(FrameDecoder&& frameDecoder) = delete;
+
+    /**
+     * @brief Destroy the FrameDecoder object
+     *
+     */
+    ~FrameDecoder() noexcept = default;
+
+    /**
+     * @brief Read the next frame, reading from the serial port once if no buffered frame is available
+     *
+     * @param frame Frame including its header
+     * @return true Frame available
+     * @return false No complete frame available
+     * @note Frame view is valid until the next call of readFrame(), fill(), feed() or reset()
+     */
+    bool readFrame(std::string_view& frame);
+
+    /**
+     * @brief Get the next buffered frame without reading from the serial port
+     *
+     * @param frame Frame including its header
+     * @return true Frame available
+     * @return false No complete frame buffered
+     * @note Frame view is valid until the next call of readFrame(), fill(), feed() or reset()
+     */
+    bool nextFrame(std::string_view& frame);
+
+    /**
+     * @brief Read available data from the serial port into the buffer
+     *
+     * @return size_t Size of the data read
+     */
+    size_t fill();
+
+    /**
+     * @brief Append data from another source to the buffer
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return size_t Size of the data accepted, less than size when buffered frames must be consumed first
+     */
+    size_t feed(const char* data, size_t size);
+
+    /**
+     * @brief Discard all buffered data
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Get the size of the buffered data not yet returned as a frame
+     *
+     * @return size_t Size of the buffered data
+     */
+    size_t getBufferedSize() const;
+
+    /**
+     * @brief Get the frame layout
+     *
+     * @return const FrameLayout& Frame layout
+     */
+    const FrameLayout& getFrameLayout() const;
+
+    /**
+     * @brief Get the number of returned frames
+     *
+     * @return unsigned long Number of returned frames
+     */
+    unsigned long getFrameCount() const;
+
+    /**
+     * @brief Get the number of invalid frames which caused a resync
+     *
+     * @return unsigned long Number of invalid frames
+     */
+    unsigned long getResyncCount() const;
+
+    /**
+     * @brief Get the number of bytes discarded while searching for a frame
+     *
+     * @return unsigned long Number of discarded bytes
+     */
+    unsigned long getDiscardedCount() const;
+protected:
+    /**
+     * @brief Skip data up to the next sync pattern
+     *
+     * @return true Sync pattern at the start of the buffered data
+     * @return false More data needed to find the sync pattern
+     */
+    bool synchronize();
+
+    /**
+     * @brief Decode the frame size from the header of the current frame
+     *
+     * @return size_t Frame size or 0 if invalid
+     */
+    size_t decodeFrameSize() const;
+
+    /**
+     * @brief Discard data of the current frame
+     *
+     * @param size Size of the data to discard
+     */
+    void discard(size_t size);
+
+    /**
+     * @brief Make room for new data at the end of the buffer
+     *
+     * @return size_t Size of the free space at the end of the buffer
+     */
+    size_t prepareSpace();
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Frame layout
+     *
+     */
+    FrameLayout frameLayout;
+
+    /**
+     * @brief Header size needed to determine the frame size
+     *
+     */
+    size_t headerSize;
+
+    /**
+     * @brief Data buffer
+     *
+     */
+    std::vector<char> buffer;
+
+    /**
+     * @brief Offset of the current frame in the buffer
+     *
+     */
+    size_t frameBegin;
+
+    /**
+     * @brief End of the buffered data
+     *
+     */
+    size_t bufferEnd;
+
+    /**
+     * @brief Number of returned frames
+     *
+     */
+    unsigned long frameCount;
+
+    /**
+     * @brief Number of invalid frames
+     *
+     */
+    unsigned long resyncCount;
+
+    /**
+     * @brief Number of discarded bytes
+     *
+     */
+    unsigned long discardedCount;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,230 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default frame reader buffer size in bytes
+ *
+ */
+static constexpr size_t DEFAULT_FRAME_READER_SIZE{1U << 16};
+
+/**
+ * @brief FrameReader class
+ *
+ * Splits data received on a serial port into frames terminated by a single- or
+ * multi-byte delimiter (e.g. "\n" or "\r\n"). Received data is scanned only
+ * once using vectorized byte search and frames are returned as views into the
+ * internal buffer, without copying.
+ *
+ * Frames longer than the buffer are discarded up to and including the next
+ * delimiter.
+ */
+class FrameReader final
+{
+public:
+    /**
+     * @brief Construct a new FrameReader object
+     *
+     * @param serialPort Serial port
+     * @param delimiter Frame delimiter
+     * @param bufferSize Buffer size limiting the maximum frame size
+     * @throw std::runtime_error Delimiter is empty
+     */
+    explicit FrameReader(SerialPort& serialPort, const std::string& delimiter = "\n",
+        size_t bufferSize = DEFAULT_FRAME_READER_SIZE);
+
+    /**
+     * @brief Copy-construct a new FrameReader object
+     *
+     * @param frameReader Frame reader
+     */
+    FrameReader(const FrameReader& frameReader) = delete;
+
+    /**
+     * @brief Move-construct a new FrameReader object
+     *
+     * @param frameReader Frame reader
+     */
+    FrameReader(FrameReader&& frameReader) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param frameReader Frame reader to copy-assign
+     * @return FrameReader& Assigned frame reader
+     */
+    FrameReader& operator=(const FrameReader& frameReader) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param frameReader Frame reader to move-assign
+     * @return FrameReader& Assigned frame reader
+     */
+    FrameReader& operator=(FrameReader&& frameReader) = delete;
+
+    /**
+     * @brief Destroy the FrameReader object
+     *
+     */
+    ~FrameReader() noexcept = default;
+
+    /**
+     * @brief Read the next frame, reading from the serial port once if no buffered frame is available
+     *
+     * @param frame Frame without the delimiter
+     * @return true Frame available
+     * @return false No complete frame available
+     * @note Frame view is valid until the next call of readFrame(), fill(), feed() or reset()
+     */
+    bool readFrame(std::string_view& frame);
+
+    /**
+     * @brief Get the next buffered frame without reading from the serial port
+     *
+     * @param frame Frame without the delimiter
+     * @return true Frame available
+     * @return false No complete frame buffered
+     * @note Frame view is valid until the next call of readFrame(), fill(), feed() or reset()
+     */
+    bool nextFrame(std::string_view& frame);
+
+    /**
+     * @brief Read available data from the serial port into the buffer
+     *
+     * @return size_t Size of the data read
+     */
+    size_t fill();
+
+    /**
+     * @brief Append data from another source to the buffer
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return size_t Size of the data accepted, less than size when buffered frames must be consumed first
+     */
+    size_t feed(const char* data, size_t size);
+
+    /**
+     * @brief Discard all buffered data
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Get the size of the buffered data not yet returned as a frame
+     *
+     * @return size_t Size of the buffered data
+     */
+    size_t getBufferedSize() const;
+
+    /**
+     * @brief Get the frame delimiter
+     *
+     * @return const std::string& Frame delimiter
+     */
+    const std::string& getDelimiter() const;
+
+    /**
+     * @brief Get the number of returned frames
+     *
+     * @return unsigned long Number of returned frames
+     */
+    unsigned long getFrameCount() const;
+
+    /**
+     * @brief Get the number of discarded frames exceeding the buffer size
+     *
+     * @return unsigned long Number of discarded frames
+     */
+    unsigned long getOverflowCount() const;
+protected:
+    /**
+     * @brief Make room for new data at the end of the buffer
+     *
+     * @return size_t Size of the free space at the end of the buffer
+     */
+    size_t prepareSpace();
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Frame delimiter
+     *
+     */
+    std::string delimiter;
+
+    /**
+     * @brief Data buffer
+     *
+     */
+    std::vector<char> buffer;
+
+    /**
+     * @brief Offset of the current frame in the buffer
+     *
+     */
+    size_t frameBegin;
+
+    /**
+     * @brief Offset from which the delimiter search resumes
+     *
+     */
+    size_t scanPosition;
+
+    /**
+     * @brief End of the buffered data
+     *
+     */
+    size_t bufferEnd;
+
+    /**
+     * @brief Discarding an oversized frame up to the next delimiter
+     *
+     */
+    bool discarding;
+
+    /**
+     * @brief Number of returned frames
+     *
+     */
+    unsigned long frameCount;
+
+    /**
+     * @brief Number of discarded frames
+     *
+     */
+    unsigned long overflowCount;
+};
+
+END_NAMESPACE_LIBSERIAL
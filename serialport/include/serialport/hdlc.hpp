@@ -0,0 +1,401 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default maximum HDLC frame size in bytes, excluding the frame check sequence
+ *
+ */
+static constexpr size_t DEFAULT_HDLC_FRAME_SIZE{4096};
+
+/**
+ * @brief Default HDLC receive buffer size in bytes
+ *
+ */
+static constexpr size_t DEFAULT_HDLC_BUFFER_SIZE{1U << 16};
+
+/**
+ * @brief HDLC flag byte
+ *
+ */
+static constexpr char HDLC_FLAG{'\x7E'};
+
+/**
+ * @brief HDLC control escape byte
+ *
+ */
+static constexpr char HDLC_ESCAPE{'\x7D'};
+
+/**
+ * @brief HDLC escaped byte modifier
+ *
+ */
+static constexpr char HDLC_ESCAPE_MASK{'\x20'};
+
+/**
+ * @brief HDLC frame check sequence
+ *
+ */
+enum class HdlcFrameCheck : unsigned char
+{
+    /**
+     * @brief 16-bit frame check sequence (CRC-16/CCITT as used by HDLC and PPP)
+     *
+     */
+    HDLC_FRAME_CHECK_16 = 0U,
+
+    /**
+     * @brief 32-bit frame check sequence (CRC-32 as used by HDLC and PPP)
+     *
+     */
+    HDLC_FRAME_CHECK_32 = 1U,
+};
+
+/**
+ * @brief HDLC codec statistics
+ *
+ */
+struct HdlcStatistics
+{
+    /**
+     * @brief Number of received valid frames
+     *
+     */
+    unsigned long frameCount{0};
+
+    /**
+     * @brief Number of received frames with a frame check sequence mismatch
+     *
+     */
+    unsigned long crcErrorCount{0};
+
+    /**
+     * @brief Number of received frames shorter than the frame check sequence
+     *
+     */
+    unsigned long runtCount{0};
+
+    /**
+     * @brief Number of received frames exceeding the maximum frame size
+     *
+     */
+    unsigned long overflowCount{0};
+
+    /**
+     * @brief Number of received abort sequences
+     *
+     */
+    unsigned long abortCount{0};
+
+    /**
+     * @brief Number of received idle flags not ending a frame
+     *
+     */
+    unsigned long idleFlagCount{0};
+};
+
+/**
+ * @brief HdlcCodec class
+ *
+ * Asynchronous HDLC-like framing (RFC 1662) on a serial port. Frames are
+ * delimited by flag bytes, flag and escape bytes within a frame are escaped
+ * and every frame ends with a 16- or 32-bit frame check sequence.
+ *
+ * Received data is unescaped directly into a reusable frame buffer while the
+ * CRC (Crc16X25 or Crc32) is updated incrementally, so complete frames
+ * are returned as views without allocation. An escape byte followed by a
+ * flag aborts the current frame.
+ */
+class HdlcCodec final
+{
+public:
+    /**
+     * @brief Construct a new HdlcCodec object
+     *
+     * @param serialPort Serial port
+     * @param frameCheck Frame check sequence
+     * @param maxFrameSize Maximum frame size, excluding the frame check sequence
+     * @param bufferSize Receive buffer size
+     */
+    explicit HdlcCodec(SerialPort& serialPort,
+        HdlcFrameCheck frameCheck = HdlcFrameCheck::HDLC_FRAME_CHECK_16,
+        size_t maxFrameSize = DEFAULT_HDLC_FRAME_SIZE,
+        size_t bufferSize = DEFAULT_HDLC_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new HdlcCodec object
+     *
+     * @param hdlcCodec HDLC codec
+     */
+    HdlcCodec(const HdlcCodec& hdlcCodec) = delete;
+
+    /**
+     * @brief Move-construct a new HdlcCodec object
+     *
+     * @param hdlcCodec HDLC codec
+     */
+    HdlcCodec(HdlcCodec&& hdlcCodec) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param hdlcCodec HDLC codec to copy-assign
+     * @return HdlcCodec& Assigned HDLC codec
+     */
+    HdlcCodec& operator=(const HdlcCodec& hdlcCodec) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param hdlcCodec HDLC codec to move-assign
+     * @return HdlcCodec& Assigned HDLC codec
+     */
+    HdlcCodec& operator=(HdlcCodec&& hdlcCodec) = delete;
+
+    /**
+     * @brief Destroy the HdlcCodec object
+     *
+     */
+    ~HdlcCodec() noexcept = default;
+
+    /**
+     * @brief Read the next frame, reading from the serial port once if no buffered frame is available
+     *
+     * @param frame Frame without the frame check sequence
+     * @return true Frame available
+     * @return false No complete frame available
+     * @note Frame view is valid until the next call of readFrame() or nextFrame()
+     */
+    bool readFrame(std::string_view& frame);
+
+    /**
+     * @brief Get the next buffered frame without reading from the serial port
+     *
+     * @param frame Frame without the frame check sequence
+     * @return true Frame available
+     * @return false No complete frame buffered
+     * @note Frame view is valid until the next call of readFrame() or nextFrame()
+     */
+    bool nextFrame(std::string_view& frame);
+
+    /**
+     * @brief Read available data from the serial port into the receive buffer
+     *
+     * @return size_t Size of the data read
+     */
+    size_t fill();
+
+    /**
+     * @brief Append received data from another source
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return size_t Size of the data accepted, less than size when buffered frames must be consumed first
+     */
+    size_t feed(const char* data, size_t size);
+
+    /**
+     * @brief Discard all received data and the partially received frame
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Encode a frame and write it to the serial port
+     *
+     * @param data Frame data
+     * @param size Size of the frame data
+     * @param timeout Maximum time to wait for space in the output buffer, negative waits indefinitely
+     * @return true Frame written
+     * @return false Frame not or only partially written
+     */
+    bool writeFrame(const char* data, size_t size, std::chrono::milliseconds timeout = DEFAULT_WRITE_TIMEOUT);
+
+    /**
+     * @brief Get the idle status of the receiver
+     *
+     * @return true No frame is being received
+     * @return false Frame reception is in progress
+     */
+    bool isIdle() const;
+
+    /**
+     * @brief Get the frame check sequence
+     *
+     * @return HdlcFrameCheck Frame check sequence
+     */
+    HdlcFrameCheck getFrameCheck() const;
+
+    /**
+     * @brief Get the codec statistics
+     *
+     * @return HdlcStatistics Codec statistics
+     */
+    HdlcStatistics getStatistics() const;
+
+    /**
+     * @brief Get the size of a frame check sequence
+     *
+     * @param frameCheck Frame check sequence
+     * @return size_t Size of the frame check sequence in bytes
+     */
+    static size_t getFrameCheckSize(HdlcFrameCheck frameCheck);
+
+    /**
+     * @brief Get the maximum size of an encoded frame including its flags
+     *
+     * @param size Size of the frame data
+     * @param frameCheck Frame check sequence
+     * @return size_t Maximum encoded size
+     */
+    static size_t getMaxEncodedSize(size_t size, HdlcFrameCheck frameCheck);
+
+    /**
+     * @brief Encode a frame between an opening and a closing flag
+     *
+     * @param data Frame data
+     * @param size Size of the frame data
+     * @param output Output buffer of at least getMaxEncodedSize(size, frameCheck) bytes
+     * @param frameCheck Frame check sequence
+     * @return size_t Size of the encoded frame
+     */
+    static size_t encode(const char* data, size_t size, char* output, HdlcFrameCheck frameCheck);
+
+    /**
+     * @brief Calculate the frame check sequence of data
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @param frameCheck Frame check sequence
+     * @return uint32_t Frame check sequence
+     */
+    static uint32_t calculateFrameCheck(const char* data, size_t size, HdlcFrameCheck frameCheck);
+protected:
+    /**
+     * @brief Append unescaped data to the current frame
+     *
+     * @param data Data
+     * @param size Size of the data
+     */
+    void append(const char* data, size_t size);
+
+    /**
+     * @brief Start a new frame
+     *
+     */
+    void restartFrame();
+
+    /**
+     * @brief Make room for new data at the end of the receive buffer
+     *
+     * @return size_t Size of the free space at the end of the receive buffer
+     */
+    size_t prepareSpace();
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Frame check sequence
+     *
+     */
+    HdlcFrameCheck frameCheck;
+
+    /**
+     * @brief Receive buffer
+     *
+     */
+    std::vector<char> receiveBuffer;
+
+    /**
+     * @brief Offset of the unprocessed data in the receive buffer
+     *
+     */
+    size_t receiveBegin;
+
+    /**
+     * @brief End of the data in the receive buffer
+     *
+     */
+    size_t receiveEnd;
+
+    /**
+     * @brief Unescaped frame buffer including the frame check sequence
+     *
+     */
+    std::vector<char> frameBuffer;
+
+    /**
+     * @brief Size of the unescaped frame
+     *
+     */
+    size_t frameSize;
+
+    /**
+     * @brief CRC register of the unescaped frame
+     *
+     */
+    uint32_t crc;
+
+    /**
+     * @brief Previous byte was an escape byte
+     *
+     */
+    bool escaped;
+
+    /**
+     * @brief Waiting for a flag before the first frame
+     *
+     */
+    bool hunting;
+
+    /**
+     * @brief Current frame exceeds the maximum frame size
+     *
+     */
+    bool overflow;
+
+    /**
+     * @brief Transmit buffer
+     *
+     */
+    std::vector<char> transmitBuffer;
+
+    /**
+     * @brief Codec statistics
+     *
+     */
+    HdlcStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
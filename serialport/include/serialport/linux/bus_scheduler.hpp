@@ -0,0 +1,790 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default size of the bus scheduler receive buffer
+ *
+ */
+static constexpr size_t DEFAULT_BUS_BUFFER_SIZE{256};
+
+/**
+ * @brief Default maximum poll period multiplier of a device which does not respond
+ *
+ */
+static constexpr unsigned DEFAULT_BUS_MAX_BACKOFF{16};
+
+/**
+ * @brief Default number of consecutive timeouts after which a device is offline
+ *
+ */
+static constexpr unsigned DEFAULT_BUS_OFFLINE_THRESHOLD{3};
+
+/**
+ * @brief Bus poll status
+ *
+ */
+enum class PollStatus : unsigned char
+{
+    /**
+     * @brief Complete response received
+     *
+     */
+    POLL_COMPLETED = 0U,
+
+    /**
+     * @brief No complete response received within the response timeout
+     *
+     */
+    POLL_TIMEOUT = 1U,
+
+    /**
+     * @brief Serial port hung up or failed
+     *
+     */
+    POLL_IO_ERROR = 2U,
+};
+
+/**
+ * @brief Statistics of a polled bus device
+ *
+ */
+struct BusDeviceStatistics
+{
+    /**
+     * @brief Number of polls
+     *
+     */
+    uint64_t pollCount{0};
+
+    /**
+     * @brief Number of complete responses
+     *
+     */
+    uint64_t responseCount{0};
+
+    /**
+     * @brief Number of polls without a complete response
+     *
+     */
+    uint64_t timeoutCount{0};
+
+    /**
+     * @brief Number of polls skipped because the bus was overloaded
+     *
+     */
+    uint64_t overrunCount{0};
+
+    /**
+     * @brief Maximum delay of a poll after its scheduled time
+     *
+     */
+    std::chrono::microseconds maxLateness{0};
+
+    /**
+     * @brief Total delay of all polls after their scheduled time
+     *
+     */
+    std::chrono::microseconds totalLateness{0};
+
+    /**
+     * @brief Maximum deviation of the interval between two polls from the poll period
+     *
+     */
+    std::chrono::microseconds maxJitter{0};
+
+    /**
+     * @brief Total deviation of the intervals between polls from the poll period
+     *
+     */
+    std::chrono::microseconds totalJitter{0};
+
+    /**
+     * @brief Maximum time between the end of a request and its complete response
+     *
+     */
+    std::chrono::microseconds maxResponseTime{0};
+
+    /**
+     * @brief Total time between the end of the requests and their complete responses
+     *
+     */
+    std::chrono::microseconds totalResponseTime{0};
+};
+
+/**
+ * @brief Bus scheduler statistics
+ *
+ */
+struct BusStatistics
+{
+    /**
+     * @brief Number of polls of all devices
+     *
+     */
+    uint64_t pollCount{0};
+
+    /**
+     * @brief Number of complete responses of all devices
+     *
+     */
+    uint64_t responseCount{0};
+
+    /**
+     * @brief Number of polls without a complete response of all devices
+     *
+     */
+    uint64_t timeoutCount{0};
+
+    /**
+     * @brief Number of polls ended by a hang-up or an I/O error of the serial port
+     *
+     */
+    uint64_t failedCount{0};
+
+    /**
+     * @brief Size of the received data not belonging to a response
+     *
+     */
+    uint64_t discardedCount{0};
+
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Size of the received data
+     *
+     */
+    uint64_t receivedCount{0};
+};
+
+/**
+ * @brief BusScheduler class
+ *
+ * Polls the addressed devices of a multi-drop (RS-485) bus by a master on an
+ * open serial port. Every device has a poll request, the size of its expected
+ * response, a poll period and a priority. The first polls are staggered by the
+ * transaction costs (wire time of the request and the response from
+ * calculateTime() and the turnaround delay), so devices are polled back-to-back
+ * instead of all becoming due at once. Of all the due devices the device with
+ * the highest priority and then the earliest scheduled time is polled, the next
+ * request is transmitted as soon as a response is complete and the turnaround
+ * delay has passed.
+ *
+ * A device which does not respond has its poll period doubled after every
+ * timeout up to the maximum backoff, so it does not take the bus time of the
+ * responding devices; a single response restores its poll period. Polls a
+ * device misses because the bus is overloaded are skipped to keep its phase.
+ *
+ * A request which can not be written within its wire time and the response
+ * timeout times out as well. A hang-up or an I/O error of the serial port ends
+ * the active poll with POLL_IO_ERROR, stops polling and ends the event loop.
+ *
+ * All members but stop() must be called from the thread running the event
+ * loop; poll handlers are called from it.
+ */
+class BusScheduler final
+{
+public:
+    /**
+     * @brief Response extractor returning the size of the complete response at
+     *   the start of the received data or 0 if more data is needed
+     *
+     */
+    typedef std::function<size_t(std::string_view data)> ResponseExtractor;
+
+    /**
+     * @brief Poll handler called with the device index, the status and the
+     *   response, which is only valid during the call
+     *
+     */
+    typedef std::function<void(size_t device, PollStatus status, std::string_view response)> PollHandler;
+
+    /**
+     * @brief Construct a new BusScheduler object
+     *
+     * @param serialPort Open serial port
+     * @param responseExtractor Response extractor or nullptr to complete responses at their expected size
+     * @param bufferSize Size of the receive buffer, at least the size of the largest response
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create event
+     * @throw std::out_of_range Invalid buffer size
+     */
+    explicit BusScheduler(SerialPort& serialPort, ResponseExtractor responseExtractor = nullptr,
+        size_t bufferSize = DEFAULT_BUS_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new BusScheduler object
+     *
+     * @param busScheduler Bus scheduler
+     */
+    BusScheduler(const BusScheduler& busScheduler) = delete;
+
+    /**
+     * @brief Move-construct a new BusScheduler object
+     *
+     * @param busScheduler Bus scheduler
+     */
+    BusScheduler(BusScheduler&& busScheduler) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param busScheduler Bus scheduler to copy-assign
+     * @return BusScheduler& Assigned bus scheduler
+     */
+    BusScheduler& operator=(const BusScheduler& busScheduler) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param busScheduler Bus scheduler to move-assign
+     * @return BusScheduler& Assigned bus scheduler
+     */
+    BusScheduler& operator=(BusScheduler&& busScheduler) = delete;
+
+    /**
+     * @brief Destroy the BusScheduler object
+     *
+     */
+    ~BusScheduler() noexcept;
+
+    /**
+     * @brief Add a polled device
+     *
+     * @param request Poll request
+     * @param responseSize Expected size of the response
+     * @param period Poll period
+     * @param priority Priority, a higher value is polled first
+     * @param pollHandler Poll handler
+     * @return size_t Device index
+     * @throw std::out_of_range Empty request, invalid response size or poll period
+     * @note The schedule of all the devices is rebuilt before the next poll
+     */
+    size_t addDevice(std::string request, size_t responseSize, std::chrono::microseconds period,
+        unsigned priority, PollHandler pollHandler);
+
+    /**
+     * @brief Get the number of devices
+     *
+     * @return size_t Number of devices
+     */
+    size_t getDeviceCount() const;
+
+    /**
+     * @brief Set the poll request of a device
+     *
+     * @param device Device index
+     * @param request Poll request
+     * @throw std::out_of_range Invalid device index or empty request
+     * @note The request takes effect with the next poll of the device
+     */
+    void setRequest(size_t device, std::string request);
+
+    /**
+     * @brief Get the poll period of a device
+     *
+     * @param device Device index
+     * @return std::chrono::microseconds Poll period
+     * @throw std::out_of_range Invalid device index
+     */
+    std::chrono::microseconds getPeriod(size_t device) const;
+
+    /**
+     * @brief Set the poll period of a device
+     *
+     * @param device Device index
+     * @param period Poll period
+     * @throw std::out_of_range Invalid device index or poll period
+     * @note The schedule of all the devices is rebuilt before the next poll
+     */
+    void setPeriod(size_t device, std::chrono::microseconds period);
+
+    /**
+     * @brief Enable or disable polling of a device
+     *
+     * @param device Device index
+     * @param enabled Device is polled
+     * @throw std::out_of_range Invalid device index
+     */
+    void setEnabled(size_t device, bool enabled);
+
+    /**
+     * @brief Get the online status of a device
+     *
+     * @param device Device index
+     * @return true Device responded within the offline threshold
+     * @return false Device did not respond to the number of polls of the offline threshold
+     * @throw std::out_of_range Invalid device index
+     */
+    bool isOnline(size_t device) const;
+
+    /**
+     * @brief Get the current poll period multiplier of a device
+     *
+     * @param device Device index
+     * @return unsigned Poll period multiplier, 1 for a responding device
+     * @throw std::out_of_range Invalid device index
+     */
+    unsigned getBackoff(size_t device) const;
+
+    /**
+     * @brief Poll the due devices once
+     *
+     * @param timeout Maximum time to wait for an event
+     * @return size_t Number of finished polls
+     */
+    size_t poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Poll the devices until stopped or the serial port fails
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop the event loop
+     *
+     * @note May be called from another thread
+     */
+    void stop();
+
+    /**
+     * @brief Get the failed status
+     *
+     * @return true Serial port hung up or failed, no more devices are polled
+     * @return false Serial port is operational
+     */
+    bool isFailed() const;
+
+    /**
+     * @brief Get the response timeout
+     *
+     * @return std::chrono::microseconds Maximum time to wait for a response after the request left the wire
+     */
+    std::chrono::microseconds getResponseTimeout() const;
+
+    /**
+     * @brief Set the response timeout
+     *
+     * @param responseTimeout Maximum time to wait for a response after the request left the wire
+     */
+    void setResponseTimeout(std::chrono::microseconds responseTimeout);
+
+    /**
+     * @brief Get the turnaround delay
+     *
+     * @return std::chrono::microseconds Minimum bus idle time between a response and the next request
+     */
+    std::chrono::microseconds getTurnaroundDelay() const;
+
+    /**
+     * @brief Set the turnaround delay
+     *
+     * @param turnaroundDelay Minimum bus idle time between a response and the next request
+     * @note The schedule of all the devices is rebuilt before the next poll
+     */
+    void setTurnaroundDelay(std::chrono::microseconds turnaroundDelay);
+
+    /**
+     * @brief Get the maximum backoff
+     *
+     * @return unsigned Maximum poll period multiplier of a device which does not respond
+     */
+    unsigned getMaxBackoff() const;
+
+    /**
+     * @brief Set the maximum backoff
+     *
+     * @param maxBackoff Maximum poll period multiplier of a device which does not respond
+     * @throw std::out_of_range Invalid maximum backoff
+     */
+    void setMaxBackoff(unsigned maxBackoff);
+
+    /**
+     * @brief Get the offline threshold
+     *
+     * @return unsigned Number of consecutive timeouts after which a device is offline
+     */
+    unsigned getOfflineThreshold() const;
+
+    /**
+     * @brief Set the offline threshold
+     *
+     * @param offlineThreshold Number of consecutive timeouts after which a device is offline
+     */
+    void setOfflineThreshold(unsigned offlineThreshold);
+
+    /**
+     * @brief Get the planned load of the bus
+     *
+     * @return double Sum of the transaction costs of the enabled devices relative to
+     *   their poll periods, the bus is overloaded above 1
+     */
+    double getLoad() const;
+
+    /**
+     * @brief Get the utilisation of the bus
+     *
+     * @return double Transmitted and received data relative to the capacity of the
+     *   line at the current baud rate since the statistics were reset
+     */
+    double getUtilisation() const;
+
+    /**
+     * @brief Get the achieved poll rate of a device
+     *
+     * @param device Device index
+     * @return double Polls per second since the statistics were reset
+     * @throw std::out_of_range Invalid device index
+     */
+    double getPollRate(size_t device) const;
+
+    /**
+     * @brief Get the statistics of a device
+     *
+     * @param device Device index
+     * @return BusDeviceStatistics Device statistics
+     * @throw std::out_of_range Invalid device index
+     */
+    BusDeviceStatistics getDeviceStatistics(size_t device) const;
+
+    /**
+     * @brief Get the bus statistics
+     *
+     * @return BusStatistics Bus statistics
+     */
+    BusStatistics getStatistics() const;
+
+    /**
+     * @brief Reset the statistics and the utilisation measurement
+     *
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    void resetStatistics();
+protected:
+    /**
+     * @brief Invalid device index
+     *
+     */
+    static constexpr size_t INVALID_INDEX{SIZE_MAX};
+
+    /**
+     * @brief Polled device
+     *
+     */
+    struct Device
+    {
+        /**
+         * @brief Poll request
+         *
+         */
+        std::string request;
+
+        /**
+         * @brief Expected size of the response
+         *
+         */
+        size_t responseSize;
+
+        /**
+         * @brief Poll period
+         *
+         */
+        std::chrono::microseconds period;
+
+        /**
+         * @brief Priority
+         *
+         */
+        unsigned priority;
+
+        /**
+         * @brief Poll handler
+         *
+         */
+        PollHandler pollHandler;
+
+        /**
+         * @brief Device is polled
+         *
+         */
+        bool enabled;
+
+        /**
+         * @brief Poll period multiplier
+         *
+         */
+        unsigned backoff;
+
+        /**
+         * @brief Number of consecutive timeouts
+         *
+         */
+        unsigned timeoutCount;
+
+        /**
+         * @brief Scheduled time of the next poll
+         *
+         */
+        std::chrono::steady_clock::time_point nextPoll;
+
+        /**
+         * @brief Delay of the last poll after its scheduled time
+         *
+         */
+        std::chrono::microseconds lateness;
+
+        /**
+         * @brief Device statistics
+         *
+         */
+        BusDeviceStatistics statistics;
+    };
+
+    /**
+     * @brief Get a device
+     *
+     * @param device Device index
+     * @return const Device& Device
+     * @throw std::out_of_range Invalid device index
+     */
+    const Device& getDevice(size_t device) const;
+
+    /**
+     * @brief Get the transaction cost of a device
+     *
+     * @param device Device
+     * @return std::chrono::steady_clock::duration Wire time of the request and the response and the turnaround delay
+     */
+    std::chrono::steady_clock::duration getCost(const Device& device) const;
+
+    /**
+     * @brief Stagger the scheduled times of the devices by their transaction costs
+     *
+     * @param now Current time
+     */
+    void schedule(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Select the device to poll
+     *
+     * @param now Current time
+     * @return size_t Index of the due device with the highest priority or INVALID_INDEX
+     */
+    size_t select(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief Get the time of the next poll
+     *
+     * @return std::chrono::steady_clock::time_point Earliest time a device is due and the bus is idle
+     */
+    std::chrono::steady_clock::time_point getNextPollTime() const;
+
+    /**
+     * @brief Start polling the selected device if the bus is idle
+     *
+     */
+    void start();
+
+    /**
+     * @brief Transmit the rest of the request
+     *
+     */
+    void transmit();
+
+    /**
+     * @brief Read the response
+     *
+     * @return size_t Number of finished polls
+     */
+    size_t receive();
+
+    /**
+     * @brief Finish the poll of the active device and call its poll handler
+     *
+     * @param status Poll status
+     * @param response Response
+     */
+    void finish(PollStatus status, std::string_view response);
+
+    /**
+     * @brief Stop polling after a hang-up or an I/O error
+     *
+     */
+    void fail();
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Response extractor
+     *
+     */
+    ResponseExtractor responseExtractor;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Event loop stop request
+     *
+     */
+    bool stopped;
+
+    /**
+     * @brief Serial port hung up or failed
+     *
+     */
+    bool failed;
+
+    /**
+     * @brief Polled devices, a deque keeps them in place while devices are added by a poll handler
+     *
+     */
+    std::deque<Device> devices;
+
+    /**
+     * @brief Schedule is valid
+     *
+     */
+    bool scheduled;
+
+    /**
+     * @brief Device being polled
+     *
+     */
+    size_t activeDevice;
+
+    /**
+     * @brief Request being transmitted
+     *
+     */
+    std::string request;
+
+    /**
+     * @brief Size of the transmitted part of the request
+     *
+     */
+    size_t transmitOffset;
+
+    /**
+     * @brief Request is being transmitted
+     *
+     */
+    bool transmitting;
+
+    /**
+     * @brief Time the request left the wire
+     *
+     */
+    std::chrono::steady_clock::time_point requestTime;
+
+    /**
+     * @brief Deadline of the request and its response
+     *
+     */
+    std::chrono::steady_clock::time_point responseDeadline;
+
+    /**
+     * @brief Earliest time of the next request
+     *
+     */
+    std::chrono::steady_clock::time_point idleTime;
+
+    /**
+     * @brief Maximum time to wait for a response
+     *
+     */
+    std::chrono::microseconds responseTimeout;
+
+    /**
+     * @brief Minimum bus idle time between a response and the next request
+     *
+     */
+    std::chrono::microseconds turnaroundDelay;
+
+    /**
+     * @brief Maximum poll period multiplier
+     *
+     */
+    unsigned maxBackoff;
+
+    /**
+     * @brief Number of consecutive timeouts after which a device is offline
+     *
+     */
+    unsigned offlineThreshold;
+
+    /**
+     * @brief Receive buffer
+     *
+     */
+    std::vector<char> buffer;
+
+    /**
+     * @brief End of the received data
+     *
+     */
+    size_t bufferEnd;
+
+    /**
+     * @brief Transmit time of a single byte in milli-seconds
+     *
+     */
+    double byteTime;
+
+    /**
+     * @brief Time the statistics were reset
+     *
+     */
+    std::chrono::steady_clock::time_point statisticsTime;
+
+    /**
+     * @brief Bus statistics
+     *
+     */
+    BusStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,249 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default maximum spin budget of a busy-poll reader
+ *
+ */
+static constexpr std::chrono::nanoseconds DEFAULT_SPIN_BUDGET{std::chrono::microseconds{50}};
+
+/**
+ * @brief Busy-poll reader statistics
+ *
+ */
+struct BusyPollStatistics
+{
+    /**
+     * @brief Number of reads which returned data
+     *
+     */
+    uint64_t readCount{0};
+
+    /**
+     * @brief Number of reads whose data arrived while spinning
+     *
+     */
+    uint64_t spinCount{0};
+
+    /**
+     * @brief Number of reads which exhausted the spin budget and blocked
+     *
+     */
+    uint64_t sleepCount{0};
+
+    /**
+     * @brief Number of reads without data within the timeout
+     *
+     */
+    uint64_t timeoutCount{0};
+
+    /**
+     * @brief Total time spent spinning
+     *
+     */
+    std::chrono::nanoseconds spinTime{0};
+
+    /**
+     * @brief Total time spent blocked
+     *
+     */
+    std::chrono::nanoseconds sleepTime{0};
+};
+
+/**
+ * @brief BusyPollReader class
+ *
+ * Reads an open serial port by spinning on non-blocking reads with a CPU
+ * pause hint for a spin budget and then blocking in poll() for the rest of
+ * the timeout, trading CPU time for the wakeup latency of the scheduler.
+ *
+ * With adaptive spinning the budget follows the observed waits for data: it
+ * is set to twice their moving average, so data arriving at a steady rate is
+ * caught while spinning, and drops to zero while the average wait is longer
+ * than half the maximum budget, where spinning would mostly burn CPU. The
+ * time spent spinning and blocked is reported, so the trade-off can be tuned
+ * per serial port.
+ */
+class BusyPollReader final
+{
+public:
+    /**
+     * @brief Construct a new BusyPollReader object
+     *
+     * @param serialPort Open serial port
+     * @param maxSpinBudget Maximum time to spin before blocking
+     * @throw std::out_of_range Invalid spin budget
+     */
+    explicit BusyPollReader(SerialPort& serialPort, std::chrono::nanoseconds maxSpinBudget = DEFAULT_SPIN_BUDGET);
+
+    /**
+     * @brief Copy-construct a new BusyPollReader object
+     *
+     * @param busyPollReader Busy-poll reader
+     */
+    BusyPollReader(const BusyPollReader& busyPollReader) = delete;
+
+    /**
+     * @brief Move-construct a new BusyPollReader object
+     *
+     * @param busyPollReader Busy-poll reader
+     */
+    BusyPollReader(BusyPollReader&& busyPollReader) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param busyPollReader Busy-poll reader to copy-assign
+     * @return BusyPollReader& Assigned busy-poll reader
+     */
+    BusyPollReader& operator=(const BusyPollReader& busyPollReader) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param busyPollReader Busy-poll reader to move-assign
+     * @return BusyPollReader& Assigned busy-poll reader
+     */
+    BusyPollReader& operator=(BusyPollReader&& busyPollReader) = delete;
+
+    /**
+     * @brief Destroy the BusyPollReader object
+     *
+     */
+    ~BusyPollReader() noexcept = default;
+
+    /**
+     * @brief Read data, spinning for the spin budget before blocking
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param timeout Maximum time to wait for data including the spin budget
+     * @param error Error code, std::errc::timed_out without data within the timeout,
+     *   SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually read, 0 on error
+     */
+    size_t read(char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error);
+
+    /**
+     * @brief Get the current spin budget
+     *
+     * @return std::chrono::nanoseconds Time to spin before blocking
+     */
+    std::chrono::nanoseconds getSpinBudget() const;
+
+    /**
+     * @brief Get the maximum spin budget
+     *
+     * @return std::chrono::nanoseconds Maximum time to spin before blocking
+     */
+    std::chrono::nanoseconds getMaxSpinBudget() const;
+
+    /**
+     * @brief Set the maximum spin budget
+     *
+     * @param maxSpinBudget Maximum time to spin before blocking
+     * @throw std::out_of_range Invalid spin budget
+     */
+    void setMaxSpinBudget(std::chrono::nanoseconds maxSpinBudget);
+
+    /**
+     * @brief Get the adaptive spinning status
+     *
+     * @return true Spin budget follows the observed waits for data
+     * @return false Spin budget is the maximum spin budget
+     */
+    bool isAdaptive() const;
+
+    /**
+     * @brief Enable or disable adaptive spinning
+     *
+     * @param adaptive Spin budget follows the observed waits for data
+     */
+    void setAdaptive(bool adaptive);
+
+    /**
+     * @brief Get the busy-poll reader statistics
+     *
+     * @return BusyPollStatistics Busy-poll reader statistics
+     */
+    BusyPollStatistics getStatistics() const;
+
+    /**
+     * @brief Reset the busy-poll reader statistics
+     *
+     */
+    void resetStatistics();
+protected:
+    /**
+     * @brief Update the spin budget with the wait for data of a read
+     *
+     * @param wait Time from the start of the read to the arrival of data
+     */
+    void adapt(std::chrono::nanoseconds wait);
+
+    /**
+     * @brief Read serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Current spin budget
+     *
+     */
+    std::chrono::nanoseconds spinBudget;
+
+    /**
+     * @brief Maximum spin budget
+     *
+     */
+    std::chrono::nanoseconds maxSpinBudget;
+
+    /**
+     * @brief Moving average of the waits for data
+     *
+     */
+    std::chrono::nanoseconds averageWait;
+
+    /**
+     * @brief Adaptive spinning status
+     *
+     */
+    bool adaptive;
+
+    /**
+     * @brief Busy-poll reader statistics
+     *
+     */
+    BusyPollStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
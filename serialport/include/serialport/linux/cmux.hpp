@@ -0,0 +1,1090 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <poll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Highest data link connection identifier
+ *
+ */
+static constexpr uint8_t CMUX_MAX_DLCI{63};
+
+/**
+ * @brief Default maximum size of the information field of a frame (N1)
+ *
+ */
+static constexpr size_t DEFAULT_CMUX_FRAME_SIZE{127};
+
+/**
+ * @brief Minimum size of the information field of a frame (N1) holding any control channel message
+ *
+ */
+static constexpr size_t CMUX_MIN_FRAME_SIZE{16};
+
+/**
+ * @brief Maximum size of the information field of a frame (N1)
+ *
+ */
+static constexpr size_t CMUX_MAX_FRAME_SIZE{32768};
+
+/**
+ * @brief Default size of the receive and transmit buffers of a channel
+ *
+ */
+static constexpr size_t DEFAULT_CMUX_BUFFER_SIZE{65536};
+
+/**
+ * @brief Multiplexer framing mode
+ *
+ */
+enum class CmuxMode : unsigned char
+{
+    /**
+     * @brief Basic option, frames delimited by 0xF9 with a length field
+     *
+     */
+    CMUX_MODE_BASIC = 0U,
+
+    /**
+     * @brief Advanced option, frames delimited by 0x7E with control octet transparency
+     *
+     */
+    CMUX_MODE_ADVANCED = 1U,
+};
+
+/**
+ * @brief Multiplexer channel state
+ *
+ */
+enum class CmuxChannelState : unsigned char
+{
+    /**
+     * @brief Channel is closed
+     *
+     */
+    CMUX_CHANNEL_CLOSED = 0U,
+
+    /**
+     * @brief SABM sent, waiting for the response
+     *
+     */
+    CMUX_CHANNEL_OPENING = 1U,
+
+    /**
+     * @brief Channel is open
+     *
+     */
+    CMUX_CHANNEL_OPEN = 2U,
+
+    /**
+     * @brief DISC or close down sent, waiting for the response
+     *
+     */
+    CMUX_CHANNEL_CLOSING = 3U,
+};
+
+/**
+ * @brief Multiplexer statistics
+ *
+ */
+struct CmuxStatistics
+{
+    /**
+     * @brief Number of transmitted frames
+     *
+     */
+    uint64_t transmittedFrameCount{0};
+
+    /**
+     * @brief Number of received valid frames
+     *
+     */
+    uint64_t receivedFrameCount{0};
+
+    /**
+     * @brief Number of received frames with a frame check sequence mismatch
+     *
+     */
+    uint64_t frameCheckErrorCount{0};
+
+    /**
+     * @brief Number of malformed or unexpected frames
+     *
+     */
+    uint64_t invalidFrameCount{0};
+
+    /**
+     * @brief Size of the received data discarded outside of frames
+     *
+     */
+    uint64_t discardedCount{0};
+
+    /**
+     * @brief Number of control channel commands answered as not supported
+     *
+     */
+    uint64_t unsupportedCount{0};
+};
+
+/**
+ * @brief Multiplexer channel statistics
+ *
+ */
+struct CmuxChannelStatistics
+{
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Size of the received data
+     *
+     */
+    uint64_t receivedCount{0};
+
+    /**
+     * @brief Size of the received data dropped on a full receive buffer
+     *
+     */
+    uint64_t droppedCount{0};
+
+    /**
+     * @brief Number of times the peer stopped the transmission of the channel
+     *
+     */
+    uint64_t flowStopCount{0};
+
+    /**
+     * @brief Number of times the transmission of the peer was stopped by a full receive buffer
+     *
+     */
+    uint64_t flowOffCount{0};
+};
+
+/**
+ * @brief Forward declaration of the multiplexer class
+ *
+ */
+class CmuxMultiplexer;
+
+/**
+ * @brief CmuxChannel class
+ *
+ * Endpoint of a single data link connection of a multiplexer with a serial
+ * port like interface. Data is exchanged either through read() and write()
+ * from the thread servicing the multiplexer or, for channels backed by a
+ * pseudo terminal, by any process opening the slave side given by
+ * getPortName().
+ *
+ * The V.24 signals of the channel are carried by modem status commands:
+ * DTR and RTS are sent to the peer, DSR, CTS, DCD and RI are received from it.
+ */
+class CmuxChannel final
+{
+    friend class CmuxMultiplexer;
+public:
+    /**
+     * @brief Copy-construct a new CmuxChannel object
+     *
+     * @param cmuxChannel Multiplexer channel
+     */
+    CmuxChannel(const CmuxChannel& cmuxChannel) = delete;
+
+    /**
+     * @brief Move-construct a new CmuxChannel object
+     *
+     * @param cmuxChannel Multiplexer channel
+     */
+    CmuxChannel(CmuxChannel&& cmuxChannel) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param cmuxChannel Multiplexer channel to copy-assign
+     * @return CmuxChannel& Assigned multiplexer channel
+     */
+    CmuxChannel& operator=(const CmuxChannel& cmuxChannel) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param cmuxChannel Multiplexer channel to move-assign
+     * @return CmuxChannel& Assigned multiplexer channel
+     */
+    CmuxChannel& operator=(CmuxChannel&& cmuxChannel) = delete;
+
+    /**
+     * @brief Destroy the CmuxChannel object
+     *
+     */
+    ~CmuxChannel() noexcept;
+
+    /**
+     * @brief Get the channel open status
+     *
+     * @return true Channel is open
+     * @return false Channel is not open
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the channel state
+     *
+     * @return CmuxChannelState Channel state
+     */
+    CmuxChannelState getState() const;
+
+    /**
+     * @brief Get the data link connection identifier
+     *
+     * @return uint8_t Data link connection identifier
+     */
+    uint8_t getDlci() const;
+
+    /**
+     * @brief Get the port name
+     *
+     * @return std::string Slave name of the pseudo terminal or an empty string
+     */
+    std::string getPortName() const;
+
+    /**
+     * @brief Read data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @return size_t Size of the data actually read
+     */
+    size_t read(char* buffer, size_t size);
+
+    /**
+     * @brief Read all the received data
+     *
+     * @param buffer Data buffer
+     * @return size_t Size of the data actually read
+     */
+    size_t read(std::string& buffer);
+
+    /**
+     * @brief Write data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @return size_t Size of the data queued for transmission, 0 on a closed channel or a full buffer
+     */
+    size_t write(const char* buffer, size_t size);
+
+    /**
+     * @brief Write data
+     *
+     * @param buffer Data buffer
+     * @return size_t Size of the data queued for transmission, 0 on a closed channel or a full buffer
+     */
+    size_t write(const std::string& buffer);
+
+    /**
+     * @brief Flush all pending received data
+     *
+     */
+    void flushInput();
+
+    /**
+     * @brief Flush all pending transmit data
+     *
+     */
+    void flushOutput();
+
+    /**
+     * @brief Get the input queue count
+     *
+     * @return size_t Size of the received data not read yet
+     */
+    size_t getInputQueueCount() const;
+
+    /**
+     * @brief Get the output queue count
+     *
+     * @return size_t Size of the data not transmitted yet
+     */
+    size_t getOutputQueueCount() const;
+
+    /**
+     * @brief Get the control line status
+     *
+     * @param controlLine Control line
+     * @return true Control line is enabled
+     * @return false Control line is disabled
+     */
+    bool getControlLine(ControlLine controlLine) const;
+
+    /**
+     * @brief Set the control line status, sent to the peer by the multiplexer
+     *
+     * @param controlLine Control line, DTR or RTS
+     * @param state Control line status
+     * @return true Successfully set control line status
+     * @return false Control line is an input
+     */
+    bool setControlLine(ControlLine controlLine, bool state);
+
+    /**
+     * @brief Get the flow control status
+     *
+     * @return true Peer stopped the transmission of the channel
+     * @return false Channel may transmit
+     */
+    bool isFlowStopped() const;
+
+    /**
+     * @brief Get the channel statistics
+     *
+     * @return CmuxChannelStatistics Channel statistics
+     */
+    CmuxChannelStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Byte ring buffer of a fixed capacity
+     *
+     */
+    struct Queue
+    {
+        /**
+         * @brief Construct a new Queue object
+         *
+         * @param capacity Capacity
+         */
+        explicit Queue(size_t capacity);
+
+        /**
+         * @brief Get the free space
+         *
+         * @return size_t Size of the data which may be appended
+         */
+        size_t getFree() const;
+
+        /**
+         * @brief Append data
+         *
+         * @param data Data
+         * @param size Size of the data
+         * @return size_t Size of the appended data
+         */
+        size_t push(const char* data, size_t size);
+
+        /**
+         * @brief Remove data from the front
+         *
+         * @param data Data buffer
+         * @param size Size of the data buffer
+         * @return size_t Size of the removed data
+         */
+        size_t pop(char* data, size_t size);
+
+        /**
+         * @brief Get the contiguous data at the front
+         *
+         * @param data Start of the data
+         * @return size_t Size of the contiguous data
+         */
+        size_t peek(const char*& data) const;
+
+        /**
+         * @brief Remove data from the front after peek()
+         *
+         * @param size Size of the data
+         */
+        void consume(size_t size);
+
+        /**
+         * @brief Get the contiguous free space at the back
+         *
+         * @param data Start of the free space
+         * @return size_t Size of the contiguous free space
+         */
+        size_t reserve(char*& data);
+
+        /**
+         * @brief Append data written to the space obtained by reserve()
+         *
+         * @param size Size of the data
+         */
+        void commit(size_t size);
+
+        /**
+         * @brief Remove all the data
+         *
+         */
+        void clear();
+
+        /**
+         * @brief Storage
+         *
+         */
+        std::vector<char> storage;
+
+        /**
+         * @brief Start of the data
+         *
+         */
+        size_t begin;
+
+        /**
+         * @brief Size of the data
+         *
+         */
+        size_t size;
+    };
+
+    /**
+     * @brief Construct a new CmuxChannel object
+     *
+     * @param dlci Data link connection identifier
+     * @param bufferSize Size of the receive and transmit buffers
+     * @param pseudoTerminal Back the channel by a pseudo terminal
+     * @throw std::runtime_error Unable to open pseudo terminal
+     */
+    explicit CmuxChannel(uint8_t dlci, size_t bufferSize, bool pseudoTerminal);
+
+    /**
+     * @brief Data link connection identifier
+     *
+     */
+    uint8_t dlci;
+
+    /**
+     * @brief Channel state
+     *
+     */
+    CmuxChannelState state;
+
+    /**
+     * @brief Received data
+     *
+     */
+    Queue input;
+
+    /**
+     * @brief Data to transmit
+     *
+     */
+    Queue output;
+
+    /**
+     * @brief Master side of the pseudo terminal
+     *
+     */
+    int master;
+
+    /**
+     * @brief Slave side of the pseudo terminal, kept open to avoid hang-ups
+     *
+     */
+    int slave;
+
+    /**
+     * @brief Slave name of the pseudo terminal
+     *
+     */
+    std::string slaveName;
+
+    /**
+     * @brief V.24 signals sent to the peer
+     *
+     */
+    uint8_t localSignals;
+
+    /**
+     * @brief V.24 signals received from the peer
+     *
+     */
+    uint8_t peerSignals;
+
+    /**
+     * @brief Local signals must be sent to the peer
+     *
+     */
+    bool signalsChanged;
+
+    /**
+     * @brief Peer stopped the transmission of the channel
+     *
+     */
+    bool peerStopped;
+
+    /**
+     * @brief Transmission of the peer is stopped by a full receive buffer
+     *
+     */
+    bool localStopped;
+
+    /**
+     * @brief Channel statistics
+     *
+     */
+    CmuxChannelStatistics statistics;
+};
+
+/**
+ * @brief CmuxMultiplexer class
+ *
+ * User space 3GPP TS 27.010 multiplexer running over an open serial port in
+ * the basic or the advanced option. The multiplexer either initiates the
+ * multiplexer session and opens the channels by connect() and openChannel(),
+ * or responds to a peer that does and accepts the channels it opens.
+ *
+ * A single thread services the serial port and all the channels, including
+ * their pseudo terminals, from one event loop. Data of the channels is
+ * transmitted round-robin in frames of at most the frame size (N1) and
+ * control channel frames are transmitted ahead of data. Flow control
+ * follows the peer's modem status command FC bit per channel and the
+ * FCon/FCoff commands for all channels, and stops the peer's transmission of
+ * a channel by the FC bit once half of the receive buffer is filled.
+ *
+ * A hang-up or an I/O error of the serial port closes the session and all the
+ * channels, ends the event loop and is reported by isFailed(); the failed
+ * multiplexer does not connect again.
+ *
+ * All members but stop() must be called from the thread running the event
+ * loop. Blocking members run the event loop while they wait.
+ */
+class CmuxMultiplexer final
+{
+public:
+    /**
+     * @brief Construct a new CmuxMultiplexer object
+     *
+     * @param serialPort Open serial port
+     * @param mode Framing mode
+     * @param frameSize Maximum size of the information field of a frame (N1)
+     * @param bufferSize Size of the receive and transmit buffers of each channel
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create event
+     * @throw std::out_of_range Invalid frame or buffer size
+     */
+    explicit CmuxMultiplexer(SerialPort& serialPort, CmuxMode mode = CmuxMode::CMUX_MODE_BASIC,
+        size_t frameSize = DEFAULT_CMUX_FRAME_SIZE, size_t bufferSize = DEFAULT_CMUX_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new CmuxMultiplexer object
+     *
+     * @param cmuxMultiplexer Multiplexer
+     */
+    CmuxMultiplexer(const CmuxMultiplexer& cmuxMultiplexer) = delete;
+
+    /**
+     * @brief Move-construct a new CmuxMultiplexer object
+     *
+     * @param cmuxMultiplexer Multiplexer
+     */
+    CmuxMultiplexer(CmuxMultiplexer&& cmuxMultiplexer) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param cmuxMultiplexer Multiplexer to copy-assign
+     * @return CmuxMultiplexer& Assigned multiplexer
+     */
+    CmuxMultiplexer& operator=(const CmuxMultiplexer& cmuxMultiplexer) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param cmuxMultiplexer Multiplexer to move-assign
+     * @return CmuxMultiplexer& Assigned multiplexer
+     */
+    CmuxMultiplexer& operator=(CmuxMultiplexer&& cmuxMultiplexer) = delete;
+
+    /**
+     * @brief Destroy the CmuxMultiplexer object
+     *
+     */
+    ~CmuxMultiplexer() noexcept;
+
+    /**
+     * @brief Start the multiplexer session as the initiator
+     *
+     * @param timeout Maximum time to wait for the response
+     * @return true Multiplexer session started
+     * @return false Peer refused or did not respond
+     */
+    bool connect(std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+    /**
+     * @brief Close down the multiplexer session and all its channels
+     *
+     * @param timeout Maximum time to wait for the response
+     * @return true Peer confirmed the close down
+     * @return false Peer did not respond, the session is closed regardless
+     */
+    bool disconnect(std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+    /**
+     * @brief Get the multiplexer session status
+     *
+     * @return true Multiplexer session is started
+     * @return false Multiplexer session is closed
+     */
+    bool isConnected() const;
+
+    /**
+     * @brief Open a channel
+     *
+     * @param dlci Data link connection identifier
+     * @param pseudoTerminal Back the channel by a pseudo terminal
+     * @param timeout Maximum time to wait for the response
+     * @return true Channel is open
+     * @return false Session is closed or the peer refused or did not respond
+     * @throw std::out_of_range Invalid data link connection identifier
+     * @throw std::runtime_error Unable to open pseudo terminal
+     */
+    bool openChannel(uint8_t dlci, bool pseudoTerminal = false,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+    /**
+     * @brief Close a channel
+     *
+     * @param dlci Data link connection identifier
+     * @param timeout Maximum time to wait for the response
+     * @return true Peer confirmed the close
+     * @return false Peer did not respond, the channel is closed regardless
+     * @throw std::out_of_range Invalid data link connection identifier
+     */
+    bool closeChannel(uint8_t dlci, std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+    /**
+     * @brief Get a channel
+     *
+     * @param dlci Data link connection identifier
+     * @return CmuxChannel& Channel opened by either side
+     * @throw std::out_of_range Invalid data link connection identifier or unknown channel
+     */
+    CmuxChannel& getChannel(uint8_t dlci);
+
+    /**
+     * @brief Set whether channels opened by the peer are accepted
+     *
+     * @param accept Accept channels opened by the peer
+     * @param pseudoTerminal Back accepted channels by a pseudo terminal
+     */
+    void setAcceptChannels(bool accept, bool pseudoTerminal = false);
+
+    /**
+     * @brief Process pending events once
+     *
+     * @param timeout Maximum time to wait for an event
+     * @return size_t Number of received valid frames
+     */
+    size_t poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Process events until stopped or the serial port fails
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop the event loop
+     *
+     * @note May be called from another thread
+     */
+    void stop();
+
+    /**
+     * @brief Get the failed status
+     *
+     * @return true Serial port hung up or failed, the session and all the channels are closed
+     * @return false Serial port is operational
+     */
+    bool isFailed() const;
+
+    /**
+     * @brief Get the framing mode
+     *
+     * @return CmuxMode Framing mode
+     */
+    CmuxMode getMode() const;
+
+    /**
+     * @brief Get the frame size
+     *
+     * @return size_t Maximum size of the information field of a frame (N1)
+     */
+    size_t getFrameSize() const;
+
+    /**
+     * @brief Get the multiplexer statistics
+     *
+     * @return CmuxStatistics Multiplexer statistics
+     */
+    CmuxStatistics getStatistics() const;
+
+    /**
+     * @brief Get the maximum size of an encoded frame
+     *
+     * @param mode Framing mode
+     * @param size Size of the information field
+     * @return size_t Maximum size of the encoded frame including the flags
+     */
+    static size_t getMaxEncodedSize(CmuxMode mode, size_t size);
+
+    /**
+     * @brief Encode a frame
+     *
+     * @param mode Framing mode
+     * @param address Address field
+     * @param control Control field
+     * @param data Information field
+     * @param size Size of the information field
+     * @param output Output buffer of at least getMaxEncodedSize() bytes
+     * @return size_t Size of the encoded frame
+     */
+    static size_t encodeFrame(CmuxMode mode, uint8_t address, uint8_t control, const char* data, size_t size, char* output);
+protected:
+    /**
+     * @brief Get the state of a channel or of the control channel
+     *
+     * @param dlci Data link connection identifier
+     * @return CmuxChannelState& Channel state
+     */
+    CmuxChannelState& getState(uint8_t dlci);
+
+    /**
+     * @brief Run the event loop while a channel is opening or closing
+     *
+     * @param dlci Data link connection identifier
+     * @param timeout Maximum time to wait
+     * @return true Peer responded
+     * @return false Timeout or the serial port failed
+     */
+    bool waitForResponse(uint8_t dlci, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Get the address field of a frame
+     *
+     * @param dlci Data link connection identifier
+     * @param command Frame is a command
+     * @return uint8_t Address field
+     */
+    uint8_t getAddress(uint8_t dlci, bool command) const;
+
+    /**
+     * @brief Queue a frame ahead of the channel data
+     *
+     * @param dlci Data link connection identifier
+     * @param command Frame is a command
+     * @param control Control field
+     * @param data Information field
+     * @param size Size of the information field
+     */
+    void queueFrame(uint8_t dlci, bool command, uint8_t control, const char* data = nullptr, size_t size = 0);
+
+    /**
+     * @brief Queue a control channel message
+     *
+     * @param type Message type without the command/response and extension bits
+     * @param command Message is a command
+     * @param values Message values
+     */
+    void queueMessage(uint8_t type, bool command, std::string_view values);
+
+    /**
+     * @brief Queue the modem status command of a channel
+     *
+     * @param channel Channel
+     */
+    void queueSignals(CmuxChannel& channel);
+
+    /**
+     * @brief Create a channel object
+     *
+     * @param dlci Data link connection identifier
+     * @param pseudoTerminal Back the channel by a pseudo terminal
+     * @return CmuxChannel& Channel
+     * @throw std::runtime_error Unable to open pseudo terminal
+     */
+    CmuxChannel& createChannel(uint8_t dlci, bool pseudoTerminal);
+
+    /**
+     * @brief Close the session and all the channels
+     *
+     */
+    void closeAll();
+
+    /**
+     * @brief Close the session and all the channels after a hang-up or an I/O error
+     *
+     */
+    void fail();
+
+    /**
+     * @brief Update the flow control and modem status of all the channels
+     *
+     */
+    void updateChannels();
+
+    /**
+     * @brief Fill the transmit buffer with control frames and channel data
+     *
+     */
+    void fill();
+
+    /**
+     * @brief Write the transmit buffer to the serial port
+     *
+     */
+    void flush();
+
+    /**
+     * @brief Read and decode frames from the serial port
+     *
+     * @return size_t Number of received valid frames
+     */
+    size_t receive();
+
+    /**
+     * @brief Decode basic option frames from the receive buffer
+     *
+     * @return size_t Number of received valid frames
+     */
+    size_t decodeBasic();
+
+    /**
+     * @brief Decode advanced option frames from the receive buffer
+     *
+     * @return size_t Number of received valid frames
+     */
+    size_t decodeAdvanced();
+
+    /**
+     * @brief Handle a received frame
+     *
+     * @param address Address field
+     * @param control Control field
+     * @param data Information field
+     */
+    void dispatch(uint8_t address, uint8_t control, std::string_view data);
+
+    /**
+     * @brief Handle a SABM frame
+     *
+     * @param dlci Data link connection identifier
+     */
+    void handleOpen(uint8_t dlci);
+
+    /**
+     * @brief Handle the messages of a control channel frame
+     *
+     * @param data Information field
+     */
+    void handleControl(std::string_view data);
+
+    /**
+     * @brief Handle a control channel message
+     *
+     * @param type Message type including the command/response and extension bits
+     * @param values Message values
+     */
+    void handleMessage(uint8_t type, std::string_view values);
+
+    /**
+     * @brief Handle received channel data
+     *
+     * @param channel Channel
+     * @param data Data
+     */
+    void handleData(CmuxChannel& channel, std::string_view data);
+
+    /**
+     * @brief Move data from the pseudo terminal to the transmit buffer of a channel
+     *
+     * @param channel Channel
+     */
+    void readPseudoTerminal(CmuxChannel& channel);
+
+    /**
+     * @brief Move data from the receive buffer of a channel to its pseudo terminal
+     *
+     * @param channel Channel
+     */
+    void writePseudoTerminal(CmuxChannel& channel);
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Framing mode
+     *
+     */
+    CmuxMode mode;
+
+    /**
+     * @brief Maximum size of the information field of a frame
+     *
+     */
+    size_t frameSize;
+
+    /**
+     * @brief Size of the receive and transmit buffers of each channel
+     *
+     */
+    size_t bufferSize;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Event loop stop request
+     *
+     */
+    bool stopped;
+
+    /**
+     * @brief Serial port hung up or failed
+     *
+     */
+    bool failed;
+
+    /**
+     * @brief Multiplexer started the session
+     *
+     */
+    bool initiator;
+
+    /**
+     * @brief Channels opened by the peer are accepted
+     *
+     */
+    bool accept;
+
+    /**
+     * @brief Accepted channels are backed by a pseudo terminal
+     *
+     */
+    bool acceptPseudoTerminal;
+
+    /**
+     * @brief State of the control channel
+     *
+     */
+    CmuxChannelState controlState;
+
+    /**
+     * @brief Peer stopped the transmission of all the channels
+     *
+     */
+    bool aggregateStopped;
+
+    /**
+     * @brief Channels by data link connection identifier
+     *
+     */
+    std::array<std::unique_ptr<CmuxChannel>, CMUX_MAX_DLCI + 1> channels;
+
+    /**
+     * @brief Channel transmitted last
+     *
+     */
+    uint8_t nextChannel;
+
+    /**
+     * @brief Encoded control frames
+     *
+     */
+    std::string controlQueue;
+
+    /**
+     * @brief Transmit buffer
+     *
+     */
+    std::vector<char> transmitBuffer;
+
+    /**
+     * @brief Start of the data not written yet
+     *
+     */
+    size_t transmitBegin;
+
+    /**
+     * @brief End of the data in the transmit buffer
+     *
+     */
+    size_t transmitEnd;
+
+    /**
+     * @brief Receive buffer
+     *
+     */
+    std::vector<char> receiveBuffer;
+
+    /**
+     * @brief End of the received data
+     *
+     */
+    size_t receiveEnd;
+
+    /**
+     * @brief Information field of a frame being encoded or decoded
+     *
+     */
+    std::vector<char> frame;
+
+    /**
+     * @brief Poll descriptors
+     *
+     */
+    std::vector<struct pollfd> descriptors;
+
+    /**
+     * @brief Channels of the pseudo terminal poll descriptors
+     *
+     */
+    std::vector<CmuxChannel*> descriptorChannels;
+
+    /**
+     * @brief Multiplexer statistics
+     *
+     */
+    CmuxStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,425 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_rtu.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief ModbusMaster class
+ *
+ * Modbus RTU master (client) on an open serial port. Every request is
+ * followed by a wait for the matching response: frames from other units or
+ * with another function code (e.g. late responses to a timed out request)
+ * are discarded, echoed fields of write responses are compared with the
+ * request and the byte counts of read responses are validated.
+ *
+ * The response timeout starts once the request has left the transmit queue.
+ * Requests to the broadcast address are not answered, the line is held idle
+ * for the turnaround delay instead.
+ */
+class ModbusMaster final
+{
+public:
+    /**
+     * @brief Construct a new ModbusMaster object
+     *
+     * @param serialPort Open serial port
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create timer
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    explicit ModbusMaster(SerialPort& serialPort);
+
+    /**
+     * @brief Copy-construct a new ModbusMaster object
+     *
+     * @param modbusMaster Modbus master
+     */
+    ModbusMaster(const ModbusMaster& modbusMaster) = delete;
+
+    /**
+     * @brief Move-construct a new ModbusMaster object
+     *
+     * @param modbusMaster Modbus master
+     */
+    ModbusMaster(ModbusMaster&& modbusMaster) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param modbusMaster Modbus master to copy-assign
+     * @return ModbusMaster& Assigned Modbus master
+     */
+    ModbusMaster& operator=(const ModbusMaster& modbusMaster) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param modbusMaster Modbus master to move-assign
+     * @return ModbusMaster& Assigned Modbus master
+     */
+    ModbusMaster& operator=(ModbusMaster&& modbusMaster) = delete;
+
+    /**
+     * @brief Destroy the ModbusMaster object
+     *
+     */
+    ~ModbusMaster() noexcept = default;
+
+    /**
+     * @brief Read coils (0x01)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of coils
+     * @param values Coil values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readCoils(uint8_t unit, uint16_t address, uint16_t count, bool* values);
+
+    /**
+     * @brief Read discrete inputs (0x02)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of discrete inputs
+     * @param values Discrete input values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readDiscreteInputs(uint8_t unit, uint16_t address, uint16_t count, bool* values);
+
+    /**
+     * @brief Read holding registers (0x03)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of registers
+     * @param values Register values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readHoldingRegisters(uint8_t unit, uint16_t address, uint16_t count, uint16_t* values);
+
+    /**
+     * @brief Read input registers (0x04)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of registers
+     * @param values Register values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readInputRegisters(uint8_t unit, uint16_t address, uint16_t count, uint16_t* values);
+
+    /**
+     * @brief Write single coil (0x05)
+     *
+     * @param unit Unit address
+     * @param address Coil address
+     * @param value Coil value
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus writeSingleCoil(uint8_t unit, uint16_t address, bool value);
+
+    /**
+     * @brief Write single register (0x06)
+     *
+     * @param unit Unit address
+     * @param address Register address
+     * @param value Register value
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus writeSingleRegister(uint8_t unit, uint16_t address, uint16_t value);
+
+    /**
+     * @brief Read exception status (0x07)
+     *
+     * @param unit Unit address
+     * @param status Exception status outputs
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readExceptionStatus(uint8_t unit, uint8_t& status);
+
+    /**
+     * @brief Diagnostics (0x08)
+     *
+     * @param unit Unit address
+     * @param subFunction Sub-function code
+     * @param data Request data
+     * @param result Response data
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus diagnostics(uint8_t unit, uint16_t subFunction, uint16_t data, uint16_t& result);
+
+    /**
+     * @brief Get communication event counter (0x0B)
+     *
+     * @param unit Unit address
+     * @param status Status word
+     * @param eventCount Event count
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus getCommEventCounter(uint8_t unit, uint16_t& status, uint16_t& eventCount);
+
+    /**
+     * @brief Get communication event log (0x0C)
+     *
+     * @param unit Unit address
+     * @param log Status, event count, message count and events, valid until the next request
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus getCommEventLog(uint8_t unit, std::string_view& log);
+
+    /**
+     * @brief Write multiple coils (0x0F)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of coils
+     * @param values Coil values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus writeMultipleCoils(uint8_t unit, uint16_t address, uint16_t count, const bool* values);
+
+    /**
+     * @brief Write multiple registers (0x10)
+     *
+     * @param unit Unit address
+     * @param address Starting address
+     * @param count Number of registers
+     * @param values Register values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus writeMultipleRegisters(uint8_t unit, uint16_t address, uint16_t count, const uint16_t* values);
+
+    /**
+     * @brief Report server identifier (0x11)
+     *
+     * @param unit Unit address
+     * @param data Server identifier, run indicator and additional data, valid until the next request
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus reportServerId(uint8_t unit, std::string_view& data);
+
+    /**
+     * @brief Read a single file record (0x14)
+     *
+     * @param unit Unit address
+     * @param file File number
+     * @param record Starting record number
+     * @param count Number of registers
+     * @param values Register values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readFileRecord(uint8_t unit, uint16_t file, uint16_t record, uint16_t count, uint16_t* values);
+
+    /**
+     * @brief Write a single file record (0x15)
+     *
+     * @param unit Unit address
+     * @param file File number
+     * @param record Starting record number
+     * @param count Number of registers
+     * @param values Register values
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus writeFileRecord(uint8_t unit, uint16_t file, uint16_t record, uint16_t count, const uint16_t* values);
+
+    /**
+     * @brief Mask write register (0x16)
+     *
+     * @param unit Unit address
+     * @param address Register address
+     * @param andMask AND mask
+     * @param orMask OR mask
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus maskWriteRegister(uint8_t unit, uint16_t address, uint16_t andMask, uint16_t orMask);
+
+    /**
+     * @brief Read/write multiple registers (0x17)
+     *
+     * @param unit Unit address
+     * @param readAddress Starting address of the read
+     * @param readCount Number of registers to read
+     * @param readValues Read register values
+     * @param writeAddress Starting address of the write
+     * @param writeCount Number of registers to write
+     * @param writeValues Written register values
+     * @return ModbusStatus Transaction status
+     * @note The write is performed before the read
+     */
+    ModbusStatus readWriteMultipleRegisters(uint8_t unit, uint16_t readAddress, uint16_t readCount, uint16_t* readValues,
+        uint16_t writeAddress, uint16_t writeCount, const uint16_t* writeValues);
+
+    /**
+     * @brief Read FIFO queue (0x18)
+     *
+     * @param unit Unit address
+     * @param address FIFO pointer address
+     * @param values Register values, space for MODBUS_MAX_FIFO_COUNT registers
+     * @param count Number of registers read
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readFifoQueue(uint8_t unit, uint16_t address, uint16_t* values, uint16_t& count);
+
+    /**
+     * @brief Encapsulated interface transport (0x2B)
+     *
+     * @param unit Unit address
+     * @param meiType MEI type (e.g. 0x0E for read device identification)
+     * @param data MEI request data
+     * @param size Size of the MEI request data
+     * @param response MEI response data following the MEI type, valid until the next request
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus encapsulatedInterfaceTransport(uint8_t unit, uint8_t meiType, const char* data, size_t size,
+        std::string_view& response);
+
+    /**
+     * @brief Perform a raw transaction
+     *
+     * @param unit Unit address
+     * @param function Function code
+     * @param data Request data following the function code
+     * @param size Size of the request data
+     * @param response Response data following the function code, valid until the next request
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus transact(uint8_t unit, ModbusFunction function, const char* data, size_t size, std::string_view& response);
+
+    /**
+     * @brief Get the exception code of the last exception response
+     *
+     * @return ModbusException Exception code
+     */
+    ModbusException getLastException() const;
+
+    /**
+     * @brief Get the response timeout
+     *
+     * @return std::chrono::milliseconds Maximum time to wait for a response
+     */
+    std::chrono::milliseconds getResponseTimeout() const;
+
+    /**
+     * @brief Set the response timeout
+     *
+     * @param responseTimeout Maximum time to wait for a response
+     */
+    void setResponseTimeout(std::chrono::milliseconds responseTimeout);
+
+    /**
+     * @brief Get the turnaround delay after a broadcast request
+     *
+     * @return std::chrono::milliseconds Turnaround delay
+     */
+    std::chrono::milliseconds getTurnaroundDelay() const;
+
+    /**
+     * @brief Set the turnaround delay after a broadcast request
+     *
+     * @param turnaroundDelay Turnaround delay
+     */
+    void setTurnaroundDelay(std::chrono::milliseconds turnaroundDelay);
+
+    /**
+     * @brief Get the underlying Modbus RTU link
+     *
+     * @return ModbusRtuLink& Modbus RTU link
+     * @note Call ModbusRtuLink::updateTiming after changing the serial port settings
+     */
+    ModbusRtuLink& getLink();
+protected:
+    /**
+     * @brief Start a request in the transmit buffer
+     *
+     * @param unit Unit address
+     * @param function Function code
+     * @return char* Request data following the function code
+     */
+    char* startRequest(uint8_t unit, ModbusFunction function);
+
+    /**
+     * @brief Transmit the request and wait for the matching response
+     *
+     * @param size Size of the request data following the function code
+     * @param echoSize Size of the request data the response has to echo
+     * @param response Response data following the function code
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus execute(size_t size, size_t echoSize, std::string_view& response);
+
+    /**
+     * @brief Read registers or coils with a byte counted response
+     *
+     * @param unit Unit address
+     * @param function Function code
+     * @param address Starting address
+     * @param count Number of values
+     * @param byteCount Expected byte count of the response
+     * @param response Response data following the byte count
+     * @return ModbusStatus Transaction status
+     */
+    ModbusStatus readValues(uint8_t unit, ModbusFunction function, uint16_t address, uint16_t count,
+        size_t byteCount, std::string_view& response);
+
+    /**
+     * @brief Modbus RTU link
+     *
+     */
+    ModbusRtuLink link;
+
+    /**
+     * @brief Transmit buffer
+     *
+     */
+    std::array<char, MODBUS_MAX_FRAME_SIZE> transmitBuffer;
+
+    /**
+     * @brief Exception code of the last exception response
+     *
+     */
+    ModbusException lastException;
+
+    /**
+     * @brief Response timeout
+     *
+     */
+    std::chrono::milliseconds responseTimeout;
+
+    /**
+     * @brief Turnaround delay after a broadcast request
+     *
+     */
+    std::chrono::milliseconds turnaroundDelay;
+};
+
+END_NAMESPACE_LIBSERIAL
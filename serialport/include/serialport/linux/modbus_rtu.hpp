@@ -0,0 +1,285 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Modbus RTU link statistics
+ *
+ */
+struct ModbusLinkStatistics
+{
+    /**
+     * @brief Number of transmitted frames
+     *
+     */
+    unsigned long transmittedCount{0};
+
+    /**
+     * @brief Number of received frames with a valid CRC
+     *
+     */
+    unsigned long receivedCount{0};
+
+    /**
+     * @brief Number of received frames which failed the CRC check
+     *
+     */
+    unsigned long crcErrorCount{0};
+
+    /**
+     * @brief Number of received frames which were truncated or too long
+     *
+     */
+    unsigned long invalidFrameCount{0};
+
+    /**
+     * @brief Number of receive timeouts
+     *
+     */
+    unsigned long timeoutCount{0};
+
+    /**
+     * @brief Number of frames completed by their decoded size before the inter-frame delay
+     *
+     */
+    unsigned long earlyCompletionCount{0};
+};
+
+/**
+ * @brief ModbusRtuLink class
+ *
+ * Modbus RTU framing on an open serial port. Frame ends are detected by a
+ * timerfd armed for the inter-frame delay (t3.5) after every received chunk,
+ * so the silence is measured with the resolution of the high resolution
+ * timers instead of the 100ms granularity of VTIME. Frames whose size is
+ * known from their header are completed as soon as the last byte arrives,
+ * which bounds the turnaround by the wire time of the frame.
+ *
+ * The next transmission is delayed until the line has been idle for the
+ * inter-frame delay using an absolute CLOCK_MONOTONIC sleep.
+ *
+ * @note The inter-character timeout (t1.5) is not enforced since USB serial
+ *   adapters deliver data in bursts separated by their latency timer.
+ */
+class ModbusRtuLink final
+{
+public:
+    /**
+     * @brief Construct a new ModbusRtuLink object
+     *
+     * @param serialPort Open serial port
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create timer
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    explicit ModbusRtuLink(SerialPort& serialPort);
+
+    /**
+     * @brief Copy-construct a new ModbusRtuLink object
+     *
+     * @param modbusRtuLink Modbus RTU link
+     */
+    ModbusRtuLink(const ModbusRtuLink& modbusRtuLink) = delete;
+
+    /**
+     * @brief Move-construct a new ModbusRtuLink object
+     *
+     * @param modbusRtuLink Modbus RTU link
+     */
+    ModbusRtuLink(ModbusRtuLink&& modbusRtuLink) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param modbusRtuLink Modbus RTU link to copy-assign
+     * @return ModbusRtuLink& Assigned Modbus RTU link
+     */
+    ModbusRtuLink& operator=(const ModbusRtuLink& modbusRtuLink) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param modbusRtuLink Modbus RTU link to move-assign
+     * @return ModbusRtuLink& Assigned Modbus RTU link
+     */
+    ModbusRtuLink& operator=(ModbusRtuLink&& modbusRtuLink) = delete;
+
+    /**
+     * @brief Destroy the ModbusRtuLink object
+     *
+     */
+    ~ModbusRtuLink() noexcept;
+
+    /**
+     * @brief Recalculate the timing from the current serial port settings
+     *
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    void updateTiming();
+
+    /**
+     * @brief Get the Modbus RTU timing
+     *
+     * @return const ModbusTiming& Modbus RTU timing
+     */
+    const ModbusTiming& getTiming() const;
+
+    /**
+     * @brief Get the wire time of a frame
+     *
+     * @param size Size of the frame
+     * @return std::chrono::microseconds Time needed to transmit the frame
+     */
+    std::chrono::microseconds getWireTime(size_t size) const;
+
+    /**
+     * @brief Transmit a frame once the line has been idle for the inter-frame delay
+     *
+     * @param frame Frame including the CRC
+     * @param size Size of the frame
+     * @return ModbusStatus MODBUS_SUCCESS or MODBUS_IO_ERROR
+     */
+    ModbusStatus send(const char* frame, size_t size);
+
+    /**
+     * @brief Receive a single frame
+     *
+     * @param frame Received frame including the address and CRC, valid until the next receive
+     * @param timeout Maximum time to wait for the start of the frame
+     * @param request Frame is a request (true) or a response (false)
+     * @param stopEvent Event file descriptor ending the wait once signalled, left signalled
+     * @return ModbusStatus MODBUS_SUCCESS, MODBUS_TIMEOUT (also when stopped), MODBUS_CRC_ERROR,
+     *   MODBUS_INVALID_FRAME or MODBUS_IO_ERROR
+     */
+    ModbusStatus receive(std::string_view& frame, std::chrono::microseconds timeout, bool request,
+        int stopEvent = INVALID_FILE_DESCRIPTOR);
+
+    /**
+     * @brief Delay the next transmission
+     *
+     * @param delay Additional time the line must stay idle
+     */
+    void holdLine(std::chrono::microseconds delay);
+
+    /**
+     * @brief Set the earliest time of the next transmission
+     *
+     * @param idleTime Earliest time of the next transmission
+     * @note Allows a server to answer before the inter-frame delay following the request has elapsed
+     */
+    void setIdleTime(std::chrono::steady_clock::time_point idleTime);
+
+    /**
+     * @brief Get the time the last byte of the last frame was received
+     *
+     * @return std::chrono::steady_clock::time_point Receive time
+     */
+    std::chrono::steady_clock::time_point getReceiveTime() const;
+
+    /**
+     * @brief Discard all received data
+     *
+     */
+    void discardInput();
+
+    /**
+     * @brief Get the link statistics
+     *
+     * @return ModbusLinkStatistics Link statistics
+     */
+    ModbusLinkStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Arm or disarm the frame end timer
+     *
+     * @param delay Relative expiry or zero to disarm
+     * @return true Timer updated
+     * @return false Failed to update timer
+     */
+    bool armTimer(std::chrono::microseconds delay) const;
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Frame end timer file descriptor
+     *
+     */
+    int timer;
+
+    /**
+     * @brief Modbus RTU timing
+     *
+     */
+    ModbusTiming timing;
+
+    /**
+     * @brief Earliest time of the next transmission
+     *
+     */
+    std::chrono::steady_clock::time_point idleTime;
+
+    /**
+     * @brief Time the last byte of the last frame was received
+     *
+     */
+    std::chrono::steady_clock::time_point receiveTime;
+
+    /**
+     * @brief Receive buffer
+     *
+     */
+    std::array<char, MODBUS_MAX_FRAME_SIZE> receiveBuffer;
+
+    /**
+     * @brief Offset of the received data following the last frame
+     *
+     */
+    size_t pendingBegin;
+
+    /**
+     * @brief End of the received data following the last frame
+     *
+     */
+    size_t pendingEnd;
+
+    /**
+     * @brief Link statistics
+     *
+     */
+    ModbusLinkStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,447 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_rtu.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Modbus server statistics
+ *
+ */
+struct ModbusServerStatistics
+{
+    /**
+     * @brief Number of requests addressed to the server (including broadcasts)
+     *
+     */
+    unsigned long requestCount{0};
+
+    /**
+     * @brief Number of broadcast requests
+     *
+     */
+    unsigned long broadcastCount{0};
+
+    /**
+     * @brief Number of exception responses
+     *
+     */
+    unsigned long exceptionCount{0};
+
+    /**
+     * @brief Number of frames addressed to other units
+     *
+     */
+    unsigned long ignoredCount{0};
+
+    /**
+     * @brief Number of transmitted responses
+     *
+     */
+    unsigned long responseCount{0};
+
+    /**
+     * @brief Latency between the end of the last request and its response
+     *
+     */
+    std::chrono::nanoseconds lastResponseLatency{0};
+
+    /**
+     * @brief Maximum latency between the end of a request and its response
+     *
+     */
+    std::chrono::nanoseconds maxResponseLatency{0};
+
+    /**
+     * @brief Total latency between the end of the requests and their responses
+     *
+     */
+    std::chrono::nanoseconds totalResponseLatency{0};
+};
+
+/**
+ * @brief ModbusServer class
+ *
+ * Modbus RTU server (slave) on an open serial port. Coils, discrete inputs,
+ * holding registers and input registers are stored in contiguous arrays
+ * allocated on construction which are accessed directly by the user and by
+ * the request processing. Responses are built in place in a preallocated
+ * transmit buffer, so serving a request does not allocate.
+ *
+ * Supported function codes are 0x01-0x06, 0x08 (return query data), 0x0B,
+ * 0x0F, 0x10, 0x11, 0x16 and 0x17, any other function is answered with the
+ * illegal function exception.
+ *
+ * Requests of known size are decoded as soon as their last byte arrives and
+ * answered after the response delay, which is zero by default. Set it to the
+ * inter-frame delay of the link for strict compliance with the Modbus serial
+ * line specification.
+ */
+class ModbusServer final
+{
+public:
+    /**
+     * @brief Access hook called with the function code, starting address and
+     *   number of values. Read hooks are called before the values are read and
+     *   may refresh them, write hooks are called after the values were stored.
+     *   Anything but MODBUS_EXCEPTION_NONE is returned as an exception response.
+     *
+     */
+    typedef std::function<ModbusException(ModbusFunction function, uint16_t address, uint16_t count)> AccessHook;
+
+    /**
+     * @brief Construct a new ModbusServer object
+     *
+     * @param serialPort Open serial port
+     * @param unit Unit address of the server
+     * @param coilCount Number of coils
+     * @param discreteInputCount Number of discrete inputs
+     * @param holdingRegisterCount Number of holding registers
+     * @param inputRegisterCount Number of input registers
+     * @throw std::out_of_range Invalid unit address
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create timer
+     * @throw std::runtime_error Unable to create event
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    explicit ModbusServer(SerialPort& serialPort, uint8_t unit, size_t coilCount, size_t discreteInputCount,
+        size_t holdingRegisterCount, size_t inputRegisterCount);
+
+    /**
+     * @brief Copy-construct a new ModbusServer object
+     *
+     * @param modbusServer Modbus server
+     */
+    ModbusServer(const ModbusServer& modbusServer) = delete;
+
+    /**
+     * @brief Move-construct a new ModbusServer object
+     *
+     * @param modbusServer Modbus server
+     */
+    ModbusServer(ModbusServer&& modbusServer) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param modbusServer Modbus server to copy-assign
+     * @return ModbusServer& Assigned Modbus server
+     */
+    ModbusServer& operator=(const ModbusServer& modbusServer) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param modbusServer Modbus server to move-assign
+     * @return ModbusServer& Assigned Modbus server
+     */
+    ModbusServer& operator=(ModbusServer&& modbusServer) = delete;
+
+    /**
+     * @brief Destroy the ModbusServer object
+     *
+     */
+    ~ModbusServer() noexcept;
+
+    /**
+     * @brief Receive and serve a single request
+     *
+     * @param timeout Maximum time to wait for the start of a request
+     * @return ModbusStatus MODBUS_SUCCESS on a valid frame (even if addressed to
+     *   another unit), otherwise the receive or transmit status
+     */
+    ModbusStatus poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Serve requests until stopped or the serial port fails
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop serving requests
+     *
+     * @note May be called from another thread, a stop requested before run() ends the next run()
+     */
+    void stop();
+
+    /**
+     * @brief Get the coils
+     *
+     * @return bool* Coils
+     */
+    bool* getCoils();
+
+    /**
+     * @brief Get the number of coils
+     *
+     * @return size_t Number of coils
+     */
+    size_t getCoilCount() const;
+
+    /**
+     * @brief Get the discrete inputs
+     *
+     * @return bool* Discrete inputs
+     */
+    bool* getDiscreteInputs();
+
+    /**
+     * @brief Get the number of discrete inputs
+     *
+     * @return size_t Number of discrete inputs
+     */
+    size_t getDiscreteInputCount() const;
+
+    /**
+     * @brief Get the holding registers
+     *
+     * @return uint16_t* Holding registers
+     */
+    uint16_t* getHoldingRegisters();
+
+    /**
+     * @brief Get the number of holding registers
+     *
+     * @return size_t Number of holding registers
+     */
+    size_t getHoldingRegisterCount() const;
+
+    /**
+     * @brief Get the input registers
+     *
+     * @return uint16_t* Input registers
+     */
+    uint16_t* getInputRegisters();
+
+    /**
+     * @brief Get the number of input registers
+     *
+     * @return size_t Number of input registers
+     */
+    size_t getInputRegisterCount() const;
+
+    /**
+     * @brief Set the read hook
+     *
+     * @param readHook Hook called before values are read
+     */
+    void setReadHook(AccessHook readHook);
+
+    /**
+     * @brief Set the write hook
+     *
+     * @param writeHook Hook called after values were stored
+     */
+    void setWriteHook(AccessHook writeHook);
+
+    /**
+     * @brief Get the unit address
+     *
+     * @return uint8_t Unit address
+     */
+    uint8_t getUnit() const;
+
+    /**
+     * @brief Get the response delay
+     *
+     * @return std::chrono::microseconds Delay between the end of a request and its response
+     */
+    std::chrono::microseconds getResponseDelay() const;
+
+    /**
+     * @brief Set the response delay
+     *
+     * @param responseDelay Delay between the end of a request and its response
+     */
+    void setResponseDelay(std::chrono::microseconds responseDelay);
+
+    /**
+     * @brief Get the server statistics
+     *
+     * @return ModbusServerStatistics Server statistics
+     */
+    ModbusServerStatistics getStatistics() const;
+
+    /**
+     * @brief Get the underlying Modbus RTU link
+     *
+     * @return ModbusRtuLink& Modbus RTU link
+     */
+    ModbusRtuLink& getLink();
+protected:
+    /**
+     * @brief Receive and serve a single request
+     *
+     * @param timeout Maximum time to wait for the start of a request
+     * @param stoppable The stop event ends the wait with MODBUS_TIMEOUT
+     * @return ModbusStatus MODBUS_SUCCESS on a valid frame (even if addressed to
+     *   another unit), otherwise the receive or transmit status
+     */
+    ModbusStatus serve(std::chrono::milliseconds timeout, bool stoppable);
+
+    /**
+     * @brief Process a request and build the response in the transmit buffer
+     *
+     * @param request Request frame including the address and CRC
+     * @param size Size of the request frame
+     * @return size_t Size of the response following the address, without the CRC
+     */
+    size_t process(const char* request, size_t size);
+
+    /**
+     * @brief Execute a request
+     *
+     * @param function Function code
+     * @param data Request data following the function code
+     * @param size Size of the request data
+     * @param response Response data following the function code
+     * @param responseSize Size of the response data
+     * @return ModbusException Exception code or MODBUS_EXCEPTION_NONE
+     */
+    ModbusException execute(ModbusFunction function, const char* data, size_t size, char* response, size_t& responseSize);
+
+    /**
+     * @brief Call an access hook
+     *
+     * @param hook Access hook
+     * @param function Function code
+     * @param address Starting address
+     * @param count Number of values
+     * @return ModbusException Exception code or MODBUS_EXCEPTION_NONE
+     */
+    static ModbusException callHook(const AccessHook& hook, ModbusFunction function, uint16_t address, uint16_t count);
+
+    /**
+     * @brief Modbus RTU link
+     *
+     */
+    ModbusRtuLink link;
+
+    /**
+     * @brief Unit address
+     *
+     */
+    uint8_t unit;
+
+    /**
+     * @brief Coils
+     *
+     */
+    std::unique_ptr<bool[]> coils;
+
+    /**
+     * @brief Number of coils
+     *
+     */
+    size_t coilCount;
+
+    /**
+     * @brief Discrete inputs
+     *
+     */
+    std::unique_ptr<bool[]> discreteInputs;
+
+    /**
+     * @brief Number of discrete inputs
+     *
+     */
+    size_t discreteInputCount;
+
+    /**
+     * @brief Holding registers
+     *
+     */
+    std::unique_ptr<uint16_t[]> holdingRegisters;
+
+    /**
+     * @brief Number of holding registers
+     *
+     */
+    size_t holdingRegisterCount;
+
+    /**
+     * @brief Input registers
+     *
+     */
+    std::unique_ptr<uint16_t[]> inputRegisters;
+
+    /**
+     * @brief Number of input registers
+     *
+     */
+    size_t inputRegisterCount;
+
+    /**
+     * @brief Read hook
+     *
+     */
+    AccessHook readHook;
+
+    /**
+     * @brief Write hook
+     *
+     */
+    AccessHook writeHook;
+
+    /**
+     * @brief Delay between the end of a request and its response
+     *
+     */
+    std::chrono::microseconds responseDelay;
+
+    /**
+     * @brief Number of successfully completed requests reported by the communication event counter
+     *
+     */
+    uint16_t eventCount;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Transmit buffer
+     *
+     */
+    std::array<char, MODBUS_MAX_FRAME_SIZE> transmitBuffer;
+
+    /**
+     * @brief Server statistics
+     *
+     */
+    ModbusServerStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,406 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <system_error>
+#include <vector>
+#include <poll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/timer_dispatcher.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Port registry handle, a slot index in the low and a generation in the high 32 bits
+ *
+ */
+typedef uint64_t PortHandle;
+
+/**
+ * @brief Handle never returned by the port registry
+ *
+ */
+static constexpr PortHandle INVALID_PORT_HANDLE{0};
+
+/**
+ * @brief Port registry counters
+ *
+ */
+struct PortCounters
+{
+    /**
+     * @brief Size of the received data
+     *
+     */
+    uint64_t receivedCount{0};
+
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Number of failed reads and writes, not including would-block
+     *
+     */
+    uint64_t errorCount{0};
+};
+
+/**
+ * @brief PortRegistry class
+ *
+ * Owns a large number of serial ports and keeps their state in a
+ * struct-of-arrays table. The hot fields (the poll descriptor, the flags and
+ * the counters) are stored in separate dense arrays, so polling all the ports
+ * passes the descriptor array to a single poll() call and summing the counters
+ * walks contiguous memory. The serial ports themselves are moved into the
+ * registry and are only touched to read, write, open or close them.
+ *
+ * Ports are referred to by handles which stay valid until the port is
+ * removed; a removed port's slot is reused with a new generation, so a stale
+ * handle is rejected instead of referring to another port. Removal moves the
+ * last port into the removed port's place, keeping the arrays dense.
+ *
+ * Ports opened or closed through getPort() must be passed to update() to
+ * refresh their poll descriptor.
+ */
+class PortRegistry final
+{
+public:
+    /**
+     * @brief Event handler called with the handle of a ready port and its poll events
+     *
+     */
+    typedef std::function<void(PortHandle handle, short events)> EventHandler;
+
+    /**
+     * @brief Construct a new PortRegistry object
+     *
+     * @param capacity Number of ports to reserve space for
+     */
+    explicit PortRegistry(size_t capacity = 0);
+
+    /**
+     * @brief Copy-construct a new PortRegistry object
+     *
+     * @param portRegistry Port registry
+     */
+    PortRegistry(const PortRegistry& portRegistry) = delete;
+
+    /**
+     * @brief Move-construct a new PortRegistry object
+     *
+     * @param portRegistry Port registry
+     */
+    PortRegistry(PortRegistry&& portRegistry) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param portRegistry Port registry to copy-assign
+     * @return PortRegistry& Assigned port registry
+     */
+    PortRegistry& operator=(const PortRegistry& portRegistry) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param portRegistry Port registry to move-assign
+     * @return PortRegistry& Assigned port registry
+     */
+    PortRegistry& operator=(PortRegistry&& portRegistry) = delete;
+
+    /**
+     * @brief Destroy the PortRegistry object and close all the ports
+     *
+     */
+    ~PortRegistry() noexcept = default;
+
+    /**
+     * @brief Reserve space for a number of ports
+     *
+     * @param capacity Number of ports
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * @brief Add a serial port
+     *
+     * @param serialPort Open or closed serial port
+     * @return PortHandle Port handle
+     * @throw std::out_of_range Too many ports
+     */
+    PortHandle add(SerialPort serialPort);
+
+    /**
+     * @brief Remove a serial port
+     *
+     * @param handle Port handle
+     * @return SerialPort Removed serial port
+     * @throw std::out_of_range Invalid port handle
+     */
+    SerialPort remove(PortHandle handle);
+
+    /**
+     * @brief Check whether a handle refers to a registered port
+     *
+     * @param handle Port handle
+     * @return true Port is registered
+     * @return false Handle is invalid or the port was removed
+     */
+    bool contains(PortHandle handle) const;
+
+    /**
+     * @brief Get the number of ports
+     *
+     * @return size_t Number of ports
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief Get the handle of a port by its position
+     *
+     * @param index Port position, less than getSize()
+     * @return PortHandle Port handle
+     * @throw std::out_of_range Invalid port position
+     * @note Positions change when a port is removed
+     */
+    PortHandle getHandle(size_t index) const;
+
+    /**
+     * @brief Get a serial port
+     *
+     * @param handle Port handle
+     * @return SerialPort& Serial port, valid until a port is added or removed
+     * @throw std::out_of_range Invalid port handle
+     */
+    SerialPort& getPort(PortHandle handle);
+
+    /**
+     * @brief Get a serial port
+     *
+     * @param handle Port handle
+     * @return const SerialPort& Serial port, valid until a port is added or removed
+     * @throw std::out_of_range Invalid port handle
+     */
+    const SerialPort& getPort(PortHandle handle) const;
+
+    /**
+     * @brief Refresh the poll descriptor of a port opened or closed through getPort()
+     *
+     * @param handle Port handle
+     * @throw std::out_of_range Invalid port handle
+     */
+    void update(PortHandle handle);
+
+    /**
+     * @brief Open a serial port
+     *
+     * @param handle Port handle
+     * @param openMode Serial port open mode
+     * @param error Error of the open
+     * @throw std::out_of_range Invalid port handle
+     */
+    void open(PortHandle handle, std::ios_base::openmode openMode, std::error_code& error);
+
+    /**
+     * @brief Close a serial port
+     *
+     * @param handle Port handle
+     * @param error Error of the close
+     * @throw std::out_of_range Invalid port handle
+     */
+    void close(PortHandle handle, std::error_code& error);
+
+    /**
+     * @brief Check whether a hang-up of a port was detected by a read, write or poll
+     *
+     * @param handle Port handle
+     * @return true Port hung up since it was added or opened
+     * @return false No hang-up detected
+     * @throw std::out_of_range Invalid port handle
+     */
+    bool isHungUp(PortHandle handle) const;
+
+    /**
+     * @brief Read data from a port and update its counters
+     *
+     * @param handle Port handle
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param error Error of the read
+     * @return size_t Size of the data actually read
+     * @throw std::out_of_range Invalid port handle
+     */
+    size_t read(PortHandle handle, char* buffer, size_t size, std::error_code& error);
+
+    /**
+     * @brief Write data to a port and update its counters
+     *
+     * @param handle Port handle
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param error Error of the write
+     * @return size_t Size of the data actually written
+     * @throw std::out_of_range Invalid port handle
+     */
+    size_t write(PortHandle handle, const char* buffer, size_t size, std::error_code& error);
+
+    /**
+     * @brief Wait for events on all the open ports
+     *
+     * @param timeout Maximum time to wait for an event
+     * @param eventHandler Event handler called for every ready port
+     * @param events Poll events to wait for
+     * @return size_t Number of ready ports
+     * @note The event handler may add ports and remove the port it is called for
+     */
+    size_t poll(std::chrono::milliseconds timeout, const EventHandler& eventHandler, short events = POLLIN);
+
+    /**
+     * @brief Wait for events on all the open ports and for the timers of a timer dispatcher
+     *
+     * @param timeout Maximum time to wait for an event or a timer
+     * @param eventHandler Event handler called for every ready port
+     * @param timerDispatcher Timer dispatcher whose due timers are expired after the port events
+     * @param events Poll events to wait for
+     * @return size_t Number of ready ports
+     * @throw std::runtime_error Unable to set timer
+     * @note The event handler may add ports, remove the port it is called for and re-arm timers
+     */
+    size_t poll(std::chrono::milliseconds timeout, const EventHandler& eventHandler, TimerDispatcher& timerDispatcher,
+        short events = POLLIN);
+
+    /**
+     * @brief Get the counters of a port
+     *
+     * @param handle Port handle
+     * @return PortCounters Port counters
+     * @throw std::out_of_range Invalid port handle
+     */
+    PortCounters getCounters(PortHandle handle) const;
+
+    /**
+     * @brief Get the sum of the counters of all the ports
+     *
+     * @return PortCounters Total port counters
+     */
+    PortCounters getTotalCounters() const;
+
+    /**
+     * @brief Reset the counters of all the ports
+     *
+     */
+    void resetCounters();
+protected:
+    /**
+     * @brief Get the position of a port
+     *
+     * @param handle Port handle
+     * @return size_t Port position
+     * @throw std::out_of_range Invalid port handle
+     */
+    size_t getIndex(PortHandle handle) const;
+
+    /**
+     * @brief Update the counters and flags of a port after a read or write
+     *
+     * @param index Port position
+     * @param error Error of the read or write
+     */
+    void handleError(size_t index, const std::error_code& error);
+
+    /**
+     * @brief Call the event handler for every port with poll events
+     *
+     * @param eventHandler Event handler
+     */
+    void handleEvents(const EventHandler& eventHandler);
+
+    /**
+     * @brief Poll descriptors of the ports, closed ports have a negative descriptor
+     *
+     */
+    std::vector<struct pollfd> descriptors;
+
+    /**
+     * @brief Flags of the ports
+     *
+     */
+    std::vector<uint8_t> flags;
+
+    /**
+     * @brief Size of the received data of the ports
+     *
+     */
+    std::vector<uint64_t> receivedCounts;
+
+    /**
+     * @brief Size of the transmitted data of the ports
+     *
+     */
+    std::vector<uint64_t> transmittedCounts;
+
+    /**
+     * @brief Number of failed reads and writes of the ports
+     *
+     */
+    std::vector<uint64_t> errorCounts;
+
+    /**
+     * @brief Slots of the ports
+     *
+     */
+    std::vector<uint32_t> slots;
+
+    /**
+     * @brief Serial ports
+     *
+     */
+    std::vector<SerialPort> ports;
+
+    /**
+     * @brief Port position of a used slot or the next free slot of a free slot
+     *
+     */
+    std::vector<uint32_t> indices;
+
+    /**
+     * @brief Generation of the slots, odd for a used slot
+     *
+     */
+    std::vector<uint32_t> generations;
+
+    /**
+     * @brief First free slot
+     *
+     */
+    uint32_t freeSlot;
+};
+
+END_NAMESPACE_LIBSERIAL
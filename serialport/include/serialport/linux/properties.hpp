@@ -20,12 +20,20 @@
 */
 
 #pragma once
+#include <chrono>
 #include <string>
 #include <termios.h>
+#include <time.h>
 #include <serialport/namespace.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+/**
+ * @brief Native serial port handle
+ *
+ */
+typedef int NativeHandle;
+
 /**
  * @brief Default value for an invalid file descriptor
  *
@@ -44,6 +52,81 @@ static constexpr char DEFAULT_PORT_NAME[]{"/dev/ttyUSB0"};
  */
 static constexpr char SERIAL_PORT_PREFIX[]{"/dev/"};
 
+/**
+ * @brief Precomputed native serial port settings
+ *
+ * Flags are applied on top of the current termios settings of the serial port
+ * as (flags & ~clear) | set, replacing the runtime preparation of the settings.
+ */
+struct NativePortSettings
+{
+    /**
+     * @brief Input mode flags to clear
+     *
+     */
+    tcflag_t inputFlagsClear;
+
+    /**
+     * @brief Input mode flags to set
+     *
+     */
+    tcflag_t inputFlagsSet;
+
+    /**
+     * @brief Output mode flags to clear
+     *
+     */
+    tcflag_t outputFlagsClear;
+
+    /**
+     * @brief Output mode flags to set
+     *
+     */
+    tcflag_t outputFlagsSet;
+
+    /**
+     * @brief Control mode flags to clear
+     *
+     */
+    tcflag_t controlFlagsClear;
+
+    /**
+     * @brief Control mode flags to set
+     *
+     */
+    tcflag_t controlFlagsSet;
+
+    /**
+     * @brief Local mode flags to clear
+     *
+     */
+    tcflag_t localFlagsClear;
+
+    /**
+     * @brief Local mode flags to set
+     *
+     */
+    tcflag_t localFlagsSet;
+
+    /**
+     * @brief Input and output speed
+     *
+     */
+    speed_t speed;
+
+    /**
+     * @brief Mask of the special characters to replace (bit n replaces c_cc[n])
+     *
+     */
+    unsigned long long controlCharacterMask;
+
+    /**
+     * @brief Special characters
+     *
+     */
+    cc_t controlCharacters[NCCS];
+};
+
 /**
  * @brief Function for handling interrupted system calls
  *
@@ -66,4 +149,18 @@ typename std::result_of<F(A...)>::type systemCall(F call, A... args)
     return result;
 }
 
+/**
+ * @brief Convert a duration to a timespec
+ *
+ * @param duration Duration
+ * @return struct timespec Time specification
+ */
+inline struct timespec toTimespec(std::chrono::nanoseconds duration)
+{
+    struct timespec result{};
+    result.tv_sec = static_cast<time_t>(duration.count() / 1000000000);
+    result.tv_nsec = static_cast<long>(duration.count() % 1000000000);
+    return result;
+}
+
 END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,432 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default serial bridge buffer size in bytes
+ *
+ */
+static constexpr size_t DEFAULT_BRIDGE_BUFFER_SIZE{1U << 16};
+
+/**
+ * @brief Serial bridge statistics of a single direction
+ *
+ */
+struct BridgeDirectionStatistics
+{
+    /**
+     * @brief Size of the forwarded data
+     *
+     */
+    uint64_t byteCount{0};
+
+    /**
+     * @brief Size of the data forwarded with splice()
+     *
+     */
+    uint64_t splicedByteCount{0};
+
+    /**
+     * @brief Size of the data forwarded through the user space buffer
+     *
+     */
+    uint64_t copiedByteCount{0};
+
+    /**
+     * @brief Number of times the destination could not accept more data
+     *
+     */
+    uint64_t stallCount{0};
+
+    /**
+     * @brief Size of the data read from the source but not forwarded when the bridge ended
+     *
+     */
+    uint64_t droppedByteCount{0};
+
+    /**
+     * @brief Average throughput in bytes per second
+     *
+     */
+    double throughput{0.0};
+};
+
+/**
+ * @brief Serial bridge statistics
+ *
+ */
+struct BridgeStatistics
+{
+    /**
+     * @brief Statistics of the serial port to socket direction
+     *
+     */
+    BridgeDirectionStatistics serialToSocket{};
+
+    /**
+     * @brief Statistics of the socket to serial port direction
+     *
+     */
+    BridgeDirectionStatistics socketToSerial{};
+
+    /**
+     * @brief Time elapsed since the bridge was constructed
+     *
+     */
+    std::chrono::microseconds elapsed{0};
+};
+
+/**
+ * @brief SerialBridge class
+ *
+ * Forwards data between an open serial port and a connected stream socket
+ * (TCP or Unix domain) in both directions from a single epoll loop. Data is
+ * moved with splice() through a pipe where both file types support it and
+ * through a user space buffer otherwise. A direction stops reading from its
+ * source while its destination can not accept more data. Once either side
+ * hangs up, data already read is still forwarded to the remaining side for a
+ * limited time, anything left behind is counted as dropped.
+ *
+ * @note The bridge does not take ownership of the socket.
+ */
+class SerialBridge final
+{
+public:
+    /**
+     * @brief Construct a new SerialBridge object
+     *
+     * @param serialPort Open serial port
+     * @param socket Connected stream socket
+     * @param bufferSize Size of the buffer of a single direction
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create event loop
+     */
+    explicit SerialBridge(SerialPort& serialPort, int socket, size_t bufferSize = DEFAULT_BRIDGE_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new SerialBridge object
+     *
+     * @param serialBridge Serial bridge
+     */
+    SerialBridge(const SerialBridge& serialBridge) = delete;
+
+    /**
+     * @brief Move-construct a new SerialBridge object
+     *
+     * @param serialBridge Serial bridge
+     */
+    SerialBridge(SerialBridge&& serialBridge) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialBridge Serial bridge to copy-assign
+     * @return SerialBridge& Assigned serial bridge
+     */
+    SerialBridge& operator=(const SerialBridge& serialBridge) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialBridge Serial bridge to move-assign
+     * @return SerialBridge& Assigned serial bridge
+     */
+    SerialBridge& operator=(SerialBridge&& serialBridge) = delete;
+
+    /**
+     * @brief Destroy the SerialBridge object
+     *
+     */
+    ~SerialBridge() noexcept;
+
+    /**
+     * @brief Wait for events and forward all data which can be forwarded
+     *
+     * @param timeout Maximum time to wait for events, also limits forwarding the
+     *   remaining data after a hang-up (1 s if negative)
+     * @return true Bridge is active
+     * @return false Socket or serial port was closed or the bridge was stopped
+     */
+    bool poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Forward data until the socket or serial port is closed or the bridge is stopped
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop the bridge
+     *
+     * @note Safe to call from any thread, pending data is counted as dropped
+     */
+    void stop();
+
+    /**
+     * @brief Get the active status
+     *
+     * @return true Bridge is active
+     * @return false Bridge is closed or stopped
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Get the bridge statistics
+     *
+     * @return BridgeStatistics Bridge statistics
+     */
+    BridgeStatistics getStatistics() const;
+
+    /**
+     * @brief Connect a TCP socket
+     *
+     * @param host Host name or address
+     * @param port TCP port
+     * @return int Connected socket or INVALID_FILE_DESCRIPTOR on failure
+     */
+    static int connectTcp(const std::string& host, unsigned short port);
+
+    /**
+     * @brief Connect a Unix domain stream socket
+     *
+     * @param path Socket path
+     * @return int Connected socket or INVALID_FILE_DESCRIPTOR on failure
+     */
+    static int connectUnix(const std::string& path);
+protected:
+    /**
+     * @brief Forwarding state of a single direction
+     *
+     */
+    struct Channel
+    {
+        /**
+         * @brief Source file descriptor
+         *
+         */
+        int source;
+
+        /**
+         * @brief Destination file descriptor
+         *
+         */
+        int destination;
+
+        /**
+         * @brief End-of-file on the source means the peer closed the connection
+         *
+         */
+        bool sourceEndOfFile;
+
+        /**
+         * @brief Source supports splice() into a pipe
+         *
+         */
+        bool spliceSource;
+
+        /**
+         * @brief Destination supports splice() from a pipe
+         *
+         */
+        bool spliceDestination;
+
+        /**
+         * @brief Splice pipe (read end, write end)
+         *
+         */
+        int pipe[2];
+
+        /**
+         * @brief Size of the data pending in the pipe
+         *
+         */
+        size_t pipeCount;
+
+        /**
+         * @brief User space buffer
+         *
+         */
+        std::vector<char> buffer;
+
+        /**
+         * @brief Offset of the pending data in the buffer
+         *
+         */
+        size_t bufferBegin;
+
+        /**
+         * @brief End of the pending data in the buffer
+         *
+         */
+        size_t bufferEnd;
+
+        /**
+         * @brief Direction statistics
+         *
+         */
+        BridgeDirectionStatistics statistics;
+    };
+
+    /**
+     * @brief Initialize a channel
+     *
+     * @param channel Channel
+     * @param source Source file descriptor
+     * @param destination Destination file descriptor
+     * @param sourceEndOfFile End-of-file on the source means the peer closed the connection
+     */
+    void initializeChannel(Channel& channel, int source, int destination, bool sourceEndOfFile);
+
+    /**
+     * @brief Release channel resources
+     *
+     * @param channel Channel
+     */
+    void releaseChannel(Channel& channel);
+
+    /**
+     * @brief Forward data of a channel until either side would block
+     *
+     * @param channel Channel
+     * @return true Channel is active
+     * @return false Source reached end-of-file or an error occurred
+     */
+    bool forward(Channel& channel);
+
+    /**
+     * @brief Flush the pending data of a channel to its destination
+     *
+     * @param channel Channel
+     * @return true Flush did not fail
+     * @return false Destination failed
+     */
+    bool flush(Channel& channel);
+
+    /**
+     * @brief Forward the remaining data of both channels after a hang-up
+     *
+     * @param timeout Maximum time to wait for the destinations to accept the data
+     * @param serialPortHangUp Serial port hung up and no longer accepts data
+     * @param socketHangUp Socket hung up and no longer accepts data
+     */
+    void drain(std::chrono::milliseconds timeout, bool serialPortHangUp, bool socketHangUp);
+
+    /**
+     * @brief Count the pending data of a channel as dropped and discard it
+     *
+     * @param channel Channel
+     */
+    void discard(Channel& channel);
+
+    /**
+     * @brief Get the size of the pending data of a channel
+     *
+     * @param channel Channel
+     * @return size_t Size of the pending data
+     */
+    size_t getPendingCount(const Channel& channel) const;
+
+    /**
+     * @brief Update the event loop interest of both file descriptors
+     *
+     */
+    void updateInterest();
+
+    /**
+     * @brief Update the event loop interest of a file descriptor
+     *
+     * @param fileDescriptor File descriptor
+     * @param events Requested events
+     * @param currentEvents Currently registered events
+     */
+    void updateInterest(int fileDescriptor, uint32_t events, uint32_t& currentEvents);
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Socket
+     *
+     */
+    int socket;
+
+    /**
+     * @brief Event loop file descriptor
+     *
+     */
+    int eventLoop;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Bridge active status
+     *
+     */
+    bool active;
+
+    /**
+     * @brief Registered events of the serial port
+     *
+     */
+    uint32_t serialPortEvents;
+
+    /**
+     * @brief Registered events of the socket
+     *
+     */
+    uint32_t socketEvents;
+
+    /**
+     * @brief Serial port to socket channel
+     *
+     */
+    Channel serialToSocket;
+
+    /**
+     * @brief Socket to serial port channel
+     *
+     */
+    Channel socketToSerial;
+
+    /**
+     * @brief Construction time
+     *
+     */
+    std::chrono::steady_clock::time_point startTime;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,426 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <sys/epoll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Minimal serial gateway buffer size in bytes
+ *
+ */
+static constexpr size_t MIN_GATEWAY_BUFFER_SIZE{256};
+
+/**
+ * @brief Maximal serial gateway buffer size in bytes
+ *
+ */
+static constexpr size_t MAX_GATEWAY_BUFFER_SIZE{1U << 16};
+
+/**
+ * @brief Line time covered by a serial gateway buffer in milli-seconds
+ *
+ */
+static constexpr double GATEWAY_BUFFER_TIME{50.0};
+
+/**
+ * @brief Serial gateway statistics of a single direction
+ *
+ */
+struct GatewayDirectionStatistics
+{
+    /**
+     * @brief Size of the data read from the source
+     *
+     */
+    uint64_t receivedCount{0};
+
+    /**
+     * @brief Size of the data written to the destination
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Number of times the destination could not accept more data
+     *
+     */
+    uint64_t stallCount{0};
+
+    /**
+     * @brief Size of the data read from the source but not forwarded when the route ended
+     *
+     */
+    uint64_t droppedByteCount{0};
+
+    /**
+     * @brief Size of the read buffer derived from the source baud rate
+     *
+     */
+    size_t bufferSize{0};
+};
+
+/**
+ * @brief Serial gateway statistics of a route
+ *
+ */
+struct GatewayRouteStatistics
+{
+    /**
+     * @brief Route active status
+     *
+     */
+    bool active{false};
+
+    /**
+     * @brief Statistics of the first to second serial port direction
+     *
+     */
+    GatewayDirectionStatistics firstToSecond{};
+
+    /**
+     * @brief Statistics of the second to first serial port direction
+     *
+     */
+    GatewayDirectionStatistics secondToFirst{};
+};
+
+/**
+ * @brief SerialGateway class
+ *
+ * Forwards data between registered pairs of open serial ports in both
+ * directions from a single epoll loop. Only ports with pending events are
+ * serviced, so the cost of a loop iteration does not depend on the number of
+ * routes. Each direction may transform the data in place before it is
+ * forwarded and reads in chunks sized to the line time of its source port.
+ * Once a serial port of a route hangs up, data already read is still
+ * forwarded to the other serial port for a limited time, anything left behind
+ * is counted as dropped.
+ *
+ * @note Routes must be added while the gateway is not running.
+ */
+class SerialGateway final
+{
+public:
+    /**
+     * @brief Transform function
+     *
+     * Called with the received data in a buffer of the given capacity, which
+     * is at least twice the received size, and returns the size of the
+     * transformed data to forward.
+     */
+    typedef std::function<size_t(char* data, size_t size, size_t capacity)> Transform;
+
+    /**
+     * @brief Construct a new SerialGateway object
+     *
+     * @throw std::runtime_error Unable to create event loop
+     */
+    explicit SerialGateway();
+
+    /**
+     * @brief Copy-construct a new SerialGateway object
+     *
+     * @param serialGateway Serial gateway
+     */
+    SerialGateway(const SerialGateway& serialGateway) = delete;
+
+    /**
+     * @brief Move-construct a new SerialGateway object
+     *
+     * @param serialGateway Serial gateway
+     */
+    SerialGateway(SerialGateway&& serialGateway) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialGateway Serial gateway to copy-assign
+     * @return SerialGateway& Assigned serial gateway
+     */
+    SerialGateway& operator=(const SerialGateway& serialGateway) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialGateway Serial gateway to move-assign
+     * @return SerialGateway& Assigned serial gateway
+     */
+    SerialGateway& operator=(SerialGateway&& serialGateway) = delete;
+
+    /**
+     * @brief Destroy the SerialGateway object
+     *
+     */
+    ~SerialGateway() noexcept;
+
+    /**
+     * @brief Add a route between two open serial ports
+     *
+     * @param first First serial port
+     * @param second Second serial port
+     * @param firstToSecond Transform of the first to second serial port direction
+     * @param secondToFirst Transform of the second to first serial port direction
+     * @return size_t Route index
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Serial port is already routed
+     */
+    size_t addRoute(SerialPort& first, SerialPort& second,
+        Transform firstToSecond = nullptr, Transform secondToFirst = nullptr);
+
+    /**
+     * @brief Get the number of routes
+     *
+     * @return size_t Number of routes
+     */
+    size_t getRouteCount() const;
+
+    /**
+     * @brief Wait for events and forward all data which can be forwarded
+     *
+     * @param timeout Maximum time to wait for events, also limits forwarding the
+     *   remaining data of a route after a hang-up (1 s if negative)
+     * @return true Gateway has active routes
+     * @return false Gateway was stopped or has no active routes
+     */
+    bool poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Forward data until the gateway is stopped or has no active routes
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop the gateway
+     *
+     * @note Safe to call from any thread, pending data is counted as dropped
+     */
+    void stop();
+
+    /**
+     * @brief Get the route statistics
+     *
+     * @param route Route index
+     * @return GatewayRouteStatistics Route statistics
+     * @throw std::out_of_range Route index out of range
+     */
+    GatewayRouteStatistics getStatistics(size_t route) const;
+
+    /**
+     * @brief Get the buffer size for a serial port
+     *
+     * @param serialPort Serial port
+     * @return size_t Buffer size covering the gateway buffer time at the serial port baud rate
+     */
+    static size_t getBufferSize(const SerialPort& serialPort);
+protected:
+    /**
+     * @brief Forwarding state of a single direction
+     *
+     */
+    struct Direction
+    {
+        /**
+         * @brief Source endpoint index
+         *
+         */
+        size_t source;
+
+        /**
+         * @brief Destination endpoint index
+         *
+         */
+        size_t destination;
+
+        /**
+         * @brief Transform function
+         *
+         */
+        Transform transform;
+
+        /**
+         * @brief Buffer holding twice the read size for transforms
+         *
+         */
+        std::vector<char> buffer;
+
+        /**
+         * @brief Offset of the pending data in the buffer
+         *
+         */
+        size_t bufferBegin;
+
+        /**
+         * @brief End of the pending data in the buffer
+         *
+         */
+        size_t bufferEnd;
+
+        /**
+         * @brief Direction statistics
+         *
+         */
+        GatewayDirectionStatistics statistics;
+    };
+
+    /**
+     * @brief Serial port endpoint
+     *
+     */
+    struct Endpoint
+    {
+        /**
+         * @brief Serial port file descriptor
+         *
+         */
+        int fileDescriptor;
+
+        /**
+         * @brief Registered events
+         *
+         */
+        uint32_t events;
+
+        /**
+         * @brief Index of the direction reading from the endpoint
+         *
+         */
+        size_t outgoing;
+
+        /**
+         * @brief Index of the direction writing to the endpoint
+         *
+         */
+        size_t incoming;
+
+        /**
+         * @brief Route index
+         *
+         */
+        size_t route;
+    };
+
+    /**
+     * @brief Forward data of a direction until either side would block
+     *
+     * @param direction Direction
+     * @return true Direction is active
+     * @return false Direction failed
+     */
+    bool forward(Direction& direction);
+
+    /**
+     * @brief Flush the pending data of a direction to its destination
+     *
+     * @param direction Direction
+     * @return true Flush did not fail
+     * @return false Destination failed
+     */
+    bool flush(Direction& direction);
+
+    /**
+     * @brief Update the event loop interest of an endpoint
+     *
+     * @param endpoint Endpoint index
+     */
+    void updateInterest(size_t endpoint);
+
+    /**
+     * @brief Forward the remaining data of a route after a hang-up
+     *
+     * @param endpoint Index of the endpoint which ended the route
+     * @param timeout Maximum time to wait for the destinations to accept the data
+     * @param hangUp Endpoint hung up and no longer accepts data
+     */
+    void drain(size_t endpoint, std::chrono::milliseconds timeout, bool hangUp);
+
+    /**
+     * @brief Count the pending data of a direction as dropped and discard it
+     *
+     * @param direction Direction
+     */
+    void discard(Direction& direction);
+
+    /**
+     * @brief Deactivate a route and remove its serial ports from the event loop
+     *
+     * @param route Route index
+     */
+    void deactivateRoute(size_t route);
+
+    /**
+     * @brief Event loop file descriptor
+     *
+     */
+    int eventLoop;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Gateway stopped status
+     *
+     */
+    bool stopped;
+
+    /**
+     * @brief Number of active routes
+     *
+     */
+    size_t activeRouteCount;
+
+    /**
+     * @brief Serial port endpoints, two per route
+     *
+     */
+    std::vector<Endpoint> endpoints;
+
+    /**
+     * @brief Directions, two per route
+     *
+     */
+    std::vector<Direction> directions;
+
+    /**
+     * @brief Route active status
+     *
+     */
+    std::vector<bool> activeRoutes;
+
+    /**
+     * @brief Event buffer
+     *
+     */
+    std::vector<struct epoll_event> events;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,482 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serialport_pump.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default interval of the serial reactor load balancing
+ *
+ */
+static constexpr std::chrono::milliseconds DEFAULT_REACTOR_BALANCE_INTERVAL{10};
+
+/**
+ * @brief Serial reactor options
+ *
+ */
+struct ReactorOptions
+{
+    /**
+     * @brief Number of shards, each served by its own thread, or 0 for the number of CPUs
+     *
+     */
+    size_t shardCount{0};
+
+    /**
+     * @brief Bind the thread of shard n to CPU n modulo the number of CPUs
+     *
+     */
+    bool bindShards{false};
+
+    /**
+     * @brief Allow idle shards to steal ports from busy shards
+     *
+     */
+    bool workStealing{true};
+
+    /**
+     * @brief Interval over which the load of the shards is measured and balanced
+     *
+     */
+    std::chrono::milliseconds balanceInterval{DEFAULT_REACTOR_BALANCE_INTERVAL};
+};
+
+/**
+ * @brief Serial reactor shard statistics
+ *
+ */
+struct ShardStatistics
+{
+    /**
+     * @brief Number of ports served by the shard
+     *
+     */
+    size_t portCount{0};
+
+    /**
+     * @brief Number of port events handled
+     *
+     */
+    uint64_t eventCount{0};
+
+    /**
+     * @brief Number of port events handled in the last balance interval
+     *
+     */
+    uint64_t load{0};
+
+    /**
+     * @brief Number of ports stolen from other shards
+     *
+     */
+    uint64_t stolenCount{0};
+
+    /**
+     * @brief Number of ports given away to other shards
+     *
+     */
+    uint64_t donatedCount{0};
+
+    /**
+     * @brief Number of wakeups by another shard or by stop()
+     *
+     */
+    uint64_t wakeupCount{0};
+
+    /**
+     * @brief Total time spent handling port events
+     *
+     */
+    std::chrono::nanoseconds busyTime{0};
+};
+
+/**
+ * @brief SerialReactor class
+ *
+ * Multi-threaded event engine sharding open serial ports across a number of
+ * reactor threads, each waiting on the epoll instance of its own ports and
+ * calling the event handler for the ready ones only. A port is owned by exactly one shard at a time, so all
+ * the I/O of the event handler for a given port runs on one thread at a time
+ * and the ports of different shards are served in parallel.
+ *
+ * Every shard measures its load as the number of port events handled per
+ * balance interval. With work stealing a shard carrying less than half the
+ * load of the busiest shard asks it for a port; the busy shard hands over
+ * the port with the highest load not exceeding half the difference between
+ * the two, between two polls, so no event of the port is being handled
+ * during the migration. A migrating port is removed from the epoll instance
+ * of the busy shard and added to the one of its new shard.
+ */
+class SerialReactor final
+{
+public:
+    /**
+     * @brief Event handler called on the thread of the owning shard with the port index,
+     *   the serial port and its poll events, called concurrently for ports of different shards
+     *
+     */
+    typedef std::function<void(size_t port, SerialPort& serialPort, short events)> EventHandler;
+
+    /**
+     * @brief Construct a new SerialReactor object
+     *
+     * @param eventHandler Event handler
+     * @param options Serial reactor options
+     * @throw std::out_of_range Invalid balance interval
+     * @throw std::runtime_error Unable to create event loop
+     */
+    explicit SerialReactor(EventHandler eventHandler, const ReactorOptions& options = ReactorOptions{});
+
+    /**
+     * @brief Copy-construct a new SerialReactor object
+     *
+     * @param serialReactor Serial reactor
+     */
+    SerialReactor(const SerialReactor& serialReactor) = delete;
+
+    /**
+     * @brief Move-construct a new SerialReactor object
+     *
+     * @param serialReactor Serial reactor
+     */
+    SerialReactor(SerialReactor&& serialReactor) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialReactor Serial reactor to copy-assign
+     * @return SerialReactor& Assigned serial reactor
+     */
+    SerialReactor& operator=(const SerialReactor& serialReactor) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialReactor Serial reactor to move-assign
+     * @return SerialReactor& Assigned serial reactor
+     */
+    SerialReactor& operator=(SerialReactor&& serialReactor) = delete;
+
+    /**
+     * @brief Destroy the SerialReactor object
+     *
+     */
+    ~SerialReactor() noexcept;
+
+    /**
+     * @brief Add an open serial port, assigned to the shards in turn
+     *
+     * @param serialPort Open serial port, must outlive the reactor
+     * @return size_t Port index
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Reactor is running
+     */
+    size_t addPort(SerialPort& serialPort);
+
+    /**
+     * @brief Get the number of ports
+     *
+     * @return size_t Number of ports
+     */
+    size_t getPortCount() const;
+
+    /**
+     * @brief Get the number of shards
+     *
+     * @return size_t Number of shards
+     */
+    size_t getShardCount() const;
+
+    /**
+     * @brief Get the shard currently owning a port
+     *
+     * @param port Port index
+     * @return size_t Shard index
+     * @throw std::out_of_range Invalid port index
+     */
+    size_t getShard(size_t port) const;
+
+    /**
+     * @brief Start the reactor threads
+     *
+     * @throw std::runtime_error Reactor is running
+     * @throw std::runtime_error Unable to start reactor thread
+     * @throw std::runtime_error Unable to set CPU affinity
+     */
+    void start();
+
+    /**
+     * @brief Stop the reactor threads
+     *
+     */
+    void stop();
+
+    /**
+     * @brief Get the reactor status
+     *
+     * @return true Reactor threads are running
+     * @return false Reactor threads are stopped
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get the statistics of a shard
+     *
+     * @param shard Shard index
+     * @return ShardStatistics Shard statistics
+     * @throw std::out_of_range Invalid shard index
+     */
+    ShardStatistics getStatistics(size_t shard) const;
+protected:
+    /**
+     * @brief Serial port served by the reactor
+     *
+     */
+    struct Port
+    {
+        /**
+         * @brief Serial port
+         *
+         */
+        SerialPort* serialPort;
+
+        /**
+         * @brief File descriptor of the serial port
+         *
+         */
+        int fileDescriptor;
+
+        /**
+         * @brief Owning shard
+         *
+         */
+        std::atomic<size_t> shard;
+
+        /**
+         * @brief Number of events in the current balance interval, owning shard only
+         *
+         */
+        uint64_t eventCount;
+
+        /**
+         * @brief Number of events in the last balance interval, owning shard only
+         *
+         */
+        uint64_t load;
+
+        /**
+         * @brief Port hung up and is no longer polled, owning shard only
+         *
+         */
+        bool failed;
+    };
+
+    /**
+     * @brief Reactor shard
+     *
+     */
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        /**
+         * @brief Owned ports, shard thread only while running
+         *
+         */
+        std::vector<size_t> ports;
+
+        /**
+         * @brief Event loop file descriptor of the wakeup event and the owned ports
+         *
+         */
+        int eventLoop;
+
+        /**
+         * @brief Event buffer, shard thread only
+         *
+         */
+        std::vector<struct epoll_event> events;
+
+        /**
+         * @brief Wakeup event file descriptor
+         *
+         */
+        int wakeupEvent;
+
+        /**
+         * @brief Inbox mutex
+         *
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief Ports handed over by other shards
+         *
+         */
+        std::vector<size_t> inbox;
+
+        /**
+         * @brief Shard asking this shard for a port
+         *
+         */
+        std::atomic<size_t> stealRequest;
+
+        /**
+         * @brief Number of owned ports
+         *
+         */
+        std::atomic<size_t> portCount;
+
+        /**
+         * @brief Number of handled port events
+         *
+         */
+        std::atomic<uint64_t> eventCount;
+
+        /**
+         * @brief Number of port events handled in the last balance interval
+         *
+         */
+        std::atomic<uint64_t> load;
+
+        /**
+         * @brief Number of stolen ports
+         *
+         */
+        std::atomic<uint64_t> stolenCount;
+
+        /**
+         * @brief Number of donated ports
+         *
+         */
+        std::atomic<uint64_t> donatedCount;
+
+        /**
+         * @brief Number of wakeups
+         *
+         */
+        std::atomic<uint64_t> wakeupCount;
+
+        /**
+         * @brief Total time spent handling port events in nano-seconds
+         *
+         */
+        std::atomic<int64_t> busyTime;
+
+        /**
+         * @brief Shard thread
+         *
+         */
+        std::thread thread;
+    };
+
+    /**
+     * @brief Shard thread function
+     *
+     * @param index Shard index
+     */
+    void run(size_t index);
+
+    /**
+     * @brief Take over the ports handed over by other shards and add them to the event loop
+     *
+     * @param shard Shard
+     */
+    void adopt(Shard& shard);
+
+    /**
+     * @brief Hand over a port to a shard asking for one and remove it from the event loop
+     *
+     * @param shard Busy shard
+     * @param thief Index of the shard asking for a port
+     */
+    void donate(Shard& shard, size_t thief);
+
+    /**
+     * @brief Add a serial port to the event loop of a shard
+     *
+     * @param shard Shard
+     * @param port Port index
+     * @return true Serial port added
+     * @return false Unable to add the serial port
+     */
+    bool watch(Shard& shard, size_t port);
+
+    /**
+     * @brief Publish the load of the last balance interval and ask the busiest shard for a port
+     *
+     * @param index Shard index
+     * @param eventCount Number of port events handled in the interval
+     */
+    void balance(size_t index, uint64_t eventCount);
+
+    /**
+     * @brief Wake a shard thread up from poll
+     *
+     * @param shard Shard
+     */
+    void wake(Shard& shard);
+
+    /**
+     * @brief Event handler
+     *
+     */
+    EventHandler eventHandler;
+
+    /**
+     * @brief Serial reactor options
+     *
+     */
+    ReactorOptions options;
+
+    /**
+     * @brief Ports
+     *
+     */
+    std::vector<std::unique_ptr<Port>> ports;
+
+    /**
+     * @brief Shards
+     *
+     */
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    /**
+     * @brief Stop request of the reactor threads
+     *
+     */
+    std::atomic<bool> stopped;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,450 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <system_error>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default size of a serial stream buffer in bytes
+ *
+ */
+static constexpr size_t DEFAULT_STREAM_BUFFER_SIZE{4096};
+
+/**
+ * @brief Default read and write timeout of a serial stream
+ *
+ */
+static constexpr std::chrono::milliseconds DEFAULT_STREAM_TIMEOUT{1000};
+
+/**
+ * @brief Serial stream buffer statistics
+ *
+ */
+struct SerialStreamStatistics
+{
+    /**
+     * @brief Number of reads returning data
+     *
+     */
+    uint64_t readCount{0};
+
+    /**
+     * @brief Number of writes
+     *
+     */
+    uint64_t writeCount{0};
+
+    /**
+     * @brief Number of reads and writes failed by a timeout
+     *
+     */
+    uint64_t timeoutCount{0};
+};
+
+/**
+ * @brief SerialStreamBuf class
+ *
+ * Stream buffer of an open serial port with separate input and output
+ * buffers of configurable size. The input buffer is refilled by a single
+ * read of all the available data and the output buffer is written in a
+ * single write when full or on sync, so formatted and line based I/O does
+ * not reach the serial port byte by byte. Transfers at least as large as a
+ * buffer bypass it and go straight between the serial port and the caller.
+ *
+ * A read waits for data up to the read timeout and a write waits for the
+ * serial port to accept data up to the write timeout. A timeout fails the
+ * operation, which the stream reports as eofbit and failbit on input and
+ * as badbit on output, with getError() returning std::errc::timed_out; the
+ * stream may be used again after clear(). A negative timeout waits
+ * indefinitely. The stream buffer is not thread-safe.
+ */
+class SerialStreamBuf final : public std::streambuf
+{
+public:
+    /**
+     * @brief Construct a new SerialStreamBuf object
+     *
+     * @param serialPort Open serial port
+     * @param inputBufferSize Size of the input buffer or 0 for an output only stream buffer
+     * @param outputBufferSize Size of the output buffer or 0 for an input only stream buffer
+     * @throw std::out_of_range Invalid buffer size
+     */
+    explicit SerialStreamBuf(SerialPort& serialPort, size_t inputBufferSize = DEFAULT_STREAM_BUFFER_SIZE,
+        size_t outputBufferSize = DEFAULT_STREAM_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new SerialStreamBuf object
+     *
+     * @param serialStreamBuf Serial stream buffer
+     */
+    SerialStreamBuf(const SerialStreamBuf& serialStreamBuf) = delete;
+
+    /**
+     * @brief Move-construct a new SerialStreamBuf object
+     *
+     * @param serialStreamBuf Serial stream buffer
+     */
+    SerialStreamBuf(SerialStreamBuf&& serialStreamBuf) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialStreamBuf Serial stream buffer to copy-assign
+     * @return SerialStreamBuf& Assigned serial stream buffer
+     */
+    SerialStreamBuf& operator=(const SerialStreamBuf& serialStreamBuf) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialStreamBuf Serial stream buffer to move-assign
+     * @return SerialStreamBuf& Assigned serial stream buffer
+     */
+    SerialStreamBuf& operator=(SerialStreamBuf&& serialStreamBuf) = delete;
+
+    /**
+     * @brief Destroy the SerialStreamBuf object, writing the buffered output
+     *
+     */
+    ~SerialStreamBuf() noexcept override;
+
+    /**
+     * @brief Get the read timeout
+     *
+     * @return std::chrono::milliseconds Maximum time to wait for data
+     */
+    std::chrono::milliseconds getReadTimeout() const;
+
+    /**
+     * @brief Set the read timeout
+     *
+     * @param readTimeout Maximum time to wait for data, negative to wait indefinitely
+     */
+    void setReadTimeout(std::chrono::milliseconds readTimeout);
+
+    /**
+     * @brief Get the write timeout
+     *
+     * @return std::chrono::milliseconds Maximum time to wait for a write to complete
+     */
+    std::chrono::milliseconds getWriteTimeout() const;
+
+    /**
+     * @brief Set the write timeout
+     *
+     * @param writeTimeout Maximum time to wait for a write to complete, negative to wait indefinitely
+     */
+    void setWriteTimeout(std::chrono::milliseconds writeTimeout);
+
+    /**
+     * @brief Get the error of the last read or write
+     *
+     * @return const std::error_code& Error code, cleared by a successful read or write,
+     *   std::errc::timed_out on a timeout,
+     *   SerialError::SERIAL_ERROR_NOT_SUPPORTED for a direction without a buffer
+     */
+    const std::error_code& getError() const;
+
+    /**
+     * @brief Get the serial stream buffer statistics
+     *
+     * @return SerialStreamStatistics Serial stream buffer statistics
+     */
+    SerialStreamStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Refill the input buffer
+     *
+     * @return int_type First character of the input buffer or eof on a timeout or an error
+     */
+    int_type underflow() override;
+
+    /**
+     * @brief Read characters
+     *
+     * @param buffer Data buffer
+     * @param count Number of characters to read
+     * @return std::streamsize Number of characters actually read
+     */
+    std::streamsize xsgetn(char_type* buffer, std::streamsize count) override;
+
+    /**
+     * @brief Get the number of characters available without waiting
+     *
+     * @return std::streamsize Number of characters waiting in the serial port input queue
+     */
+    std::streamsize showmanyc() override;
+
+    /**
+     * @brief Write the output buffer and store a character
+     *
+     * @param character Character to store or eof
+     * @return int_type Stored character or eof on a timeout or an error
+     */
+    int_type overflow(int_type character) override;
+
+    /**
+     * @brief Write characters
+     *
+     * @param buffer Data buffer
+     * @param count Number of characters to write
+     * @return std::streamsize Number of characters actually written or buffered
+     */
+    std::streamsize xsputn(const char_type* buffer, std::streamsize count) override;
+
+    /**
+     * @brief Write the output buffer
+     *
+     * @return int 0 on success, -1 on a timeout or an error
+     */
+    int sync() override;
+
+    /**
+     * @brief Read the available data, waiting for data up to the read timeout
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data buffer
+     * @return size_t Size of the data actually read, 0 on a timeout or an error
+     */
+    size_t receive(char* buffer, size_t size);
+
+    /**
+     * @brief Write all the data, waiting for the serial port up to the write timeout
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data
+     * @return size_t Size of the data actually written, less than size on a timeout or an error
+     */
+    size_t transmit(const char* buffer, size_t size);
+
+    /**
+     * @brief Write the output buffer, keeping the unwritten rest on a timeout or an error
+     *
+     * @return true Output buffer written
+     * @return false Timeout or error
+     */
+    bool flushBuffer();
+
+    /**
+     * @brief Wait for the serial port to become ready
+     *
+     * @param events Poll events to wait for
+     * @param deadline Time the wait ends
+     * @param infinite Wait indefinitely
+     * @return true Serial port ready
+     * @return false Timeout or error, stored as the last error
+     */
+    bool wait(short events, std::chrono::steady_clock::time_point deadline, bool infinite);
+
+    /**
+     * @brief Stream serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Input buffer
+     *
+     */
+    std::vector<char> inputBuffer;
+
+    /**
+     * @brief Output buffer
+     *
+     */
+    std::vector<char> outputBuffer;
+
+    /**
+     * @brief Read timeout
+     *
+     */
+    std::chrono::milliseconds readTimeout;
+
+    /**
+     * @brief Write timeout
+     *
+     */
+    std::chrono::milliseconds writeTimeout;
+
+    /**
+     * @brief Error of the last read or write
+     *
+     */
+    std::error_code error;
+
+    /**
+     * @brief Serial stream buffer statistics
+     *
+     */
+    SerialStreamStatistics statistics;
+};
+
+/**
+ * @brief SerialIStream class
+ *
+ * Input stream reading an open serial port through its own SerialStreamBuf.
+ */
+class SerialIStream final : public std::istream
+{
+public:
+    /**
+     * @brief Construct a new SerialIStream object
+     *
+     * @param serialPort Open serial port
+     * @param bufferSize Size of the input buffer
+     * @param timeout Maximum time to wait for data, negative to wait indefinitely
+     * @throw std::out_of_range Invalid buffer size
+     */
+    explicit SerialIStream(SerialPort& serialPort, size_t bufferSize = DEFAULT_STREAM_BUFFER_SIZE,
+        std::chrono::milliseconds timeout = DEFAULT_STREAM_TIMEOUT);
+
+    /**
+     * @brief Copy-construct a new SerialIStream object
+     *
+     * @param serialIStream Serial input stream
+     */
+    SerialIStream(const SerialIStream& serialIStream) = delete;
+
+    /**
+     * @brief Move-construct a new SerialIStream object
+     *
+     * @param serialIStream Serial input stream
+     */
+    SerialIStream(SerialIStream&& serialIStream) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialIStream Serial input stream to copy-assign
+     * @return SerialIStream& Assigned serial input stream
+     */
+    SerialIStream& operator=(const SerialIStream& serialIStream) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialIStream Serial input stream to move-assign
+     * @return SerialIStream& Assigned serial input stream
+     */
+    SerialIStream& operator=(SerialIStream&& serialIStream) = delete;
+
+    /**
+     * @brief Destroy the SerialIStream object
+     *
+     */
+    ~SerialIStream() noexcept override = default;
+
+    /**
+     * @brief Get the stream buffer
+     *
+     * @return SerialStreamBuf& Serial stream buffer
+     */
+    SerialStreamBuf& getStreamBuf();
+protected:
+    /**
+     * @brief Serial stream buffer
+     *
+     */
+    SerialStreamBuf streamBuf;
+};
+
+/**
+ * @brief SerialOStream class
+ *
+ * Output stream writing an open serial port through its own SerialStreamBuf.
+ * Buffered output is written by flush(), std::endl or the destructor.
+ */
+class SerialOStream final : public std::ostream
+{
+public:
+    /**
+     * @brief Construct a new SerialOStream object
+     *
+     * @param serialPort Open serial port
+     * @param bufferSize Size of the output buffer
+     * @param timeout Maximum time to wait for a write to complete, negative to wait indefinitely
+     * @throw std::out_of_range Invalid buffer size
+     */
+    explicit SerialOStream(SerialPort& serialPort, size_t bufferSize = DEFAULT_STREAM_BUFFER_SIZE,
+        std::chrono::milliseconds timeout = DEFAULT_STREAM_TIMEOUT);
+
+    /**
+     * @brief Copy-construct a new SerialOStream object
+     *
+     * @param serialOStream Serial output stream
+     */
+    SerialOStream(const SerialOStream& serialOStream) = delete;
+
+    /**
+     * @brief Move-construct a new SerialOStream object
+     *
+     * @param serialOStream Serial output stream
+     */
+    SerialOStream(SerialOStream&& serialOStream) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialOStream Serial output stream to copy-assign
+     * @return SerialOStream& Assigned serial output stream
+     */
+    SerialOStream& operator=(const SerialOStream& serialOStream) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialOStream Serial output stream to move-assign
+     * @return SerialOStream& Assigned serial output stream
+     */
+    SerialOStream& operator=(SerialOStream&& serialOStream) = delete;
+
+    /**
+     * @brief Destroy the SerialOStream object
+     *
+     */
+    ~SerialOStream() noexcept override = default;
+
+    /**
+     * @brief Get the stream buffer
+     *
+     * @return SerialStreamBuf& Serial stream buffer
+     */
+    SerialStreamBuf& getStreamBuf();
+protected:
+    /**
+     * @brief Serial stream buffer
+     *
+     */
+    SerialStreamBuf streamBuf;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,294 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <iostream>
+#include <termios.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Get the termios speed of a baud rate at compile time
+ *
+ * @param baudRate Baud rate
+ * @return speed_t Speed constant or B0 if the baud rate is not supported
+ */
+constexpr speed_t getBaudRateSpeed(BaudRate baudRate)
+{
+    switch (baudRate)
+    {
+        case BaudRate::BAUD_RATE_50:
+            return B50;
+        case BaudRate::BAUD_RATE_75:
+            return B75;
+        case BaudRate::BAUD_RATE_110:
+            return B110;
+        case BaudRate::BAUD_RATE_134:
+            return B134;
+        case BaudRate::BAUD_RATE_150:
+            return B150;
+        case BaudRate::BAUD_RATE_200:
+            return B200;
+        case BaudRate::BAUD_RATE_300:
+            return B300;
+        case BaudRate::BAUD_RATE_600:
+            return B600;
+        case BaudRate::BAUD_RATE_1200:
+            return B1200;
+        case BaudRate::BAUD_RATE_1800:
+            return B1800;
+        case BaudRate::BAUD_RATE_2400:
+            return B2400;
+        case BaudRate::BAUD_RATE_4800:
+            return B4800;
+        case BaudRate::BAUD_RATE_9600:
+            return B9600;
+        case BaudRate::BAUD_RATE_19200:
+            return B19200;
+        case BaudRate::BAUD_RATE_38400:
+            return B38400;
+        case BaudRate::BAUD_RATE_57600:
+            return B57600;
+        case BaudRate::BAUD_RATE_115200:
+            return B115200;
+        case BaudRate::BAUD_RATE_230400:
+            return B230400;
+        case BaudRate::BAUD_RATE_460800:
+            return B460800;
+        case BaudRate::BAUD_RATE_500000:
+            return B500000;
+        case BaudRate::BAUD_RATE_576000:
+            return B576000;
+        case BaudRate::BAUD_RATE_921600:
+            return B921600;
+        case BaudRate::BAUD_RATE_1000000:
+            return B1000000;
+        case BaudRate::BAUD_RATE_1152000:
+            return B1152000;
+        case BaudRate::BAUD_RATE_1500000:
+            return B1500000;
+#if __MAX_BAUD > B2000000
+        case BaudRate::BAUD_RATE_2000000:
+            return B2000000;
+        case BaudRate::BAUD_RATE_2500000:
+            return B2500000;
+        case BaudRate::BAUD_RATE_3000000:
+            return B3000000;
+        case BaudRate::BAUD_RATE_3500000:
+            return B3500000;
+        case BaudRate::BAUD_RATE_4000000:
+            return B4000000;
+#endif // __MAX_BAUD
+        default:
+            return B0;
+    }
+}
+
+/**
+ * @brief Get the termios character size flags at compile time
+ *
+ * @param characterSize Character size
+ * @return tcflag_t Character size flags
+ */
+constexpr tcflag_t getCharacterSizeFlags(CharacterSize characterSize)
+{
+    switch (characterSize)
+    {
+        case CharacterSize::CHARACTER_SIZE_5:
+            return CS5;
+        case CharacterSize::CHARACTER_SIZE_6:
+            return CS6;
+        case CharacterSize::CHARACTER_SIZE_7:
+            return CS7;
+        case CharacterSize::CHARACTER_SIZE_8:
+        default:
+            return CS8;
+    }
+}
+
+/**
+ * @brief Build native port settings equal to the runtime preparation of the
+ *   termios settings performed on open
+ *
+ * @param baudRate Baud rate
+ * @param characterSize Character size
+ * @param parity Parity
+ * @param stopBit Stop bit
+ * @param flowControl Flow control
+ * @return NativePortSettings Native port settings
+ */
+constexpr NativePortSettings getNativePortSettings(BaudRate baudRate, CharacterSize characterSize,
+    Parity parity, StopBit stopBit, FlowControl flowControl)
+{
+    const bool checked{(parity == Parity::PARITY_TYPE_EVEN) || (parity == Parity::PARITY_TYPE_ODD)};
+    const bool sticky{(parity == Parity::PARITY_TYPE_MARK) || (parity == Parity::PARITY_TYPE_SPACE)};
+    const bool software{flowControl == FlowControl::FLOW_CONTROL_SOFTWARE};
+    static_assert(NCCS <= 64, "Special characters do not fit the control character mask");
+
+    NativePortSettings settings{};
+
+    // Raw input with optional parity checking and software flow control
+    settings.inputFlagsClear = IGNBRK | BRKINT | IGNPAR | PARMRK | INPCK | ISTRIP | INLCR |
+        IGNCR | ICRNL | IUCLC | IXON | IXANY | IXOFF | IMAXBEL | IUTF8;
+    settings.inputFlagsSet = (checked ? INPCK : IGNPAR) | (software ? (IXON | IXOFF) : 0);
+
+    // Raw output
+    settings.outputFlagsClear = OPOST | OLCUC | ONLCR | OCRNL | ONOCR | ONLRET | OFILL | OFDEL |
+        NLDLY | CRDLY | TABDLY | BSDLY | VTDLY | FFDLY;
+    settings.outputFlagsSet = 0;
+
+    // Frame format, receiver enabled, modem control lines ignored
+    settings.controlFlagsClear = CSIZE | CSTOPB | PARENB | PARODD | CMSPAR | HUPCL | CRTSCTS;
+    settings.controlFlagsSet = getCharacterSizeFlags(characterSize) | CREAD | CLOCAL |
+        ((stopBit == StopBit::STOP_BIT_TWO) ? CSTOPB : 0) |
+        ((checked || sticky) ? PARENB : 0) |
+        (((parity == Parity::PARITY_TYPE_ODD) || (parity == Parity::PARITY_TYPE_MARK)) ? PARODD : 0) |
+        (sticky ? CMSPAR : 0) |
+        ((flowControl == FlowControl::FLOW_CONTROL_HARDWARE) ? CRTSCTS : 0);
+
+    // Non-canonical mode without echo and signals
+    settings.localFlagsClear = ISIG | ICANON | XCASE | ECHO | ECHOE | ECHOK | ECHONL | NOFLSH |
+        TOSTOP | ECHOCTL | ECHOPRT | ECHOKE | FLUSHO | PENDIN | IEXTEN;
+    settings.localFlagsSet = 0;
+
+    settings.speed = getBaudRateSpeed(baudRate);
+
+    // Special characters are disabled apart from software flow control
+    const unsigned char controlCharacters[]{VDISCARD, VEOF, VEOL, VEOL2, VERASE, VINTR, VKILL, VLNEXT,
+        VMIN, VQUIT, VREPRINT, VSTART, VSTOP, VSUSP, VSWTC, VTIME, VWERASE};
+    for (const auto controlCharacter: controlCharacters)
+    {
+        settings.controlCharacterMask |= (1ULL << controlCharacter);
+        settings.controlCharacters[controlCharacter] = _POSIX_VDISABLE;
+    }
+    if (software)
+    {
+        settings.controlCharacters[VSTART] = XON;
+        settings.controlCharacters[VSTOP] = XOFF;
+    }
+    return settings;
+}
+
+/**
+ * @brief SerialPortConfig class template
+ *
+ * Fixed serial port configuration validated at compile time. The termios flag
+ * words are generated as constants and applied on open with a single
+ * tcsetattr call, skipping the runtime preparation of the port settings.
+ *
+ * @tparam BaudRateValue Baud rate
+ * @tparam CharacterSizeValue Character size
+ * @tparam ParityValue Parity
+ * @tparam StopBitValue Stop bit
+ * @tparam FlowControlValue Flow control
+ */
+template<BaudRate BaudRateValue,
+    CharacterSize CharacterSizeValue = CharacterSize::CHARACTER_SIZE_DEFAULT,
+    Parity ParityValue = Parity::PARITY_TYPE_DEFAULT,
+    StopBit StopBitValue = StopBit::STOP_BIT_DEFAULT,
+    FlowControl FlowControlValue = FlowControl::FLOW_CONTROL_DEFAULT>
+class SerialPortConfig final
+{
+    static_assert(getBaudRateSpeed(BaudRateValue) != B0, "Baud rate not supported");
+    static_assert((CharacterSizeValue >= CharacterSize::CHARACTER_SIZE_MIN) && (CharacterSizeValue <= CharacterSize::CHARACTER_SIZE_MAX),
+        "Character size not supported");
+    static_assert((ParityValue >= Parity::PARITY_TYPE_MIN) && (ParityValue <= Parity::PARITY_TYPE_MAX),
+        "Parity not supported");
+    static_assert((StopBitValue == StopBit::STOP_BIT_ONE) || (StopBitValue == StopBit::STOP_BIT_TWO),
+        "Stop bit not supported");
+    static_assert((FlowControlValue >= FlowControl::FLOW_CONTROL_MIN) && (FlowControlValue <= FlowControl::FLOW_CONTROL_MAX),
+        "Flow control not supported");
+public:
+    /**
+     * @brief Baud rate
+     *
+     */
+    static constexpr BaudRate BAUD_RATE{BaudRateValue};
+
+    /**
+     * @brief Character size
+     *
+     */
+    static constexpr CharacterSize CHARACTER_SIZE{CharacterSizeValue};
+
+    /**
+     * @brief Parity
+     *
+     */
+    static constexpr Parity PARITY{ParityValue};
+
+    /**
+     * @brief Stop bit
+     *
+     */
+    static constexpr StopBit STOP_BIT{StopBitValue};
+
+    /**
+     * @brief Flow control
+     *
+     */
+    static constexpr FlowControl FLOW_CONTROL{FlowControlValue};
+
+    /**
+     * @brief Native port settings
+     *
+     */
+    static constexpr NativePortSettings NATIVE_PORT_SETTINGS{
+        getNativePortSettings(BaudRateValue, CharacterSizeValue, ParityValue, StopBitValue, FlowControlValue)};
+
+    /**
+     * @brief Construct a new SerialPortConfig object
+     *
+     */
+    SerialPortConfig() = delete;
+
+    /**
+     * @brief Apply the configuration to a serial port and open it
+     *
+     * @param serialPort Serial port
+     * @param openMode Serial port open mode
+     * @throw std::runtime_error Unsupported open mode
+     * @throw std::runtime_error Unable to open serial port
+     * @throw std::runtime_error Unable to get port settings
+     * @throw std::runtime_error Unable to set exclusive mode
+     * @throw std::runtime_error Unable to set port settings
+     * @note Does nothing on an open serial port
+     */
+    static void open(SerialPort& serialPort, std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out)
+    {
+        // Do nothing on an open port
+        if (serialPort.isOpen())
+            return;
+
+        // Properties of a closed port are only stored
+        serialPort.setBaudRate(BAUD_RATE);
+        serialPort.setCharacterSize(CHARACTER_SIZE);
+        serialPort.setParity(PARITY);
+        serialPort.setStopBit(STOP_BIT);
+        serialPort.setFlowControl(FLOW_CONTROL);
+        serialPort.open(NATIVE_PORT_SETTINGS, openMode);
+    }
+};
+
+END_NAMESPACE_LIBSERIAL
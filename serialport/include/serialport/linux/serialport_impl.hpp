@@ -20,10 +20,14 @@
 */
 
 #pragma once
+#include <chrono>
 #include <string>
 #include <iostream>
+#include <shared_mutex>
+#include <system_error>
 #include <termios.h>
 #include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
 #include <serialport/properties.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
@@ -113,6 +117,31 @@ public:
      */
     void open(std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
 
+    /**
+     * @brief Open serial port with precomputed native port settings
+     *
+     * @param nativePortSettings Native port settings applied with a single system call
+     * @param openMode Serial port open mode
+     * @throw std::runtime_error Unsupported open mode
+     * @throw std::runtime_error Unable to open serial port
+     * @throw std::runtime_error Unable to get port settings
+     * @throw std::runtime_error Unable to set exclusive mode
+     * @throw std::runtime_error Unable to set port settings
+     * @note Baud rate, character size, flow control, parity and stop bit
+     *   properties must be set to match the native port settings
+     */
+    void open(const NativePortSettings& nativePortSettings,
+        std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
+
+    /**
+     * @brief Open serial port without throwing
+     *
+     * @param openMode Serial port open mode
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an unsupported
+     *   open mode or port settings, system error otherwise
+     */
+    void open(std::ios_base::openmode openMode, std::error_code& error) noexcept;
+
     /**
      * @brief Close serial port
      *
@@ -120,12 +149,27 @@ public:
      */
     void close();
 
+    /**
+     * @brief Close serial port without throwing
+     *
+     * @param error Error code of restoring previous port settings, port is closed regardless
+     */
+    void close(std::error_code& error) noexcept;
+
+    /**
+     * @brief Close serial port without restoring previous port settings
+     *
+     * @note Intended for serial ports whose device has disappeared
+     */
+    void abandon() noexcept;
+
     /**
      * @brief Set the exclusive mode of the serial port
      *
      * @param exclusive Exclusive mode
      * @return true Successfully changed the exclusive mode
      * @return false Failed to change the exclusive mode
+     * @note Serial port is always opened in exclusive mode, the mode is not retained across reopens
      */
     bool setExclusive(bool exclusive);
 
@@ -138,6 +182,17 @@ public:
      */
     size_t read(char* buffer, size_t size) const;
 
+    /**
+     * @brief Read data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when no data is
+     *   available, SerialError::SERIAL_ERROR_HANGUP on end of file or a disappeared device
+     * @return size_t Size of the data actually read, 0 on error
+     */
+    size_t read(char* buffer, size_t size, std::error_code& error) const noexcept;
+
     /**
      * @brief Read data
      *
@@ -164,6 +219,29 @@ public:
      */
     size_t write(const char* buffer, size_t size) const;
 
+    /**
+     * @brief Write data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when the output
+     *   buffer is full, SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, 0 on error
+     */
+    size_t write(const char* buffer, size_t size, std::error_code& error) const noexcept;
+
+    /**
+     * @brief Write all data, waiting for space in the output buffer
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param timeout Maximum time to wait for space in the output buffer, negative waits indefinitely
+     * @param error Error code, std::errc::timed_out when no space became available in time,
+     *   SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, less than size on error
+     */
+    size_t writeAll(const char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error) const noexcept;
+
     /**
      * @brief Write data
      *
@@ -225,6 +303,20 @@ public:
      */
     std::string getPortName() const;
 
+    /**
+     * @brief Get the native serial port handle
+     *
+     * @return NativeHandle Native handle or INVALID_FILE_DESCRIPTOR on a closed port
+     */
+    NativeHandle getNativeHandle() const;
+
+    /**
+     * @brief Get the mutex serializing configuration changes against I/O
+     *
+     * @return std::shared_mutex& Mutex, held shared by I/O and exclusively by configuration changes
+     */
+    std::shared_mutex& getMutex() const noexcept;
+
     /**
      * @brief Set the port name
      *
@@ -252,6 +344,14 @@ public:
      */
     void setBaudRate(BaudRate baudRate);
 
+    /**
+     * @brief Set the baud rate without throwing
+     *
+     * @param baudRate Baud rate
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported baud rate
+     */
+    void setBaudRate(BaudRate baudRate, std::error_code& error) noexcept;
+
     /**
      * @brief Get the character size
      *
@@ -267,6 +367,14 @@ public:
      */
     void setCharacterSize(CharacterSize characterSize);
 
+    /**
+     * @brief Set the character size without throwing
+     *
+     * @param characterSize Character size
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported character size
+     */
+    void setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept;
+
     /**
      * @brief Get the flow control
      *
@@ -282,6 +390,14 @@ public:
      */
     void setFlowControl(FlowControl flowControl);
 
+    /**
+     * @brief Set the flow control without throwing
+     *
+     * @param flowControl Flow control
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported flow control
+     */
+    void setFlowControl(FlowControl flowControl, std::error_code& error) noexcept;
+
     /**
      * @brief Get the parity
      *
@@ -297,6 +413,14 @@ public:
      */
     void setParity(Parity parity);
 
+    /**
+     * @brief Set the parity without throwing
+     *
+     * @param parity Parity
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported parity
+     */
+    void setParity(Parity parity, std::error_code& error) noexcept;
+
     /**
      * @brief Get the stop bit
      *
@@ -312,6 +436,14 @@ public:
      */
     void setStopBit(StopBit stopBit);
 
+    /**
+     * @brief Set the stop bit without throwing
+     *
+     * @param stopBit Stop bit
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported stop bit
+     */
+    void setStopBit(StopBit stopBit, std::error_code& error) noexcept;
+
     /**
      * @brief Get the control line status
      *
@@ -342,6 +474,18 @@ protected:
      */
     void reopen();
 
+    /**
+     * @brief Open serial port, store current port settings and apply new ones
+     *
+     * @param openMode Serial port open mode
+     * @param nativePortSettings Precomputed native port settings or nullptr to prepare them
+     * @param error Error code
+     * @return const char* Description of the failed step or nullptr on success
+     * @note Serial port is closed on failure
+     */
+    const char* openPort(std::ios_base::openmode openMode,
+        const NativePortSettings* nativePortSettings, std::error_code& error) noexcept;
+
     /**
      * @brief Update serial port settings
      *
@@ -350,6 +494,22 @@ protected:
      */
     void updatePortSettings() const;
 
+    /**
+     * @brief Update serial port settings without throwing
+     *
+     * @param error Error code
+     * @return const char* Description of the failed step or nullptr on success
+     */
+    const char* updatePortSettings(std::error_code& error) const noexcept;
+
+    /**
+     * @brief Check the serial port for a hang-up without waiting
+     *
+     * @return true Device hung up
+     * @return false Device is connected
+     */
+    bool isHungUp() const noexcept;
+
     /**
      * @brief Get the serial port settings
      *
@@ -366,6 +526,14 @@ protected:
      */
     void preparePortSettings(struct termios& portSettings) const;
 
+    /**
+     * @brief Prepare serial port settings from precomputed native port settings
+     *
+     * @param portSettings Serial port settings
+     * @param nativePortSettings Native port settings
+     */
+    void preparePortSettings(struct termios& portSettings, const NativePortSettings& nativePortSettings) const;
+
     /**
      * @brief Set the serial port settings
      *
@@ -454,6 +622,12 @@ protected:
      *
      */
     StopBit stopBit;
+
+    /**
+     * @brief Mutex serializing configuration changes against I/O
+     *
+     */
+    mutable std::shared_mutex mutex;
 };
 
 END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,491 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default size of a serial port pump chunk in bytes
+ *
+ */
+static constexpr size_t DEFAULT_PUMP_CHUNK_SIZE{256};
+
+/**
+ * @brief Default number of chunks of a serial port pump queue
+ *
+ */
+static constexpr size_t DEFAULT_PUMP_QUEUE_SIZE{64};
+
+/**
+ * @brief Number of buckets of the serial port pump wakeup latency histogram
+ *
+ */
+static constexpr size_t PUMP_HISTOGRAM_SIZE{24};
+
+/**
+ * @brief Size of a cache line in bytes
+ *
+ */
+static constexpr size_t CACHE_LINE_SIZE{64};
+
+/**
+ * @brief Serial port pump options
+ *
+ */
+struct PumpOptions
+{
+    /**
+     * @brief CPU the pump thread is bound to or -1 for any CPU
+     *
+     */
+    int cpu{-1};
+
+    /**
+     * @brief SCHED_FIFO priority of the pump thread or 0 for the default scheduler
+     *
+     */
+    int priority{0};
+
+    /**
+     * @brief Lock all current and future pages of the process in memory
+     *
+     */
+    bool lockMemory{false};
+
+    /**
+     * @brief Size of a chunk, the largest single read or send
+     *
+     */
+    size_t chunkSize{DEFAULT_PUMP_CHUNK_SIZE};
+
+    /**
+     * @brief Number of chunks of each receive and transmit queue, a power of two
+     *
+     */
+    size_t queueSize{DEFAULT_PUMP_QUEUE_SIZE};
+};
+
+/**
+ * @brief Serial port pump statistics
+ *
+ */
+struct PumpStatistics
+{
+    /**
+     * @brief Number of wakeups of the pump thread by a send
+     *
+     */
+    uint64_t wakeupCount{0};
+
+    /**
+     * @brief Size of the received data
+     *
+     */
+    uint64_t receivedCount{0};
+
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Number of times a receive queue was full and reading was paused
+     *
+     */
+    uint64_t stallCount{0};
+
+    /**
+     * @brief Number of serial ports removed from the pump after a read or write error
+     *
+     */
+    uint64_t errorCount{0};
+
+    /**
+     * @brief Maximum time between a send and the pump thread servicing it
+     *
+     */
+    std::chrono::nanoseconds maxWakeupLatency{0};
+
+    /**
+     * @brief Wakeup latency histogram, bucket 0 counts latencies below 1 us and
+     *   bucket n latencies from 2^(n-1) us up to 2^n us, the last bucket counts all longer latencies
+     *
+     */
+    std::array<uint64_t, PUMP_HISTOGRAM_SIZE> wakeupLatencyHistogram{};
+};
+
+/**
+ * @brief SerialPortPump class
+ *
+ * Services a set of open serial ports from a dedicated thread which may be
+ * bound to a CPU and run with SCHED_FIFO priority, optionally with all the
+ * process memory locked. Received data is read straight into preallocated
+ * chunks of a single-producer single-consumer queue per port and data to
+ * transmit is passed to the pump through a second queue per port, so
+ * neither side allocates, locks or blocks the other after start().
+ *
+ * Each port must have a single consumer thread calling receive() and a
+ * single producer thread calling send(); receive() never blocks. A full
+ * receive queue pauses reading of its port, leaving the data in the driver,
+ * and the paused port is rechecked every millisecond. The time between a
+ * send() and the pump thread servicing it is recorded in a wakeup latency
+ * histogram.
+ */
+class SerialPortPump final
+{
+public:
+    /**
+     * @brief Construct a new SerialPortPump object
+     *
+     * @param options Pump options
+     * @throw std::out_of_range Invalid chunk or queue size
+     * @throw std::runtime_error Unable to create event
+     */
+    explicit SerialPortPump(const PumpOptions& options = PumpOptions{});
+
+    /**
+     * @brief Copy-construct a new SerialPortPump object
+     *
+     * @param serialPortPump Serial port pump
+     */
+    SerialPortPump(const SerialPortPump& serialPortPump) = delete;
+
+    /**
+     * @brief Move-construct a new SerialPortPump object
+     *
+     * @param serialPortPump Serial port pump
+     */
+    SerialPortPump(SerialPortPump&& serialPortPump) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialPortPump Serial port pump to copy-assign
+     * @return SerialPortPump& Assigned serial port pump
+     */
+    SerialPortPump& operator=(const SerialPortPump& serialPortPump) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialPortPump Serial port pump to move-assign
+     * @return SerialPortPump& Assigned serial port pump
+     */
+    SerialPortPump& operator=(SerialPortPump&& serialPortPump) = delete;
+
+    /**
+     * @brief Stop the pump thread and destroy the SerialPortPump object
+     *
+     */
+    ~SerialPortPump() noexcept;
+
+    /**
+     * @brief Add a serial port and preallocate its queues
+     *
+     * @param serialPort Open serial port
+     * @return size_t Port index
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Pump is running
+     */
+    size_t addPort(SerialPort& serialPort);
+
+    /**
+     * @brief Get the number of serial ports
+     *
+     * @return size_t Number of serial ports
+     */
+    size_t getPortCount() const;
+
+    /**
+     * @brief Apply the options and start the pump thread
+     *
+     * @throw std::runtime_error Pump is running
+     * @throw std::runtime_error Unable to lock memory
+     * @throw std::runtime_error Unable to start pump thread
+     * @throw std::runtime_error Unable to set CPU affinity
+     * @throw std::runtime_error Unable to set real-time priority
+     * @note Locked memory stays locked after the pump is stopped
+     */
+    void start();
+
+    /**
+     * @brief Stop the pump thread
+     *
+     */
+    void stop();
+
+    /**
+     * @brief Get the running status
+     *
+     * @return true Pump thread is running
+     * @return false Pump thread is stopped
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Copy received data out of the receive queue of a port
+     *
+     * @param port Port index
+     * @param buffer Data buffer
+     * @param size Size of the data buffer
+     * @return size_t Size of the data copied, 0 if no data was received
+     * @throw std::out_of_range Invalid port index
+     */
+    size_t receive(size_t port, char* buffer, size_t size);
+
+    /**
+     * @brief Queue data for transmission on a port
+     *
+     * @param port Port index
+     * @param data Data
+     * @param size Size of the data, at most the chunk size
+     * @return true Data queued
+     * @return false Transmit queue is full or data is larger than a chunk
+     * @throw std::out_of_range Invalid port index
+     */
+    bool send(size_t port, const char* data, size_t size);
+
+    /**
+     * @brief Get the pump statistics
+     *
+     * @return PumpStatistics Pump statistics
+     * @note May be called while the pump is running
+     */
+    PumpStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Single-producer single-consumer queue of fixed size chunks
+     *
+     */
+    struct Queue
+    {
+        /**
+         * @brief Chunk storage
+         *
+         */
+        std::unique_ptr<char[]> data;
+
+        /**
+         * @brief Chunk sizes
+         *
+         */
+        std::unique_ptr<size_t[]> sizes;
+
+        /**
+         * @brief Consumed size of the oldest chunk, owned by the consumer
+         *
+         */
+        size_t offset;
+
+        /**
+         * @brief Index of the oldest chunk, written by the consumer
+         *
+         */
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+
+        /**
+         * @brief Index of the next free chunk, written by the producer
+         *
+         */
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+    };
+
+    /**
+     * @brief Pumped serial port
+     *
+     */
+    struct Port
+    {
+        /**
+         * @brief Serial port
+         *
+         */
+        SerialPort* serialPort;
+
+        /**
+         * @brief Serial port file descriptor
+         *
+         */
+        int fileDescriptor;
+
+        /**
+         * @brief Queue of the received data
+         *
+         */
+        Queue receiveQueue;
+
+        /**
+         * @brief Queue of the data to transmit
+         *
+         */
+        Queue transmitQueue;
+
+        /**
+         * @brief Reading is paused on a full receive queue
+         *
+         */
+        bool stalled;
+
+        /**
+         * @brief Serial port was removed after an error
+         *
+         */
+        bool failed;
+    };
+
+    /**
+     * @brief Allocate the chunks of a queue
+     *
+     * @param queue Queue
+     */
+    void allocate(Queue& queue) const;
+
+    /**
+     * @brief Service the serial ports until stopped
+     *
+     */
+    void run();
+
+    /**
+     * @brief Read from a serial port into its receive queue
+     *
+     * @param port Pumped serial port
+     */
+    void receive(Port& port);
+
+    /**
+     * @brief Write the transmit queue of a serial port
+     *
+     * @param port Pumped serial port
+     */
+    void transmit(Port& port);
+
+    /**
+     * @brief Record the latency of a wakeup by a send
+     *
+     */
+    void recordWakeup();
+
+    /**
+     * @brief Pump options
+     *
+     */
+    PumpOptions options;
+
+    /**
+     * @brief Mask of the queue indices
+     *
+     */
+    size_t queueMask;
+
+    /**
+     * @brief Pumped serial ports
+     *
+     */
+    std::vector<std::unique_ptr<Port>> ports;
+
+    /**
+     * @brief Poll descriptors of the serial ports and the wakeup event
+     *
+     */
+    std::vector<struct pollfd> descriptors;
+
+    /**
+     * @brief Wakeup event signalled by sends and stop
+     *
+     */
+    int wakeupEvent;
+
+    /**
+     * @brief Stop flag
+     *
+     */
+    std::atomic<bool> stopped;
+
+    /**
+     * @brief Steady clock time of the earliest unserviced wakeup in nano-seconds or 0
+     *
+     */
+    std::atomic<int64_t> wakeupTime;
+
+    /**
+     * @brief Number of wakeups by a send
+     *
+     */
+    std::atomic<uint64_t> wakeupCount;
+
+    /**
+     * @brief Size of the received data
+     *
+     */
+    std::atomic<uint64_t> receivedCount;
+
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    std::atomic<uint64_t> transmittedCount;
+
+    /**
+     * @brief Number of receive queue stalls
+     *
+     */
+    std::atomic<uint64_t> stallCount;
+
+    /**
+     * @brief Number of failed serial ports
+     *
+     */
+    std::atomic<uint64_t> errorCount;
+
+    /**
+     * @brief Maximum wakeup latency in nano-seconds
+     *
+     */
+    std::atomic<int64_t> maxWakeupLatency;
+
+    /**
+     * @brief Wakeup latency histogram
+     *
+     */
+    std::array<std::atomic<uint64_t>, PUMP_HISTOGRAM_SIZE> wakeupLatencyHistogram;
+
+    /**
+     * @brief Pump thread
+     *
+     */
+    std::thread thread;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,326 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Forward declaration of the shared ring header
+ *
+ */
+struct SharedRingHeader;
+
+/**
+ * @brief Default shared ring capacity in bytes
+ *
+ */
+static constexpr size_t DEFAULT_SHARED_RING_CAPACITY{1U << 20};
+
+/**
+ * @brief Default shared ring permissions, read-write for the owner only
+ *
+ */
+static constexpr mode_t DEFAULT_SHARED_RING_MODE{0600};
+
+/**
+ * @brief SharedRingPublisher class
+ *
+ * Owns a serial port and publishes all received data into a single-producer,
+ * multi-consumer ring in POSIX shared memory (/dev/shm). Any number of
+ * SharedRingSubscriber objects, in the same or other processes, receive the
+ * same data stream. Received data is read by the kernel directly into the
+ * ring and subscribers are woken up through a futex only when they wait.
+ *
+ * The shared memory object is created exclusively, so a ring which is still
+ * in use by another publisher is never truncated under its subscribers.
+ * Subscribers map the ring read-write to announce their waits, so the
+ * permissions must grant write access to every subscriber (e.g. 0660 for
+ * subscribers of the same group).
+ *
+ * @note Subscribers which fall behind by more than the ring capacity lose
+ *   the oldest data and continue with the oldest data still available.
+ */
+class SharedRingPublisher final
+{
+public:
+    /**
+     * @brief Construct a new SharedRingPublisher object
+     *
+     * @param serialPort Open serial port to publish
+     * @param name Shared memory object name (e.g. /ttyUSB0)
+     * @param capacity Ring capacity in bytes, rounded up to a power of two
+     * @param mode Permissions of the shared memory object, not masked by the umask
+     * @throw std::runtime_error Shared memory object already exists
+     * @throw std::runtime_error Unable to create shared memory object
+     */
+    explicit SharedRingPublisher(SerialPort& serialPort, const std::string& name,
+        size_t capacity = DEFAULT_SHARED_RING_CAPACITY, mode_t mode = DEFAULT_SHARED_RING_MODE);
+
+    /**
+     * @brief Copy-construct a new SharedRingPublisher object
+     *
+     * @param sharedRingPublisher Shared ring publisher
+     */
+    SharedRingPublisher(const SharedRingPublisher& sharedRingPublisher) = delete;
+
+    /**
+     * @brief Move-construct a new SharedRingPublisher object
+     *
+     * @param sharedRingPublisher Shared ring publisher
+     */
+    SharedRingPublisher(SharedRingPublisher&& sharedRingPublisher) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param sharedRingPublisher Shared ring publisher to copy-assign
+     * @return SharedRingPublisher& Assigned shared ring publisher
+     */
+    SharedRingPublisher& operator=(const SharedRingPublisher& sharedRingPublisher) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param sharedRingPublisher Shared ring publisher to move-assign
+     * @return SharedRingPublisher& Assigned shared ring publisher
+     */
+    SharedRingPublisher& operator=(SharedRingPublisher&& sharedRingPublisher) = delete;
+
+    /**
+     * @brief Destroy the SharedRingPublisher object and unlink the shared memory object
+     *
+     */
+    ~SharedRingPublisher() noexcept;
+
+    /**
+     * @brief Wait for the serial port data and publish all available data
+     *
+     * @param timeout Maximum time to wait for the data
+     * @return size_t Size of the published data
+     */
+    size_t pump(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Publish data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to publish
+     * @return size_t Size of the published data
+     */
+    size_t publish(const char* buffer, size_t size);
+
+    /**
+     * @brief Get the shared memory object name
+     *
+     * @return std::string Shared memory object name
+     */
+    std::string getName() const;
+
+    /**
+     * @brief Get the ring capacity
+     *
+     * @return size_t Ring capacity in bytes
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief Get the total size of the published data
+     *
+     * @return uint64_t Total size of the published data
+     */
+    uint64_t getPosition() const;
+protected:
+    /**
+     * @brief Wake up the waiting subscribers
+     *
+     */
+    void notify();
+
+    /**
+     * @brief Published serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Shared memory object name
+     *
+     */
+    std::string name;
+
+    /**
+     * @brief Ring capacity in bytes
+     *
+     */
+    size_t capacity;
+
+    /**
+     * @brief Size of the mapping
+     *
+     */
+    size_t mappingSize;
+
+    /**
+     * @brief Shared ring header
+     *
+     */
+    SharedRingHeader* header;
+
+    /**
+     * @brief Shared ring data
+     *
+     */
+    char* data;
+};
+
+/**
+ * @brief SharedRingSubscriber class
+ *
+ * Reads the data stream of a SharedRingPublisher. Reading available data
+ * only touches shared memory; a system call is made only to wait for data.
+ */
+class SharedRingSubscriber final
+{
+public:
+    /**
+     * @brief Construct a new SharedRingSubscriber object
+     *
+     * @param name Shared memory object name
+     * @throw std::runtime_error Unable to open shared memory object
+     * @throw std::runtime_error Invalid shared memory object
+     * @note Subscriber receives data published after construction
+     */
+    explicit SharedRingSubscriber(const std::string& name);
+
+    /**
+     * @brief Copy-construct a new SharedRingSubscriber object
+     *
+     * @param sharedRingSubscriber Shared ring subscriber
+     */
+    SharedRingSubscriber(const SharedRingSubscriber& sharedRingSubscriber) = delete;
+
+    /**
+     * @brief Move-construct a new SharedRingSubscriber object
+     *
+     * @param sharedRingSubscriber Shared ring subscriber
+     */
+    SharedRingSubscriber(SharedRingSubscriber&& sharedRingSubscriber) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param sharedRingSubscriber Shared ring subscriber to copy-assign
+     * @return SharedRingSubscriber& Assigned shared ring subscriber
+     */
+    SharedRingSubscriber& operator=(const SharedRingSubscriber& sharedRingSubscriber) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param sharedRingSubscriber Shared ring subscriber to move-assign
+     * @return SharedRingSubscriber& Assigned shared ring subscriber
+     */
+    SharedRingSubscriber& operator=(SharedRingSubscriber&& sharedRingSubscriber) = delete;
+
+    /**
+     * @brief Destroy the SharedRingSubscriber object
+     *
+     */
+    ~SharedRingSubscriber() noexcept;
+
+    /**
+     * @brief Read data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param timeout Maximum time to wait for the data
+     * @return size_t Size of the data actually read
+     */
+    size_t read(char* buffer, size_t size, std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+
+    /**
+     * @brief Get the size of the data available to read
+     *
+     * @return size_t Size of the available data
+     */
+    size_t getAvailable() const;
+
+    /**
+     * @brief Get the size of the data lost due to falling behind the publisher
+     *
+     * @return uint64_t Size of the lost data
+     */
+    uint64_t getLostCount() const;
+protected:
+    /**
+     * @brief Wait for the publisher to publish past the current position
+     *
+     * @param deadline Wait deadline
+     * @return true Data is available
+     * @return false Timeout expired
+     */
+    bool wait(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Ring capacity in bytes
+     *
+     */
+    size_t capacity;
+
+    /**
+     * @brief Size of the mapping
+     *
+     */
+    size_t mappingSize;
+
+    /**
+     * @brief Shared ring header
+     *
+     */
+    SharedRingHeader* header;
+
+    /**
+     * @brief Shared ring data
+     *
+     */
+    const char* data;
+
+    /**
+     * @brief Read position
+     *
+     */
+    uint64_t position;
+
+    /**
+     * @brief Size of the lost data
+     *
+     */
+    uint64_t lostCount;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,369 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <serialport/namespace.hpp>
+#include <serialport/enumerator.hpp>
+#include <serialport/serialport.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Serial port supervisor state
+ *
+ */
+enum class SupervisorState : unsigned char
+{
+    /**
+     * @brief Serial port is closed by the user or was never opened, no reconnect is attempted
+     *
+     */
+    SUPERVISOR_STATE_CLOSED = 0U,
+
+    /**
+     * @brief Serial port is open
+     *
+     */
+    SUPERVISOR_STATE_OPEN = 1U,
+
+    /**
+     * @brief Device has disappeared and the serial port is reopened once it reappears
+     *
+     */
+    SUPERVISOR_STATE_DISCONNECTED = 2U
+};
+
+/**
+ * @brief Serial port supervisor statistics
+ *
+ */
+struct SupervisorStatistics
+{
+    /**
+     * @brief Number of detected disconnects
+     *
+     */
+    unsigned long disconnectCount{0};
+
+    /**
+     * @brief Number of successful reconnects
+     *
+     */
+    unsigned long reconnectCount{0};
+
+    /**
+     * @brief Number of failed reconnect attempts
+     *
+     */
+    unsigned long failedAttemptCount{0};
+
+    /**
+     * @brief Latency of the last successful reconnect
+     *
+     */
+    std::chrono::microseconds lastReconnectLatency{0};
+
+    /**
+     * @brief Maximum latency of a successful reconnect
+     *
+     */
+    std::chrono::microseconds maxReconnectLatency{0};
+
+    /**
+     * @brief Total latency of all successful reconnects
+     *
+     */
+    std::chrono::microseconds totalReconnectLatency{0};
+};
+
+/**
+ * @brief SerialPortSupervisor class
+ *
+ * Supervises an open serial port, detects a hang-up of the underlying device
+ * (EIO, ENXIO, ENODEV or POLLHUP), closes the dead port without restoring its
+ * settings and reopens it once the device reappears with the same settings,
+ * open mode and the exclusive mode set through the supervisor.
+ *
+ * The device is located by its stable identity (USB descriptors or
+ * /dev/serial/by-id path) so a device which reappears under a different
+ * name (e.g. ttyUSB1 instead of ttyUSB0) is still matched.
+ *
+ * Only a detected disconnect is recovered from. A serial port closed with
+ * close() or never opened is left closed: reads and writes return 0 and
+ * reconnect() fails until open() is called.
+ */
+class SerialPortSupervisor final
+{
+public:
+    /**
+     * @brief Port locator function returning the current file name of the
+     *   supervised device or an empty string if the device is not present
+     *
+     */
+    typedef std::function<std::string()> PortLocator;
+
+    /**
+     * @brief Construct a new SerialPortSupervisor object
+     *
+     * @param serialPort Supervised serial port
+     */
+    explicit SerialPortSupervisor(SerialPort& serialPort);
+
+    /**
+     * @brief Construct a new SerialPortSupervisor object
+     *
+     * @param serialPort Supervised serial port
+     * @param portLocator Port locator function
+     */
+    explicit SerialPortSupervisor(SerialPort& serialPort, PortLocator portLocator);
+
+    /**
+     * @brief Copy-construct a new SerialPortSupervisor object
+     *
+     * @param serialPortSupervisor Serial port supervisor
+     */
+    SerialPortSupervisor(const SerialPortSupervisor& serialPortSupervisor) = delete;
+
+    /**
+     * @brief Move-construct a new SerialPortSupervisor object
+     *
+     * @param serialPortSupervisor Serial port supervisor
+     */
+    SerialPortSupervisor(SerialPortSupervisor&& serialPortSupervisor) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param serialPortSupervisor Serial port supervisor to copy-assign
+     * @return SerialPortSupervisor& Assigned serial port supervisor
+     */
+    SerialPortSupervisor& operator=(const SerialPortSupervisor& serialPortSupervisor) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param serialPortSupervisor Serial port supervisor to move-assign
+     * @return SerialPortSupervisor& Assigned serial port supervisor
+     */
+    SerialPortSupervisor& operator=(SerialPortSupervisor&& serialPortSupervisor) = delete;
+
+    /**
+     * @brief Destroy the SerialPortSupervisor object
+     *
+     */
+    ~SerialPortSupervisor() noexcept = default;
+
+    /**
+     * @brief Open the supervised serial port and capture its identity
+     *
+     * @param openMode Serial port open mode
+     * @throw std::runtime_error Unsupported open mode
+     * @throw std::runtime_error Unable to open serial port
+     * @throw std::runtime_error Unable to get port settings
+     * @throw std::runtime_error Unable to set exclusive mode
+     */
+    void open(std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
+
+    /**
+     * @brief Close the supervised serial port
+     *
+     * @throw std::runtime_error Unable to set port settings
+     */
+    void close();
+
+    /**
+     * @brief Get the connection status
+     *
+     * @return true Serial port is connected
+     * @return false Serial port is disconnected or closed
+     */
+    bool isConnected() const;
+
+    /**
+     * @brief Get the supervisor state
+     *
+     * @return SupervisorState Supervisor state
+     */
+    SupervisorState getState() const;
+
+    /**
+     * @brief Set the exclusive mode of the serial port, reapplied on every open and reconnect
+     *
+     * @param exclusive Exclusive mode
+     * @return true Exclusive mode is applied or stored for the next open or reconnect
+     * @return false Failed to change the exclusive mode of the connected serial port
+     */
+    bool setExclusive(bool exclusive);
+
+    /**
+     * @brief Check the connection status of the serial port for a hang-up
+     *
+     * @return true Serial port is connected
+     * @return false Serial port is disconnected or closed
+     */
+    bool checkConnection();
+
+    /**
+     * @brief Read data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @return size_t Size of the data actually read, 0 on a closed port
+     * @note A single reconnect attempt is made on a disconnected port
+     */
+    size_t read(char* buffer, size_t size);
+
+    /**
+     * @brief Write data
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @return size_t Size of the data actually written, 0 on a closed port
+     * @note A single reconnect attempt is made on a disconnected port
+     */
+    size_t write(const char* buffer, size_t size);
+
+    /**
+     * @brief Wait for the device to reappear and reopen the serial port
+     *
+     * @param timeout Maximum time to wait for the device
+     * @return true Serial port is connected
+     * @return false Device did not reappear within the timeout or serial port is closed
+     */
+    bool reconnect(std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+
+    /**
+     * @brief Get the retry interval
+     *
+     * @return std::chrono::milliseconds Interval between reconnect attempts
+     */
+    std::chrono::milliseconds getRetryInterval() const;
+
+    /**
+     * @brief Set the retry interval
+     *
+     * @param retryInterval Interval between reconnect attempts
+     */
+    void setRetryInterval(std::chrono::milliseconds retryInterval);
+
+    /**
+     * @brief Get the identity of the supervised device
+     *
+     * @return const PortInfo& Serial port information captured on open
+     */
+    const PortInfo& getIdentity() const;
+
+    /**
+     * @brief Get the supervisor statistics
+     *
+     * @return SupervisorStatistics Supervisor statistics
+     */
+    SupervisorStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Handle a failed or empty read/write system call
+     *
+     * @param result Result of the system call
+     * @param size Requested size
+     */
+    void handleResult(size_t result, size_t size);
+
+    /**
+     * @brief Mark the serial port as disconnected and close it
+     *
+     */
+    void disconnect();
+
+    /**
+     * @brief Attempt to reopen the serial port once
+     *
+     * @return true Serial port is connected
+     * @return false Serial port could not be reopened
+     */
+    bool attemptReconnect();
+
+    /**
+     * @brief Locate the supervised device by its stable identity
+     *
+     * @return std::string Current file name of the device or an empty string
+     */
+    std::string locatePort() const;
+
+    /**
+     * @brief Supervised serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Port locator function
+     *
+     */
+    PortLocator portLocator;
+
+    /**
+     * @brief Identity of the supervised device
+     *
+     */
+    PortInfo identity;
+
+    /**
+     * @brief Serial port open mode
+     *
+     */
+    std::ios_base::openmode openMode;
+
+    /**
+     * @brief Exclusive mode of the serial port
+     *
+     */
+    bool exclusive;
+
+    /**
+     * @brief Supervisor state
+     *
+     */
+    SupervisorState state;
+
+    /**
+     * @brief Interval between reconnect attempts
+     *
+     */
+    std::chrono::milliseconds retryInterval;
+
+    /**
+     * @brief Time of the last detected disconnect
+     *
+     */
+    std::chrono::steady_clock::time_point disconnectTime;
+
+    /**
+     * @brief Supervisor statistics
+     *
+     */
+    SupervisorStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,244 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/timer_wheel.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Timer dispatcher statistics
+ *
+ */
+struct TimerDispatcherStatistics
+{
+    /**
+     * @brief Number of armed timers
+     *
+     */
+    uint64_t armCount{0};
+
+    /**
+     * @brief Number of expired timers
+     *
+     */
+    uint64_t expiredCount{0};
+
+    /**
+     * @brief Number of dispatch calls
+     *
+     */
+    uint64_t dispatchCount{0};
+
+    /**
+     * @brief Number of timerfd reprograms
+     *
+     */
+    uint64_t programCount{0};
+};
+
+/**
+ * @brief TimerDispatcher class
+ *
+ * Drives a hierarchical timer wheel holding the read, inter-byte and
+ * transaction timeouts of any number of serial ports with a single timerfd,
+ * which is polled together with the serial ports (see PortRegistry::poll).
+ *
+ * The timerfd is programmed for the earliest expiry and is only reprogrammed
+ * when a newly armed timer is due earlier. Re-arming a timeout which moves
+ * it later (e.g. an inter-byte timeout restarted on every received byte)
+ * therefore costs an O(1) wheel update without a system call, a timeout
+ * passed by in the meantime is found stale on the next dispatch.
+ */
+class TimerDispatcher final
+{
+public:
+    /**
+     * @brief Expiry handler called with the timer identifier and user data of each expired timer,
+     *   may arm and cancel timers
+     *
+     */
+    typedef std::function<void(TimerId timerId, uint64_t data)> ExpiryHandler;
+
+    /**
+     * @brief Construct a new TimerDispatcher object
+     *
+     * @param expiryHandler Expiry handler
+     * @param resolution Duration of a single tick
+     * @param slotCount Number of slots of each level
+     * @param levelCount Number of levels
+     * @throw std::out_of_range Invalid resolution, slot count or level count
+     * @throw std::runtime_error Unable to create timer
+     */
+    explicit TimerDispatcher(ExpiryHandler expiryHandler, std::chrono::microseconds resolution = DEFAULT_TIMER_RESOLUTION,
+        size_t slotCount = DEFAULT_TIMER_SLOT_COUNT, size_t levelCount = DEFAULT_TIMER_LEVEL_COUNT);
+
+    /**
+     * @brief Copy-construct a new TimerDispatcher object
+     *
+     * @param timerDispatcher Timer dispatcher
+     */
+    TimerDispatcher(const TimerDispatcher& timerDispatcher) = delete;
+
+    /**
+     * @brief Move-construct a new TimerDispatcher object
+     *
+     * @param timerDispatcher Timer dispatcher
+     */
+    TimerDispatcher(TimerDispatcher&& timerDispatcher) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param timerDispatcher Timer dispatcher to copy-assign
+     * @return TimerDispatcher& Assigned timer dispatcher
+     */
+    TimerDispatcher& operator=(const TimerDispatcher& timerDispatcher) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param timerDispatcher Timer dispatcher to move-assign
+     * @return TimerDispatcher& Assigned timer dispatcher
+     */
+    TimerDispatcher& operator=(TimerDispatcher&& timerDispatcher) = delete;
+
+    /**
+     * @brief Destroy the TimerDispatcher object
+     *
+     */
+    ~TimerDispatcher() noexcept;
+
+    /**
+     * @brief Get the native handle of the timerfd, readable when timers are due
+     *
+     * @return NativeHandle Native handle
+     */
+    NativeHandle getNativeHandle() const;
+
+    /**
+     * @brief Arm a timer
+     *
+     * @param deadline Expiry time
+     * @param data User data passed to the expiry handler
+     * @return TimerId Timer identifier
+     * @throw std::runtime_error Unable to set timer
+     */
+    TimerId arm(std::chrono::steady_clock::time_point deadline, uint64_t data);
+
+    /**
+     * @brief Arm a timer
+     *
+     * @param timeout Time from now to the expiry
+     * @param data User data passed to the expiry handler
+     * @return TimerId Timer identifier
+     * @throw std::runtime_error Unable to set timer
+     */
+    TimerId arm(std::chrono::microseconds timeout, uint64_t data);
+
+    /**
+     * @brief Cancel a timer, if still armed, and arm it again
+     *
+     * @param timerId Timer identifier, may be INVALID_TIMER_ID
+     * @param timeout Time from now to the expiry
+     * @param data User data passed to the expiry handler
+     * @return TimerId Timer identifier of the re-armed timer
+     * @throw std::runtime_error Unable to set timer
+     */
+    TimerId rearm(TimerId timerId, std::chrono::microseconds timeout, uint64_t data);
+
+    /**
+     * @brief Cancel a timer
+     *
+     * @param timerId Timer identifier
+     * @return true Timer cancelled
+     * @return false Timer already expired or cancelled
+     */
+    bool cancel(TimerId timerId);
+
+    /**
+     * @brief Expire all due timers and reprogram the timerfd, called when the timerfd is readable
+     *
+     * @return size_t Number of expired timers
+     * @throw std::runtime_error Unable to set timer
+     */
+    size_t dispatch();
+
+    /**
+     * @brief Get the number of armed timers
+     *
+     * @return size_t Number of armed timers
+     */
+    size_t getActiveCount() const;
+
+    /**
+     * @brief Get the timer dispatcher statistics
+     *
+     * @return TimerDispatcherStatistics Timer dispatcher statistics
+     */
+    TimerDispatcherStatistics getStatistics() const;
+protected:
+    /**
+     * @brief Program the timerfd for an expiry time
+     *
+     * @param expiry Expiry time or time_point::max() to disarm
+     * @throw std::runtime_error Unable to set timer
+     */
+    void program(std::chrono::steady_clock::time_point expiry);
+
+    /**
+     * @brief Timer wheel
+     *
+     */
+    TimerWheel wheel;
+
+    /**
+     * @brief Expiry handler
+     *
+     */
+    ExpiryHandler expiryHandler;
+
+    /**
+     * @brief Timer file descriptor
+     *
+     */
+    int timer;
+
+    /**
+     * @brief Expiry time the timerfd is programmed for
+     *
+     */
+    std::chrono::steady_clock::time_point programmedExpiry;
+
+    /**
+     * @brief Timer dispatcher statistics
+     *
+     */
+    TimerDispatcherStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,575 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/timer_wheel.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default number of transactions in flight
+ *
+ */
+static constexpr size_t DEFAULT_TRANSACTION_WINDOW{8};
+
+/**
+ * @brief Default size of the transaction receive buffer
+ *
+ */
+static constexpr size_t DEFAULT_TRANSACTION_BUFFER_SIZE{4096};
+
+/**
+ * @brief Transaction completion status
+ *
+ */
+enum class TransactionStatus : unsigned char
+{
+    /**
+     * @brief Matching response received
+     *
+     */
+    TRANSACTION_COMPLETED = 0U,
+
+    /**
+     * @brief No matching response received after all retries
+     *
+     */
+    TRANSACTION_TIMEOUT = 1U,
+
+    /**
+     * @brief Transaction cancelled before completion
+     *
+     */
+    TRANSACTION_CANCELLED = 2U,
+
+    /**
+     * @brief Serial port hung up or failed
+     *
+     */
+    TRANSACTION_IO_ERROR = 3U,
+};
+
+/**
+ * @brief Transaction manager statistics
+ *
+ */
+struct TransactionStatistics
+{
+    /**
+     * @brief Number of submitted transactions
+     *
+     */
+    uint64_t submittedCount{0};
+
+    /**
+     * @brief Number of transactions completed with a matching response
+     *
+     */
+    uint64_t completedCount{0};
+
+    /**
+     * @brief Number of transactions which timed out after all retries
+     *
+     */
+    uint64_t timeoutCount{0};
+
+    /**
+     * @brief Number of retransmitted requests
+     *
+     */
+    uint64_t retryCount{0};
+
+    /**
+     * @brief Number of cancelled transactions
+     *
+     */
+    uint64_t cancelledCount{0};
+
+    /**
+     * @brief Number of transactions failed by a hang-up or an I/O error of the serial port
+     *
+     */
+    uint64_t failedCount{0};
+
+    /**
+     * @brief Number of responses not matching a transaction in flight
+     *
+     */
+    uint64_t unmatchedCount{0};
+
+    /**
+     * @brief Size of the received data discarded because no response could be extracted
+     *
+     */
+    uint64_t discardedCount{0};
+
+    /**
+     * @brief Size of the transmitted data
+     *
+     */
+    uint64_t transmittedCount{0};
+
+    /**
+     * @brief Size of the received data
+     *
+     */
+    uint64_t receivedCount{0};
+
+    /**
+     * @brief Maximum number of transactions in flight
+     *
+     */
+    size_t maxInFlightCount{0};
+
+    /**
+     * @brief Maximum round-trip time of a completed transaction
+     *
+     */
+    std::chrono::microseconds maxRoundTripTime{0};
+
+    /**
+     * @brief Total round-trip time of all completed transactions
+     *
+     */
+    std::chrono::microseconds totalRoundTripTime{0};
+};
+
+/**
+ * @brief TransactionManager class
+ *
+ * Pipelines request/response transactions on an open serial port. Up to a
+ * window of requests are in flight at once, responses are extracted from
+ * the received stream and matched to their requests by correlation keys
+ * obtained from user supplied correlators, so responses may arrive in any
+ * order. Deadlines are kept in a timer wheel, an expired request is
+ * retransmitted until its retries are exhausted. A request which can not be
+ * written within its wire time and timeout times out as well. A hang-up or an
+ * I/O error of the serial port fails all transactions and ends the event loop.
+ *
+ * A request whose key equals the key of a request in flight is held back
+ * until that request completes. All members but stop() must be called from
+ * the thread running the event loop; completions are called from it.
+ */
+class TransactionManager final
+{
+public:
+    /**
+     * @brief Request correlator returning the correlation key of a request
+     *
+     */
+    typedef std::function<uint64_t(std::string_view request)> RequestCorrelator;
+
+    /**
+     * @brief Response correlator returning the size of the complete response at
+     *   the start of the received data and its correlation key, or 0 if more data is needed
+     *
+     */
+    typedef std::function<size_t(std::string_view data, uint64_t& key)> ResponseCorrelator;
+
+    /**
+     * @brief Completion function called with the status and the response, which
+     *   is only valid during the call
+     *
+     */
+    typedef std::function<void(TransactionStatus status, std::string_view response)> Completion;
+
+    /**
+     * @brief Construct a new TransactionManager object
+     *
+     * @param serialPort Open serial port
+     * @param requestCorrelator Request correlator
+     * @param responseCorrelator Response correlator
+     * @param window Maximum number of transactions in flight
+     * @param bufferSize Size of the receive buffer, at least the size of the largest response
+     * @throw std::runtime_error Serial port is not open
+     * @throw std::runtime_error Unable to create event
+     * @throw std::out_of_range Invalid window or buffer size
+     */
+    explicit TransactionManager(SerialPort& serialPort, RequestCorrelator requestCorrelator,
+        ResponseCorrelator responseCorrelator, size_t window = DEFAULT_TRANSACTION_WINDOW,
+        size_t bufferSize = DEFAULT_TRANSACTION_BUFFER_SIZE);
+
+    /**
+     * @brief Copy-construct a new TransactionManager object
+     *
+     * @param transactionManager Transaction manager
+     */
+    TransactionManager(const TransactionManager& transactionManager) = delete;
+
+    /**
+     * @brief Move-construct a new TransactionManager object
+     *
+     * @param transactionManager Transaction manager
+     */
+    TransactionManager(TransactionManager&& transactionManager) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param transactionManager Transaction manager to copy-assign
+     * @return TransactionManager& Assigned transaction manager
+     */
+    TransactionManager& operator=(const TransactionManager& transactionManager) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param transactionManager Transaction manager to move-assign
+     * @return TransactionManager& Assigned transaction manager
+     */
+    TransactionManager& operator=(TransactionManager&& transactionManager) = delete;
+
+    /**
+     * @brief Destroy the TransactionManager object
+     *
+     */
+    ~TransactionManager() noexcept;
+
+    /**
+     * @brief Queue a transaction
+     *
+     * @param request Request
+     * @param completion Completion function
+     * @param timeout Maximum time to wait for the response after the request left the wire
+     * @param retryCount Number of retransmissions after a timeout
+     * @note Completes immediately with TRANSACTION_IO_ERROR once the serial port failed
+     */
+    void submit(std::string request, Completion completion, std::chrono::milliseconds timeout, unsigned retryCount = 0);
+
+    /**
+     * @brief Process pending events once
+     *
+     * @param timeout Maximum time to wait for an event
+     * @return size_t Number of finished transactions
+     */
+    size_t poll(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Process events until stopped or the serial port fails
+     *
+     */
+    void run();
+
+    /**
+     * @brief Stop the event loop
+     *
+     * @note May be called from another thread
+     */
+    void stop();
+
+    /**
+     * @brief Cancel all queued transactions and transactions in flight
+     *
+     */
+    void cancelAll();
+
+    /**
+     * @brief Get the failed status
+     *
+     * @return true Serial port hung up or failed, no more transactions are processed
+     * @return false Serial port is operational
+     */
+    bool isFailed() const;
+
+    /**
+     * @brief Get the number of transactions in flight
+     *
+     * @return size_t Number of transactions in flight
+     */
+    size_t getInFlightCount() const;
+
+    /**
+     * @brief Get the number of queued transactions
+     *
+     * @return size_t Number of transactions waiting to be transmitted
+     */
+    size_t getQueuedCount() const;
+
+    /**
+     * @brief Get the window
+     *
+     * @return size_t Maximum number of transactions in flight
+     */
+    size_t getWindow() const;
+
+    /**
+     * @brief Set the window
+     *
+     * @param window Maximum number of transactions in flight
+     * @throw std::out_of_range Invalid window
+     */
+    void setWindow(size_t window);
+
+    /**
+     * @brief Get the transaction statistics
+     *
+     * @return TransactionStatistics Transaction statistics
+     */
+    TransactionStatistics getStatistics() const;
+
+    /**
+     * @brief Get the transmit utilisation of the line
+     *
+     * @return double Transmitted data relative to the capacity of the line at the
+     *   current baud rate since the statistics were reset
+     */
+    double getTransmitUtilisation() const;
+
+    /**
+     * @brief Get the receive utilisation of the line
+     *
+     * @return double Received data relative to the capacity of the line at the
+     *   current baud rate since the statistics were reset
+     */
+    double getReceiveUtilisation() const;
+
+    /**
+     * @brief Reset the statistics and the utilisation measurement
+     *
+     * @throw std::out_of_range Baud rate is out of range
+     */
+    void resetStatistics();
+protected:
+    /**
+     * @brief Invalid transaction index
+     *
+     */
+    static constexpr size_t INVALID_INDEX{SIZE_MAX};
+
+    /**
+     * @brief Transaction slab entry
+     *
+     */
+    struct Transaction
+    {
+        /**
+         * @brief Request
+         *
+         */
+        std::string request;
+
+        /**
+         * @brief Completion function
+         *
+         */
+        Completion completion;
+
+        /**
+         * @brief Response timeout
+         *
+         */
+        std::chrono::milliseconds timeout;
+
+        /**
+         * @brief Remaining retransmissions
+         *
+         */
+        unsigned retryCount;
+
+        /**
+         * @brief Correlation key
+         *
+         */
+        uint64_t key;
+
+        /**
+         * @brief Deadline timer
+         *
+         */
+        TimerId timer;
+
+        /**
+         * @brief Time the request was transmitted
+         *
+         */
+        std::chrono::steady_clock::time_point transmitTime;
+    };
+
+    /**
+     * @brief Transmit queued requests while the window allows
+     *
+     */
+    void transmit();
+
+    /**
+     * @brief Read and match responses
+     *
+     * @return size_t Number of completed transactions
+     */
+    size_t receive();
+
+    /**
+     * @brief Handle an expired deadline
+     *
+     * @param index Transaction index
+     * @return size_t Number of finished transactions
+     */
+    size_t expire(size_t index);
+
+    /**
+     * @brief Finish a transaction and call its completion
+     *
+     * @param index Transaction index
+     * @param status Completion status
+     * @param response Response
+     */
+    void finish(size_t index, TransactionStatus status, std::string_view response);
+
+    /**
+     * @brief Finish all queued transactions and transactions in flight
+     *
+     * @param status Completion status
+     */
+    void finishAll(TransactionStatus status);
+
+    /**
+     * @brief Fail all transactions after a hang-up or an I/O error
+     *
+     */
+    void fail();
+
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Request correlator
+     *
+     */
+    RequestCorrelator requestCorrelator;
+
+    /**
+     * @brief Response correlator
+     *
+     */
+    ResponseCorrelator responseCorrelator;
+
+    /**
+     * @brief Maximum number of transactions in flight
+     *
+     */
+    size_t window;
+
+    /**
+     * @brief Stop event file descriptor
+     *
+     */
+    int stopEvent;
+
+    /**
+     * @brief Event loop stop request
+     *
+     */
+    bool stopped;
+
+    /**
+     * @brief Serial port hung up or failed
+     *
+     */
+    bool failed;
+
+    /**
+     * @brief Transaction slab
+     *
+     */
+    std::vector<Transaction> transactions;
+
+    /**
+     * @brief Free transaction indices
+     *
+     */
+    std::vector<size_t> freeTransactions;
+
+    /**
+     * @brief Queued transaction indices
+     *
+     */
+    std::deque<size_t> queue;
+
+    /**
+     * @brief Transactions in flight by correlation key
+     *
+     */
+    std::unordered_map<uint64_t, size_t> inFlight;
+
+    /**
+     * @brief Transaction being transmitted
+     *
+     */
+    size_t transmitIndex;
+
+    /**
+     * @brief Size of the transmitted part of the request
+     *
+     */
+    size_t transmitOffset;
+
+    /**
+     * @brief Deadline timers
+     *
+     */
+    TimerWheel timers;
+
+    /**
+     * @brief Receive buffer
+     *
+     */
+    std::vector<char> buffer;
+
+    /**
+     * @brief End of the received data
+     *
+     */
+    size_t bufferEnd;
+
+    /**
+     * @brief Transmit time of a single byte in milli-seconds
+     *
+     */
+    double byteTime;
+
+    /**
+     * @brief Start of the utilisation measurement
+     *
+     */
+    std::chrono::steady_clock::time_point statisticsTime;
+
+    /**
+     * @brief Transaction statistics
+     *
+     */
+    TransactionStatistics statistics;
+};
+
+END_NAMESPACE_LIBSERIAL
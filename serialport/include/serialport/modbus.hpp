@@ -0,0 +1,454 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Modbus broadcast unit address
+ *
+ */
+constexpr uint8_t MODBUS_BROADCAST_ADDRESS{0U};
+
+/**
+ * @brief Maximum unit address of a Modbus server
+ *
+ */
+constexpr uint8_t MODBUS_MAX_UNIT_ADDRESS{247U};
+
+/**
+ * @brief Maximum size of a Modbus RTU frame (address, PDU and CRC)
+ *
+ */
+constexpr size_t MODBUS_MAX_FRAME_SIZE{256};
+
+/**
+ * @brief Minimum size of a Modbus RTU frame (address, function code and CRC)
+ *
+ */
+constexpr size_t MODBUS_MIN_FRAME_SIZE{4};
+
+/**
+ * @brief Maximum size of a Modbus PDU (function code and data)
+ *
+ */
+constexpr size_t MODBUS_MAX_PDU_SIZE{253};
+
+/**
+ * @brief Maximum number of coils or discrete inputs read by a single request
+ *
+ */
+constexpr uint16_t MODBUS_MAX_READ_BITS{2000U};
+
+/**
+ * @brief Maximum number of coils written by a single request
+ *
+ */
+constexpr uint16_t MODBUS_MAX_WRITE_BITS{1968U};
+
+/**
+ * @brief Maximum number of registers read by a single request
+ *
+ */
+constexpr uint16_t MODBUS_MAX_READ_REGISTERS{125U};
+
+/**
+ * @brief Maximum number of registers written by a single request
+ *
+ */
+constexpr uint16_t MODBUS_MAX_WRITE_REGISTERS{123U};
+
+/**
+ * @brief Maximum number of registers written by a read/write multiple registers request
+ *
+ */
+constexpr uint16_t MODBUS_MAX_READ_WRITE_REGISTERS{121U};
+
+/**
+ * @brief Maximum number of registers in a FIFO queue
+ *
+ */
+constexpr uint16_t MODBUS_MAX_FIFO_COUNT{31U};
+
+/**
+ * @brief Modbus exception flag of the response function code
+ *
+ */
+constexpr uint8_t MODBUS_EXCEPTION_FLAG{0x80U};
+
+/**
+ * @brief Modbus function code
+ *
+ */
+enum class ModbusFunction : unsigned char
+{
+    /**
+     * @brief Read coils
+     *
+     */
+    MODBUS_READ_COILS = 0x01U,
+
+    /**
+     * @brief Read discrete inputs
+     *
+     */
+    MODBUS_READ_DISCRETE_INPUTS = 0x02U,
+
+    /**
+     * @brief Read holding registers
+     *
+     */
+    MODBUS_READ_HOLDING_REGISTERS = 0x03U,
+
+    /**
+     * @brief Read input registers
+     *
+     */
+    MODBUS_READ_INPUT_REGISTERS = 0x04U,
+
+    /**
+     * @brief Write single coil
+     *
+     */
+    MODBUS_WRITE_SINGLE_COIL = 0x05U,
+
+    /**
+     * @brief Write single register
+     *
+     */
+    MODBUS_WRITE_SINGLE_REGISTER = 0x06U,
+
+    /**
+     * @brief Read exception status (serial line only)
+     *
+     */
+    MODBUS_READ_EXCEPTION_STATUS = 0x07U,
+
+    /**
+     * @brief Diagnostics (serial line only)
+     *
+     */
+    MODBUS_DIAGNOSTICS = 0x08U,
+
+    /**
+     * @brief Get communication event counter (serial line only)
+     *
+     */
+    MODBUS_GET_COMM_EVENT_COUNTER = 0x0BU,
+
+    /**
+     * @brief Get communication event log (serial line only)
+     *
+     */
+    MODBUS_GET_COMM_EVENT_LOG = 0x0CU,
+
+    /**
+     * @brief Write multiple coils
+     *
+     */
+    MODBUS_WRITE_MULTIPLE_COILS = 0x0FU,
+
+    /**
+     * @brief Write multiple registers
+     *
+     */
+    MODBUS_WRITE_MULTIPLE_REGISTERS = 0x10U,
+
+    /**
+     * @brief Report server identifier (serial line only)
+     *
+     */
+    MODBUS_REPORT_SERVER_ID = 0x11U,
+
+    /**
+     * @brief Read file record
+     *
+     */
+    MODBUS_READ_FILE_RECORD = 0x14U,
+
+    /**
+     * @brief Write file record
+     *
+     */
+    MODBUS_WRITE_FILE_RECORD = 0x15U,
+
+    /**
+     * @brief Mask write register
+     *
+     */
+    MODBUS_MASK_WRITE_REGISTER = 0x16U,
+
+    /**
+     * @brief Read/write multiple registers
+     *
+     */
+    MODBUS_READ_WRITE_MULTIPLE_REGISTERS = 0x17U,
+
+    /**
+     * @brief Read FIFO queue
+     *
+     */
+    MODBUS_READ_FIFO_QUEUE = 0x18U,
+
+    /**
+     * @brief Encapsulated interface transport (e.g. read device identification)
+     *
+     */
+    MODBUS_ENCAPSULATED_INTERFACE_TRANSPORT = 0x2BU,
+};
+
+/**
+ * @brief Modbus exception code
+ *
+ */
+enum class ModbusException : unsigned char
+{
+    /**
+     * @brief No exception
+     *
+     */
+    MODBUS_EXCEPTION_NONE = 0x00U,
+
+    /**
+     * @brief Function code is not supported
+     *
+     */
+    MODBUS_ILLEGAL_FUNCTION = 0x01U,
+
+    /**
+     * @brief Data address is not valid
+     *
+     */
+    MODBUS_ILLEGAL_DATA_ADDRESS = 0x02U,
+
+    /**
+     * @brief Data value is not valid
+     *
+     */
+    MODBUS_ILLEGAL_DATA_VALUE = 0x03U,
+
+    /**
+     * @brief Unrecoverable error on the server
+     *
+     */
+    MODBUS_SERVER_DEVICE_FAILURE = 0x04U,
+
+    /**
+     * @brief Request accepted but requires a long time to process
+     *
+     */
+    MODBUS_ACKNOWLEDGE = 0x05U,
+
+    /**
+     * @brief Server is busy processing a long-duration request
+     *
+     */
+    MODBUS_SERVER_DEVICE_BUSY = 0x06U,
+
+    /**
+     * @brief Memory parity error in a file record
+     *
+     */
+    MODBUS_MEMORY_PARITY_ERROR = 0x08U,
+
+    /**
+     * @brief Gateway path is not available
+     *
+     */
+    MODBUS_GATEWAY_PATH_UNAVAILABLE = 0x0AU,
+
+    /**
+     * @brief Gateway target device failed to respond
+     *
+     */
+    MODBUS_GATEWAY_TARGET_FAILED = 0x0BU,
+};
+
+/**
+ * @brief Modbus transaction status
+ *
+ */
+enum class ModbusStatus : unsigned char
+{
+    /**
+     * @brief Transaction succeeded
+     *
+     */
+    MODBUS_SUCCESS = 0U,
+
+    /**
+     * @brief No response within the response timeout
+     *
+     */
+    MODBUS_TIMEOUT = 1U,
+
+    /**
+     * @brief Received frame failed the CRC check
+     *
+     */
+    MODBUS_CRC_ERROR = 2U,
+
+    /**
+     * @brief Received frame is malformed or does not match the request
+     *
+     */
+    MODBUS_INVALID_FRAME = 3U,
+
+    /**
+     * @brief Server responded with an exception
+     *
+     */
+    MODBUS_EXCEPTION = 4U,
+
+    /**
+     * @brief Request is malformed or exceeds the protocol limits
+     *
+     */
+    MODBUS_INVALID_REQUEST = 5U,
+
+    /**
+     * @brief Unable to transmit or receive a frame
+     *
+     */
+    MODBUS_IO_ERROR = 6U,
+};
+
+/**
+ * @brief Modbus RTU timing of a serial line
+ *
+ */
+struct ModbusTiming
+{
+    /**
+     * @brief Transmit time of a single character
+     *
+     */
+    std::chrono::microseconds characterTime{0};
+
+    /**
+     * @brief Maximum silence between characters of a frame (t1.5)
+     *
+     */
+    std::chrono::microseconds interCharacterTimeout{0};
+
+    /**
+     * @brief Minimum silence between frames (t3.5)
+     *
+     */
+    std::chrono::microseconds interFrameDelay{0};
+};
+
+/**
+ * @brief Calculate the Modbus RTU timing of a serial line
+ *
+ * @param baudRate Baud rate
+ * @param characterSize Character size
+ * @param parity Parity
+ * @param stopBit Stop bit
+ * @return ModbusTiming Modbus RTU timing
+ * @throw std::out_of_range Baud rate is out of range
+ * @note Above 19200 baud the fixed values of 750us (t1.5) and 1750us (t3.5)
+ *   recommended by the Modbus serial line specification are used
+ */
+ModbusTiming calculateModbusTiming(BaudRate baudRate,
+    CharacterSize characterSize = CharacterSize::CHARACTER_SIZE_DEFAULT,
+    Parity parity = Parity::PARITY_TYPE_DEFAULT,
+    StopBit stopBit = StopBit::STOP_BIT_DEFAULT);
+
+/**
+ * @brief Get the size of a Modbus RTU frame from its leading bytes
+ *
+ * @param frame Received part of the frame
+ * @param size Size of the received part
+ * @param request Frame is a request (true) or a response (false)
+ * @return size_t Size of the complete frame including the CRC, 0 if more bytes are
+ *   needed to determine it or size_t(-1) if the size is only known from the
+ *   inter-frame delay
+ */
+size_t getModbusFrameSize(const char* frame, size_t size, bool request);
+
+/**
+ * @brief Append the Modbus CRC to a frame
+ *
+ * @param frame Frame with two bytes of space after its end
+ * @param size Size of the frame without the CRC
+ * @return size_t Size of the frame including the CRC
+ */
+size_t appendModbusCrc(char* frame, size_t size);
+
+/**
+ * @brief Check the Modbus CRC of a frame
+ *
+ * @param frame Frame
+ * @param size Size of the frame including the CRC
+ * @return true CRC is valid
+ * @return false CRC is invalid or the frame is too short
+ */
+bool checkModbusCrc(const char* frame, size_t size);
+
+/**
+ * @brief Pack coil or discrete input values into Modbus bit order
+ *
+ * @param values Values
+ * @param count Number of values
+ * @param data Packed data of (count + 7) / 8 bytes, first value in the least significant bit
+ */
+void packModbusBits(const bool* values, size_t count, char* data);
+
+/**
+ * @brief Unpack coil or discrete input values from Modbus bit order
+ *
+ * @param data Packed data
+ * @param count Number of values
+ * @param values Values
+ */
+void unpackModbusBits(const char* data, size_t count, bool* values);
+
+/**
+ * @brief Read a big-endian 16-bit value of a Modbus frame
+ *
+ * @param data Data
+ * @return uint16_t Value
+ */
+inline uint16_t readModbusValue(const char* data)
+{
+    return static_cast<uint16_t>((static_cast<uint8_t>(data[0]) << 8) | static_cast<uint8_t>(data[1]));
+}
+
+/**
+ * @brief Write a big-endian 16-bit value of a Modbus frame
+ *
+ * @param data Data
+ * @param value Value
+ */
+inline void writeModbusValue(char* data, uint16_t value)
+{
+    data[0] = static_cast<char>(value >> 8);
+    data[1] = static_cast<char>(value & 0xFFU);
+}
+
+END_NAMESPACE_LIBSERIAL
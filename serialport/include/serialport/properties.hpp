@@ -20,7 +20,9 @@
 */
 
 #pragma once
-
+#include <cstddef>
+#include <string>
+#include <string_view>
 #include <serialport/namespace.hpp>
 #if defined(__linux__)
     #include <serialport/linux/properties.hpp>
@@ -513,10 +515,19 @@ int getBaudRateValue(BaudRate baudRate);
  * @brief Get the baud rate number
  *
  * @param baudRate Baud rate
+ * @throw std::out_of_range Baud rate is out of range
  * @return unsigned long Baud rate number
  */
 unsigned long getBaudRate(BaudRate baudRate);
 
+/**
+ * @brief Find the baud rate of a baud rate number
+ *
+ * @param baudRate Baud rate number
+ * @return BaudRate Baud rate or BaudRate::BAUD_RATE_CUSTOM if the number has no baud rate
+ */
+BaudRate findBaudRate(unsigned long baudRate) noexcept;
+
 /**
  * @brief Character size
  *
@@ -633,6 +644,15 @@ bool isFlowControlSupported(FlowControl flowControl);
  */
 std::string getFlowControlName(FlowControl flowControl);
 
+/**
+ * @brief Get the flow control name without allocating
+ *
+ * @param flowControl Flow control
+ * @throw std::out_of_range Unsupported or out-of-range flow control
+ * @return std::string_view Name of static storage duration
+ */
+std::string_view getFlowControlNameView(FlowControl flowControl);
+
 /**
  * @brief Parity
  *
@@ -697,6 +717,15 @@ bool isParitySupported(Parity parity);
  */
 std::string getParityName(Parity parity);
 
+/**
+ * @brief Get the parity name without allocating
+ *
+ * @param parity Parity
+ * @throw std::out_of_range Unsupported or out-of-range parity
+ * @return std::string_view Name of static storage duration
+ */
+std::string_view getParityNameView(Parity parity);
+
 /**
  * @brief Stop bit
  *
@@ -747,6 +776,15 @@ bool isStopBitSupported(StopBit stopBit);
  */
 std::string getStopBitName(StopBit stopBit);
 
+/**
+ * @brief Get the stop bit name without allocating
+ *
+ * @param stopBit Stop bit
+ * @throw std::out_of_range Unsupported or out-of-range stop bit
+ * @return std::string_view Name of static storage duration
+ */
+std::string_view getStopBitNameView(StopBit stopBit);
+
 /**
  * @brief Control line
  *
@@ -823,6 +861,77 @@ double calculateTime(BaudRate baudRate,
     Parity parity = Parity::PARITY_TYPE_DEFAULT,
     StopBit stopBit = StopBit::STOP_BIT_DEFAULT);
 
+/**
+ * @brief Maximum size of a formatted link specification including the
+ *   terminating null character
+ *
+ */
+static constexpr size_t MAX_LINK_SPEC_SIZE{22};
+
+/**
+ * @brief Link specification
+ *
+ * Serial line parameters written as "<baud rate>[,<frame>[,<flow control>]]",
+ * e.g. "921600,8E1,rtscts" or "115200-8N1". Fields are separated by a comma or
+ * a dash. The frame is the character size (5 to 8), the parity (N, O, E, M or
+ * S) and the stop bits (1, 1.5 or 2). The flow control is none, rtscts or
+ * xonxoff. Omitted fields keep their default values.
+ */
+struct LinkSpec
+{
+    /**
+     * @brief Baud rate
+     *
+     */
+    BaudRate baudRate{BaudRate::BAUD_RATE_DEFAULT};
+
+    /**
+     * @brief Character size
+     *
+     */
+    CharacterSize characterSize{CharacterSize::CHARACTER_SIZE_DEFAULT};
+
+    /**
+     * @brief Parity
+     *
+     */
+    Parity parity{Parity::PARITY_TYPE_DEFAULT};
+
+    /**
+     * @brief Stop bit
+     *
+     */
+    StopBit stopBit{StopBit::STOP_BIT_DEFAULT};
+
+    /**
+     * @brief Flow control
+     *
+     */
+    FlowControl flowControl{FlowControl::FLOW_CONTROL_DEFAULT};
+};
+
+/**
+ * @brief Parse a link specification
+ *
+ * @param spec Link specification text
+ * @param linkSpec Parsed link specification, unchanged on failure
+ * @return true Link specification parsed
+ * @return false Link specification is malformed or names an unknown value
+ * @note Letters are matched case-insensitively
+ */
+bool parseLinkSpec(std::string_view spec, LinkSpec& linkSpec) noexcept;
+
+/**
+ * @brief Format a link specification
+ *
+ * @param linkSpec Link specification
+ * @param buffer Text buffer, null-terminated on success
+ * @param size Size of the text buffer (MAX_LINK_SPEC_SIZE is always sufficient)
+ * @return size_t Length of the text or 0 if a value is out of range or the buffer is too small
+ * @note Flow control is omitted when disabled
+ */
+size_t formatLinkSpec(const LinkSpec& linkSpec, char* buffer, size_t size) noexcept;
+
 /**
  * @brief ControlLine NOT operator
  *
@@ -0,0 +1,100 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <cstddef>
+#include <serialport/namespace.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Byte scan implementation
+ *
+ */
+enum class ScanImplementation
+{
+    /**
+     * @brief Portable byte at a time scan
+     *
+     */
+    SCAN_SCALAR,
+
+    /**
+     * @brief 16 bytes at a time scan using SSE2
+     *
+     */
+    SCAN_SSE2,
+
+    /**
+     * @brief 32 bytes at a time scan using AVX2
+     *
+     */
+    SCAN_AVX2,
+};
+
+/**
+ * @brief Find the first occurrence of a byte
+ *
+ * @param data Data to scan
+ * @param size Size of the data
+ * @param value Byte to find
+ * @return size_t Offset of the byte or size if not found
+ */
+size_t findByte(const char* data, size_t size, char value);
+
+/**
+ * @brief Find the first occurrence of either of two bytes
+ *
+ * @param data Data to scan
+ * @param size Size of the data
+ * @param first First byte to find
+ * @param second Second byte to find
+ * @return size_t Offset of the first matching byte or size if not found
+ */
+size_t findEitherByte(const char* data, size_t size, char first, char second);
+
+/**
+ * @brief Get the byte scan implementation in use
+ *
+ * @return ScanImplementation Byte scan implementation
+ * @note The fastest implementation supported by the processor is selected at startup
+ */
+ScanImplementation getScanImplementation();
+
+/**
+ * @brief Set the byte scan implementation
+ *
+ * @param scanImplementation Byte scan implementation
+ * @return true Byte scan implementation selected
+ * @return false Byte scan implementation not supported by the processor
+ */
+bool setScanImplementation(ScanImplementation scanImplementation);
+
+/**
+ * @brief Check whether a byte scan implementation is supported by the processor
+ *
+ * @param scanImplementation Byte scan implementation
+ * @return true Byte scan implementation is supported
+ * @return false Byte scan implementation is not supported
+ */
+bool isScanImplementationSupported(ScanImplementation scanImplementation);
+
+END_NAMESPACE_LIBSERIAL
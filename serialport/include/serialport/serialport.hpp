@@ -20,14 +20,23 @@
 */
 
 #pragma once
+#include <chrono>
 #include <memory>
 #include <string>
 #include <iostream>
+#include <system_error>
 #include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
 #include <serialport/properties.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+/**
+ * @brief Default time to wait for space in the output buffer when writing a whole frame
+ *
+ */
+static constexpr std::chrono::milliseconds DEFAULT_WRITE_TIMEOUT{1000};
+
 /**
  * @brief Forward declaration of the SerialPort implementation class
  *
@@ -37,6 +46,12 @@ class SerialPortImpl;
 /**
  * @brief SerialPort class
  *
+ * Reads, writes, queries and control line changes may be called concurrently
+ * from multiple threads, e.g. a reader and a writer thread of a full-duplex
+ * link, without blocking each other. Opening, closing and configuration
+ * changes (port name, exclusive mode and port properties) wait for in-flight
+ * I/O to finish and hold off new I/O until they are complete. Moving or
+ * destroying a serial port must not be concurrent with any other call.
  */
 class SerialPort final
 {
@@ -74,9 +89,10 @@ public:
     /**
      * @brief Move-construct a new SerialPort object
      *
-     * @param serialPort Serial port
+     * @param serialPort Serial port, left without an implementation
+     * @note A moved-from serial port is closed and may only be assigned or destroyed
      */
-    SerialPort(SerialPort&& serialPort) = delete;
+    SerialPort(SerialPort&& serialPort) noexcept;
 
     /**
      * @brief Copy-assignment operator
@@ -89,10 +105,11 @@ public:
     /**
      * @brief Move-assignment operator
      *
-     * @param serialPort Serial port to move-assign
+     * @param serialPort Serial port to move-assign, left without an implementation
      * @return SerialPort& Assigned serial port
+     * @note Previously open serial port is closed without throwing
      */
-    SerialPort& operator=(SerialPort&& serialPort) = delete;
+    SerialPort& operator=(SerialPort&& serialPort) noexcept;
 
     /**
      * @brief Destroy the SerialPort object
@@ -120,6 +137,31 @@ public:
      */
     void open(std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
 
+    /**
+     * @brief Open serial port with precomputed native port settings
+     *
+     * @param nativePortSettings Native port settings applied with a single system call
+     * @param openMode Serial port open mode
+     * @throw std::runtime_error Unsupported open mode
+     * @throw std::runtime_error Unable to open serial port
+     * @throw std::runtime_error Unable to get port settings
+     * @throw std::runtime_error Unable to set exclusive mode
+     * @throw std::runtime_error Unable to set port settings
+     * @note Baud rate, character size, flow control, parity and stop bit
+     *   properties must be set to match the native port settings
+     */
+    void open(const NativePortSettings& nativePortSettings,
+        std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
+
+    /**
+     * @brief Open serial port without throwing
+     *
+     * @param openMode Serial port open mode
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an unsupported
+     *   open mode or port settings, system error otherwise
+     */
+    void open(std::ios_base::openmode openMode, std::error_code& error) noexcept;
+
     /**
      * @brief Close serial port
      *
@@ -127,12 +169,27 @@ public:
      */
     void close();
 
+    /**
+     * @brief Close serial port without throwing
+     *
+     * @param error Error code of restoring previous port settings, port is closed regardless
+     */
+    void close(std::error_code& error) noexcept;
+
+    /**
+     * @brief Close serial port without restoring previous port settings
+     *
+     * @note Intended for serial ports whose device has disappeared
+     */
+    void abandon() noexcept;
+
     /**
      * @brief Set the exclusive mode of the serial port
      *
      * @param exclusive Exclusive mode
      * @return true Successfully changed the exclusive mode
      * @return false Failed to change the exclusive mode
+     * @note Serial port is always opened in exclusive mode, the mode is not retained across reopens
      */
     bool setExclusive(bool exclusive);
 
@@ -145,6 +202,17 @@ public:
      */
     size_t read(char* buffer, size_t size) const;
 
+    /**
+     * @brief Read data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when no data is
+     *   available, SerialError::SERIAL_ERROR_HANGUP on end of file or a disappeared device
+     * @return size_t Size of the data actually read, 0 on error
+     */
+    size_t read(char* buffer, size_t size, std::error_code& error) const noexcept;
+
     /**
      * @brief Read data
      *
@@ -171,6 +239,29 @@ public:
      */
     size_t write(const char* buffer, size_t size) const;
 
+    /**
+     * @brief Write data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when the output
+     *   buffer is full, SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, 0 on error
+     */
+    size_t write(const char* buffer, size_t size, std::error_code& error) const noexcept;
+
+    /**
+     * @brief Write all data, waiting for space in the output buffer
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param timeout Maximum time to wait for space in the output buffer, negative waits indefinitely
+     * @param error Error code, std::errc::timed_out when no space became available in time,
+     *   SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, less than size on error
+     */
+    size_t writeAll(const char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error) const noexcept;
+
     /**
      * @brief Write data
      *
@@ -232,6 +323,13 @@ public:
      */
     std::string getPortName() const;
 
+    /**
+     * @brief Get the native serial port handle
+     *
+     * @return NativeHandle Native handle or INVALID_FILE_DESCRIPTOR on a closed port
+     */
+    NativeHandle getNativeHandle() const;
+
     /**
      * @brief Set the port name
      *
@@ -259,6 +357,14 @@ public:
      */
     void setBaudRate(BaudRate baudRate);
 
+    /**
+     * @brief Set the baud rate without throwing
+     *
+     * @param baudRate Baud rate
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported baud rate
+     */
+    void setBaudRate(BaudRate baudRate, std::error_code& error) noexcept;
+
     /**
      * @brief Get the character size
      *
@@ -274,6 +380,14 @@ public:
      */
     void setCharacterSize(CharacterSize characterSize);
 
+    /**
+     * @brief Set the character size without throwing
+     *
+     * @param characterSize Character size
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported character size
+     */
+    void setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept;
+
     /**
      * @brief Get the flow control
      *
@@ -289,6 +403,14 @@ public:
      */
     void setFlowControl(FlowControl flowControl);
 
+    /**
+     * @brief Set the flow control without throwing
+     *
+     * @param flowControl Flow control
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported flow control
+     */
+    void setFlowControl(FlowControl flowControl, std::error_code& error) noexcept;
+
     /**
      * @brief Get the parity
      *
@@ -304,6 +426,14 @@ public:
      */
     void setParity(Parity parity);
 
+    /**
+     * @brief Set the parity without throwing
+     *
+     * @param parity Parity
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported parity
+     */
+    void setParity(Parity parity, std::error_code& error) noexcept;
+
     /**
      * @brief Get the stop bit
      *
@@ -319,6 +449,14 @@ public:
      */
     void setStopBit(StopBit stopBit);
 
+    /**
+     * @brief Set the stop bit without throwing
+     *
+     * @param stopBit Stop bit
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported stop bit
+     */
+    void setStopBit(StopBit stopBit, std::error_code& error) noexcept;
+
     /**
      * @brief Get the control line status
      *
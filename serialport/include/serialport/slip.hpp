@@ -0,0 +1,222 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <string_view>
+#include <vector>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_reader.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Default maximum SLIP frame size in bytes
+ *
+ */
+static constexpr size_t DEFAULT_SLIP_FRAME_SIZE{4096};
+
+/**
+ * @brief SLIP frame end byte
+ *
+ */
+static constexpr char SLIP_END{'\xC0'};
+
+/**
+ * @brief SLIP escape byte
+ *
+ */
+static constexpr char SLIP_ESC{'\xDB'};
+
+/**
+ * @brief SLIP escaped frame end byte
+ *
+ */
+static constexpr char SLIP_ESC_END{'\xDC'};
+
+/**
+ * @brief SLIP escaped escape byte
+ *
+ */
+static constexpr char SLIP_ESC_ESC{'\xDD'};
+
+/**
+ * @brief SlipCodec class
+ *
+ * Serial Line Internet Protocol (SLIP, RFC 1055) framing on a serial port.
+ * END and ESC bytes are located with vectorized byte search and the data
+ * between them is copied in bulk.
+ */
+class SlipCodec final
+{
+public:
+    /**
+     * @brief Construct a new SlipCodec object
+     *
+     * @param serialPort Serial port
+     * @param maxFrameSize Maximum decoded frame size
+     */
+    explicit SlipCodec(SerialPort& serialPort, size_t maxFrameSize = DEFAULT_SLIP_FRAME_SIZE);
+
+    /**
+     * @brief Copy-construct a new SlipCodec object
+     *
+     * @param slipCodec SLIP codec
+     */
+    SlipCodec(const SlipCodec& slipCodec) = delete;
+
+    /**
+     * @brief Move-construct a new SlipCodec object
+     *
+     * @param slipCodec SLIP codec
+     */
+    SlipCodec(SlipCodec&& slipCodec) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param slipCodec SLIP codec to copy-assign
+     * @return SlipCodec& Assigned SLIP codec
+     */
+    SlipCodec& operator=(const SlipCodec& slipCodec) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param slipCodec SLIP codec to move-assign
+     * @return SlipCodec& Assigned SLIP codec
+     */
+    SlipCodec& operator=(SlipCodec&& slipCodec) = delete;
+
+    /**
+     * @brief Destroy the SlipCodec object
+     *
+     */
+    ~SlipCodec() noexcept = default;
+
+    /**
+     * @brief Read and decode the next frame, reading from the serial port once if no buffered frame is available
+     *
+     * @param frame Decoded frame
+     * @return true Frame available
+     * @return false No complete frame available
+     * @note Frame view is valid until the next frame is decoded
+     */
+    bool readFrame(std::string_view& frame);
+
+    /**
+     * @brief Decode the next buffered frame without reading from the serial port
+     *
+     * @param frame Decoded frame
+     * @return true Frame available
+     * @return false No complete frame buffered
+     * @note Frame view is valid until the next frame is decoded
+     */
+    bool nextFrame(std::string_view& frame);
+
+    /**
+     * @brief Append received data from another source
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @return size_t Size of the data accepted, less than size when buffered frames must be decoded first
+     */
+    size_t feed(const char* data, size_t size);
+
+    /**
+     * @brief Encode a frame and write it to the serial port
+     *
+     * @param data Frame data
+     * @param size Size of the frame data
+     * @param timeout Maximum time to wait for space in the output buffer, negative waits indefinitely
+     * @return true Frame written
+     * @return false Frame not or only partially written
+     */
+    bool writeFrame(const char* data, size_t size, std::chrono::milliseconds timeout = DEFAULT_WRITE_TIMEOUT);
+
+    /**
+     * @brief Get the number of frames dropped due to an invalid encoding
+     *
+     * @return unsigned long Number of invalid frames
+     */
+    unsigned long getErrorCount() const;
+
+    /**
+     * @brief Get the maximum size of an encoded frame including its END bytes
+     *
+     * @param size Size of the frame data
+     * @return size_t Maximum encoded size
+     */
+    static size_t getMaxEncodedSize(size_t size);
+
+    /**
+     * @brief Encode a frame between a leading and a trailing END byte
+     *
+     * @param data Frame data
+     * @param size Size of the frame data
+     * @param output Output buffer of at least getMaxEncodedSize(size) bytes, e.g. a transmit buffer
+     * @return size_t Size of the encoded frame
+     */
+    static size_t encode(const char* data, size_t size, char* output);
+
+    /**
+     * @brief Decode a frame without its END bytes
+     *
+     * @param data Encoded frame
+     * @param size Size of the encoded frame
+     * @param output Output buffer of at least size bytes
+     * @return size_t Size of the decoded frame or size_t(-1) on an invalid escape sequence
+     */
+    static size_t decode(const char* data, size_t size, char* output);
+protected:
+    /**
+     * @brief Serial port
+     *
+     */
+    SerialPort& serialPort;
+
+    /**
+     * @brief Reader of the END terminated encoded frames
+     *
+     */
+    FrameReader frameReader;
+
+    /**
+     * @brief Decoded frame buffer
+     *
+     */
+    std::vector<char> frameBuffer;
+
+    /**
+     * @brief Transmit buffer
+     *
+     */
+    std::vector<char> transmitBuffer;
+
+    /**
+     * @brief Number of invalid frames
+     *
+     */
+    unsigned long errorCount;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,426 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <serialport/namespace.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Timer identifier
+ *
+ */
+typedef uint64_t TimerId;
+
+/**
+ * @brief Invalid timer identifier
+ *
+ */
+constexpr TimerId INVALID_TIMER_ID{UINT64_MAX};
+
+/**
+ * @brief Default resolution of a timer wheel
+ *
+ */
+constexpr std::chrono::microseconds DEFAULT_TIMER_RESOLUTION{1000};
+
+/**
+ * @brief Default number of slots of a timer wheel
+ *
+ */
+constexpr size_t DEFAULT_TIMER_SLOT_COUNT{256};
+
+/**
+ * @brief Default number of levels of a timer wheel
+ *
+ */
+constexpr size_t DEFAULT_TIMER_LEVEL_COUNT{4};
+
+/**
+ * @brief TimerWheel class
+ *
+ * Hashed hierarchical timer wheel with O(1) arm and cancel. Level l has
+ * slotCount slots of slotCount^l ticks each, a timer is kept in the lowest
+ * level covering its remaining time and is cascaded to a lower level once
+ * the wheel reaches the span of its slot. Timers beyond the range of the top
+ * level wait in the top level and are cascaded repeatedly until due.
+ *
+ * Timers are kept in doubly linked slot lists and are stored in a slab which
+ * is reused, so arming a timer does not allocate once the slab has grown to
+ * the peak number of timers. Deadlines are rounded up to the resolution, a
+ * timer never expires early.
+ *
+ * Timer identifiers carry a generation, so cancelling an already expired
+ * timer whose slot has been reused is harmless.
+ */
+class TimerWheel final
+{
+public:
+    /**
+     * @brief Construct a new TimerWheel object
+     *
+     * @param resolution Duration of a single tick
+     * @param slotCount Number of slots of each level
+     * @param levelCount Number of levels
+     * @throw std::out_of_range Invalid resolution, slot count or level count
+     */
+    explicit TimerWheel(std::chrono::microseconds resolution = DEFAULT_TIMER_RESOLUTION,
+        size_t slotCount = DEFAULT_TIMER_SLOT_COUNT, size_t levelCount = DEFAULT_TIMER_LEVEL_COUNT);
+
+    /**
+     * @brief Copy-construct a new TimerWheel object
+     *
+     * @param timerWheel Timer wheel
+     */
+    TimerWheel(const TimerWheel& timerWheel) = delete;
+
+    /**
+     * @brief Move-construct a new TimerWheel object
+     *
+     * @param timerWheel Timer wheel
+     */
+    TimerWheel(TimerWheel&& timerWheel) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param timerWheel Timer wheel to copy-assign
+     * @return TimerWheel& Assigned timer wheel
+     */
+    TimerWheel& operator=(const TimerWheel& timerWheel) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param timerWheel Timer wheel to move-assign
+     * @return TimerWheel& Assigned timer wheel
+     */
+    TimerWheel& operator=(TimerWheel&& timerWheel) = delete;
+
+    /**
+     * @brief Destroy the TimerWheel object
+     *
+     */
+    ~TimerWheel() noexcept = default;
+
+    /**
+     * @brief Arm a timer
+     *
+     * @param deadline Expiry time
+     * @param data User data passed to the expiry function
+     * @return TimerId Timer identifier
+     */
+    TimerId arm(std::chrono::steady_clock::time_point deadline, uint64_t data);
+
+    /**
+     * @brief Cancel a timer
+     *
+     * @param timerId Timer identifier
+     * @return true Timer cancelled
+     * @return false Timer already expired or cancelled
+     */
+    bool cancel(TimerId timerId);
+
+    /**
+     * @brief Expire all timers due at the given time
+     *
+     * @tparam Expire Function called with the timer identifier and user data of each expired timer
+     * @param now Current time
+     * @param expire Expiry function, may arm and cancel timers
+     * @return size_t Number of expired timers
+     */
+    template<typename Expire>
+    size_t advance(std::chrono::steady_clock::time_point now, Expire&& expire)
+    {
+        const auto nowTick{toTick(now, false)};
+        size_t count{0};
+        while (currentTick <= nowTick)
+        {
+            // Skip to the next cascade of the lowest occupied level
+            const auto level{getLowestLevel()};
+            if (level == levels.size())
+            {
+                currentTick = nowTick + 1;
+                break;
+            }
+            if (level > 0)
+            {
+                const auto span{spans[level]};
+                const auto tick{((currentTick + span - 1) / span) * span};
+                if (tick > nowTick)
+                {
+                    currentTick = nowTick + 1;
+                    break;
+                }
+                currentTick = tick;
+            }
+
+            // Timers armed by the expiry function land in later ticks
+            const auto tick{currentTick};
+            cascade(tick);
+            currentTick = tick + 1;
+            count += expireSlot(tick % slotCount, tick, expire);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Get the expiry time of the earliest timer
+     *
+     * @return std::chrono::steady_clock::time_point Expiry time or time_point::max() without timers
+     */
+    std::chrono::steady_clock::time_point getNextExpiry() const;
+
+    /**
+     * @brief Get the number of armed timers
+     *
+     * @return size_t Number of armed timers
+     */
+    size_t getActiveCount() const;
+
+    /**
+     * @brief Get the expiry time of a timer
+     *
+     * @param timerId Timer identifier
+     * @return std::chrono::steady_clock::time_point Deadline rounded up to the resolution
+     *   or time_point::max() for an expired or cancelled timer
+     */
+    std::chrono::steady_clock::time_point getExpiry(TimerId timerId) const;
+
+    /**
+     * @brief Get the resolution
+     *
+     * @return std::chrono::microseconds Duration of a single tick
+     */
+    std::chrono::microseconds getResolution() const;
+
+    /**
+     * @brief Get the number of levels
+     *
+     * @return size_t Number of levels
+     */
+    size_t getLevelCount() const;
+protected:
+    /**
+     * @brief Invalid slab index
+     *
+     */
+    static constexpr uint32_t INVALID_INDEX{UINT32_MAX};
+
+    /**
+     * @brief Timer slab entry
+     *
+     */
+    struct Timer
+    {
+        /**
+         * @brief Deadline tick
+         *
+         */
+        uint64_t tick;
+
+        /**
+         * @brief User data
+         *
+         */
+        uint64_t data;
+
+        /**
+         * @brief Slot list the timer is linked into
+         *
+         */
+        uint32_t slot;
+
+        /**
+         * @brief Generation of the slab entry
+         *
+         */
+        uint32_t generation;
+
+        /**
+         * @brief Previous timer of the slot or the next free entry
+         *
+         */
+        uint32_t previous;
+
+        /**
+         * @brief Next timer of the slot
+         *
+         */
+        uint32_t next;
+
+        /**
+         * @brief Timer is armed
+         *
+         */
+        bool active;
+    };
+
+    /**
+     * @brief Expire the due timers of a slot
+     *
+     * @tparam Expire Function called with the timer identifier and user data of each expired timer
+     * @param slot Slot index
+     * @param tick Last due tick
+     * @param expire Expiry function
+     * @return size_t Number of expired timers
+     */
+    template<typename Expire>
+    size_t expireSlot(size_t slot, uint64_t tick, Expire& expire)
+    {
+        size_t count{0};
+        auto index{slots[slot]};
+        while (index != INVALID_INDEX)
+        {
+            if (timers[index].tick > tick)
+            {
+                index = timers[index].next;
+                continue;
+            }
+
+            // Unlink the timer before calling the expiry function
+            const auto timerId{getTimerId(index)};
+            const auto data{timers[index].data};
+            const auto next{timers[index].next};
+            const auto nextGeneration{(next != INVALID_INDEX) ? timers[next].generation : 0U};
+            release(index);
+            expire(timerId, data);
+            ++count;
+
+            // Restart the slot if the expiry function cancelled the next timer
+            const auto nextValid{(next == INVALID_INDEX) || (timers[next].active && (timers[next].generation == nextGeneration))};
+            index = (nextValid ? next : slots[slot]);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Get the lowest level holding a timer
+     *
+     * @return size_t Level or the number of levels without timers
+     */
+    size_t getLowestLevel() const;
+
+    /**
+     * @brief Move the timers of every level whose span starts at the tick to lower levels
+     *
+     * @param tick Current tick
+     */
+    void cascade(uint64_t tick);
+
+    /**
+     * @brief Link a timer into the slot of the lowest level covering its remaining time
+     *
+     * @param index Slab index
+     */
+    void link(uint32_t index);
+
+    /**
+     * @brief Convert a time to a tick
+     *
+     * @param time Time
+     * @param roundUp Round up to the next tick
+     * @return uint64_t Tick
+     */
+    uint64_t toTick(std::chrono::steady_clock::time_point time, bool roundUp) const;
+
+    /**
+     * @brief Get the timer identifier of a slab entry
+     *
+     * @param index Slab index
+     * @return TimerId Timer identifier
+     */
+    TimerId getTimerId(uint32_t index) const;
+
+    /**
+     * @brief Unlink a timer from its slot and return it to the free list
+     *
+     * @param index Slab index
+     */
+    void release(uint32_t index);
+
+    /**
+     * @brief Time of tick zero
+     *
+     */
+    std::chrono::steady_clock::time_point origin;
+
+    /**
+     * @brief Duration of a single tick
+     *
+     */
+    std::chrono::microseconds resolution;
+
+    /**
+     * @brief First tick not processed yet
+     *
+     */
+    uint64_t currentTick;
+
+    /**
+     * @brief Number of slots of each level
+     *
+     */
+    size_t slotCount;
+
+    /**
+     * @brief Number of ticks covered by a slot of each level, with the range
+     *   of the top level (saturated) as the last entry
+     *
+     */
+    std::vector<uint64_t> spans;
+
+    /**
+     * @brief Number of timers of each level
+     *
+     */
+    std::vector<size_t> levels;
+
+    /**
+     * @brief Slot list heads of all levels
+     *
+     */
+    std::vector<uint32_t> slots;
+
+    /**
+     * @brief Timer slab
+     *
+     */
+    std::vector<Timer> timers;
+
+    /**
+     * @brief Head of the free list
+     *
+     */
+    uint32_t freeList;
+
+    /**
+     * @brief Number of armed timers
+     *
+     */
+    size_t activeCount;
+};
+
+END_NAMESPACE_LIBSERIAL
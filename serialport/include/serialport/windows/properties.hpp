@@ -27,6 +27,12 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+/**
+ * @brief Native serial port handle
+ *
+ */
+typedef HANDLE NativeHandle;
+
 /**
  * @brief Default value for an invalid file descriptor
  *
@@ -45,4 +51,10 @@ static constexpr char DEFAULT_PORT_NAME[]{"COM1"};
  */
 static constexpr char SERIAL_PORT_PREFIX[]{"\\\\.\\"};
 
+/**
+ * @brief Precomputed native serial port settings
+ *
+ */
+typedef DCB NativePortSettings;
+
 END_NAMESPACE_LIBSERIAL
@@ -20,10 +20,14 @@
 */
 
 #pragma once
+#include <chrono>
 #include <string>
 #include <iostream>
+#include <shared_mutex>
+#include <system_error>
 #include <winbase.h>
 #include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
 #include <serialport/properties.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
@@ -113,6 +117,29 @@ public:
      */
     void open(std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
 
+    /**
+     * @brief Open serial port with precomputed native port settings
+     *
+     * @param nativePortSettings Native port settings
+     * @param openMode Serial port open mode
+     * @throw std::runtime_error Unsupported open mode
+     * @throw std::runtime_error Unable to open serial port
+     * @throw std::runtime_error Unable to get port settings
+     * @throw std::runtime_error Unable to get port timeout settings
+     * @throw std::runtime_error Unable to set port settings
+     */
+    void open(const NativePortSettings& nativePortSettings,
+        std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::out);
+
+    /**
+     * @brief Open serial port without throwing
+     *
+     * @param openMode Serial port open mode
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an unsupported
+     *   open mode or port settings, system error otherwise
+     */
+    void open(std::ios_base::openmode openMode, std::error_code& error) noexcept;
+
     /**
      * @brief Close serial port
      *
@@ -120,6 +147,20 @@ public:
      */
     void close();
 
+    /**
+     * @brief Close serial port without throwing
+     *
+     * @param error Error code of restoring previous port settings, port is closed regardless
+     */
+    void close(std::error_code& error) noexcept;
+
+    /**
+     * @brief Close serial port without restoring previous port settings
+     *
+     * @note Intended for serial ports whose device has disappeared
+     */
+    void abandon() noexcept;
+
     /**
      * @brief Set the exclusive mode of the serial port
      *
@@ -138,6 +179,17 @@ public:
      */
     size_t read(char* buffer, size_t size) const;
 
+    /**
+     * @brief Read data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to read
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when no data is
+     *   available, SerialError::SERIAL_ERROR_HANGUP on end of file or a disappeared device
+     * @return size_t Size of the data actually read, 0 on error
+     */
+    size_t read(char* buffer, size_t size, std::error_code& error) const noexcept;
+
     /**
      * @brief Read data
      *
@@ -164,6 +216,29 @@ public:
      */
     size_t write(const char* buffer, size_t size) const;
 
+    /**
+     * @brief Write data without throwing
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param error Error code, SerialError::SERIAL_ERROR_WOULD_BLOCK when the output
+     *   buffer is full, SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, 0 on error
+     */
+    size_t write(const char* buffer, size_t size, std::error_code& error) const noexcept;
+
+    /**
+     * @brief Write all data, waiting for space in the output buffer
+     *
+     * @param buffer Data buffer
+     * @param size Size of the data to write
+     * @param timeout Maximum time to wait for space in the output buffer, negative waits indefinitely
+     * @param error Error code, std::errc::timed_out when no space became available in time,
+     *   SerialError::SERIAL_ERROR_HANGUP on a disappeared device
+     * @return size_t Size of the data actually written, less than size on error
+     */
+    size_t writeAll(const char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error) const noexcept;
+
     /**
      * @brief Write data
      *
@@ -225,6 +300,20 @@ public:
      */
     std::string getPortName() const;
 
+    /**
+     * @brief Get the native serial port handle
+     *
+     * @return NativeHandle Native handle or INVALID_FILE_DESCRIPTOR on a closed port
+     */
+    NativeHandle getNativeHandle() const;
+
+    /**
+     * @brief Get the mutex serializing configuration changes against I/O
+     *
+     * @return std::shared_mutex& Mutex, held shared by I/O and exclusively by configuration changes
+     */
+    std::shared_mutex& getMutex() const noexcept;
+
     /**
      * @brief Set the port name
      *
@@ -252,6 +341,14 @@ public:
      */
     void setBaudRate(BaudRate baudRate);
 
+    /**
+     * @brief Set the baud rate without throwing
+     *
+     * @param baudRate Baud rate
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported baud rate
+     */
+    void setBaudRate(BaudRate baudRate, std::error_code& error) noexcept;
+
     /**
      * @brief Get the character size
      *
@@ -267,6 +364,14 @@ public:
      */
     void setCharacterSize(CharacterSize characterSize);
 
+    /**
+     * @brief Set the character size without throwing
+     *
+     * @param characterSize Character size
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported character size
+     */
+    void setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept;
+
     /**
      * @brief Get the flow control
      *
@@ -282,6 +387,14 @@ public:
      */
     void setFlowControl(FlowControl flowControl);
 
+    /**
+     * @brief Set the flow control without throwing
+     *
+     * @param flowControl Flow control
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported flow control
+     */
+    void setFlowControl(FlowControl flowControl, std::error_code& error) noexcept;
+
     /**
      * @brief Get the parity
      *
@@ -297,6 +410,14 @@ public:
      */
     void setParity(Parity parity);
 
+    /**
+     * @brief Set the parity without throwing
+     *
+     * @param parity Parity
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported parity
+     */
+    void setParity(Parity parity, std::error_code& error) noexcept;
+
     /**
      * @brief Get the stop bit
      *
@@ -312,6 +433,14 @@ public:
      */
     void setStopBit(StopBit stopBit);
 
+    /**
+     * @brief Set the stop bit without throwing
+     *
+     * @param stopBit Stop bit
+     * @param error Error code, SerialError::SERIAL_ERROR_NOT_SUPPORTED on an invalid or unsupported stop bit
+     */
+    void setStopBit(StopBit stopBit, std::error_code& error) noexcept;
+
     /**
      * @brief Get the control line status
      *
@@ -462,6 +591,12 @@ protected:
      *
      */
     StopBit stopBit;
+
+    /**
+     * @brief Mutex serializing configuration changes against I/O
+     *
+     */
+    mutable std::shared_mutex mutex;
 };
 
 END_NAMESPACE_LIBSERIAL
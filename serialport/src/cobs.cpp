@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_reader.hpp>
+#include <serialport/cobs.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Maximum number of data bytes in a COBS block
+     *
+     */
+    constexpr size_t COBS_BLOCK_SIZE{254};
+} // namespace
+
+CobsCodec::CobsCodec(SerialPort& serialPort, size_t maxFrameSize) :
+    serialPort{serialPort}, frameReader{serialPort, std::string(1, '\0'), getMaxEncodedSize(maxFrameSize) * 2},
+    frameBuffer(getMaxEncodedSize(maxFrameSize)), transmitBuffer(getMaxEncodedSize(maxFrameSize)), errorCount{0}
+{
+
+}
+
+bool CobsCodec::readFrame(std::string_view& frame)
+{
+    if (nextFrame(frame))
+        return true;
+
+    return ((frameReader.fill() > 0) && nextFrame(frame));
+}
+
+bool CobsCodec::nextFrame(std::string_view& frame)
+{
+    std::string_view encoded{};
+    while (frameReader.nextFrame(encoded))
+    {
+        // Skip empty frames between delimiters
+        if (encoded.empty())
+            continue;
+
+        // Encoded frame exceeding the maximum frame size
+        if (encoded.size() > frameBuffer.size())
+        {
+            ++errorCount;
+            continue;
+        }
+
+        const auto size{decode(encoded.data(), encoded.size(), frameBuffer.data())};
+        if (size == static_cast<size_t>(-1))
+        {
+            ++errorCount;
+            continue;
+        }
+
+        frame = std::string_view{frameBuffer.data(), size};
+        return true;
+    }
+    return false;
+}
+
+size_t CobsCodec::feed(const char* data, size_t size)
+{
+    return frameReader.feed(data, size);
+}
+
+bool CobsCodec::writeFrame(const char* data, size_t size, std::chrono::milliseconds timeout)
+{
+    const auto maxSize{getMaxEncodedSize(size)};
+    if (maxSize > transmitBuffer.size())
+        transmitBuffer.resize(maxSize);
+
+    // Frame is written whole, a partially written frame can not be resumed
+    const auto encodedSize{encode(data, size, transmitBuffer.data())};
+    std::error_code error{};
+    return (serialPort.writeAll(transmitBuffer.data(), encodedSize, timeout, error) == encodedSize);
+}
+
+unsigned long CobsCodec::getErrorCount() const
+{
+    return (errorCount + frameReader.getOverflowCount());
+}
+
+size_t CobsCodec::getMaxEncodedSize(size_t size)
+{
+    // Code byte per started block and the delimiter
+    return (size + (size / COBS_BLOCK_SIZE) + 2);
+}
+
+size_t CobsCodec::encode(const char* data, size_t size, char* output)
+{
+    size_t result{0};
+    size_t offset{0};
+    while (true)
+    {
+        // Block of non-zero bytes is stored after its code byte
+        const auto count{findByte(data + offset, std::min(size - offset, COBS_BLOCK_SIZE), '\0')};
+        output[result] = static_cast<char>(count + 1);
+        std::memcpy(output + result + 1, data + offset, count);
+        result += count + 1;
+        offset += count;
+        if (offset == size)
+            break;
+
+        // Full block is not followed by an implicit zero
+        if (count < COBS_BLOCK_SIZE)
+            ++offset;
+    }
+
+    output[result++] = '\0';
+    return result;
+}
+
+size_t CobsCodec::decode(const char* data, size_t size, char* output)
+{
+    size_t result{0};
+    size_t offset{0};
+    while (offset < size)
+    {
+        const auto code{static_cast<unsigned char>(data[offset++])};
+        const auto count{static_cast<size_t>(code) - 1};
+        if ((code == 0) || (count > (size - offset)) || (findByte(data + offset, count, '\0') != count))
+            return static_cast<size_t>(-1);
+
+        std::memcpy(output + result, data + offset, count);
+        result += count;
+        offset += count;
+
+        // Every block except a full or the last one ends with a zero
+        if ((code != 0xFF) && (offset < size))
+            output[result++] = '\0';
+    }
+    return result;
+}
+
+END_NAMESPACE_LIBSERIAL
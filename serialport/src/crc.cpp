@@ -0,0 +1,292 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define LIBSERIAL_CRC_X86
+    #include <immintrin.h>
+#endif // (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief CRC register update function
+     *
+     */
+    typedef uint32_t (*UpdateFunction)(uint32_t crc, const char* data, size_t size);
+
+    /**
+     * @brief Update a CRC-32 register using the slicing-by-8 tables
+     *
+     * @param crc Reflected CRC register
+     * @param data Data
+     * @param size Size of the data
+     * @return uint32_t Updated CRC register
+     */
+    uint32_t updateCrc32Table(uint32_t crc, const char* data, size_t size)
+    {
+        return Crc32::updateTable(crc, data, size);
+    }
+
+    /**
+     * @brief Update a CRC-32C register using the slicing-by-8 tables
+     *
+     * @param crc Reflected CRC register
+     * @param data Data
+     * @param size Size of the data
+     * @return uint32_t Updated CRC register
+     */
+    uint32_t updateCrc32cTable(uint32_t crc, const char* data, size_t size)
+    {
+        return Crc32c::updateTable(crc, data, size);
+    }
+
+#ifdef LIBSERIAL_CRC_X86
+    /**
+     * @brief Update a CRC-32C register using the SSE4.2 CRC32 instruction
+     *
+     * @param crc Reflected CRC register
+     * @param data Data
+     * @param size Size of the data
+     * @return uint32_t Updated CRC register
+     */
+    __attribute__((target("sse4.2")))
+    uint32_t updateCrc32cSse42(uint32_t crc, const char* data, size_t size)
+    {
+#ifdef __x86_64__
+        uint64_t result{crc};
+        for (; size >= 8; size -= 8, data += 8)
+        {
+            uint64_t value{0};
+            std::memcpy(&value, data, sizeof(value));
+            result = _mm_crc32_u64(result, value);
+        }
+        crc = static_cast<uint32_t>(result);
+#endif // __x86_64__
+
+        for (; size >= 4; size -= 4, data += 4)
+        {
+            uint32_t value{0};
+            std::memcpy(&value, data, sizeof(value));
+            crc = _mm_crc32_u32(crc, value);
+        }
+
+        for (; size > 0; --size, ++data)
+            crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*data));
+        return crc;
+    }
+
+    /**
+     * @brief Update a CRC-32 register by folding with the PCLMULQDQ instruction
+     *
+     * Folds 64 bytes per iteration and reduces the result with a Barrett
+     * reduction, as described in "Fast CRC Computation for Generic Polynomials
+     * Using PCLMULQDQ Instruction" (Intel, 2009).
+     *
+     * @param crc Reflected CRC register
+     * @param data Data
+     * @param size Size of the data
+     * @return uint32_t Updated CRC register
+     */
+    __attribute__((target("pclmul,sse4.1")))
+    uint32_t updateCrc32Pclmul(uint32_t crc, const char* data, size_t size)
+    {
+        // Folding needs at least one 64 byte block
+        if (size < 64)
+            return Crc32::updateTable(crc, data, size);
+
+        // Bit-reflected folding and reduction constants of the CRC-32 polynomial
+        const auto k1k2{_mm_set_epi64x(0x01C6E41596, 0x0154442BD4)};
+        const auto k3k4{_mm_set_epi64x(0x00CCAA009E, 0x01751997D0)};
+        const auto k5k0{_mm_set_epi64x(0x0000000000, 0x0163CD6124)};
+        const auto polynomial{_mm_set_epi64x(0x01F7011641, 0x01DB710641)};
+        const auto lowMask{_mm_setr_epi32(~0, 0, ~0, 0)};
+
+        auto x1{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00))};
+        auto x2{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10))};
+        auto x3{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20))};
+        auto x4{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30))};
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+        data += 64;
+        size -= 64;
+
+        // Fold four 128-bit lanes in parallel
+        for (; size >= 64; data += 64, size -= 64)
+        {
+            const auto x5{_mm_clmulepi64_si128(x1, k1k2, 0x00)};
+            const auto x6{_mm_clmulepi64_si128(x2, k1k2, 0x00)};
+            const auto x7{_mm_clmulepi64_si128(x3, k1k2, 0x00)};
+            const auto x8{_mm_clmulepi64_si128(x4, k1k2, 0x00)};
+            x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k1k2, 0x11), x5);
+            x2 = _mm_xor_si128(_mm_clmulepi64_si128(x2, k1k2, 0x11), x6);
+            x3 = _mm_xor_si128(_mm_clmulepi64_si128(x3, k1k2, 0x11), x7);
+            x4 = _mm_xor_si128(_mm_clmulepi64_si128(x4, k1k2, 0x11), x8);
+            x1 = _mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+            x2 = _mm_xor_si128(x2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+            x3 = _mm_xor_si128(x3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+            x4 = _mm_xor_si128(x4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+        }
+
+        // Fold the four lanes into one
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x2), _mm_clmulepi64_si128(x1, k3k4, 0x00));
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x3), _mm_clmulepi64_si128(x1, k3k4, 0x00));
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x4), _mm_clmulepi64_si128(x1, k3k4, 0x00));
+
+        // Fold the remaining 16 byte blocks
+        for (; size >= 16; data += 16, size -= 16)
+        {
+            const auto x5{_mm_clmulepi64_si128(x1, k3k4, 0x00)};
+            x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+        }
+
+        // Fold 128 bits to 64 bits
+        auto x2Fold{_mm_clmulepi64_si128(x1, k3k4, 0x10)};
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2Fold);
+        x2Fold = _mm_srli_si128(x1, 4);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, lowMask), k5k0, 0x00), x2Fold);
+
+        // Barrett reduction to 32 bits
+        x2Fold = _mm_clmulepi64_si128(_mm_and_si128(x1, lowMask), polynomial, 0x10);
+        x2Fold = _mm_clmulepi64_si128(_mm_and_si128(x2Fold, lowMask), polynomial, 0x00);
+        x1 = _mm_xor_si128(x1, x2Fold);
+        crc = static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+
+        return Crc32::updateTable(crc, data, size);
+    }
+#endif // LIBSERIAL_CRC_X86
+
+    /**
+     * @brief Select the fastest CRC implementation supported by the processor
+     *
+     * @return CrcImplementation CRC implementation
+     */
+    CrcImplementation selectCrcImplementation()
+    {
+        return (isCrcImplementationSupported(CrcImplementation::CRC_HARDWARE) ?
+            CrcImplementation::CRC_HARDWARE : CrcImplementation::CRC_SLICING_BY_8);
+    }
+
+    /**
+     * @brief Get the CRC-32 update function of a CRC implementation
+     *
+     * @param crcImplementation CRC implementation
+     * @return UpdateFunction Update function
+     */
+    UpdateFunction getCrc32Function(CrcImplementation crcImplementation)
+    {
+#ifdef LIBSERIAL_CRC_X86
+        if (crcImplementation == CrcImplementation::CRC_HARDWARE)
+            return updateCrc32Pclmul;
+#endif // LIBSERIAL_CRC_X86
+        static_cast<void>(crcImplementation);
+        return updateCrc32Table;
+    }
+
+    /**
+     * @brief Get the CRC-32C update function of a CRC implementation
+     *
+     * @param crcImplementation CRC implementation
+     * @return UpdateFunction Update function
+     */
+    UpdateFunction getCrc32cFunction(CrcImplementation crcImplementation)
+    {
+#ifdef LIBSERIAL_CRC_X86
+        if (crcImplementation == CrcImplementation::CRC_HARDWARE)
+            return updateCrc32cSse42;
+#endif // LIBSERIAL_CRC_X86
+        static_cast<void>(crcImplementation);
+        return updateCrc32cTable;
+    }
+
+    /**
+     * @brief CRC implementation in use
+     *
+     */
+    std::atomic<CrcImplementation> currentImplementation{selectCrcImplementation()};
+
+    /**
+     * @brief CRC-32 update function in use
+     *
+     */
+    std::atomic<UpdateFunction> crc32Function{getCrc32Function(currentImplementation.load())};
+
+    /**
+     * @brief CRC-32C update function in use
+     *
+     */
+    std::atomic<UpdateFunction> crc32cFunction{getCrc32cFunction(currentImplementation.load())};
+} // namespace
+
+CrcImplementation getCrcImplementation()
+{
+    return currentImplementation.load();
+}
+
+bool setCrcImplementation(CrcImplementation crcImplementation)
+{
+    if (!isCrcImplementationSupported(crcImplementation))
+        return false;
+
+    currentImplementation.store(crcImplementation);
+    crc32Function.store(getCrc32Function(crcImplementation));
+    crc32cFunction.store(getCrc32cFunction(crcImplementation));
+    return true;
+}
+
+bool isCrcImplementationSupported(CrcImplementation crcImplementation)
+{
+    switch (crcImplementation)
+    {
+        case CrcImplementation::CRC_SLICING_BY_8:
+            return true;
+
+#ifdef LIBSERIAL_CRC_X86
+        case CrcImplementation::CRC_HARDWARE:
+            // Processor features may be queried before static initialization completes
+            __builtin_cpu_init();
+            return ((__builtin_cpu_supports("sse4.2") != 0) && (__builtin_cpu_supports("pclmul") != 0));
+#endif // LIBSERIAL_CRC_X86
+
+        default:
+            return false;
+    }
+}
+
+uint32_t updateCrc32(uint32_t crc, const char* data, size_t size)
+{
+    return crc32Function.load(std::memory_order_relaxed)(crc, data, size);
+}
+
+uint32_t updateCrc32c(uint32_t crc, const char* data, size_t size)
+{
+    return crc32cFunction.load(std::memory_order_relaxed)(crc, data, size);
+}
+
+END_NAMESPACE_LIBSERIAL
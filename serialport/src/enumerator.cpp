@@ -19,6 +19,10 @@
     SPDX-License-Identifier: GPL-3.0-or-later
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
 #include <serialport/namespace.hpp>
 #include <serialport/properties.hpp>
 #include <serialport/enumerator.hpp>
@@ -29,7 +33,10 @@
     #include <sys/ioctl.h>
     #include <linux/serial.h>
     #include <unistd.h>
+    #include <dirent.h>
+    #include <climits>
     #include <cstring>
+    #include <map>
 #elif defined(_WIN32) || defined(_WIN64)
     #include <fileapi.h>
     #include <winnt.h>
@@ -38,6 +45,212 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+namespace
+{
+
+/**
+ * @brief Cached serial port information list
+ *
+ */
+std::vector<PortInfo> portInfoCache{};
+
+/**
+ * @brief Generation of the cached serial port information list
+ *
+ */
+std::atomic<unsigned long> portInfoGeneration{0};
+
+/**
+ * @brief Mutex guarding the cached serial port information list
+ *
+ */
+std::mutex portInfoMutex{};
+
+#ifdef __linux__
+/**
+ * @brief Sysfs tty class directory
+ *
+ */
+constexpr char SYSFS_TTY_CLASS[]{"/sys/class/tty/"};
+
+/**
+ * @brief Persistent serial port by-id directory
+ *
+ */
+constexpr char SERIAL_BY_ID[]{"/dev/serial/by-id/"};
+
+/**
+ * @brief Read a single line sysfs attribute
+ *
+ * @param path Attribute path
+ * @return std::string Attribute value without trailing whitespace
+ */
+std::string readAttribute(const std::string& path)
+{
+    const auto fileDescriptor{systemCall(::open, path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fileDescriptor == INVALID_FILE_DESCRIPTOR)
+        return {};
+
+    char data[256];
+    const auto size{systemCall(::read, fileDescriptor, data, sizeof(data))};
+    systemCall(::close, fileDescriptor);
+    if (size <= 0)
+        return {};
+
+    std::string result(data, static_cast<size_t>(size));
+    while (!result.empty() && ((result.back() == '\n') || (result.back() == ' ')))
+        result.pop_back();
+    return result;
+}
+
+/**
+ * @brief Resolve a path to its canonical form
+ *
+ * @param path Path
+ * @return std::string Canonical path or an empty string on failure
+ */
+std::string resolvePath(const std::string& path)
+{
+    char resolved[PATH_MAX];
+    return ((realpath(path.c_str(), resolved) != nullptr) ? std::string(resolved) : std::string());
+}
+
+/**
+ * @brief Get the parent directory of a path
+ *
+ * @param path Path
+ * @return std::string Parent directory
+ */
+std::string parentPath(const std::string& path)
+{
+    const auto position{path.rfind('/')};
+    return (((position == std::string::npos) || (position == 0)) ? std::string() : path.substr(0, position));
+}
+
+/**
+ * @brief Collect /dev/serial/by-id links keyed by the port name of their target
+ *
+ * @param byIdDirectory By-id directory including the trailing slash
+ * @return std::map<std::string, std::string> By-id paths keyed by the target port name
+ */
+std::map<std::string, std::string> collectByIdPaths(const std::string& byIdDirectory)
+{
+    std::map<std::string, std::string> result{};
+    auto directory{opendir(byIdDirectory.c_str())};
+    if (directory == nullptr)
+        return result;
+
+    while (const auto entry{readdir(directory)})
+    {
+        if (entry->d_name[0] == '.')
+            continue;
+
+        const auto link{byIdDirectory + entry->d_name};
+        const auto target{resolvePath(link)};
+        if (!target.empty())
+            result.emplace(target.substr(target.rfind('/') + 1), link);
+    }
+    closedir(directory);
+    return result;
+}
+
+/**
+ * @brief Collect the serial port information from the sysfs
+ *
+ * @param ttyClassDirectory Sysfs tty class directory including the trailing slash
+ * @param portName Serial port name
+ * @param byIdPaths By-id paths keyed by the target port name
+ * @param portInfo Serial port information
+ * @return true Serial port is backed by a device
+ * @return false Serial port is virtual or has no hardware present
+ */
+bool collectPortInfo(const std::string& ttyClassDirectory, const std::string& portName,
+    const std::map<std::string, std::string>& byIdPaths, PortInfo& portInfo)
+{
+    const auto classPath{ttyClassDirectory + portName};
+    const auto devicePath{resolvePath(classPath + "/device")};
+    if (devicePath.empty())
+        return false;
+
+    // Legacy 8250 UARTs are registered even without hardware present
+    const auto type{readAttribute(classPath + "/type")};
+    if (!type.empty() && (type == "0"))
+        return false;
+
+    portInfo.portName = portName;
+    portInfo.fileName = Enumerator::serialPortToFileName(portName);
+
+    const auto driverPath{resolvePath(devicePath + "/driver")};
+    portInfo.driver = driverPath.substr(driverPath.rfind('/') + 1);
+
+    // Walk up the device tree to the USB interface and device
+    for (auto path{devicePath}; !path.empty(); path = parentPath(path))
+    {
+        if (portInfo.interfaceNumber < 0)
+        {
+            const auto interfaceNumber{readAttribute(path + "/bInterfaceNumber")};
+            if (!interfaceNumber.empty())
+                portInfo.interfaceNumber = static_cast<int>(std::strtol(interfaceNumber.c_str(), nullptr, 16));
+        }
+
+        const auto vendorId{readAttribute(path + "/idVendor")};
+        if (!vendorId.empty())
+        {
+            portInfo.vendorId = static_cast<unsigned short>(std::strtoul(vendorId.c_str(), nullptr, 16));
+            portInfo.productId = static_cast<unsigned short>(std::strtoul(readAttribute(path + "/idProduct").c_str(), nullptr, 16));
+            portInfo.serialNumber = readAttribute(path + "/serial");
+            portInfo.manufacturer = readAttribute(path + "/manufacturer");
+            portInfo.product = readAttribute(path + "/product");
+            break;
+        }
+    }
+
+    const auto byIdPath{byIdPaths.find(portName)};
+    if (byIdPath != byIdPaths.end())
+        portInfo.byIdPath = byIdPath->second;
+    return true;
+}
+#endif // __linux__
+
+} // namespace
+
+bool PortInfo::isUsb() const
+{
+    return ((vendorId != 0) || (productId != 0));
+}
+
+bool PortInfo::hasStableIdentity() const
+{
+    return ((isUsb() && !serialNumber.empty()) || !byIdPath.empty());
+}
+
+bool PortInfo::isSameDevice(const PortInfo& portInfo) const
+{
+    if (!hasStableIdentity() || !portInfo.hasStableIdentity())
+        return false;
+
+    // USB descriptors identify the device and the interface identifies the port of a multi-port device
+    if (isUsb() && !serialNumber.empty())
+        return ((vendorId == portInfo.vendorId) && (productId == portInfo.productId) &&
+            (serialNumber == portInfo.serialNumber) && (interfaceNumber == portInfo.interfaceNumber));
+
+    return (byIdPath == portInfo.byIdPath);
+}
+
+bool PortInfo::operator==(const PortInfo& portInfo) const
+{
+    return ((portName == portInfo.portName) && (fileName == portInfo.fileName) &&
+        (vendorId == portInfo.vendorId) && (productId == portInfo.productId) &&
+        (serialNumber == portInfo.serialNumber) && (manufacturer == portInfo.manufacturer) &&
+        (product == portInfo.product) && (interfaceNumber == portInfo.interfaceNumber) &&
+        (driver == portInfo.driver) && (byIdPath == portInfo.byIdPath));
+}
+
+bool PortInfo::operator!=(const PortInfo& portInfo) const
+{
+    return !(*this == portInfo);
+}
+
 bool Enumerator::updateSerialPortList(std::vector<std::string>& list)
 {
     bool result{false};
@@ -100,4 +313,99 @@ std::string Enumerator::fileNameToSerialPort(const std::string& fileName)
     return serialPort;
 }
 
+bool Enumerator::updatePortInfoList(std::vector<PortInfo>& list)
+{
+#if defined(__linux__)
+    return updatePortInfoList(list, SYSFS_TTY_CLASS, SERIAL_BY_ID);
+#elif defined(_WIN32) || defined(_WIN64)
+    std::vector<std::string> portNames{};
+    const auto result{updateSerialPortList(portNames)};
+    for (const auto& portName: portNames)
+    {
+        PortInfo portInfo{};
+        portInfo.portName = portName;
+        portInfo.fileName = serialPortToFileName(portName);
+        list.push_back(std::move(portInfo));
+    }
+    return result;
+#endif // __linux__
+}
+
+#ifdef __linux__
+bool Enumerator::updatePortInfoList(std::vector<PortInfo>& list, const std::string& ttyClassDirectory,
+    const std::string& byIdDirectory)
+{
+    bool result{false};
+    const auto byIdPaths{collectByIdPaths(byIdDirectory)};
+    std::vector<std::string> portNames{};
+
+    auto directory{opendir(ttyClassDirectory.c_str())};
+    if (directory == nullptr)
+        return false;
+
+    while (const auto entry{readdir(directory)})
+    {
+        if (entry->d_name[0] != '.')
+            portNames.emplace_back(entry->d_name);
+    }
+    closedir(directory);
+    std::sort(portNames.begin(), portNames.end());
+
+    for (const auto& portName: portNames)
+    {
+        PortInfo portInfo{};
+        if (collectPortInfo(ttyClassDirectory, portName, byIdPaths, portInfo))
+        {
+            result = true;
+            list.push_back(std::move(portInfo));
+        }
+    }
+    return result;
+}
+#endif // __linux__
+
+unsigned long Enumerator::refreshPortInfoCache()
+{
+    std::vector<PortInfo> list{};
+    updatePortInfoList(list);
+
+    std::lock_guard<std::mutex> lock{portInfoMutex};
+    if ((portInfoGeneration.load() == 0) || (list != portInfoCache))
+    {
+        portInfoCache = std::move(list);
+        portInfoGeneration.fetch_add(1);
+    }
+    return portInfoGeneration.load();
+}
+
+std::vector<PortInfo> Enumerator::getPortInfoCache()
+{
+    if (portInfoGeneration.load() == 0)
+        refreshPortInfoCache();
+
+    std::lock_guard<std::mutex> lock{portInfoMutex};
+    return portInfoCache;
+}
+
+unsigned long Enumerator::getPortInfoGeneration()
+{
+    return portInfoGeneration.load();
+}
+
+bool Enumerator::findPortInfo(const std::string& serialPort, PortInfo& portInfo)
+{
+    if (portInfoGeneration.load() == 0)
+        refreshPortInfoCache();
+
+    const auto fileName{serialPortToFileName(serialPort)};
+    std::lock_guard<std::mutex> lock{portInfoMutex};
+    const auto position{std::find_if(portInfoCache.begin(), portInfoCache.end(),
+        [&fileName](const PortInfo& info) { return (info.fileName == fileName); })};
+    if (position == portInfoCache.end())
+        return false;
+
+    portInfo = *position;
+    return true;
+}
+
 END_NAMESPACE_LIBSERIAL
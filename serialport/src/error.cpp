@@ -0,0 +1,130 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windef.h>
+    #include <winbase.h>
+#endif // _WIN32 || _WIN64
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+
+/**
+ * @brief SerialErrorCategory class
+ *
+ */
+class SerialErrorCategory final : public std::error_category
+{
+public:
+    /**
+     * @brief Get the category name
+     *
+     * @return const char* Category name
+     */
+    const char* name() const noexcept override
+    {
+        return "serial";
+    }
+
+    /**
+     * @brief Get the error message
+     *
+     * @param value Error value
+     * @return std::string Error message
+     */
+    std::string message(int value) const override
+    {
+        switch (static_cast<SerialError>(value))
+        {
+            case SerialError::SERIAL_ERROR_WOULD_BLOCK:
+                return "Operation would block";
+
+            case SerialError::SERIAL_ERROR_HANGUP:
+                return "Device hung up";
+
+            case SerialError::SERIAL_ERROR_NOT_OPEN:
+                return "Serial port is not open";
+
+            case SerialError::SERIAL_ERROR_NOT_SUPPORTED:
+                return "Not supported";
+
+            default:
+                return "Unknown serial port error";
+        }
+    }
+
+    /**
+     * @brief Map an error value to a portable error condition
+     *
+     * @param value Error value
+     * @return std::error_condition Error condition
+     */
+    std::error_condition default_error_condition(int value) const noexcept override
+    {
+        switch (static_cast<SerialError>(value))
+        {
+            case SerialError::SERIAL_ERROR_WOULD_BLOCK:
+                return std::errc::operation_would_block;
+
+            case SerialError::SERIAL_ERROR_NOT_OPEN:
+                return std::errc::bad_file_descriptor;
+
+            case SerialError::SERIAL_ERROR_NOT_SUPPORTED:
+                return std::errc::invalid_argument;
+
+            case SerialError::SERIAL_ERROR_HANGUP:
+            default:
+                return std::error_condition(value, *this);
+        }
+    }
+};
+
+} // namespace
+
+const std::error_category& getSerialErrorCategory() noexcept
+{
+    static const SerialErrorCategory category{};
+    return category;
+}
+
+std::error_code make_error_code(SerialError serialError) noexcept
+{
+    return std::error_code(static_cast<int>(serialError), getSerialErrorCategory());
+}
+
+std::error_code getLastError() noexcept
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return std::error_code(static_cast<int>(GetLastError()), std::system_category());
+#else
+    return std::error_code(errno, std::system_category());
+#endif // _WIN32 || _WIN64
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_decoder.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+size_t FrameLayout::getHeaderSize() const
+{
+    return std::max(syncPattern.size(), lengthOffset + lengthSize);
+}
+
+FrameDecoder::FrameDecoder(SerialPort& serialPort, const FrameLayout& frameLayout, size_t bufferSize) :
+    serialPort{serialPort}, frameLayout{frameLayout}, headerSize{frameLayout.getHeaderSize()},
+    buffer{}, frameBegin{0}, bufferEnd{0}, frameCount{0}, resyncCount{0}, discardedCount{0}
+{
+    if ((frameLayout.lengthSize == 0) || (frameLayout.lengthSize > sizeof(unsigned long long)))
+        throw std::runtime_error("Invalid length field size");
+    if ((frameLayout.maxFrameSize < headerSize) || (frameLayout.maxFrameSize == 0))
+        throw std::runtime_error("Invalid maximum frame size");
+
+    buffer.resize(std::max(bufferSize, frameLayout.maxFrameSize));
+}
+
+bool FrameDecoder::readFrame(std::string_view& frame)
+{
+    if (nextFrame(frame))
+        return true;
+
+    return ((fill() > 0) && nextFrame(frame));
+}
+
+bool FrameDecoder::nextFrame(std::string_view& frame)
+{
+    while (synchronize())
+    {
+        // Wait for the whole header
+        const auto available{bufferEnd - frameBegin};
+        if (available < headerSize)
+            return false;
+
+        // Invalid length is a corrupted or false sync pattern
+        const auto frameSize{decodeFrameSize()};
+        if (frameSize == 0)
+        {
+            ++resyncCount;
+            discard(1);
+            continue;
+        }
+
+        // Wait for the whole frame
+        if (available < frameSize)
+            return false;
+
+        const std::string_view result{buffer.data() + frameBegin, frameSize};
+        if (frameLayout.validator && !frameLayout.validator(result))
+        {
+            ++resyncCount;
+            discard(1);
+            continue;
+        }
+
+        frameBegin += frameSize;
+        ++frameCount;
+        frame = result;
+        return true;
+    }
+    return false;
+}
+
+size_t FrameDecoder::fill()
+{
+    const auto space{prepareSpace()};
+    if (space == 0)
+        return 0;
+
+    const auto result{serialPort.read(buffer.data() + bufferEnd, space)};
+    if ((result == 0) || (result == static_cast<size_t>(-1)))
+        return 0;
+
+    bufferEnd += result;
+    return result;
+}
+
+size_t FrameDecoder::feed(const char* data, size_t size)
+{
+    const auto result{std::min(size, prepareSpace())};
+    std::memcpy(buffer.data() + bufferEnd, data, result);
+    bufferEnd += result;
+    return result;
+}
+
+void FrameDecoder::reset()
+{
+    frameBegin = 0;
+    bufferEnd = 0;
+}
+
+size_t FrameDecoder::getBufferedSize() const
+{
+    return (bufferEnd - frameBegin);
+}
+
+const FrameLayout& FrameDecoder::getFrameLayout() const
+{
+    return frameLayout;
+}
+
+unsigned long FrameDecoder::getFrameCount() const
+{
+    return frameCount;
+}
+
+unsigned long FrameDecoder::getResyncCount() const
+{
+    return resyncCount;
+}
+
+unsigned long FrameDecoder::getDiscardedCount() const
+{
+    return discardedCount;
+}
+
+bool FrameDecoder::synchronize()
+{
+    const auto& syncPattern{frameLayout.syncPattern};
+    const auto syncSize{syncPattern.size()};
+    while (syncSize > 0)
+    {
+        const auto available{bufferEnd - frameBegin};
+        if (available < syncSize)
+            return false;
+
+        const auto data{buffer.data() + frameBegin};
+        if (std::memcmp(data, syncPattern.data(), syncSize) == 0)
+            return true;
+
+        // Skip to the next candidate, keeping a sync pattern split across reads
+        const auto offset{findByte(data + 1, available - 1, syncPattern.front()) + 1};
+        discard(std::min(offset, available - std::min(available, syncSize - 1)));
+        if (offset == available)
+            return false;
+    }
+    return (frameBegin < bufferEnd);
+}
+
+size_t FrameDecoder::decodeFrameSize() const
+{
+    const auto field{reinterpret_cast<const unsigned char*>(buffer.data() + frameBegin + frameLayout.lengthOffset)};
+    unsigned long long value{0};
+    for (size_t index{0}; index < frameLayout.lengthSize; ++index)
+    {
+        const auto position{(frameLayout.lengthEndianness == Endianness::ENDIANNESS_BIG) ?
+            index : (frameLayout.lengthSize - 1 - index)};
+        value = (value << 8) | field[position];
+    }
+
+    // Frame must hold at least its header and fit into the buffer
+    const auto frameSize{static_cast<long long>(value) + frameLayout.lengthAdjustment};
+    if ((value > frameLayout.maxFrameSize) || (frameSize < static_cast<long long>(headerSize)) ||
+        (frameSize > static_cast<long long>(frameLayout.maxFrameSize)))
+        return 0;
+    return static_cast<size_t>(frameSize);
+}
+
+void FrameDecoder::discard(size_t size)
+{
+    frameBegin += size;
+    discardedCount += size;
+}
+
+size_t FrameDecoder::prepareSpace()
+{
+    // Cheap rewind once all frames are consumed
+    if (frameBegin == bufferEnd)
+    {
+        frameBegin = 0;
+        bufferEnd = 0;
+    }
+
+    // Move the partial frame to the front only when it may not fit the buffer tail
+    const auto capacity{buffer.size()};
+    if ((frameBegin > 0) && ((capacity - frameBegin) < frameLayout.maxFrameSize))
+    {
+        const auto size{bufferEnd - frameBegin};
+        std::memmove(buffer.data(), buffer.data() + frameBegin, size);
+        bufferEnd = size;
+        frameBegin = 0;
+    }
+    return (capacity - bufferEnd);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,182 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_reader.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+FrameReader::FrameReader(SerialPort& serialPort, const std::string& delimiter, size_t bufferSize) :
+    serialPort{serialPort}, delimiter{delimiter}, buffer{}, frameBegin{0}, scanPosition{0},
+    bufferEnd{0}, discarding{false}, frameCount{0}, overflowCount{0}
+{
+    if (delimiter.empty())
+        throw std::runtime_error("Delimiter is empty");
+
+    // Buffer must hold at least a delimiter split across two reads
+    buffer.resize(std::max(bufferSize, delimiter.size() * 2));
+}
+
+bool FrameReader::readFrame(std::string_view& frame)
+{
+    if (nextFrame(frame))
+        return true;
+
+    return ((fill() > 0) && nextFrame(frame));
+}
+
+bool FrameReader::nextFrame(std::string_view& frame)
+{
+    const auto delimiterSize{delimiter.size()};
+    while (scanPosition < bufferEnd)
+    {
+        // Search for the first delimiter byte only in data not scanned before
+        const auto offset{findByte(buffer.data() + scanPosition, bufferEnd - scanPosition, delimiter.front())};
+        const auto position{scanPosition + offset};
+        if (position == bufferEnd)
+        {
+            scanPosition = bufferEnd;
+            break;
+        }
+
+        // Resume at a delimiter split across reads once more data arrives
+        if ((position + delimiterSize) > bufferEnd)
+        {
+            scanPosition = position;
+            break;
+        }
+
+        if ((delimiterSize > 1) && (std::memcmp(buffer.data() + position + 1, delimiter.data() + 1, delimiterSize - 1) != 0))
+        {
+            scanPosition = position + 1;
+            continue;
+        }
+
+        const std::string_view result{buffer.data() + frameBegin, position - frameBegin};
+        frameBegin = position + delimiterSize;
+        scanPosition = frameBegin;
+
+        // Remainder of an oversized frame ends at the delimiter
+        if (discarding)
+        {
+            discarding = false;
+            continue;
+        }
+
+        ++frameCount;
+        frame = result;
+        return true;
+    }
+    return false;
+}
+
+size_t FrameReader::fill()
+{
+    const auto space{prepareSpace()};
+    if (space == 0)
+        return 0;
+
+    const auto result{serialPort.read(buffer.data() + bufferEnd, space)};
+    if ((result == 0) || (result == static_cast<size_t>(-1)))
+        return 0;
+
+    bufferEnd += result;
+    return result;
+}
+
+size_t FrameReader::feed(const char* data, size_t size)
+{
+    const auto result{std::min(size, prepareSpace())};
+    std::memcpy(buffer.data() + bufferEnd, data, result);
+    bufferEnd += result;
+    return result;
+}
+
+void FrameReader::reset()
+{
+    frameBegin = 0;
+    scanPosition = 0;
+    bufferEnd = 0;
+    discarding = false;
+}
+
+size_t FrameReader::getBufferedSize() const
+{
+    return (bufferEnd - frameBegin);
+}
+
+const std::string& FrameReader::getDelimiter() const
+{
+    return delimiter;
+}
+
+unsigned long FrameReader::getFrameCount() const
+{
+    return frameCount;
+}
+
+unsigned long FrameReader::getOverflowCount() const
+{
+    return overflowCount;
+}
+
+size_t FrameReader::prepareSpace()
+{
+    // Cheap rewind once all frames are consumed
+    if (frameBegin == bufferEnd)
+    {
+        frameBegin = 0;
+        scanPosition = 0;
+        bufferEnd = 0;
+    }
+
+    // Move the partial frame to the front only when the buffer tail is short
+    const auto capacity{buffer.size()};
+    if ((frameBegin > 0) && ((capacity - bufferEnd) < (capacity / 4)))
+    {
+        const auto size{bufferEnd - frameBegin};
+        std::memmove(buffer.data(), buffer.data() + frameBegin, size);
+        scanPosition -= frameBegin;
+        bufferEnd = size;
+        frameBegin = 0;
+    }
+
+    // Buffer full of data without a delimiter holds an oversized frame
+    const auto keep{delimiter.size() - 1};
+    if ((bufferEnd == capacity) && (frameBegin == 0) && (scanPosition >= (bufferEnd - keep)))
+    {
+        // Keep a possibly split delimiter and drop everything before it
+        std::memmove(buffer.data(), buffer.data() + bufferEnd - keep, keep);
+        scanPosition -= (bufferEnd - keep);
+        bufferEnd = keep;
+        if (!discarding)
+            ++overflowCount;
+        discarding = true;
+    }
+    return (capacity - bufferEnd);
+}
+
+END_NAMESPACE_LIBSERIAL
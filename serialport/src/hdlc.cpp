@@ -0,0 +1,325 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+#include <serialport/scan.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/hdlc.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Update the CRC register of a frame check sequence
+     *
+     * @param frameCheck Frame check sequence
+     * @param crc CRC register
+     * @param data Data
+     * @param size Size of the data
+     * @return uint32_t Updated CRC register
+     */
+    inline uint32_t updateCrc(HdlcFrameCheck frameCheck, uint32_t crc, const char* data, size_t size)
+    {
+        return ((frameCheck == HdlcFrameCheck::HDLC_FRAME_CHECK_32) ?
+            Crc32::update(crc, data, size) : Crc16X25::update(static_cast<uint16_t>(crc), data, size));
+    }
+
+    /**
+     * @brief Get the initial CRC register value of a frame check sequence
+     *
+     * @param frameCheck Frame check sequence
+     * @return uint32_t Initial CRC register value
+     */
+    inline uint32_t getInitialValue(HdlcFrameCheck frameCheck)
+    {
+        return ((frameCheck == HdlcFrameCheck::HDLC_FRAME_CHECK_32) ? Crc32::initialize() : Crc16X25::initialize());
+    }
+
+    /**
+     * @brief Get the CRC register value after a frame with a valid frame check sequence
+     *
+     * @param frameCheck Frame check sequence
+     * @return uint32_t Good CRC residue
+     */
+    inline uint32_t getGoodResidue(HdlcFrameCheck frameCheck)
+    {
+        return ((frameCheck == HdlcFrameCheck::HDLC_FRAME_CHECK_32) ? 0xDEBB20E3U : 0xF0B8U);
+    }
+
+    /**
+     * @brief Escape data into an output buffer
+     *
+     * @param data Data
+     * @param size Size of the data
+     * @param output Output buffer
+     * @return size_t Size of the escaped data
+     */
+    size_t escape(const char* data, size_t size, char* output)
+    {
+        size_t result{0};
+        size_t offset{0};
+        while (true)
+        {
+            const auto count{findEitherByte(data + offset, size - offset, HDLC_FLAG, HDLC_ESCAPE)};
+            std::memcpy(output + result, data + offset, count);
+            result += count;
+            offset += count;
+            if (offset == size)
+                break;
+
+            output[result++] = HDLC_ESCAPE;
+            output[result++] = static_cast<char>(data[offset++] ^ HDLC_ESCAPE_MASK);
+        }
+        return result;
+    }
+} // namespace
+
+HdlcCodec::HdlcCodec(SerialPort& serialPort, HdlcFrameCheck frameCheck, size_t maxFrameSize, size_t bufferSize) :
+    serialPort{serialPort}, frameCheck{frameCheck}, receiveBuffer(std::max<size_t>(bufferSize, 1)),
+    receiveBegin{0}, receiveEnd{0}, frameBuffer(maxFrameSize + getFrameCheckSize(frameCheck)),
+    frameSize{0}, crc{getInitialValue(frameCheck)}, escaped{false}, hunting{true}, overflow{false},
+    transmitBuffer(getMaxEncodedSize(maxFrameSize, frameCheck)), statistics{}
+{
+
+}
+
+bool HdlcCodec::readFrame(std::string_view& frame)
+{
+    if (nextFrame(frame))
+        return true;
+
+    return ((fill() > 0) && nextFrame(frame));
+}
+
+bool HdlcCodec::nextFrame(std::string_view& frame)
+{
+    const auto frameCheckSize{getFrameCheckSize(frameCheck)};
+    while (receiveBegin < receiveEnd)
+    {
+        const auto data{receiveBuffer.data() + receiveBegin};
+        const auto available{receiveEnd - receiveBegin};
+
+        // Byte following an escape byte
+        if (escaped)
+        {
+            escaped = false;
+            ++receiveBegin;
+            if (*data == HDLC_FLAG)
+            {
+                ++statistics.abortCount;
+                restartFrame();
+                continue;
+            }
+
+            const auto value{static_cast<char>(*data ^ HDLC_ESCAPE_MASK)};
+            append(&value, 1);
+            continue;
+        }
+
+        // Unescaped data up to the next flag or escape byte is appended in bulk
+        const auto count{findEitherByte(data, available, HDLC_FLAG, HDLC_ESCAPE)};
+        if (!hunting)
+            append(data, count);
+        receiveBegin += count;
+        if (count == available)
+            break;
+
+        ++receiveBegin;
+        if (data[count] == HDLC_ESCAPE)
+        {
+            escaped = !hunting;
+            continue;
+        }
+
+        // Flag without a frame in progress
+        hunting = false;
+        if ((frameSize == 0) && !overflow)
+        {
+            ++statistics.idleFlagCount;
+            continue;
+        }
+
+        if (overflow)
+        {
+            ++statistics.overflowCount;
+        }
+        else if (frameSize < frameCheckSize)
+        {
+            ++statistics.runtCount;
+        }
+        else if (crc != getGoodResidue(frameCheck))
+        {
+            ++statistics.crcErrorCount;
+        }
+        else
+        {
+            ++statistics.frameCount;
+            frame = std::string_view{frameBuffer.data(), frameSize - frameCheckSize};
+            restartFrame();
+            return true;
+        }
+        restartFrame();
+    }
+    return false;
+}
+
+size_t HdlcCodec::fill()
+{
+    const auto space{prepareSpace()};
+    if (space == 0)
+        return 0;
+
+    const auto result{serialPort.read(receiveBuffer.data() + receiveEnd, space)};
+    if ((result == 0) || (result == static_cast<size_t>(-1)))
+        return 0;
+
+    receiveEnd += result;
+    return result;
+}
+
+size_t HdlcCodec::feed(const char* data, size_t size)
+{
+    const auto result{std::min(size, prepareSpace())};
+    std::memcpy(receiveBuffer.data() + receiveEnd, data, result);
+    receiveEnd += result;
+    return result;
+}
+
+void HdlcCodec::reset()
+{
+    receiveBegin = 0;
+    receiveEnd = 0;
+    escaped = false;
+    hunting = true;
+    restartFrame();
+}
+
+bool HdlcCodec::writeFrame(const char* data, size_t size, std::chrono::milliseconds timeout)
+{
+    const auto maxSize{getMaxEncodedSize(size, frameCheck)};
+    if (maxSize > transmitBuffer.size())
+        transmitBuffer.resize(maxSize);
+
+    // Frame is written whole, a partially written frame can not be resumed
+    const auto encodedSize{encode(data, size, transmitBuffer.data(), frameCheck)};
+    std::error_code error{};
+    return (serialPort.writeAll(transmitBuffer.data(), encodedSize, timeout, error) == encodedSize);
+}
+
+bool HdlcCodec::isIdle() const
+{
+    return ((frameSize == 0) && !overflow && !escaped);
+}
+
+HdlcFrameCheck HdlcCodec::getFrameCheck() const
+{
+    return frameCheck;
+}
+
+HdlcStatistics HdlcCodec::getStatistics() const
+{
+    return statistics;
+}
+
+size_t HdlcCodec::getFrameCheckSize(HdlcFrameCheck frameCheck)
+{
+    return ((frameCheck == HdlcFrameCheck::HDLC_FRAME_CHECK_32) ? 4 : 2);
+}
+
+size_t HdlcCodec::getMaxEncodedSize(size_t size, HdlcFrameCheck frameCheck)
+{
+    // Every byte escaped and the opening and closing flags
+    return (((size + getFrameCheckSize(frameCheck)) * 2) + 2);
+}
+
+size_t HdlcCodec::encode(const char* data, size_t size, char* output, HdlcFrameCheck frameCheck)
+{
+    size_t result{0};
+    output[result++] = HDLC_FLAG;
+    result += escape(data, size, output + result);
+
+    // Frame check sequence is transmitted least significant byte first
+    const auto value{calculateFrameCheck(data, size, frameCheck)};
+    char frameCheckBytes[4];
+    const auto frameCheckSize{getFrameCheckSize(frameCheck)};
+    for (size_t index{0}; index < frameCheckSize; ++index)
+        frameCheckBytes[index] = static_cast<char>((value >> (index * 8)) & 0xFF);
+    result += escape(frameCheckBytes, frameCheckSize, output + result);
+
+    output[result++] = HDLC_FLAG;
+    return result;
+}
+
+uint32_t HdlcCodec::calculateFrameCheck(const char* data, size_t size, HdlcFrameCheck frameCheck)
+{
+    return ((frameCheck == HdlcFrameCheck::HDLC_FRAME_CHECK_32) ?
+        Crc32::calculate(data, size) : Crc16X25::calculate(data, size));
+}
+
+void HdlcCodec::append(const char* data, size_t size)
+{
+    if (overflow || (size == 0))
+        return;
+
+    if ((frameSize + size) > frameBuffer.size())
+    {
+        overflow = true;
+        return;
+    }
+
+    std::memcpy(frameBuffer.data() + frameSize, data, size);
+    frameSize += size;
+    crc = updateCrc(frameCheck, crc, data, size);
+}
+
+void HdlcCodec::restartFrame()
+{
+    frameSize = 0;
+    crc = getInitialValue(frameCheck);
+    overflow = false;
+}
+
+size_t HdlcCodec::prepareSpace()
+{
+    // Received data is moved into the frame buffer as it is processed
+    if (receiveBegin == receiveEnd)
+    {
+        receiveBegin = 0;
+        receiveEnd = 0;
+    }
+    else if (receiveBegin > 0)
+    {
+        const auto size{receiveEnd - receiveBegin};
+        std::memmove(receiveBuffer.data(), receiveBuffer.data() + receiveBegin, size);
+        receiveBegin = 0;
+        receiveEnd = size;
+    }
+    return (receiveBuffer.size() - receiveEnd);
+}
+
+END_NAMESPACE_LIBSERIAL
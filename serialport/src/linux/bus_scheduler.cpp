@@ -0,0 +1,517 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/bus_scheduler.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+BusScheduler::BusScheduler(SerialPort& serialPort, ResponseExtractor responseExtractor, size_t bufferSize) :
+    serialPort{serialPort}, responseExtractor{std::move(responseExtractor)}, stopEvent{INVALID_FILE_DESCRIPTOR},
+    stopped{false}, failed{false}, devices{}, scheduled{false}, activeDevice{INVALID_INDEX}, request{}, transmitOffset{0},
+    transmitting{false}, requestTime{}, responseDeadline{}, idleTime{}, responseTimeout{100000}, turnaroundDelay{0},
+    maxBackoff{DEFAULT_BUS_MAX_BACKOFF}, offlineThreshold{DEFAULT_BUS_OFFLINE_THRESHOLD}, buffer(bufferSize),
+    bufferEnd{0}, byteTime{0.0}, statisticsTime{}, statistics{}
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+    if (bufferSize == 0)
+        throw std::out_of_range("Invalid buffer size");
+
+    resetStatistics();
+
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopEvent == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create event");
+}
+
+BusScheduler::~BusScheduler() noexcept
+{
+    systemCall(::close, stopEvent);
+}
+
+size_t BusScheduler::addDevice(std::string request, size_t responseSize, std::chrono::microseconds period,
+    unsigned priority, PollHandler pollHandler)
+{
+    if (request.empty() || (responseSize == 0) || (responseSize > buffer.size()) || (period.count() <= 0))
+        throw std::out_of_range("Invalid bus device");
+
+    devices.push_back(Device{std::move(request), responseSize, period, priority, std::move(pollHandler), true, 1, 0,
+        std::chrono::steady_clock::time_point{}, std::chrono::microseconds{0}, BusDeviceStatistics{}});
+    scheduled = false;
+    return (devices.size() - 1);
+}
+
+size_t BusScheduler::getDeviceCount() const
+{
+    return devices.size();
+}
+
+void BusScheduler::setRequest(size_t device, std::string request)
+{
+    getDevice(device);
+    if (request.empty())
+        throw std::out_of_range("Invalid poll request");
+
+    devices[device].request = std::move(request);
+}
+
+std::chrono::microseconds BusScheduler::getPeriod(size_t device) const
+{
+    return getDevice(device).period;
+}
+
+void BusScheduler::setPeriod(size_t device, std::chrono::microseconds period)
+{
+    getDevice(device);
+    if (period.count() <= 0)
+        throw std::out_of_range("Invalid poll period");
+
+    devices[device].period = period;
+    scheduled = false;
+}
+
+void BusScheduler::setEnabled(size_t device, bool enabled)
+{
+    getDevice(device);
+    devices[device].enabled = enabled;
+}
+
+bool BusScheduler::isOnline(size_t device) const
+{
+    return (getDevice(device).timeoutCount < offlineThreshold);
+}
+
+unsigned BusScheduler::getBackoff(size_t device) const
+{
+    return getDevice(device).backoff;
+}
+
+size_t BusScheduler::poll(std::chrono::milliseconds timeout)
+{
+    // Nothing to wait for on a failed serial port
+    if (failed)
+        return 0;
+
+    const auto failedCount{statistics.failedCount};
+    start();
+
+    // Wake up for the deadline of the active poll or the next due device
+    const auto now{std::chrono::steady_clock::now()};
+    auto deadline{now + timeout};
+    if (activeDevice == INVALID_INDEX)
+        deadline = std::min(deadline, getNextPollTime());
+    else
+        deadline = std::min(deadline, responseDeadline);
+    const auto remaining{toTimespec(std::max(std::chrono::steady_clock::duration::zero(), deadline - now))};
+
+    const auto events{static_cast<short>(POLLIN | (transmitting ? POLLOUT : 0))};
+    struct pollfd descriptors[2]{{serialPort.getNativeHandle(), events, 0}, {stopEvent, POLLIN, 0}};
+    if (failed || (systemCall(::ppoll, descriptors, 2, &remaining, nullptr) < 0))
+        return static_cast<size_t>(statistics.failedCount - failedCount);
+
+    size_t count{0};
+    if (((descriptors[0].revents & POLLOUT) != 0) && transmitting)
+        transmit();
+    if (!failed && ((descriptors[0].revents & POLLIN) != 0))
+        count += receive();
+
+    // A response received before a hang-up is still completed
+    if (!failed && ((descriptors[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0))
+        fail();
+
+    if ((descriptors[1].revents & POLLIN) != 0)
+    {
+        uint64_t value{0};
+        systemCall(::read, stopEvent, &value, sizeof(value));
+        stopped = true;
+    }
+
+    // A complete response takes precedence over a deadline expiring at the same time
+    if ((activeDevice != INVALID_INDEX) && (std::chrono::steady_clock::now() >= responseDeadline))
+    {
+        finish(PollStatus::POLL_TIMEOUT, std::string_view());
+        ++count;
+    }
+
+    start();
+    return (count + static_cast<size_t>(statistics.failedCount - failedCount));
+}
+
+void BusScheduler::run()
+{
+    stopped = false;
+    while (!stopped && !failed)
+        poll(std::chrono::milliseconds{1000});
+}
+
+void BusScheduler::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+bool BusScheduler::isFailed() const
+{
+    return failed;
+}
+
+std::chrono::microseconds BusScheduler::getResponseTimeout() const
+{
+    return responseTimeout;
+}
+
+void BusScheduler::setResponseTimeout(std::chrono::microseconds responseTimeout)
+{
+    this->responseTimeout = responseTimeout;
+}
+
+std::chrono::microseconds BusScheduler::getTurnaroundDelay() const
+{
+    return turnaroundDelay;
+}
+
+void BusScheduler::setTurnaroundDelay(std::chrono::microseconds turnaroundDelay)
+{
+    this->turnaroundDelay = turnaroundDelay;
+    scheduled = false;
+}
+
+unsigned BusScheduler::getMaxBackoff() const
+{
+    return maxBackoff;
+}
+
+void BusScheduler::setMaxBackoff(unsigned maxBackoff)
+{
+    if (maxBackoff == 0)
+        throw std::out_of_range("Invalid maximum backoff");
+
+    this->maxBackoff = maxBackoff;
+}
+
+unsigned BusScheduler::getOfflineThreshold() const
+{
+    return offlineThreshold;
+}
+
+void BusScheduler::setOfflineThreshold(unsigned offlineThreshold)
+{
+    this->offlineThreshold = offlineThreshold;
+}
+
+double BusScheduler::getLoad() const
+{
+    double load{0.0};
+    for (const auto& device: devices)
+    {
+        if (device.enabled)
+            load += std::chrono::duration<double>(getCost(device)).count() / std::chrono::duration<double>(device.period).count();
+    }
+    return load;
+}
+
+double BusScheduler::getUtilisation() const
+{
+    // Transmitted and received data share a half-duplex line
+    const auto elapsed{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statisticsTime).count()};
+    const auto count{static_cast<double>(statistics.transmittedCount + statistics.receivedCount)};
+    return ((elapsed > 0.0) ? ((count * byteTime) / elapsed) : 0.0);
+}
+
+double BusScheduler::getPollRate(size_t device) const
+{
+    const auto elapsed{std::chrono::duration<double>(std::chrono::steady_clock::now() - statisticsTime).count()};
+    return ((elapsed > 0.0) ? (static_cast<double>(getDevice(device).statistics.pollCount) / elapsed) : 0.0);
+}
+
+BusDeviceStatistics BusScheduler::getDeviceStatistics(size_t device) const
+{
+    return getDevice(device).statistics;
+}
+
+BusStatistics BusScheduler::getStatistics() const
+{
+    return statistics;
+}
+
+void BusScheduler::resetStatistics()
+{
+    byteTime = calculateTime(serialPort.getBaudRate(), serialPort.getCharacterSize(), serialPort.getParity(),
+        serialPort.getStopBit());
+    statisticsTime = std::chrono::steady_clock::now();
+    statistics = BusStatistics{};
+    for (auto& device: devices)
+        device.statistics = BusDeviceStatistics{};
+}
+
+const BusScheduler::Device& BusScheduler::getDevice(size_t device) const
+{
+    if (device >= devices.size())
+        throw std::out_of_range("Invalid device index");
+
+    return devices[device];
+}
+
+std::chrono::steady_clock::duration BusScheduler::getCost(const Device& device) const
+{
+    const auto wireTime{static_cast<double>(device.request.size() + device.responseSize) * byteTime};
+    return (std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(wireTime)) + turnaroundDelay);
+}
+
+void BusScheduler::schedule(std::chrono::steady_clock::time_point now)
+{
+    // Place the devices by priority and then by rate
+    std::vector<size_t> order(devices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t first, size_t second)
+    {
+        if (devices[first].priority != devices[second].priority)
+            return (devices[first].priority > devices[second].priority);
+        return (devices[first].period < devices[second].period);
+    });
+
+    // Each device starts where the transaction of the previous one ends
+    std::chrono::steady_clock::duration offset{0};
+    for (const auto index: order)
+    {
+        auto& device{devices[index]};
+        if (!device.enabled)
+            continue;
+
+        device.nextPoll = now + (offset % device.period);
+        offset += getCost(device);
+    }
+    scheduled = true;
+}
+
+size_t BusScheduler::select(std::chrono::steady_clock::time_point now) const
+{
+    size_t selected{INVALID_INDEX};
+    for (size_t index{0}; index < devices.size(); ++index)
+    {
+        const auto& device{devices[index]};
+        if (!device.enabled || (device.nextPoll > now))
+            continue;
+
+        if ((selected == INVALID_INDEX) || (device.priority > devices[selected].priority) ||
+            ((device.priority == devices[selected].priority) && (device.nextPoll < devices[selected].nextPoll)))
+            selected = index;
+    }
+    return selected;
+}
+
+std::chrono::steady_clock::time_point BusScheduler::getNextPollTime() const
+{
+    if (!scheduled)
+        return idleTime;
+
+    auto nextPoll{std::chrono::steady_clock::time_point::max()};
+    for (const auto& device: devices)
+    {
+        if (device.enabled)
+            nextPoll = std::min(nextPoll, device.nextPoll);
+    }
+    return ((nextPoll == std::chrono::steady_clock::time_point::max()) ? nextPoll : std::max(nextPoll, idleTime));
+}
+
+void BusScheduler::start()
+{
+    if (failed || (activeDevice != INVALID_INDEX) || devices.empty())
+        return;
+
+    const auto now{std::chrono::steady_clock::now()};
+    if (!scheduled)
+        schedule(now);
+    if (now < idleTime)
+        return;
+
+    const auto index{select(now)};
+    if (index == INVALID_INDEX)
+        return;
+
+    // Jitter is the change of the delay after the scheduled time between two polls
+    auto& device{devices[index]};
+    const auto lateness{std::chrono::duration_cast<std::chrono::microseconds>(now - device.nextPoll)};
+    if (device.statistics.pollCount > 0)
+    {
+        const auto jitter{std::chrono::microseconds{std::abs((lateness - device.lateness).count())}};
+        device.statistics.maxJitter = std::max(device.statistics.maxJitter, jitter);
+        device.statistics.totalJitter += jitter;
+    }
+    device.lateness = lateness;
+    device.statistics.maxLateness = std::max(device.statistics.maxLateness, lateness);
+    device.statistics.totalLateness += lateness;
+
+    // Skip the polls missed on an overloaded bus to keep the phase
+    const auto period{device.period * device.backoff};
+    device.nextPoll += period;
+    if (device.nextPoll <= now)
+    {
+        const auto missed{((now - device.nextPoll) / period) + 1};
+        device.nextPoll += period * missed;
+        device.statistics.overrunCount += static_cast<uint64_t>(missed);
+    }
+
+    ++device.statistics.pollCount;
+    ++statistics.pollCount;
+    activeDevice = index;
+    request.assign(device.request);
+    transmitOffset = 0;
+    transmitting = true;
+    bufferEnd = 0;
+
+    // Request which can not be written within its wire time times out as well
+    const auto pending{serialPort.getOutputQueueCount()};
+    responseDeadline = now + responseTimeout + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(static_cast<double>(pending + request.size()) * byteTime));
+    transmit();
+}
+
+void BusScheduler::transmit()
+{
+    while (transmitOffset < request.size())
+    {
+        std::error_code error{};
+        const auto count{serialPort.write(request.data() + transmitOffset, request.size() - transmitOffset, error)};
+        if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+        {
+            fail();
+            return;
+        }
+        if (count == 0)
+            return;
+
+        transmitOffset += count;
+        statistics.transmittedCount += count;
+    }
+
+    // Response timeout starts once the request left the wire
+    const auto pending{serialPort.getOutputQueueCount()};
+    requestTime = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(static_cast<double>(pending) * byteTime));
+    responseDeadline = requestTime + responseTimeout;
+    transmitting = false;
+}
+
+size_t BusScheduler::receive()
+{
+    std::error_code error{};
+    const auto count{serialPort.read(buffer.data() + bufferEnd, buffer.size() - bufferEnd, error)};
+    if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+    {
+        fail();
+        return 0;
+    }
+    if (count == 0)
+        return 0;
+
+    statistics.receivedCount += count;
+    if ((activeDevice == INVALID_INDEX) || transmitting)
+    {
+        statistics.discardedCount += count;
+        return 0;
+    }
+
+    bufferEnd += count;
+    const std::string_view data(buffer.data(), bufferEnd);
+    const auto responseSize{devices[activeDevice].responseSize};
+    const auto size{responseExtractor ? responseExtractor(data) : ((bufferEnd >= responseSize) ? responseSize : 0)};
+    if ((size > 0) && (size <= bufferEnd))
+    {
+        // Data following the response belongs to no request
+        statistics.discardedCount += bufferEnd - size;
+        finish(PollStatus::POLL_COMPLETED, data.substr(0, size));
+        return 1;
+    }
+
+    if (bufferEnd == buffer.size())
+    {
+        statistics.discardedCount += bufferEnd;
+        bufferEnd = 0;
+    }
+    return 0;
+}
+
+void BusScheduler::finish(PollStatus status, std::string_view response)
+{
+    const auto index{activeDevice};
+    auto& device{devices[index]};
+    const auto now{std::chrono::steady_clock::now()};
+    activeDevice = INVALID_INDEX;
+    transmitting = false;
+    idleTime = now + turnaroundDelay;
+
+    if (status == PollStatus::POLL_COMPLETED)
+    {
+        const auto responseTime{std::chrono::duration_cast<std::chrono::microseconds>(std::max(
+            std::chrono::steady_clock::duration::zero(), now - requestTime))};
+        device.statistics.maxResponseTime = std::max(device.statistics.maxResponseTime, responseTime);
+        device.statistics.totalResponseTime += responseTime;
+        ++device.statistics.responseCount;
+        ++statistics.responseCount;
+
+        // Responding device returns to its poll period
+        if (device.backoff > 1)
+            device.nextPoll = std::min(device.nextPoll, now + device.period);
+        device.backoff = 1;
+        device.timeoutCount = 0;
+    }
+    else if (status == PollStatus::POLL_IO_ERROR)
+    {
+        ++statistics.failedCount;
+    }
+    else
+    {
+        ++device.statistics.timeoutCount;
+        ++statistics.timeoutCount;
+
+        // Silent device gives its bus time to the responding devices
+        ++device.timeoutCount;
+        device.backoff = std::min(device.backoff * 2, maxBackoff);
+        device.nextPoll = std::max(device.nextPoll, now + (device.period * device.backoff));
+    }
+
+    if (device.pollHandler)
+        device.pollHandler(index, status, response);
+    bufferEnd = 0;
+}
+
+void BusScheduler::fail()
+{
+    failed = true;
+    if (activeDevice != INVALID_INDEX)
+        finish(PollStatus::POLL_IO_ERROR, std::string_view());
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,180 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <time.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/busy_poll_reader.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Weight of a new wait in the moving average of the waits, as a divisor
+     *
+     */
+    static constexpr int WAIT_AVERAGE_WEIGHT{8};
+
+    /**
+     * @brief Hint the CPU that the calling thread is spinning
+     *
+     */
+    inline void relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield" ::: "memory");
+#endif
+    }
+} // namespace
+
+BusyPollReader::BusyPollReader(SerialPort& serialPort, std::chrono::nanoseconds maxSpinBudget) :
+    serialPort{serialPort}, spinBudget{0}, maxSpinBudget{0}, averageWait{0}, adaptive{true}, statistics{}
+{
+    setMaxSpinBudget(maxSpinBudget);
+}
+
+size_t BusyPollReader::read(char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error)
+{
+    error.clear();
+    if (size == 0)
+        return 0;
+
+    const auto start{std::chrono::steady_clock::now()};
+    const auto deadline{start + timeout};
+    const auto spinDeadline{start + std::min<std::chrono::steady_clock::duration>(spinBudget, timeout)};
+
+    // Spin on non-blocking reads, at least one read is made
+    size_t result{0};
+    while (true)
+    {
+        result = serialPort.read(buffer, size, error);
+        if ((error != SerialError::SERIAL_ERROR_WOULD_BLOCK) || (std::chrono::steady_clock::now() >= spinDeadline))
+            break;
+        relax();
+    }
+
+    auto now{std::chrono::steady_clock::now()};
+    statistics.spinTime += now - start;
+    if (!error)
+    {
+        ++statistics.readCount;
+        ++statistics.spinCount;
+        adapt(now - start);
+        return result;
+    }
+    if (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)
+        return 0;
+
+    // Block for the rest of the timeout
+    const auto sleepStart{now};
+    if (now < deadline)
+        ++statistics.sleepCount;
+    while (now < deadline)
+    {
+        const auto remaining{toTimespec(deadline - now)};
+        struct pollfd descriptor{serialPort.getNativeHandle(), POLLIN, 0};
+        systemCall(::ppoll, &descriptor, 1, &remaining, nullptr);
+
+        result = serialPort.read(buffer, size, error);
+        now = std::chrono::steady_clock::now();
+        if (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)
+            break;
+    }
+    statistics.sleepTime += now - sleepStart;
+
+    if (!error)
+    {
+        ++statistics.readCount;
+        adapt(now - start);
+        return result;
+    }
+    if (error == SerialError::SERIAL_ERROR_WOULD_BLOCK)
+    {
+        // Waits longer than the timeout are averaged as the timeout
+        ++statistics.timeoutCount;
+        adapt(timeout);
+        error = std::make_error_code(std::errc::timed_out);
+    }
+    return 0;
+}
+
+std::chrono::nanoseconds BusyPollReader::getSpinBudget() const
+{
+    return spinBudget;
+}
+
+std::chrono::nanoseconds BusyPollReader::getMaxSpinBudget() const
+{
+    return maxSpinBudget;
+}
+
+void BusyPollReader::setMaxSpinBudget(std::chrono::nanoseconds maxSpinBudget)
+{
+    if (maxSpinBudget.count() < 0)
+        throw std::out_of_range("Invalid spin budget");
+
+    // Adaptation starts over from the maximum spin budget
+    this->maxSpinBudget = maxSpinBudget;
+    spinBudget = maxSpinBudget;
+    averageWait = maxSpinBudget / 2;
+}
+
+bool BusyPollReader::isAdaptive() const
+{
+    return adaptive;
+}
+
+void BusyPollReader::setAdaptive(bool adaptive)
+{
+    this->adaptive = adaptive;
+    spinBudget = maxSpinBudget;
+    averageWait = maxSpinBudget / 2;
+}
+
+BusyPollStatistics BusyPollReader::getStatistics() const
+{
+    return statistics;
+}
+
+void BusyPollReader::resetStatistics()
+{
+    statistics = BusyPollStatistics{};
+}
+
+void BusyPollReader::adapt(std::chrono::nanoseconds wait)
+{
+    if (!adaptive)
+        return;
+
+    averageWait += (wait - averageWait) / WAIT_AVERAGE_WEIGHT;
+    spinBudget = (((averageWait * 2) <= maxSpinBudget) ? (averageWait * 2) : std::chrono::nanoseconds{0});
+}
+
+END_NAMESPACE_LIBSERIAL
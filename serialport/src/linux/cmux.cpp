@@ -0,0 +1,1323 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/cmux.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Frame check sequence of 3GPP TS 27.010
+     *
+     */
+    typedef Crc<8, 0x07, 0xFF, true, true, 0xFF> FrameCheck;
+
+    /**
+     * @brief Basic option flag
+     *
+     */
+    constexpr char BASIC_FLAG{static_cast<char>(0xF9)};
+
+    /**
+     * @brief Advanced option flag
+     *
+     */
+    constexpr char ADVANCED_FLAG{static_cast<char>(0x7E)};
+
+    /**
+     * @brief Advanced option control escape
+     *
+     */
+    constexpr char ADVANCED_ESCAPE{static_cast<char>(0x7D)};
+
+    /**
+     * @brief Value applied to an escaped byte using exclusive or
+     *
+     */
+    constexpr char ESCAPE_MASK{static_cast<char>(0x20)};
+
+    /**
+     * @brief Extension bit of the address, length and message fields
+     *
+     */
+    constexpr uint8_t EXTENSION_BIT{0x01};
+
+    /**
+     * @brief Command/response bit of the address and message type fields
+     *
+     */
+    constexpr uint8_t COMMAND_BIT{0x02};
+
+    /**
+     * @brief Poll/final bit of the control field
+     *
+     */
+    constexpr uint8_t POLL_FINAL_BIT{0x10};
+
+    /**
+     * @brief Set asynchronous balanced mode frame
+     *
+     */
+    constexpr uint8_t CONTROL_SABM{0x2F};
+
+    /**
+     * @brief Unnumbered acknowledgement frame
+     *
+     */
+    constexpr uint8_t CONTROL_UA{0x63};
+
+    /**
+     * @brief Disconnected mode frame
+     *
+     */
+    constexpr uint8_t CONTROL_DM{0x0F};
+
+    /**
+     * @brief Disconnect frame
+     *
+     */
+    constexpr uint8_t CONTROL_DISC{0x43};
+
+    /**
+     * @brief Unnumbered information with header check frame
+     *
+     */
+    constexpr uint8_t CONTROL_UIH{0xEF};
+
+    /**
+     * @brief Unnumbered information frame
+     *
+     */
+    constexpr uint8_t CONTROL_UI{0x03};
+
+    /**
+     * @brief Parameter negotiation message
+     *
+     */
+    constexpr uint8_t MESSAGE_PN{0x80};
+
+    /**
+     * @brief Multiplexer close down message
+     *
+     */
+    constexpr uint8_t MESSAGE_CLD{0xC0};
+
+    /**
+     * @brief Test message
+     *
+     */
+    constexpr uint8_t MESSAGE_TEST{0x20};
+
+    /**
+     * @brief Flow control on message
+     *
+     */
+    constexpr uint8_t MESSAGE_FCON{0xA0};
+
+    /**
+     * @brief Flow control off message
+     *
+     */
+    constexpr uint8_t MESSAGE_FCOFF{0x60};
+
+    /**
+     * @brief Modem status message
+     *
+     */
+    constexpr uint8_t MESSAGE_MSC{0xE0};
+
+    /**
+     * @brief Non supported command response
+     *
+     */
+    constexpr uint8_t MESSAGE_NSC{0x10};
+
+    /**
+     * @brief Flow control signal of a modem status message
+     *
+     */
+    constexpr uint8_t SIGNAL_FC{0x02};
+
+    /**
+     * @brief Ready to communicate signal (DTR/DSR)
+     *
+     */
+    constexpr uint8_t SIGNAL_RTC{0x04};
+
+    /**
+     * @brief Ready to receive signal (RTS/CTS)
+     *
+     */
+    constexpr uint8_t SIGNAL_RTR{0x08};
+
+    /**
+     * @brief Incoming call signal (RI)
+     *
+     */
+    constexpr uint8_t SIGNAL_IC{0x40};
+
+    /**
+     * @brief Data valid signal (DCD)
+     *
+     */
+    constexpr uint8_t SIGNAL_DV{0x80};
+
+    /**
+     * @brief Append a byte using the advanced option control octet transparency
+     *
+     * @param value Byte
+     * @param output Output position
+     * @return char* Next output position
+     */
+    inline char* appendEscaped(char value, char* output)
+    {
+        if ((value == ADVANCED_FLAG) || (value == ADVANCED_ESCAPE))
+        {
+            *output++ = ADVANCED_ESCAPE;
+            value ^= ESCAPE_MASK;
+        }
+        *output++ = value;
+        return output;
+    }
+
+    /**
+     * @brief Check for a frame whose check sequence only covers the header
+     *
+     * @param control Control field
+     * @return true UIH frame
+     * @return false Other frame
+     */
+    inline bool isHeaderChecked(uint8_t control)
+    {
+        return ((control & ~POLL_FINAL_BIT) == CONTROL_UIH);
+    }
+} // namespace
+
+CmuxChannel::Queue::Queue(size_t capacity) :
+    storage(capacity), begin{0}, size{0}
+{
+
+}
+
+size_t CmuxChannel::Queue::getFree() const
+{
+    return (storage.size() - size);
+}
+
+size_t CmuxChannel::Queue::push(const char* data, size_t size)
+{
+    size_t result{0};
+    char* space{nullptr};
+    while (result < size)
+    {
+        const auto count{std::min(reserve(space), size - result)};
+        if (count == 0)
+            break;
+
+        std::memcpy(space, data + result, count);
+        commit(count);
+        result += count;
+    }
+    return result;
+}
+
+size_t CmuxChannel::Queue::pop(char* data, size_t size)
+{
+    size_t result{0};
+    const char* available{nullptr};
+    while (result < size)
+    {
+        const auto count{std::min(peek(available), size - result)};
+        if (count == 0)
+            break;
+
+        std::memcpy(data + result, available, count);
+        consume(count);
+        result += count;
+    }
+    return result;
+}
+
+size_t CmuxChannel::Queue::peek(const char*& data) const
+{
+    data = storage.data() + begin;
+    return std::min(size, storage.size() - begin);
+}
+
+void CmuxChannel::Queue::consume(size_t size)
+{
+    begin = (begin + size) % storage.size();
+    this->size -= size;
+    if (this->size == 0)
+        begin = 0;
+}
+
+size_t CmuxChannel::Queue::reserve(char*& data)
+{
+    const auto end{(begin + size) % storage.size()};
+    data = storage.data() + end;
+    return ((end >= begin) && (size < storage.size())) ? (storage.size() - end) : (begin - end);
+}
+
+void CmuxChannel::Queue::commit(size_t size)
+{
+    this->size += size;
+}
+
+void CmuxChannel::Queue::clear()
+{
+    begin = 0;
+    size = 0;
+}
+
+CmuxChannel::CmuxChannel(uint8_t dlci, size_t bufferSize, bool pseudoTerminal) :
+    dlci{dlci}, state{CmuxChannelState::CMUX_CHANNEL_CLOSED}, input(bufferSize), output(bufferSize),
+    master{INVALID_FILE_DESCRIPTOR}, slave{INVALID_FILE_DESCRIPTOR}, slaveName{},
+    localSignals{SIGNAL_RTC | SIGNAL_RTR | SIGNAL_DV}, peerSignals{0}, signalsChanged{false}, peerStopped{false},
+    localStopped{false}, statistics{}
+{
+    if (!pseudoTerminal)
+        return;
+
+    master = systemCall(::posix_openpt, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if ((master == INVALID_FILE_DESCRIPTOR) || (grantpt(master) != 0) || (unlockpt(master) != 0))
+    {
+        if (master != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, master);
+        throw std::runtime_error("Unable to open pseudo terminal");
+    }
+    slaveName = ptsname(master);
+
+    // Raw slave keeps binary protocols such as PPP transparent
+    slave = systemCall(::open, slaveName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    struct termios settings{};
+    if ((slave == INVALID_FILE_DESCRIPTOR) || (systemCall(::tcgetattr, slave, &settings) != 0))
+    {
+        if (slave != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, slave);
+        systemCall(::close, master);
+        throw std::runtime_error("Unable to open pseudo terminal");
+    }
+    cfmakeraw(&settings);
+    systemCall(::tcsetattr, slave, TCSANOW, &settings);
+}
+
+CmuxChannel::~CmuxChannel() noexcept
+{
+    if (slave != INVALID_FILE_DESCRIPTOR)
+        systemCall(::close, slave);
+    if (master != INVALID_FILE_DESCRIPTOR)
+        systemCall(::close, master);
+}
+
+bool CmuxChannel::isOpen() const
+{
+    return (state == CmuxChannelState::CMUX_CHANNEL_OPEN);
+}
+
+CmuxChannelState CmuxChannel::getState() const
+{
+    return state;
+}
+
+uint8_t CmuxChannel::getDlci() const
+{
+    return dlci;
+}
+
+std::string CmuxChannel::getPortName() const
+{
+    return slaveName;
+}
+
+size_t CmuxChannel::read(char* buffer, size_t size)
+{
+    return input.pop(buffer, size);
+}
+
+size_t CmuxChannel::read(std::string& buffer)
+{
+    buffer.resize(input.size);
+    return input.pop(buffer.data(), buffer.size());
+}
+
+size_t CmuxChannel::write(const char* buffer, size_t size)
+{
+    return (isOpen() ? output.push(buffer, size) : 0);
+}
+
+size_t CmuxChannel::write(const std::string& buffer)
+{
+    return write(buffer.data(), buffer.size());
+}
+
+void CmuxChannel::flushInput()
+{
+    input.clear();
+}
+
+void CmuxChannel::flushOutput()
+{
+    output.clear();
+}
+
+size_t CmuxChannel::getInputQueueCount() const
+{
+    return input.size;
+}
+
+size_t CmuxChannel::getOutputQueueCount() const
+{
+    return output.size;
+}
+
+bool CmuxChannel::getControlLine(ControlLine controlLine) const
+{
+    switch (controlLine)
+    {
+        case ControlLine::LINE_DTR:
+            return ((localSignals & SIGNAL_RTC) != 0);
+
+        case ControlLine::LINE_RTS:
+            return ((localSignals & SIGNAL_RTR) != 0);
+
+        case ControlLine::LINE_DSR:
+            return ((peerSignals & SIGNAL_RTC) != 0);
+
+        case ControlLine::LINE_CTS:
+            return ((peerSignals & SIGNAL_RTR) != 0);
+
+        case ControlLine::LINE_DCD:
+            return ((peerSignals & SIGNAL_DV) != 0);
+
+        case ControlLine::LINE_RI:
+            return ((peerSignals & SIGNAL_IC) != 0);
+
+        default:
+            return false;
+    }
+}
+
+bool CmuxChannel::setControlLine(ControlLine controlLine, bool state)
+{
+    uint8_t signal{0};
+    switch (controlLine)
+    {
+        case ControlLine::LINE_DTR:
+            signal = SIGNAL_RTC;
+            break;
+
+        case ControlLine::LINE_RTS:
+            signal = SIGNAL_RTR;
+            break;
+
+        default:
+            return false;
+    }
+
+    localSignals = static_cast<uint8_t>(state ? (localSignals | signal) : (localSignals & ~signal));
+    signalsChanged = true;
+    return true;
+}
+
+bool CmuxChannel::isFlowStopped() const
+{
+    return peerStopped;
+}
+
+CmuxChannelStatistics CmuxChannel::getStatistics() const
+{
+    return statistics;
+}
+
+CmuxMultiplexer::CmuxMultiplexer(SerialPort& serialPort, CmuxMode mode, size_t frameSize, size_t bufferSize) :
+    serialPort{serialPort}, mode{mode}, frameSize{frameSize}, bufferSize{bufferSize}, stopEvent{INVALID_FILE_DESCRIPTOR},
+    stopped{false}, failed{false}, initiator{false}, accept{true}, acceptPseudoTerminal{false},
+    controlState{CmuxChannelState::CMUX_CHANNEL_CLOSED}, aggregateStopped{false}, channels{}, nextChannel{0},
+    controlQueue{}, transmitBuffer{}, transmitBegin{0}, transmitEnd{0}, receiveBuffer{}, receiveEnd{0}, frame{},
+    descriptors{}, descriptorChannels{}, statistics{}
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+    if ((frameSize < CMUX_MIN_FRAME_SIZE) || (frameSize > CMUX_MAX_FRAME_SIZE) || (bufferSize < frameSize))
+        throw std::out_of_range("Invalid frame or buffer size");
+
+    // Buffers hold several frames of the largest size
+    const auto encodedSize{getMaxEncodedSize(mode, frameSize)};
+    transmitBuffer.resize(4 * encodedSize);
+    receiveBuffer.resize(2 * encodedSize);
+    frame.resize(frameSize + 3);
+    controlQueue.reserve(4 * getMaxEncodedSize(mode, 8));
+    descriptors.reserve(CMUX_MAX_DLCI + 2);
+    descriptorChannels.reserve(CMUX_MAX_DLCI);
+
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopEvent == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create event");
+}
+
+CmuxMultiplexer::~CmuxMultiplexer() noexcept
+{
+    systemCall(::close, stopEvent);
+}
+
+bool CmuxMultiplexer::connect(std::chrono::milliseconds timeout)
+{
+    if (controlState == CmuxChannelState::CMUX_CHANNEL_OPEN)
+        return true;
+    if (failed)
+        return false;
+
+    initiator = true;
+    controlState = CmuxChannelState::CMUX_CHANNEL_OPENING;
+    queueFrame(0, true, CONTROL_SABM | POLL_FINAL_BIT);
+    if (!waitForResponse(0, timeout))
+        controlState = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+    return (controlState == CmuxChannelState::CMUX_CHANNEL_OPEN);
+}
+
+bool CmuxMultiplexer::disconnect(std::chrono::milliseconds timeout)
+{
+    if (controlState != CmuxChannelState::CMUX_CHANNEL_OPEN)
+        return true;
+
+    controlState = CmuxChannelState::CMUX_CHANNEL_CLOSING;
+    queueMessage(MESSAGE_CLD, true, std::string_view());
+    const auto result{waitForResponse(0, timeout)};
+    closeAll();
+    return result;
+}
+
+bool CmuxMultiplexer::isConnected() const
+{
+    return (controlState == CmuxChannelState::CMUX_CHANNEL_OPEN);
+}
+
+bool CmuxMultiplexer::openChannel(uint8_t dlci, bool pseudoTerminal, std::chrono::milliseconds timeout)
+{
+    if ((dlci == 0) || (dlci > CMUX_MAX_DLCI))
+        throw std::out_of_range("Invalid DLCI");
+    if (controlState != CmuxChannelState::CMUX_CHANNEL_OPEN)
+        return false;
+
+    auto& channel{channels[dlci] ? *channels[dlci] : createChannel(dlci, pseudoTerminal)};
+    if (channel.isOpen())
+        return true;
+
+    channel.state = CmuxChannelState::CMUX_CHANNEL_OPENING;
+    queueFrame(dlci, true, CONTROL_SABM | POLL_FINAL_BIT);
+    if (!waitForResponse(dlci, timeout))
+        channel.state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+    return channel.isOpen();
+}
+
+bool CmuxMultiplexer::closeChannel(uint8_t dlci, std::chrono::milliseconds timeout)
+{
+    if ((dlci == 0) || (dlci > CMUX_MAX_DLCI))
+        throw std::out_of_range("Invalid DLCI");
+    if (!channels[dlci] || !channels[dlci]->isOpen())
+        return true;
+
+    channels[dlci]->state = CmuxChannelState::CMUX_CHANNEL_CLOSING;
+    queueFrame(dlci, true, CONTROL_DISC | POLL_FINAL_BIT);
+    const auto result{waitForResponse(dlci, timeout)};
+    channels[dlci]->state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+    return result;
+}
+
+CmuxChannel& CmuxMultiplexer::getChannel(uint8_t dlci)
+{
+    if ((dlci == 0) || (dlci > CMUX_MAX_DLCI) || !channels[dlci])
+        throw std::out_of_range("Invalid channel");
+
+    return *channels[dlci];
+}
+
+void CmuxMultiplexer::setAcceptChannels(bool accept, bool pseudoTerminal)
+{
+    this->accept = accept;
+    acceptPseudoTerminal = pseudoTerminal;
+}
+
+size_t CmuxMultiplexer::poll(std::chrono::milliseconds timeout)
+{
+    // Nothing to wait for on a failed serial port
+    if (failed)
+        return 0;
+
+    updateChannels();
+    fill();
+    flush();
+
+    // Serial port, stop event and the pseudo terminals with pending work
+    descriptors.clear();
+    descriptorChannels.clear();
+    const auto pending{(transmitBegin != transmitEnd) || !controlQueue.empty()};
+    descriptors.push_back({serialPort.getNativeHandle(), static_cast<short>(POLLIN | (pending ? POLLOUT : 0)), 0});
+    descriptors.push_back({stopEvent, POLLIN, 0});
+    for (const auto& channel: channels)
+    {
+        if (!channel || (channel->master == INVALID_FILE_DESCRIPTOR))
+            continue;
+
+        const auto events{static_cast<short>(((channel->isOpen() && (channel->output.getFree() > 0)) ? POLLIN : 0) |
+            ((channel->input.size > 0) ? POLLOUT : 0))};
+        if (events == 0)
+            continue;
+
+        descriptors.push_back({channel->master, events, 0});
+        descriptorChannels.push_back(channel.get());
+    }
+
+    const auto remaining{toTimespec(timeout)};
+    if (failed || (systemCall(::ppoll, descriptors.data(), descriptors.size(), &remaining, nullptr) < 0))
+        return 0;
+
+    size_t count{0};
+    if ((descriptors[0].revents & POLLIN) != 0)
+        count += receive();
+
+    // Frames received before a hang-up are still dispatched
+    if (!failed && ((descriptors[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0))
+        fail();
+    if (failed)
+        return count;
+
+    if ((descriptors[1].revents & POLLIN) != 0)
+    {
+        uint64_t value{0};
+        systemCall(::read, stopEvent, &value, sizeof(value));
+        stopped = true;
+    }
+
+    for (size_t index{2}; index < descriptors.size(); ++index)
+    {
+        auto& channel{*descriptorChannels[index - 2]};
+        if ((descriptors[index].revents & POLLOUT) != 0)
+            writePseudoTerminal(channel);
+        if ((descriptors[index].revents & POLLIN) != 0)
+            readPseudoTerminal(channel);
+    }
+
+    updateChannels();
+    fill();
+    flush();
+    return count;
+}
+
+void CmuxMultiplexer::run()
+{
+    stopped = false;
+    while (!stopped && !failed)
+        poll(std::chrono::milliseconds{1000});
+}
+
+void CmuxMultiplexer::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+bool CmuxMultiplexer::isFailed() const
+{
+    return failed;
+}
+
+CmuxMode CmuxMultiplexer::getMode() const
+{
+    return mode;
+}
+
+size_t CmuxMultiplexer::getFrameSize() const
+{
+    return frameSize;
+}
+
+CmuxStatistics CmuxMultiplexer::getStatistics() const
+{
+    return statistics;
+}
+
+size_t CmuxMultiplexer::getMaxEncodedSize(CmuxMode mode, size_t size)
+{
+    // Flags, address, control, length and frame check sequence, each escaped in the advanced option
+    return ((mode == CmuxMode::CMUX_MODE_BASIC) ? (size + 7) : ((2 * (size + 3)) + 2));
+}
+
+size_t CmuxMultiplexer::encodeFrame(CmuxMode mode, uint8_t address, uint8_t control, const char* data, size_t size, char* output)
+{
+    char* position{output};
+    if (mode == CmuxMode::CMUX_MODE_BASIC)
+    {
+        // Length field of one or two bytes
+        char header[4]{static_cast<char>(address), static_cast<char>(control), 0, 0};
+        size_t headerSize{3};
+        if (size <= 0x7F)
+        {
+            header[2] = static_cast<char>((size << 1) | EXTENSION_BIT);
+        }
+        else
+        {
+            header[2] = static_cast<char>((size << 1) & 0xFE);
+            header[3] = static_cast<char>(size >> 7);
+            headerSize = 4;
+        }
+
+        auto frameCheck{FrameCheck::update(FrameCheck::initialize(), header, headerSize)};
+        if (!isHeaderChecked(control))
+            frameCheck = FrameCheck::update(frameCheck, data, size);
+
+        *position++ = BASIC_FLAG;
+        std::memcpy(position, header, headerSize);
+        position += headerSize;
+        if (size > 0)
+            std::memcpy(position, data, size);
+        position += size;
+        *position++ = static_cast<char>(FrameCheck::finalize(frameCheck));
+        *position++ = BASIC_FLAG;
+    }
+    else
+    {
+        const char header[2]{static_cast<char>(address), static_cast<char>(control)};
+        auto frameCheck{FrameCheck::update(FrameCheck::initialize(), header, sizeof(header))};
+        if (!isHeaderChecked(control))
+            frameCheck = FrameCheck::update(frameCheck, data, size);
+
+        *position++ = ADVANCED_FLAG;
+        position = appendEscaped(header[0], position);
+        position = appendEscaped(header[1], position);
+        for (size_t index{0}; index < size; ++index)
+            position = appendEscaped(data[index], position);
+        position = appendEscaped(static_cast<char>(FrameCheck::finalize(frameCheck)), position);
+        *position++ = ADVANCED_FLAG;
+    }
+    return static_cast<size_t>(position - output);
+}
+
+CmuxChannelState& CmuxMultiplexer::getState(uint8_t dlci)
+{
+    return ((dlci == 0) ? controlState : channels[dlci]->state);
+}
+
+bool CmuxMultiplexer::waitForResponse(uint8_t dlci, std::chrono::milliseconds timeout)
+{
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while ((getState(dlci) == CmuxChannelState::CMUX_CHANNEL_OPENING) ||
+        (getState(dlci) == CmuxChannelState::CMUX_CHANNEL_CLOSING))
+    {
+        const auto remaining{std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())};
+        if (remaining.count() <= 0)
+            return false;
+
+        poll(std::min(remaining, std::chrono::milliseconds{10}));
+    }
+    return !failed;
+}
+
+uint8_t CmuxMultiplexer::getAddress(uint8_t dlci, bool command) const
+{
+    // Commands of the initiator and responses of the responder have the C/R bit set
+    return static_cast<uint8_t>((dlci << 2) | ((command == initiator) ? COMMAND_BIT : 0) | EXTENSION_BIT);
+}
+
+void CmuxMultiplexer::queueFrame(uint8_t dlci, bool command, uint8_t control, const char* data, size_t size)
+{
+    const auto offset{controlQueue.size()};
+    controlQueue.resize(offset + getMaxEncodedSize(mode, size));
+    controlQueue.resize(offset + encodeFrame(mode, getAddress(dlci, command), control, data, size, controlQueue.data() + offset));
+    ++statistics.transmittedFrameCount;
+}
+
+void CmuxMultiplexer::queueMessage(uint8_t type, bool command, std::string_view values)
+{
+    // Type field of a single byte and a length field of one or two bytes
+    const auto size{std::min(values.size(), frameSize - 3)};
+    std::string message{};
+    message.reserve(size + 3);
+    message.push_back(static_cast<char>(type | (command ? COMMAND_BIT : 0) | EXTENSION_BIT));
+    if (size <= 0x7F)
+    {
+        message.push_back(static_cast<char>((size << 1) | EXTENSION_BIT));
+    }
+    else
+    {
+        message.push_back(static_cast<char>((size << 1) & 0xFE));
+        message.push_back(static_cast<char>(((size >> 7) << 1) | EXTENSION_BIT));
+    }
+    message.append(values.data(), size);
+    queueFrame(0, true, CONTROL_UIH, message.data(), message.size());
+}
+
+void CmuxMultiplexer::queueSignals(CmuxChannel& channel)
+{
+    const char values[2]{static_cast<char>((channel.dlci << 2) | COMMAND_BIT | EXTENSION_BIT),
+        static_cast<char>(channel.localSignals | (channel.localStopped ? SIGNAL_FC : 0) | EXTENSION_BIT)};
+    queueMessage(MESSAGE_MSC, true, std::string_view(values, sizeof(values)));
+    channel.signalsChanged = false;
+}
+
+CmuxChannel& CmuxMultiplexer::createChannel(uint8_t dlci, bool pseudoTerminal)
+{
+    channels[dlci].reset(new CmuxChannel(dlci, bufferSize, pseudoTerminal));
+    return *channels[dlci];
+}
+
+void CmuxMultiplexer::closeAll()
+{
+    controlState = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+    aggregateStopped = false;
+    for (auto& channel: channels)
+    {
+        if (!channel)
+            continue;
+
+        channel->state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+        channel->peerStopped = false;
+        channel->localStopped = false;
+    }
+}
+
+void CmuxMultiplexer::fail()
+{
+    // Frames not written yet are lost with the serial port
+    failed = true;
+    controlQueue.clear();
+    transmitBegin = 0;
+    transmitEnd = 0;
+    receiveEnd = 0;
+    closeAll();
+}
+
+void CmuxMultiplexer::updateChannels()
+{
+    for (auto& channel: channels)
+    {
+        if (!channel || !channel->isOpen())
+            continue;
+
+        // Resume the peer once the receive buffer drained to a quarter
+        if (channel->localStopped && (channel->input.size <= (bufferSize / 4)))
+        {
+            channel->localStopped = false;
+            channel->signalsChanged = true;
+        }
+        if (channel->signalsChanged)
+            queueSignals(*channel);
+    }
+}
+
+void CmuxMultiplexer::fill()
+{
+    // Reclaim the written part of the transmit buffer
+    if (transmitBegin > 0)
+    {
+        std::memmove(transmitBuffer.data(), transmitBuffer.data() + transmitBegin, transmitEnd - transmitBegin);
+        transmitEnd -= transmitBegin;
+        transmitBegin = 0;
+    }
+
+    // Control frames go ahead of the channel data
+    if (!controlQueue.empty())
+    {
+        const auto count{std::min(controlQueue.size(), transmitBuffer.size() - transmitEnd)};
+        std::memcpy(transmitBuffer.data() + transmitEnd, controlQueue.data(), count);
+        transmitEnd += count;
+        controlQueue.erase(0, count);
+        if (!controlQueue.empty())
+            return;
+    }
+    if (aggregateStopped)
+        return;
+
+    // Channels with pending data take turns of a single frame
+    const auto encodedSize{getMaxEncodedSize(mode, frameSize)};
+    size_t idleCount{0};
+    while (((transmitBuffer.size() - transmitEnd) >= encodedSize) && (idleCount < CMUX_MAX_DLCI))
+    {
+        nextChannel = static_cast<uint8_t>((nextChannel % CMUX_MAX_DLCI) + 1);
+        auto* channel{channels[nextChannel].get()};
+        if (!channel || !channel->isOpen() || channel->peerStopped || (channel->output.size == 0))
+        {
+            ++idleCount;
+            continue;
+        }
+
+        const auto size{channel->output.pop(frame.data(), frameSize)};
+        transmitEnd += encodeFrame(mode, getAddress(nextChannel, true), CONTROL_UIH, frame.data(), size,
+            transmitBuffer.data() + transmitEnd);
+        channel->statistics.transmittedCount += size;
+        ++statistics.transmittedFrameCount;
+        idleCount = 0;
+    }
+}
+
+void CmuxMultiplexer::flush()
+{
+    while (transmitBegin < transmitEnd)
+    {
+        std::error_code error{};
+        const auto count{serialPort.write(transmitBuffer.data() + transmitBegin, transmitEnd - transmitBegin, error)};
+        if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+        {
+            fail();
+            return;
+        }
+        if (count == 0)
+            return;
+
+        transmitBegin += count;
+    }
+}
+
+size_t CmuxMultiplexer::receive()
+{
+    size_t count{0};
+    while (true)
+    {
+        const auto space{receiveBuffer.size() - receiveEnd};
+        std::error_code error{};
+        const auto size{serialPort.read(receiveBuffer.data() + receiveEnd, space, error)};
+        if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+        {
+            fail();
+            return count;
+        }
+        if (size == 0)
+            return count;
+
+        receiveEnd += size;
+        count += ((mode == CmuxMode::CMUX_MODE_BASIC) ? decodeBasic() : decodeAdvanced());
+        if (size < space)
+            return count;
+    }
+}
+
+size_t CmuxMultiplexer::decodeBasic()
+{
+    const auto* data{receiveBuffer.data()};
+    size_t count{0};
+    size_t begin{0};
+    while (begin < receiveEnd)
+    {
+        // Synchronize to a flag, repeated flags delimit empty frames
+        if (data[begin] != BASIC_FLAG)
+        {
+            const auto* flag{static_cast<const char*>(std::memchr(data + begin, BASIC_FLAG, receiveEnd - begin))};
+            const auto next{flag ? static_cast<size_t>(flag - data) : receiveEnd};
+            statistics.discardedCount += next - begin;
+            begin = next;
+            continue;
+        }
+        if (((begin + 1) < receiveEnd) && (data[begin + 1] == BASIC_FLAG))
+        {
+            ++begin;
+            continue;
+        }
+
+        // Address, control and a length field of one or two bytes
+        if ((receiveEnd - begin) < 4)
+            break;
+        const auto lengthField{static_cast<uint8_t>(data[begin + 3])};
+        size_t headerSize{3};
+        size_t length{static_cast<size_t>(lengthField >> 1)};
+        if ((lengthField & EXTENSION_BIT) == 0)
+        {
+            if ((receiveEnd - begin) < 5)
+                break;
+            length |= static_cast<size_t>(static_cast<uint8_t>(data[begin + 4])) << 7;
+            headerSize = 4;
+        }
+        if (length > frameSize)
+        {
+            ++statistics.invalidFrameCount;
+            ++begin;
+            continue;
+        }
+
+        const auto total{headerSize + length + 3};
+        if ((receiveEnd - begin) < total)
+            break;
+        if (data[begin + total - 1] != BASIC_FLAG)
+        {
+            ++statistics.invalidFrameCount;
+            ++begin;
+            continue;
+        }
+
+        // Closing flag may open the next frame
+        const auto* header{data + begin + 1};
+        const auto control{static_cast<uint8_t>(header[1])};
+        const auto checkedSize{isHeaderChecked(control) ? headerSize : (headerSize + length)};
+        begin += total - 1;
+        if (FrameCheck::calculate(header, checkedSize) != static_cast<uint8_t>(header[headerSize + length]))
+        {
+            ++statistics.frameCheckErrorCount;
+            continue;
+        }
+
+        ++statistics.receivedFrameCount;
+        ++count;
+        dispatch(static_cast<uint8_t>(header[0]), control, std::string_view(header + headerSize, length));
+    }
+
+    // Keep the incomplete frame, drop a buffer full of garbage
+    if ((begin == 0) && (receiveEnd == receiveBuffer.size()))
+    {
+        statistics.discardedCount += receiveEnd;
+        begin = receiveEnd;
+    }
+    std::memmove(receiveBuffer.data(), data + begin, receiveEnd - begin);
+    receiveEnd -= begin;
+    return count;
+}
+
+size_t CmuxMultiplexer::decodeAdvanced()
+{
+    const auto* data{receiveBuffer.data()};
+    size_t count{0};
+    size_t begin{0};
+    while (begin < receiveEnd)
+    {
+        if (data[begin] != ADVANCED_FLAG)
+        {
+            const auto* flag{static_cast<const char*>(std::memchr(data + begin, ADVANCED_FLAG, receiveEnd - begin))};
+            const auto next{flag ? static_cast<size_t>(flag - data) : receiveEnd};
+            statistics.discardedCount += next - begin;
+            begin = next;
+            continue;
+        }
+
+        // Frame ends at the next flag, which may open the next frame
+        const auto* closing{static_cast<const char*>(std::memchr(data + begin + 1, ADVANCED_FLAG, receiveEnd - begin - 1))};
+        if (closing == nullptr)
+            break;
+        const auto end{static_cast<size_t>(closing - data)};
+        const auto start{begin + 1};
+        begin = end;
+        if (start == end)
+            continue;
+
+        // Remove the control octet transparency
+        size_t size{0};
+        bool valid{true};
+        for (auto index{start}; index < end; ++index)
+        {
+            auto value{data[index]};
+            if (value == ADVANCED_ESCAPE)
+            {
+                if (++index == end)
+                {
+                    valid = false;
+                    break;
+                }
+                value = static_cast<char>(data[index] ^ ESCAPE_MASK);
+            }
+            if (size == frame.size())
+            {
+                valid = false;
+                break;
+            }
+            frame[size++] = value;
+        }
+        if (!valid || (size < 3))
+        {
+            ++statistics.invalidFrameCount;
+            continue;
+        }
+
+        const auto control{static_cast<uint8_t>(frame[1])};
+        const auto checkedSize{isHeaderChecked(control) ? 2 : (size - 1)};
+        if (FrameCheck::calculate(frame.data(), checkedSize) != static_cast<uint8_t>(frame[size - 1]))
+        {
+            ++statistics.frameCheckErrorCount;
+            continue;
+        }
+
+        ++statistics.receivedFrameCount;
+        ++count;
+        dispatch(static_cast<uint8_t>(frame[0]), control, std::string_view(frame.data() + 2, size - 3));
+    }
+
+    // Drop a buffer full of an unterminated frame
+    if ((begin == 0) && (receiveEnd == receiveBuffer.size()))
+    {
+        ++statistics.invalidFrameCount;
+        statistics.discardedCount += receiveEnd;
+        begin = receiveEnd;
+    }
+    std::memmove(receiveBuffer.data(), data + begin, receiveEnd - begin);
+    receiveEnd -= begin;
+    return count;
+}
+
+void CmuxMultiplexer::dispatch(uint8_t address, uint8_t control, std::string_view data)
+{
+    const auto dlci{static_cast<uint8_t>(address >> 2)};
+    auto* channel{channels[dlci].get()};
+    switch (control & ~POLL_FINAL_BIT)
+    {
+        case CONTROL_SABM:
+            handleOpen(dlci);
+            break;
+
+        case CONTROL_UA:
+        case CONTROL_DM:
+        {
+            // Response to a pending SABM or DISC
+            const auto opened{(control & ~POLL_FINAL_BIT) == CONTROL_UA};
+            if ((dlci != 0) && !channel)
+                break;
+
+            auto& state{getState(dlci)};
+            if (state == CmuxChannelState::CMUX_CHANNEL_OPENING)
+            {
+                state = (opened ? CmuxChannelState::CMUX_CHANNEL_OPEN : CmuxChannelState::CMUX_CHANNEL_CLOSED);
+                if (opened && channel)
+                    channel->signalsChanged = true;
+            }
+            else if (state == CmuxChannelState::CMUX_CHANNEL_CLOSING)
+            {
+                if (dlci == 0)
+                    closeAll();
+                state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+            }
+            else if (!opened && (state == CmuxChannelState::CMUX_CHANNEL_OPEN))
+            {
+                state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+            }
+            break;
+        }
+
+        case CONTROL_DISC:
+            if (dlci == 0)
+            {
+                queueFrame(0, false, CONTROL_UA | POLL_FINAL_BIT);
+                closeAll();
+            }
+            else if (channel && (channel->state != CmuxChannelState::CMUX_CHANNEL_CLOSED))
+            {
+                channel->state = CmuxChannelState::CMUX_CHANNEL_CLOSED;
+                queueFrame(dlci, false, CONTROL_UA | POLL_FINAL_BIT);
+            }
+            else
+            {
+                queueFrame(dlci, false, CONTROL_DM | POLL_FINAL_BIT);
+            }
+            break;
+
+        case CONTROL_UIH:
+        case CONTROL_UI:
+            if (dlci == 0)
+                handleControl(data);
+            else if (channel && channel->isOpen())
+                handleData(*channel, data);
+            else
+                ++statistics.invalidFrameCount;
+            break;
+
+        default:
+            ++statistics.invalidFrameCount;
+            break;
+    }
+}
+
+void CmuxMultiplexer::handleOpen(uint8_t dlci)
+{
+    // Peer starts the session as the initiator
+    if (dlci == 0)
+    {
+        initiator = false;
+        controlState = CmuxChannelState::CMUX_CHANNEL_OPEN;
+        queueFrame(0, false, CONTROL_UA | POLL_FINAL_BIT);
+        return;
+    }
+
+    if ((controlState != CmuxChannelState::CMUX_CHANNEL_OPEN) || (!channels[dlci] && !accept))
+    {
+        queueFrame(dlci, false, CONTROL_DM | POLL_FINAL_BIT);
+        return;
+    }
+
+    try
+    {
+        auto& channel{channels[dlci] ? *channels[dlci] : createChannel(dlci, acceptPseudoTerminal)};
+        channel.state = CmuxChannelState::CMUX_CHANNEL_OPEN;
+        channel.signalsChanged = true;
+        queueFrame(dlci, false, CONTROL_UA | POLL_FINAL_BIT);
+    }
+    catch (const std::exception&)
+    {
+        queueFrame(dlci, false, CONTROL_DM | POLL_FINAL_BIT);
+    }
+}
+
+void CmuxMultiplexer::handleControl(std::string_view data)
+{
+    size_t offset{0};
+    while (offset < data.size())
+    {
+        // Type and length fields with extension bits
+        const auto type{static_cast<uint8_t>(data[offset++])};
+        size_t length{0};
+        unsigned shift{0};
+        while (offset < data.size())
+        {
+            const auto value{static_cast<uint8_t>(data[offset++])};
+            length |= static_cast<size_t>(value >> 1) << shift;
+            shift += 7;
+            if ((value & EXTENSION_BIT) != 0)
+                break;
+        }
+        if ((type & EXTENSION_BIT) == 0 || (length > (data.size() - offset)))
+        {
+            ++statistics.invalidFrameCount;
+            return;
+        }
+
+        handleMessage(type, data.substr(offset, length));
+        offset += length;
+    }
+}
+
+void CmuxMultiplexer::handleMessage(uint8_t type, std::string_view values)
+{
+    const auto message{static_cast<uint8_t>(type & ~(COMMAND_BIT | EXTENSION_BIT))};
+    if ((type & COMMAND_BIT) == 0)
+    {
+        // Only the close down response changes the state
+        if ((message == MESSAGE_CLD) && (controlState == CmuxChannelState::CMUX_CHANNEL_CLOSING))
+            closeAll();
+        return;
+    }
+
+    switch (message)
+    {
+        case MESSAGE_CLD:
+            queueMessage(MESSAGE_CLD, false, std::string_view());
+            closeAll();
+            break;
+
+        case MESSAGE_MSC:
+        {
+            if (values.size() >= 2)
+            {
+                auto* channel{channels[static_cast<uint8_t>(values[0]) >> 2].get()};
+                if (channel)
+                {
+                    const auto signals{static_cast<uint8_t>(values[1])};
+                    const auto peerStopped{(signals & SIGNAL_FC) != 0};
+                    if (peerStopped && !channel->peerStopped)
+                        ++channel->statistics.flowStopCount;
+                    channel->peerSignals = signals;
+                    channel->peerStopped = peerStopped;
+                }
+            }
+            queueMessage(MESSAGE_MSC, false, values);
+            break;
+        }
+
+        case MESSAGE_FCON:
+        case MESSAGE_FCOFF:
+            aggregateStopped = (message == MESSAGE_FCOFF);
+            queueMessage(message, false, std::string_view());
+            break;
+
+        case MESSAGE_TEST:
+        case MESSAGE_PN:
+            // Proposed parameters are accepted as they are
+            queueMessage(message, false, values);
+            break;
+
+        default:
+        {
+            const char value{static_cast<char>(type)};
+            queueMessage(MESSAGE_NSC, false, std::string_view(&value, 1));
+            ++statistics.unsupportedCount;
+            break;
+        }
+    }
+}
+
+void CmuxMultiplexer::handleData(CmuxChannel& channel, std::string_view data)
+{
+    const auto count{channel.input.push(data.data(), data.size())};
+    channel.statistics.receivedCount += count;
+    channel.statistics.droppedCount += data.size() - count;
+    if (channel.master != INVALID_FILE_DESCRIPTOR)
+        writePseudoTerminal(channel);
+
+    // Stop the peer once the receive buffer is half full
+    if (!channel.localStopped && (channel.input.size >= (bufferSize / 2)))
+    {
+        channel.localStopped = true;
+        ++channel.statistics.flowOffCount;
+        queueSignals(channel);
+    }
+}
+
+void CmuxMultiplexer::readPseudoTerminal(CmuxChannel& channel)
+{
+    char* space{nullptr};
+    while (channel.isOpen())
+    {
+        const auto size{channel.output.reserve(space)};
+        if (size == 0)
+            return;
+
+        const auto count{systemCall(::read, channel.master, space, size)};
+        if (count <= 0)
+            return;
+
+        channel.output.commit(static_cast<size_t>(count));
+    }
+}
+
+void CmuxMultiplexer::writePseudoTerminal(CmuxChannel& channel)
+{
+    const char* data{nullptr};
+    while (channel.input.size > 0)
+    {
+        const auto size{channel.input.peek(data)};
+        const auto count{systemCall(::write, channel.master, data, size)};
+        if (count <= 0)
+            return;
+
+        channel.input.consume(static_cast<size_t>(count));
+    }
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,575 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_rtu.hpp>
+#include <serialport/linux/modbus_master.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Default response timeout
+     *
+     */
+    constexpr std::chrono::milliseconds DEFAULT_RESPONSE_TIMEOUT{1000};
+
+    /**
+     * @brief Default turnaround delay after a broadcast request
+     *
+     */
+    constexpr std::chrono::milliseconds DEFAULT_TURNAROUND_DELAY{100};
+
+    /**
+     * @brief Coil value of an active coil
+     *
+     */
+    constexpr uint16_t COIL_ON{0xFF00U};
+
+    /**
+     * @brief Reference type of a file record sub-request
+     *
+     */
+    constexpr uint8_t FILE_RECORD_REFERENCE{6U};
+
+    /**
+     * @brief Maximum number of registers of a single file record read
+     *
+     */
+    constexpr uint16_t MAX_FILE_READ_REGISTERS{121U};
+
+    /**
+     * @brief Maximum number of registers of a single file record write
+     *
+     */
+    constexpr uint16_t MAX_FILE_WRITE_REGISTERS{119U};
+
+    /**
+     * @brief Check whether a value count is within the protocol limits
+     *
+     * @param count Value count
+     * @param maxCount Maximum value count
+     * @return true Value count is valid
+     * @return false Value count is zero or too large
+     */
+    inline bool isValidCount(uint16_t count, uint16_t maxCount)
+    {
+        return ((count > 0) && (count <= maxCount));
+    }
+
+    /**
+     * @brief Read register values of a response
+     *
+     * @param data Response data
+     * @param count Number of registers
+     * @param values Register values
+     */
+    inline void readRegisters(const char* data, uint16_t count, uint16_t* values)
+    {
+        for (uint16_t index{0}; index < count; ++index)
+            values[index] = readModbusValue(data + (index * 2));
+    }
+
+    /**
+     * @brief Write register values of a request
+     *
+     * @param data Request data
+     * @param count Number of registers
+     * @param values Register values
+     */
+    inline void writeRegisters(char* data, uint16_t count, const uint16_t* values)
+    {
+        for (uint16_t index{0}; index < count; ++index)
+            writeModbusValue(data + (index * 2), values[index]);
+    }
+
+    /**
+     * @brief Remove the byte count of a byte counted response
+     *
+     * @param response Response data starting with the byte count
+     * @return true Byte count matches the response size
+     * @return false Byte count does not match the response size
+     */
+    inline bool removeByteCount(std::string_view& response)
+    {
+        if (response.empty() || (static_cast<uint8_t>(response[0]) != (response.size() - 1)))
+            return false;
+
+        response.remove_prefix(1);
+        return true;
+    }
+} // namespace
+
+ModbusMaster::ModbusMaster(SerialPort& serialPort) :
+    link{serialPort}, transmitBuffer{}, lastException{ModbusException::MODBUS_EXCEPTION_NONE},
+    responseTimeout{DEFAULT_RESPONSE_TIMEOUT}, turnaroundDelay{DEFAULT_TURNAROUND_DELAY}
+{
+
+}
+
+ModbusStatus ModbusMaster::readCoils(uint8_t unit, uint16_t address, uint16_t count, bool* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_READ_BITS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    std::string_view response;
+    const auto status{readValues(unit, ModbusFunction::MODBUS_READ_COILS, address, count, (count + 7U) / 8U, response)};
+    if (status == ModbusStatus::MODBUS_SUCCESS)
+        unpackModbusBits(response.data(), count, values);
+    return status;
+}
+
+ModbusStatus ModbusMaster::readDiscreteInputs(uint8_t unit, uint16_t address, uint16_t count, bool* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_READ_BITS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    std::string_view response;
+    const auto status{readValues(unit, ModbusFunction::MODBUS_READ_DISCRETE_INPUTS, address, count, (count + 7U) / 8U, response)};
+    if (status == ModbusStatus::MODBUS_SUCCESS)
+        unpackModbusBits(response.data(), count, values);
+    return status;
+}
+
+ModbusStatus ModbusMaster::readHoldingRegisters(uint8_t unit, uint16_t address, uint16_t count, uint16_t* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_READ_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    std::string_view response;
+    const auto status{readValues(unit, ModbusFunction::MODBUS_READ_HOLDING_REGISTERS, address, count, count * 2U, response)};
+    if (status == ModbusStatus::MODBUS_SUCCESS)
+        readRegisters(response.data(), count, values);
+    return status;
+}
+
+ModbusStatus ModbusMaster::readInputRegisters(uint8_t unit, uint16_t address, uint16_t count, uint16_t* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_READ_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    std::string_view response;
+    const auto status{readValues(unit, ModbusFunction::MODBUS_READ_INPUT_REGISTERS, address, count, count * 2U, response)};
+    if (status == ModbusStatus::MODBUS_SUCCESS)
+        readRegisters(response.data(), count, values);
+    return status;
+}
+
+ModbusStatus ModbusMaster::writeSingleCoil(uint8_t unit, uint16_t address, bool value)
+{
+    auto data{startRequest(unit, ModbusFunction::MODBUS_WRITE_SINGLE_COIL)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, value ? COIL_ON : 0U);
+
+    std::string_view response;
+    return execute(4, 4, response);
+}
+
+ModbusStatus ModbusMaster::writeSingleRegister(uint8_t unit, uint16_t address, uint16_t value)
+{
+    auto data{startRequest(unit, ModbusFunction::MODBUS_WRITE_SINGLE_REGISTER)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, value);
+
+    std::string_view response;
+    return execute(4, 4, response);
+}
+
+ModbusStatus ModbusMaster::readExceptionStatus(uint8_t unit, uint8_t& status)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    startRequest(unit, ModbusFunction::MODBUS_READ_EXCEPTION_STATUS);
+
+    std::string_view response;
+    const auto result{execute(0, 0, response)};
+    if (result != ModbusStatus::MODBUS_SUCCESS)
+        return result;
+    if (response.size() != 1)
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    status = static_cast<uint8_t>(response[0]);
+    return result;
+}
+
+ModbusStatus ModbusMaster::diagnostics(uint8_t unit, uint16_t subFunction, uint16_t data, uint16_t& result)
+{
+    auto request{startRequest(unit, ModbusFunction::MODBUS_DIAGNOSTICS)};
+    writeModbusValue(request, subFunction);
+    writeModbusValue(request + 2, data);
+
+    // Response echoes the sub-function
+    std::string_view response;
+    const auto status{execute(4, 2, response)};
+    if ((status != ModbusStatus::MODBUS_SUCCESS) || (unit == MODBUS_BROADCAST_ADDRESS))
+        return status;
+    if (response.size() != 4)
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    result = readModbusValue(response.data() + 2);
+    return status;
+}
+
+ModbusStatus ModbusMaster::getCommEventCounter(uint8_t unit, uint16_t& status, uint16_t& eventCount)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    startRequest(unit, ModbusFunction::MODBUS_GET_COMM_EVENT_COUNTER);
+
+    std::string_view response;
+    const auto result{execute(0, 0, response)};
+    if (result != ModbusStatus::MODBUS_SUCCESS)
+        return result;
+    if (response.size() != 4)
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    status = readModbusValue(response.data());
+    eventCount = readModbusValue(response.data() + 2);
+    return result;
+}
+
+ModbusStatus ModbusMaster::getCommEventLog(uint8_t unit, std::string_view& log)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    startRequest(unit, ModbusFunction::MODBUS_GET_COMM_EVENT_LOG);
+
+    std::string_view response;
+    const auto status{execute(0, 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+    if (!removeByteCount(response) || (response.size() < 6))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    log = response;
+    return status;
+}
+
+ModbusStatus ModbusMaster::writeMultipleCoils(uint8_t unit, uint16_t address, uint16_t count, const bool* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_WRITE_BITS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    const auto byteCount{(count + 7U) / 8U};
+    auto data{startRequest(unit, ModbusFunction::MODBUS_WRITE_MULTIPLE_COILS)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, count);
+    data[4] = static_cast<char>(byteCount);
+    packModbusBits(values, count, data + 5);
+
+    // Response echoes the address and count
+    std::string_view response;
+    return execute(5 + byteCount, 4, response);
+}
+
+ModbusStatus ModbusMaster::writeMultipleRegisters(uint8_t unit, uint16_t address, uint16_t count, const uint16_t* values)
+{
+    if (!isValidCount(count, MODBUS_MAX_WRITE_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto data{startRequest(unit, ModbusFunction::MODBUS_WRITE_MULTIPLE_REGISTERS)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, count);
+    data[4] = static_cast<char>(count * 2U);
+    writeRegisters(data + 5, count, values);
+
+    // Response echoes the address and count
+    std::string_view response;
+    return execute(5 + (count * 2U), 4, response);
+}
+
+ModbusStatus ModbusMaster::reportServerId(uint8_t unit, std::string_view& data)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    startRequest(unit, ModbusFunction::MODBUS_REPORT_SERVER_ID);
+
+    std::string_view response;
+    const auto status{execute(0, 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+    if (!removeByteCount(response))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    data = response;
+    return status;
+}
+
+ModbusStatus ModbusMaster::readFileRecord(uint8_t unit, uint16_t file, uint16_t record, uint16_t count, uint16_t* values)
+{
+    if ((unit == MODBUS_BROADCAST_ADDRESS) || !isValidCount(count, MAX_FILE_READ_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto data{startRequest(unit, ModbusFunction::MODBUS_READ_FILE_RECORD)};
+    data[0] = 7;
+    data[1] = static_cast<char>(FILE_RECORD_REFERENCE);
+    writeModbusValue(data + 2, file);
+    writeModbusValue(data + 4, record);
+    writeModbusValue(data + 6, count);
+
+    std::string_view response;
+    const auto status{execute(8, 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+
+    // Single sub-response of the file record length and reference type
+    if (!removeByteCount(response) || (response.size() != (2U + (count * 2U))) ||
+        (static_cast<uint8_t>(response[0]) != (1U + (count * 2U))) ||
+        (static_cast<uint8_t>(response[1]) != FILE_RECORD_REFERENCE))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    readRegisters(response.data() + 2, count, values);
+    return status;
+}
+
+ModbusStatus ModbusMaster::writeFileRecord(uint8_t unit, uint16_t file, uint16_t record, uint16_t count, const uint16_t* values)
+{
+    if (!isValidCount(count, MAX_FILE_WRITE_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    const auto size{8U + (count * 2U)};
+    auto data{startRequest(unit, ModbusFunction::MODBUS_WRITE_FILE_RECORD)};
+    data[0] = static_cast<char>(size - 1U);
+    data[1] = static_cast<char>(FILE_RECORD_REFERENCE);
+    writeModbusValue(data + 2, file);
+    writeModbusValue(data + 4, record);
+    writeModbusValue(data + 6, count);
+    writeRegisters(data + 8, count, values);
+
+    // Response echoes the whole request
+    std::string_view response;
+    return execute(size, size, response);
+}
+
+ModbusStatus ModbusMaster::maskWriteRegister(uint8_t unit, uint16_t address, uint16_t andMask, uint16_t orMask)
+{
+    auto data{startRequest(unit, ModbusFunction::MODBUS_MASK_WRITE_REGISTER)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, andMask);
+    writeModbusValue(data + 4, orMask);
+
+    std::string_view response;
+    return execute(6, 6, response);
+}
+
+ModbusStatus ModbusMaster::readWriteMultipleRegisters(uint8_t unit, uint16_t readAddress, uint16_t readCount, uint16_t* readValues,
+    uint16_t writeAddress, uint16_t writeCount, const uint16_t* writeValues)
+{
+    if ((unit == MODBUS_BROADCAST_ADDRESS) || !isValidCount(readCount, MODBUS_MAX_READ_REGISTERS) ||
+        !isValidCount(writeCount, MODBUS_MAX_READ_WRITE_REGISTERS))
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto data{startRequest(unit, ModbusFunction::MODBUS_READ_WRITE_MULTIPLE_REGISTERS)};
+    writeModbusValue(data, readAddress);
+    writeModbusValue(data + 2, readCount);
+    writeModbusValue(data + 4, writeAddress);
+    writeModbusValue(data + 6, writeCount);
+    data[8] = static_cast<char>(writeCount * 2U);
+    writeRegisters(data + 9, writeCount, writeValues);
+
+    std::string_view response;
+    const auto status{execute(9 + (writeCount * 2U), 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+    if (!removeByteCount(response) || (response.size() != (readCount * 2U)))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    readRegisters(response.data(), readCount, readValues);
+    return status;
+}
+
+ModbusStatus ModbusMaster::readFifoQueue(uint8_t unit, uint16_t address, uint16_t* values, uint16_t& count)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto data{startRequest(unit, ModbusFunction::MODBUS_READ_FIFO_QUEUE)};
+    writeModbusValue(data, address);
+
+    std::string_view response;
+    const auto status{execute(2, 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+
+    // 16-bit byte count covers the FIFO count and the values
+    if ((response.size() < 4) || (readModbusValue(response.data()) != (response.size() - 2)))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    const auto fifoCount{readModbusValue(response.data() + 2)};
+    if ((fifoCount > MODBUS_MAX_FIFO_COUNT) || (response.size() != (4U + (fifoCount * 2U))))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    readRegisters(response.data() + 4, fifoCount, values);
+    count = fifoCount;
+    return status;
+}
+
+ModbusStatus ModbusMaster::encapsulatedInterfaceTransport(uint8_t unit, uint8_t meiType, const char* data, size_t size,
+    std::string_view& response)
+{
+    if ((size + 2) > MODBUS_MAX_PDU_SIZE)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto request{startRequest(unit, ModbusFunction::MODBUS_ENCAPSULATED_INTERFACE_TRANSPORT)};
+    request[0] = static_cast<char>(meiType);
+    std::memcpy(request + 1, data, size);
+
+    // Response echoes the MEI type
+    const auto status{execute(size + 1, 1, response)};
+    if ((status == ModbusStatus::MODBUS_SUCCESS) && !response.empty())
+        response.remove_prefix(1);
+    return status;
+}
+
+ModbusStatus ModbusMaster::transact(uint8_t unit, ModbusFunction function, const char* data, size_t size,
+    std::string_view& response)
+{
+    if ((size + 1) > MODBUS_MAX_PDU_SIZE)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    std::memcpy(startRequest(unit, function), data, size);
+    return execute(size, 0, response);
+}
+
+ModbusException ModbusMaster::getLastException() const
+{
+    return lastException;
+}
+
+std::chrono::milliseconds ModbusMaster::getResponseTimeout() const
+{
+    return responseTimeout;
+}
+
+void ModbusMaster::setResponseTimeout(std::chrono::milliseconds responseTimeout)
+{
+    this->responseTimeout = responseTimeout;
+}
+
+std::chrono::milliseconds ModbusMaster::getTurnaroundDelay() const
+{
+    return turnaroundDelay;
+}
+
+void ModbusMaster::setTurnaroundDelay(std::chrono::milliseconds turnaroundDelay)
+{
+    this->turnaroundDelay = turnaroundDelay;
+}
+
+ModbusRtuLink& ModbusMaster::getLink()
+{
+    return link;
+}
+
+char* ModbusMaster::startRequest(uint8_t unit, ModbusFunction function)
+{
+    transmitBuffer[0] = static_cast<char>(unit);
+    transmitBuffer[1] = static_cast<char>(function);
+    return (transmitBuffer.data() + 2);
+}
+
+ModbusStatus ModbusMaster::execute(size_t size, size_t echoSize, std::string_view& response)
+{
+    const auto unit{static_cast<uint8_t>(transmitBuffer[0])};
+    const auto function{static_cast<uint8_t>(transmitBuffer[1])};
+    if (unit > MODBUS_MAX_UNIT_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    lastException = ModbusException::MODBUS_EXCEPTION_NONE;
+    const auto frameSize{appendModbusCrc(transmitBuffer.data(), size + 2)};
+
+    // Stale data would be mistaken for the response
+    link.discardInput();
+    const auto status{link.send(transmitBuffer.data(), frameSize)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+
+    // Broadcast requests are not answered
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+    {
+        link.holdLine(turnaroundDelay);
+        response = std::string_view();
+        return status;
+    }
+
+    const auto deadline{std::chrono::steady_clock::now() + link.getWireTime(frameSize) + responseTimeout};
+    while (true)
+    {
+        const auto now{std::chrono::steady_clock::now()};
+        if (now >= deadline)
+            return ModbusStatus::MODBUS_TIMEOUT;
+
+        std::string_view frame;
+        const auto result{link.receive(frame, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now), false)};
+        if (result != ModbusStatus::MODBUS_SUCCESS)
+            return result;
+
+        // Frames of other units or of a previous request are ignored
+        const auto responseFunction{static_cast<uint8_t>(frame[1])};
+        if (static_cast<uint8_t>(frame[0]) != unit)
+            continue;
+
+        if (responseFunction == (function | MODBUS_EXCEPTION_FLAG))
+        {
+            lastException = static_cast<ModbusException>(frame[2]);
+            return ModbusStatus::MODBUS_EXCEPTION;
+        }
+        if (responseFunction != function)
+            continue;
+
+        response = frame.substr(2, frame.size() - 4);
+        if ((response.size() < echoSize) || (std::memcmp(response.data(), transmitBuffer.data() + 2, echoSize) != 0))
+            return ModbusStatus::MODBUS_INVALID_FRAME;
+
+        return ModbusStatus::MODBUS_SUCCESS;
+    }
+}
+
+ModbusStatus ModbusMaster::readValues(uint8_t unit, ModbusFunction function, uint16_t address, uint16_t count,
+    size_t byteCount, std::string_view& response)
+{
+    if (unit == MODBUS_BROADCAST_ADDRESS)
+        return ModbusStatus::MODBUS_INVALID_REQUEST;
+
+    auto data{startRequest(unit, function)};
+    writeModbusValue(data, address);
+    writeModbusValue(data + 2, count);
+
+    const auto status{execute(4, 0, response)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+    if (!removeByteCount(response) || (response.size() != byteCount))
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+
+    return status;
+}
+
+END_NAMESPACE_LIBSERIAL
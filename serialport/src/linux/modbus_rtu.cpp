@@ -0,0 +1,290 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_rtu.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Size of the scratch buffer used to discard an overlong frame
+     *
+     */
+    constexpr size_t DISCARD_BUFFER_SIZE{64};
+
+    /**
+     * @brief Check whether a decoded frame size is known
+     *
+     * @param frameSize Result of getModbusFrameSize
+     * @return true Frame size is known
+     * @return false Frame size is not known yet or only known from the inter-frame delay
+     */
+    inline bool isFrameSizeKnown(size_t frameSize)
+    {
+        return ((frameSize != 0) && (frameSize != static_cast<size_t>(-1)));
+    }
+} // namespace
+
+ModbusRtuLink::ModbusRtuLink(SerialPort& serialPort) :
+    serialPort{serialPort}, timer{INVALID_FILE_DESCRIPTOR}, timing{}, idleTime{}, receiveTime{}, receiveBuffer{},
+    pendingBegin{0}, pendingEnd{0}, statistics{}
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+
+    updateTiming();
+
+    timer = systemCall(::timerfd_create, CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create timer");
+}
+
+ModbusRtuLink::~ModbusRtuLink() noexcept
+{
+    systemCall(::close, timer);
+}
+
+void ModbusRtuLink::updateTiming()
+{
+    timing = calculateModbusTiming(serialPort.getBaudRate(), serialPort.getCharacterSize(),
+        serialPort.getParity(), serialPort.getStopBit());
+}
+
+const ModbusTiming& ModbusRtuLink::getTiming() const
+{
+    return timing;
+}
+
+std::chrono::microseconds ModbusRtuLink::getWireTime(size_t size) const
+{
+    return (timing.characterTime * static_cast<long>(size));
+}
+
+ModbusStatus ModbusRtuLink::send(const char* frame, size_t size)
+{
+    // Keep the line idle for the inter-frame delay
+    if (std::chrono::steady_clock::now() < idleTime)
+        std::this_thread::sleep_until(idleTime);
+
+    size_t written{0};
+    while (written < size)
+    {
+        const auto count{serialPort.write(frame + written, size - written)};
+        if ((count == static_cast<size_t>(-1)) && (errno != EAGAIN))
+            return ModbusStatus::MODBUS_IO_ERROR;
+
+        if ((count == 0) || (count == static_cast<size_t>(-1)))
+        {
+            // Wait for space in the transmit queue for the wire time of the queued and remaining data
+            const auto pending{serialPort.getOutputQueueCount() + size - written};
+            const auto timeout{std::chrono::duration_cast<std::chrono::milliseconds>(getWireTime(pending)).count() + 1};
+            struct pollfd descriptor{serialPort.getNativeHandle(), POLLOUT, 0};
+            if (systemCall(::poll, &descriptor, 1, static_cast<int>(timeout)) <= 0)
+                return ModbusStatus::MODBUS_IO_ERROR;
+            continue;
+        }
+        written += count;
+    }
+
+    // Frame leaves the transmit queue after its wire time
+    idleTime = std::chrono::steady_clock::now() + getWireTime(size) + timing.interFrameDelay;
+    ++statistics.transmittedCount;
+    return ModbusStatus::MODBUS_SUCCESS;
+}
+
+ModbusStatus ModbusRtuLink::receive(std::string_view& frame, std::chrono::microseconds timeout, bool request,
+    int stopEvent)
+{
+    // Data received after the previous frame starts the next frame
+    size_t size{pendingEnd - pendingBegin};
+    if ((size > 0) && (pendingBegin > 0))
+        std::memmove(receiveBuffer.data(), receiveBuffer.data() + pendingBegin, size);
+    pendingBegin = 0;
+    pendingEnd = 0;
+
+    const auto fileDescriptor{serialPort.getNativeHandle()};
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    auto lastReceiveTime{std::chrono::steady_clock::now()};
+    auto frameSize{getModbusFrameSize(receiveBuffer.data(), size, request)};
+    auto complete{isFrameSizeKnown(frameSize) && (size >= frameSize)};
+    auto overflow{false};
+    if (complete)
+        ++statistics.earlyCompletionCount;
+    else if ((size > 0) && !armTimer(timing.interFrameDelay))
+        return ModbusStatus::MODBUS_IO_ERROR;
+
+    while (!complete)
+    {
+        // Deadline only applies until the first byte of the frame arrives
+        struct timespec remaining{};
+        const struct timespec* pollTimeout{nullptr};
+        if (size == 0)
+        {
+            const auto now{std::chrono::steady_clock::now()};
+            if (now >= deadline)
+            {
+                ++statistics.timeoutCount;
+                return ModbusStatus::MODBUS_TIMEOUT;
+            }
+            remaining = toTimespec(deadline - now);
+            pollTimeout = &remaining;
+        }
+
+        // Negative descriptors are ignored when no stop event is given
+        struct pollfd descriptors[3]{{fileDescriptor, POLLIN, 0}, {timer, POLLIN, 0}, {stopEvent, POLLIN, 0}};
+        const auto result{systemCall(::ppoll, descriptors, 3, pollTimeout, nullptr)};
+        if (result < 0)
+        {
+            armTimer(std::chrono::microseconds{0});
+            return ModbusStatus::MODBUS_IO_ERROR;
+        }
+
+        // Partially received frames are discarded when stopped
+        if ((descriptors[2].revents & POLLIN) != 0)
+        {
+            armTimer(std::chrono::microseconds{0});
+            return ModbusStatus::MODBUS_TIMEOUT;
+        }
+
+        if ((descriptors[0].revents & POLLIN) != 0)
+        {
+            // Overlong frames are discarded until the line becomes idle
+            char discardBuffer[DISCARD_BUFFER_SIZE];
+            const auto full{size == receiveBuffer.size()};
+            const auto count{full ? serialPort.read(discardBuffer, sizeof(discardBuffer)) :
+                serialPort.read(receiveBuffer.data() + size, receiveBuffer.size() - size)};
+            if ((count == static_cast<size_t>(-1)) || ((count == 0) && ((descriptors[0].revents & POLLHUP) != 0)))
+            {
+                armTimer(std::chrono::microseconds{0});
+                return ModbusStatus::MODBUS_IO_ERROR;
+            }
+
+            if (count > 0)
+            {
+                lastReceiveTime = std::chrono::steady_clock::now();
+                overflow = (overflow || full);
+                if (!full)
+                    size += count;
+
+                if (!isFrameSizeKnown(frameSize))
+                    frameSize = getModbusFrameSize(receiveBuffer.data(), size, request);
+                complete = (!overflow && isFrameSizeKnown(frameSize) && (size >= frameSize));
+                if (complete)
+                    ++statistics.earlyCompletionCount;
+                else if (!armTimer(timing.interFrameDelay))
+                    return ModbusStatus::MODBUS_IO_ERROR;
+
+                // Re-arming the timer cleared its expirations
+                continue;
+            }
+        }
+        else if ((descriptors[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0)
+        {
+            armTimer(std::chrono::microseconds{0});
+            return ModbusStatus::MODBUS_IO_ERROR;
+        }
+
+        // Silence of the inter-frame delay ends the frame
+        uint64_t expirations{0};
+        if (((descriptors[1].revents & POLLIN) != 0) &&
+            (systemCall(::read, timer, &expirations, sizeof(expirations)) == static_cast<ssize_t>(sizeof(expirations))))
+            break;
+    }
+    armTimer(std::chrono::microseconds{0});
+    receiveTime = lastReceiveTime;
+    idleTime = std::max(idleTime, lastReceiveTime + timing.interFrameDelay);
+
+    const auto truncated{isFrameSizeKnown(frameSize) ? (size < frameSize) : (size < MODBUS_MIN_FRAME_SIZE)};
+    if (overflow || truncated)
+    {
+        ++statistics.invalidFrameCount;
+        return ModbusStatus::MODBUS_INVALID_FRAME;
+    }
+
+    // Keep data which arrived after the end of the frame
+    if (isFrameSizeKnown(frameSize) && (size > frameSize))
+    {
+        pendingBegin = frameSize;
+        pendingEnd = size;
+        size = frameSize;
+    }
+
+    if (!checkModbusCrc(receiveBuffer.data(), size))
+    {
+        ++statistics.crcErrorCount;
+        return ModbusStatus::MODBUS_CRC_ERROR;
+    }
+
+    ++statistics.receivedCount;
+    frame = std::string_view(receiveBuffer.data(), size);
+    return ModbusStatus::MODBUS_SUCCESS;
+}
+
+void ModbusRtuLink::holdLine(std::chrono::microseconds delay)
+{
+    idleTime = std::max(idleTime, std::chrono::steady_clock::now()) + delay;
+}
+
+void ModbusRtuLink::setIdleTime(std::chrono::steady_clock::time_point idleTime)
+{
+    this->idleTime = idleTime;
+}
+
+std::chrono::steady_clock::time_point ModbusRtuLink::getReceiveTime() const
+{
+    return receiveTime;
+}
+
+void ModbusRtuLink::discardInput()
+{
+    serialPort.flushInput();
+    pendingBegin = 0;
+    pendingEnd = 0;
+}
+
+ModbusLinkStatistics ModbusRtuLink::getStatistics() const
+{
+    return statistics;
+}
+
+bool ModbusRtuLink::armTimer(std::chrono::microseconds delay) const
+{
+    struct itimerspec specification{};
+    specification.it_value = toTimespec(delay);
+    return (systemCall(::timerfd_settime, timer, 0, &specification, nullptr) == 0);
+}
+
+END_NAMESPACE_LIBSERIAL
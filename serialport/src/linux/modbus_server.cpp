@@ -0,0 +1,486 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_rtu.hpp>
+#include <serialport/linux/modbus_server.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Receive timeout of the run loop, the stop event ends the wait earlier
+     *
+     */
+    constexpr std::chrono::milliseconds RUN_RECEIVE_TIMEOUT{1000};
+
+    /**
+     * @brief Coil value of an active coil
+     *
+     */
+    constexpr uint16_t COIL_ON{0xFF00U};
+
+    /**
+     * @brief Diagnostics sub-function returning the query data
+     *
+     */
+    constexpr uint16_t RETURN_QUERY_DATA{0x0000U};
+
+    /**
+     * @brief Run indicator of the report server identifier response
+     *
+     */
+    constexpr uint8_t RUN_INDICATOR_ON{0xFFU};
+
+    /**
+     * @brief Check whether a request addresses existing values
+     *
+     * @param address Starting address
+     * @param count Number of values
+     * @param size Number of available values
+     * @return true Addressed values exist
+     * @return false Addressed values exceed the available values
+     */
+    inline bool isValidRange(uint16_t address, uint16_t count, size_t size)
+    {
+        return ((static_cast<size_t>(address) + count) <= size);
+    }
+
+    /**
+     * @brief Check whether a value count is within the protocol limits
+     *
+     * @param count Value count
+     * @param maxCount Maximum value count
+     * @return true Value count is valid
+     * @return false Value count is zero or too large
+     */
+    inline bool isValidCount(uint16_t count, uint16_t maxCount)
+    {
+        return ((count > 0) && (count <= maxCount));
+    }
+} // namespace
+
+ModbusServer::ModbusServer(SerialPort& serialPort, uint8_t unit, size_t coilCount, size_t discreteInputCount,
+    size_t holdingRegisterCount, size_t inputRegisterCount) :
+    link{serialPort}, unit{unit}, coils{new bool[coilCount]()}, coilCount{coilCount},
+    discreteInputs{new bool[discreteInputCount]()}, discreteInputCount{discreteInputCount},
+    holdingRegisters{new uint16_t[holdingRegisterCount]()}, holdingRegisterCount{holdingRegisterCount},
+    inputRegisters{new uint16_t[inputRegisterCount]()}, inputRegisterCount{inputRegisterCount},
+    readHook{}, writeHook{}, responseDelay{0}, eventCount{0}, stopEvent{INVALID_FILE_DESCRIPTOR}, transmitBuffer{}, statistics{}
+{
+    if ((unit == MODBUS_BROADCAST_ADDRESS) || (unit > MODBUS_MAX_UNIT_ADDRESS))
+        throw std::out_of_range("Invalid unit address");
+
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopEvent == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create event");
+}
+
+ModbusServer::~ModbusServer() noexcept
+{
+    systemCall(::close, stopEvent);
+}
+
+ModbusStatus ModbusServer::poll(std::chrono::milliseconds timeout)
+{
+    return serve(timeout, false);
+}
+
+void ModbusServer::run()
+{
+    // A stop requested before run() stays pending in the stop event
+    while (true)
+    {
+        const auto status{serve(RUN_RECEIVE_TIMEOUT, true)};
+        if (status == ModbusStatus::MODBUS_IO_ERROR)
+            break;
+
+        uint64_t value{0};
+        if ((status == ModbusStatus::MODBUS_TIMEOUT) &&
+            (systemCall(::read, stopEvent, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))))
+            break;
+    }
+}
+
+void ModbusServer::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+ModbusStatus ModbusServer::serve(std::chrono::milliseconds timeout, bool stoppable)
+{
+    std::string_view request;
+    auto status{link.receive(request, timeout, true, stoppable ? stopEvent : INVALID_FILE_DESCRIPTOR)};
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+
+    const auto requestUnit{static_cast<uint8_t>(request[0])};
+    if ((requestUnit != unit) && (requestUnit != MODBUS_BROADCAST_ADDRESS))
+    {
+        ++statistics.ignoredCount;
+        return status;
+    }
+
+    ++statistics.requestCount;
+    const auto responseSize{process(request.data(), request.size())};
+
+    // Broadcast requests are not answered
+    if (requestUnit == MODBUS_BROADCAST_ADDRESS)
+    {
+        ++statistics.broadcastCount;
+        return status;
+    }
+
+    // Answer without waiting for the inter-frame delay following the request
+    const auto receiveTime{link.getReceiveTime()};
+    link.setIdleTime(receiveTime + responseDelay);
+    status = link.send(transmitBuffer.data(), appendModbusCrc(transmitBuffer.data(), responseSize + 1));
+    if (status != ModbusStatus::MODBUS_SUCCESS)
+        return status;
+
+    const auto latency{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - receiveTime)};
+    ++statistics.responseCount;
+    statistics.lastResponseLatency = latency;
+    statistics.maxResponseLatency = std::max(statistics.maxResponseLatency, latency);
+    statistics.totalResponseLatency += latency;
+    return status;
+}
+
+bool* ModbusServer::getCoils()
+{
+    return coils.get();
+}
+
+size_t ModbusServer::getCoilCount() const
+{
+    return coilCount;
+}
+
+bool* ModbusServer::getDiscreteInputs()
+{
+    return discreteInputs.get();
+}
+
+size_t ModbusServer::getDiscreteInputCount() const
+{
+    return discreteInputCount;
+}
+
+uint16_t* ModbusServer::getHoldingRegisters()
+{
+    return holdingRegisters.get();
+}
+
+size_t ModbusServer::getHoldingRegisterCount() const
+{
+    return holdingRegisterCount;
+}
+
+uint16_t* ModbusServer::getInputRegisters()
+{
+    return inputRegisters.get();
+}
+
+size_t ModbusServer::getInputRegisterCount() const
+{
+    return inputRegisterCount;
+}
+
+void ModbusServer::setReadHook(AccessHook readHook)
+{
+    this->readHook = std::move(readHook);
+}
+
+void ModbusServer::setWriteHook(AccessHook writeHook)
+{
+    this->writeHook = std::move(writeHook);
+}
+
+uint8_t ModbusServer::getUnit() const
+{
+    return unit;
+}
+
+std::chrono::microseconds ModbusServer::getResponseDelay() const
+{
+    return responseDelay;
+}
+
+void ModbusServer::setResponseDelay(std::chrono::microseconds responseDelay)
+{
+    this->responseDelay = responseDelay;
+}
+
+ModbusServerStatistics ModbusServer::getStatistics() const
+{
+    return statistics;
+}
+
+ModbusRtuLink& ModbusServer::getLink()
+{
+    return link;
+}
+
+size_t ModbusServer::process(const char* request, size_t size)
+{
+    // Response is built in place following the unit address and function code
+    const auto function{static_cast<ModbusFunction>(request[1])};
+    transmitBuffer[0] = static_cast<char>(unit);
+    transmitBuffer[1] = request[1];
+
+    size_t responseSize{0};
+    const auto exception{execute(function, request + 2, size - 4, transmitBuffer.data() + 2, responseSize)};
+    if (exception != ModbusException::MODBUS_EXCEPTION_NONE)
+    {
+        ++statistics.exceptionCount;
+        transmitBuffer[1] = static_cast<char>(static_cast<uint8_t>(request[1]) | MODBUS_EXCEPTION_FLAG);
+        transmitBuffer[2] = static_cast<char>(exception);
+        return 2;
+    }
+
+    ++eventCount;
+    return (responseSize + 1);
+}
+
+ModbusException ModbusServer::execute(ModbusFunction function, const char* data, size_t size, char* response, size_t& responseSize)
+{
+    switch (function)
+    {
+        case ModbusFunction::MODBUS_READ_COILS:
+        case ModbusFunction::MODBUS_READ_DISCRETE_INPUTS:
+        {
+            const auto address{readModbusValue(data)};
+            const auto count{readModbusValue(data + 2)};
+            const auto isCoil{function == ModbusFunction::MODBUS_READ_COILS};
+            if ((size != 4) || !isValidCount(count, MODBUS_MAX_READ_BITS))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, count, isCoil ? coilCount : discreteInputCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            const auto exception{callHook(readHook, function, address, count)};
+            if (exception != ModbusException::MODBUS_EXCEPTION_NONE)
+                return exception;
+
+            const auto byteCount{(count + 7U) / 8U};
+            response[0] = static_cast<char>(byteCount);
+            packModbusBits((isCoil ? coils.get() : discreteInputs.get()) + address, count, response + 1);
+            responseSize = 1 + byteCount;
+            return exception;
+        }
+
+        case ModbusFunction::MODBUS_READ_HOLDING_REGISTERS:
+        case ModbusFunction::MODBUS_READ_INPUT_REGISTERS:
+        {
+            const auto address{readModbusValue(data)};
+            const auto count{readModbusValue(data + 2)};
+            const auto isHolding{function == ModbusFunction::MODBUS_READ_HOLDING_REGISTERS};
+            if ((size != 4) || !isValidCount(count, MODBUS_MAX_READ_REGISTERS))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, count, isHolding ? holdingRegisterCount : inputRegisterCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            const auto exception{callHook(readHook, function, address, count)};
+            if (exception != ModbusException::MODBUS_EXCEPTION_NONE)
+                return exception;
+
+            const auto registers{(isHolding ? holdingRegisters.get() : inputRegisters.get()) + address};
+            response[0] = static_cast<char>(count * 2U);
+            for (uint16_t index{0}; index < count; ++index)
+                writeModbusValue(response + 1 + (index * 2U), registers[index]);
+            responseSize = 1 + (count * 2U);
+            return exception;
+        }
+
+        case ModbusFunction::MODBUS_WRITE_SINGLE_COIL:
+        {
+            const auto address{readModbusValue(data)};
+            const auto value{readModbusValue(data + 2)};
+            if ((size != 4) || ((value != COIL_ON) && (value != 0U)))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, 1, coilCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            coils[address] = (value == COIL_ON);
+            std::memcpy(response, data, 4);
+            responseSize = 4;
+            return callHook(writeHook, function, address, 1);
+        }
+
+        case ModbusFunction::MODBUS_WRITE_SINGLE_REGISTER:
+        {
+            const auto address{readModbusValue(data)};
+            if (size != 4)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, 1, holdingRegisterCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            holdingRegisters[address] = readModbusValue(data + 2);
+            std::memcpy(response, data, 4);
+            responseSize = 4;
+            return callHook(writeHook, function, address, 1);
+        }
+
+        case ModbusFunction::MODBUS_DIAGNOSTICS:
+        {
+            if (size != 4)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (readModbusValue(data) != RETURN_QUERY_DATA)
+                return ModbusException::MODBUS_ILLEGAL_FUNCTION;
+
+            std::memcpy(response, data, 4);
+            responseSize = 4;
+            return ModbusException::MODBUS_EXCEPTION_NONE;
+        }
+
+        case ModbusFunction::MODBUS_GET_COMM_EVENT_COUNTER:
+        {
+            if (size != 0)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+
+            writeModbusValue(response, 0U);
+            writeModbusValue(response + 2, eventCount);
+            responseSize = 4;
+            return ModbusException::MODBUS_EXCEPTION_NONE;
+        }
+
+        case ModbusFunction::MODBUS_WRITE_MULTIPLE_COILS:
+        {
+            if (size < 5)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+
+            const auto address{readModbusValue(data)};
+            const auto count{readModbusValue(data + 2)};
+            const auto byteCount{static_cast<uint8_t>(data[4])};
+            if (!isValidCount(count, MODBUS_MAX_WRITE_BITS) || (byteCount != ((count + 7U) / 8U)) || (size != (5U + byteCount)))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, count, coilCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            unpackModbusBits(data + 5, count, coils.get() + address);
+            std::memcpy(response, data, 4);
+            responseSize = 4;
+            return callHook(writeHook, function, address, count);
+        }
+
+        case ModbusFunction::MODBUS_WRITE_MULTIPLE_REGISTERS:
+        {
+            if (size < 5)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+
+            const auto address{readModbusValue(data)};
+            const auto count{readModbusValue(data + 2)};
+            const auto byteCount{static_cast<uint8_t>(data[4])};
+            if (!isValidCount(count, MODBUS_MAX_WRITE_REGISTERS) || (byteCount != (count * 2U)) || (size != (5U + byteCount)))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, count, holdingRegisterCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            for (uint16_t index{0}; index < count; ++index)
+                holdingRegisters[address + index] = readModbusValue(data + 5 + (index * 2U));
+            std::memcpy(response, data, 4);
+            responseSize = 4;
+            return callHook(writeHook, function, address, count);
+        }
+
+        case ModbusFunction::MODBUS_REPORT_SERVER_ID:
+        {
+            if (size != 0)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+
+            response[0] = 2;
+            response[1] = static_cast<char>(unit);
+            response[2] = static_cast<char>(RUN_INDICATOR_ON);
+            responseSize = 3;
+            return ModbusException::MODBUS_EXCEPTION_NONE;
+        }
+
+        case ModbusFunction::MODBUS_MASK_WRITE_REGISTER:
+        {
+            const auto address{readModbusValue(data)};
+            if (size != 6)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(address, 1, holdingRegisterCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            const auto andMask{readModbusValue(data + 2)};
+            const auto orMask{readModbusValue(data + 4)};
+            holdingRegisters[address] = static_cast<uint16_t>((holdingRegisters[address] & andMask) | (orMask & ~andMask));
+            std::memcpy(response, data, 6);
+            responseSize = 6;
+            return callHook(writeHook, function, address, 1);
+        }
+
+        case ModbusFunction::MODBUS_READ_WRITE_MULTIPLE_REGISTERS:
+        {
+            if (size < 9)
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+
+            const auto readAddress{readModbusValue(data)};
+            const auto readCount{readModbusValue(data + 2)};
+            const auto writeAddress{readModbusValue(data + 4)};
+            const auto writeCount{readModbusValue(data + 6)};
+            const auto byteCount{static_cast<uint8_t>(data[8])};
+            if (!isValidCount(readCount, MODBUS_MAX_READ_REGISTERS) || !isValidCount(writeCount, MODBUS_MAX_READ_WRITE_REGISTERS) ||
+                (byteCount != (writeCount * 2U)) || (size != (9U + byteCount)))
+                return ModbusException::MODBUS_ILLEGAL_DATA_VALUE;
+            if (!isValidRange(readAddress, readCount, holdingRegisterCount) ||
+                !isValidRange(writeAddress, writeCount, holdingRegisterCount))
+                return ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS;
+
+            // Write is performed before the read
+            for (uint16_t index{0}; index < writeCount; ++index)
+                holdingRegisters[writeAddress + index] = readModbusValue(data + 9 + (index * 2U));
+            auto exception{callHook(writeHook, function, writeAddress, writeCount)};
+            if (exception == ModbusException::MODBUS_EXCEPTION_NONE)
+                exception = callHook(readHook, function, readAddress, readCount);
+            if (exception != ModbusException::MODBUS_EXCEPTION_NONE)
+                return exception;
+
+            response[0] = static_cast<char>(readCount * 2U);
+            for (uint16_t index{0}; index < readCount; ++index)
+                writeModbusValue(response + 1 + (index * 2U), holdingRegisters[readAddress + index]);
+            responseSize = 1 + (readCount * 2U);
+            return exception;
+        }
+
+        default:
+            return ModbusException::MODBUS_ILLEGAL_FUNCTION;
+    }
+}
+
+ModbusException ModbusServer::callHook(const AccessHook& hook, ModbusFunction function, uint16_t address, uint16_t count)
+{
+    return (hook ? hook(function, address, count) : ModbusException::MODBUS_EXCEPTION_NONE);
+}
+
+END_NAMESPACE_LIBSERIAL
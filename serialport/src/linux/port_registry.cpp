@@ -0,0 +1,321 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/port_registry.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Port flag of a detected hang-up
+     *
+     */
+    static constexpr uint8_t PORT_FLAG_HUNG_UP{0x01};
+
+    /**
+     * @brief Slot index terminating the free slot list
+     *
+     */
+    static constexpr uint32_t INVALID_SLOT{std::numeric_limits<uint32_t>::max()};
+
+    /**
+     * @brief Make a port handle
+     *
+     * @param slot Slot index
+     * @param generation Slot generation
+     * @return PortHandle Port handle
+     */
+    PortHandle makeHandle(uint32_t slot, uint32_t generation)
+    {
+        return ((static_cast<PortHandle>(generation) << 32) | slot);
+    }
+} // namespace
+
+PortRegistry::PortRegistry(size_t capacity) :
+    descriptors{}, flags{}, receivedCounts{}, transmittedCounts{}, errorCounts{},
+    slots{}, ports{}, indices{}, generations{}, freeSlot{INVALID_SLOT}
+{
+    reserve(capacity);
+}
+
+void PortRegistry::reserve(size_t capacity)
+{
+    descriptors.reserve(capacity);
+    flags.reserve(capacity);
+    receivedCounts.reserve(capacity);
+    transmittedCounts.reserve(capacity);
+    errorCounts.reserve(capacity);
+    slots.reserve(capacity);
+    ports.reserve(capacity);
+    indices.reserve(capacity);
+    generations.reserve(capacity);
+}
+
+PortHandle PortRegistry::add(SerialPort serialPort)
+{
+    // Reuse a free slot or append a new one
+    uint32_t slot{freeSlot};
+    if (slot == INVALID_SLOT)
+    {
+        if (indices.size() >= INVALID_SLOT)
+            throw std::out_of_range("Too many ports");
+
+        slot = static_cast<uint32_t>(indices.size());
+        indices.push_back(0);
+        generations.push_back(0);
+    }
+    else
+        freeSlot = indices[slot];
+
+    // Slot is used with an odd generation
+    ++generations[slot];
+    indices[slot] = static_cast<uint32_t>(ports.size());
+
+    descriptors.push_back({serialPort.getNativeHandle(), POLLIN, 0});
+    flags.push_back(0);
+    receivedCounts.push_back(0);
+    transmittedCounts.push_back(0);
+    errorCounts.push_back(0);
+    slots.push_back(slot);
+    ports.push_back(std::move(serialPort));
+    return makeHandle(slot, generations[slot]);
+}
+
+SerialPort PortRegistry::remove(PortHandle handle)
+{
+    const auto index{getIndex(handle)};
+    const auto slot{slots[index]};
+    SerialPort serialPort{std::move(ports[index])};
+
+    // Move the last port into the place of the removed port
+    const auto last{ports.size() - 1};
+    if (index != last)
+    {
+        descriptors[index] = descriptors[last];
+        flags[index] = flags[last];
+        receivedCounts[index] = receivedCounts[last];
+        transmittedCounts[index] = transmittedCounts[last];
+        errorCounts[index] = errorCounts[last];
+        slots[index] = slots[last];
+        ports[index] = std::move(ports[last]);
+        indices[slots[index]] = static_cast<uint32_t>(index);
+    }
+
+    descriptors.pop_back();
+    flags.pop_back();
+    receivedCounts.pop_back();
+    transmittedCounts.pop_back();
+    errorCounts.pop_back();
+    slots.pop_back();
+    ports.pop_back();
+
+    // Free slot with an even generation invalidates its handles
+    ++generations[slot];
+    indices[slot] = freeSlot;
+    freeSlot = slot;
+    return serialPort;
+}
+
+bool PortRegistry::contains(PortHandle handle) const
+{
+    const auto slot{static_cast<uint32_t>(handle)};
+    const auto generation{static_cast<uint32_t>(handle >> 32)};
+    return ((slot < generations.size()) && ((generation & 1U) != 0) && (generations[slot] == generation));
+}
+
+size_t PortRegistry::getSize() const
+{
+    return ports.size();
+}
+
+PortHandle PortRegistry::getHandle(size_t index) const
+{
+    if (index >= slots.size())
+        throw std::out_of_range("Invalid port index");
+
+    return makeHandle(slots[index], generations[slots[index]]);
+}
+
+SerialPort& PortRegistry::getPort(PortHandle handle)
+{
+    return ports[getIndex(handle)];
+}
+
+const SerialPort& PortRegistry::getPort(PortHandle handle) const
+{
+    return ports[getIndex(handle)];
+}
+
+void PortRegistry::update(PortHandle handle)
+{
+    const auto index{getIndex(handle)};
+    descriptors[index].fd = ports[index].getNativeHandle();
+}
+
+void PortRegistry::open(PortHandle handle, std::ios_base::openmode openMode, std::error_code& error)
+{
+    const auto index{getIndex(handle)};
+    ports[index].open(openMode, error);
+    descriptors[index].fd = ports[index].getNativeHandle();
+    if (!error)
+        flags[index] &= static_cast<uint8_t>(~PORT_FLAG_HUNG_UP);
+}
+
+void PortRegistry::close(PortHandle handle, std::error_code& error)
+{
+    const auto index{getIndex(handle)};
+    ports[index].close(error);
+    descriptors[index].fd = ports[index].getNativeHandle();
+}
+
+bool PortRegistry::isHungUp(PortHandle handle) const
+{
+    return ((flags[getIndex(handle)] & PORT_FLAG_HUNG_UP) != 0);
+}
+
+size_t PortRegistry::read(PortHandle handle, char* buffer, size_t size, std::error_code& error)
+{
+    const auto index{getIndex(handle)};
+    const auto result{ports[index].read(buffer, size, error)};
+    receivedCounts[index] += result;
+    handleError(index, error);
+    return result;
+}
+
+size_t PortRegistry::write(PortHandle handle, const char* buffer, size_t size, std::error_code& error)
+{
+    const auto index{getIndex(handle)};
+    const auto result{ports[index].write(buffer, size, error)};
+    transmittedCounts[index] += result;
+    handleError(index, error);
+    return result;
+}
+
+size_t PortRegistry::poll(std::chrono::milliseconds timeout, const EventHandler& eventHandler, short events)
+{
+    // Closed ports have a negative descriptor and are ignored
+    for (auto& descriptor: descriptors)
+        descriptor.events = events;
+
+    const auto result{systemCall(::poll, descriptors.data(), static_cast<nfds_t>(descriptors.size()), static_cast<int>(timeout.count()))};
+    if (result <= 0)
+        return 0;
+
+    handleEvents(eventHandler);
+    return static_cast<size_t>(result);
+}
+
+size_t PortRegistry::poll(std::chrono::milliseconds timeout, const EventHandler& eventHandler, TimerDispatcher& timerDispatcher,
+    short events)
+{
+    for (auto& descriptor: descriptors)
+        descriptor.events = events;
+
+    // Timer descriptor follows the port descriptors for the duration of the call
+    descriptors.push_back({timerDispatcher.getNativeHandle(), POLLIN, 0});
+    auto result{systemCall(::poll, descriptors.data(), static_cast<nfds_t>(descriptors.size()), static_cast<int>(timeout.count()))};
+    const auto timerEvents{descriptors.back().revents};
+    descriptors.pop_back();
+    if (result <= 0)
+        return 0;
+
+    // Data received together with an expiry re-arms its timeout before the timers are expired
+    if (timerEvents != 0)
+        --result;
+    if (result > 0)
+        handleEvents(eventHandler);
+    if ((timerEvents & POLLIN) != 0)
+        timerDispatcher.dispatch();
+    return static_cast<size_t>(result);
+}
+
+PortCounters PortRegistry::getCounters(PortHandle handle) const
+{
+    const auto index{getIndex(handle)};
+    return {receivedCounts[index], transmittedCounts[index], errorCounts[index]};
+}
+
+PortCounters PortRegistry::getTotalCounters() const
+{
+    PortCounters counters{};
+    for (const auto count: receivedCounts)
+        counters.receivedCount += count;
+    for (const auto count: transmittedCounts)
+        counters.transmittedCount += count;
+    for (const auto count: errorCounts)
+        counters.errorCount += count;
+    return counters;
+}
+
+void PortRegistry::resetCounters()
+{
+    std::fill(receivedCounts.begin(), receivedCounts.end(), 0);
+    std::fill(transmittedCounts.begin(), transmittedCounts.end(), 0);
+    std::fill(errorCounts.begin(), errorCounts.end(), 0);
+}
+
+size_t PortRegistry::getIndex(PortHandle handle) const
+{
+    if (!contains(handle))
+        throw std::out_of_range("Invalid port handle");
+
+    return indices[static_cast<uint32_t>(handle)];
+}
+
+void PortRegistry::handleError(size_t index, const std::error_code& error)
+{
+    if (!error || (error == SerialError::SERIAL_ERROR_WOULD_BLOCK))
+        return;
+
+    ++errorCounts[index];
+    if (error == SerialError::SERIAL_ERROR_HANGUP)
+        flags[index] |= PORT_FLAG_HUNG_UP;
+}
+
+void PortRegistry::handleEvents(const EventHandler& eventHandler)
+{
+    // Removing the current port moves an already handled port into its place
+    for (size_t index{descriptors.size()}; index-- > 0;)
+    {
+        const auto revents{descriptors[index].revents};
+        if (revents == 0)
+            continue;
+
+        if ((revents & (POLLHUP | POLLERR | POLLNVAL)) != 0)
+            flags[index] |= PORT_FLAG_HUNG_UP;
+
+        if (eventHandler)
+            eventHandler(makeHandle(slots[index], generations[slots[index]]), revents);
+    }
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,465 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_bridge.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Time limit of forwarding the remaining data after a hang-up when waiting indefinitely
+     *
+     */
+    constexpr std::chrono::milliseconds DEFAULT_DRAIN_TIMEOUT{1000};
+} // namespace
+
+SerialBridge::SerialBridge(SerialPort& serialPort, int socket, size_t bufferSize) :
+    serialPort{serialPort}, socket{socket}, eventLoop{INVALID_FILE_DESCRIPTOR},
+    stopEvent{INVALID_FILE_DESCRIPTOR}, active{true}, serialPortEvents{0}, socketEvents{0},
+    serialToSocket{}, socketToSerial{}, startTime{std::chrono::steady_clock::now()}
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+
+    const auto serialPortHandle{serialPort.getNativeHandle()};
+    serialToSocket.buffer.resize(bufferSize);
+    socketToSerial.buffer.resize(bufferSize);
+    initializeChannel(serialToSocket, serialPortHandle, socket, false);
+    initializeChannel(socketToSerial, socket, serialPortHandle, true);
+
+    // Socket is used in non-blocking mode
+    const auto flags{systemCall(::fcntl, socket, F_GETFL)};
+    systemCall(::fcntl, socket, F_SETFL, flags | O_NONBLOCK);
+
+    eventLoop = systemCall(::epoll_create1, EPOLL_CLOEXEC);
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((eventLoop == INVALID_FILE_DESCRIPTOR) || (stopEvent == INVALID_FILE_DESCRIPTOR))
+    {
+        releaseChannel(serialToSocket);
+        releaseChannel(socketToSerial);
+        if (eventLoop != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, eventLoop);
+        if (stopEvent != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, stopEvent);
+        throw std::runtime_error("Unable to create event loop");
+    }
+
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = stopEvent;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_ADD, stopEvent, &event);
+
+    event.events = 0;
+    event.data.fd = serialPortHandle;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_ADD, serialPortHandle, &event);
+    event.data.fd = socket;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_ADD, socket, &event);
+    updateInterest();
+}
+
+SerialBridge::~SerialBridge() noexcept
+{
+    releaseChannel(serialToSocket);
+    releaseChannel(socketToSerial);
+    systemCall(::close, eventLoop);
+    systemCall(::close, stopEvent);
+}
+
+bool SerialBridge::poll(std::chrono::milliseconds timeout)
+{
+    // Do nothing on an inactive bridge
+    if (!active)
+        return false;
+
+    struct epoll_event events[3];
+    const auto count{systemCall(::epoll_wait, eventLoop, events, 3, static_cast<int>(timeout.count()))};
+
+    bool serialPortReadable{false};
+    bool serialPortWritable{false};
+    bool socketReadable{false};
+    bool socketWritable{false};
+    bool serialPortHangUp{false};
+    bool socketHangUp{false};
+    for (int index{0}; index < count; ++index)
+    {
+        const auto& event{events[index]};
+        if (event.data.fd == stopEvent)
+        {
+            active = false;
+            discard(serialToSocket);
+            discard(socketToSerial);
+            return false;
+        }
+
+        const auto readable{(event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0};
+        const auto writable{(event.events & EPOLLOUT) != 0};
+        const auto hangUp{(event.events & (EPOLLHUP | EPOLLERR)) != 0};
+        if (event.data.fd == socket)
+        {
+            socketHangUp = hangUp;
+            socketReadable = readable;
+            socketWritable = writable;
+        }
+        else
+        {
+            serialPortHangUp = hangUp;
+            serialPortReadable = readable;
+            serialPortWritable = writable;
+        }
+    }
+
+    // Forward only directions with a ready side
+    if (serialPortReadable || socketWritable)
+        active &= forward(serialToSocket);
+    if (socketReadable || serialPortWritable)
+        active &= forward(socketToSerial);
+
+    // Hang-up of either side ends the bridge once remaining data is forwarded
+    if (serialPortHangUp || socketHangUp)
+        active = false;
+
+    if (active)
+        updateInterest();
+    else
+        drain((timeout.count() < 0) ? DEFAULT_DRAIN_TIMEOUT : timeout, serialPortHangUp, socketHangUp);
+    return active;
+}
+
+void SerialBridge::run()
+{
+    while (poll(std::chrono::milliseconds{-1}));
+}
+
+void SerialBridge::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+bool SerialBridge::isActive() const
+{
+    return active;
+}
+
+BridgeStatistics SerialBridge::getStatistics() const
+{
+    BridgeStatistics result{};
+    result.serialToSocket = serialToSocket.statistics;
+    result.socketToSerial = socketToSerial.statistics;
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+    const auto seconds{std::chrono::duration<double>(result.elapsed).count()};
+    if (seconds > 0.0)
+    {
+        result.serialToSocket.throughput = static_cast<double>(result.serialToSocket.byteCount) / seconds;
+        result.socketToSerial.throughput = static_cast<double>(result.socketToSerial.byteCount) / seconds;
+    }
+    return result;
+}
+
+int SerialBridge::connectTcp(const std::string& host, unsigned short port)
+{
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addresses{nullptr};
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+        return INVALID_FILE_DESCRIPTOR;
+
+    int result{INVALID_FILE_DESCRIPTOR};
+    for (auto address{addresses}; address != nullptr; address = address->ai_next)
+    {
+        result = systemCall(::socket, address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (result == INVALID_FILE_DESCRIPTOR)
+            continue;
+
+        if (systemCall(::connect, result, address->ai_addr, address->ai_addrlen) == 0)
+        {
+            // Serial data is forwarded as soon as it arrives
+            const int enable{1};
+            ::setsockopt(result, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            break;
+        }
+
+        systemCall(::close, result);
+        result = INVALID_FILE_DESCRIPTOR;
+    }
+    ::freeaddrinfo(addresses);
+    return result;
+}
+
+int SerialBridge::connectUnix(const std::string& path)
+{
+    struct sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+        return INVALID_FILE_DESCRIPTOR;
+
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    auto result{systemCall(::socket, AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if ((result != INVALID_FILE_DESCRIPTOR) &&
+        (systemCall(::connect, result, reinterpret_cast<const struct sockaddr*>(&address), static_cast<socklen_t>(sizeof(address))) != 0))
+    {
+        systemCall(::close, result);
+        result = INVALID_FILE_DESCRIPTOR;
+    }
+    return result;
+}
+
+void SerialBridge::initializeChannel(Channel& channel, int source, int destination, bool sourceEndOfFile)
+{
+    channel.source = source;
+    channel.destination = destination;
+    channel.sourceEndOfFile = sourceEndOfFile;
+    channel.pipeCount = 0;
+    channel.bufferBegin = 0;
+    channel.bufferEnd = 0;
+
+    // Fall back to the user space buffer if a pipe is not available
+    channel.spliceSource = (systemCall(::pipe2, channel.pipe, O_CLOEXEC | O_NONBLOCK) == 0);
+    channel.spliceDestination = channel.spliceSource;
+    if (!channel.spliceSource)
+    {
+        channel.pipe[0] = INVALID_FILE_DESCRIPTOR;
+        channel.pipe[1] = INVALID_FILE_DESCRIPTOR;
+    }
+    else
+    {
+        systemCall(::fcntl, channel.pipe[1], F_SETPIPE_SZ, static_cast<int>(channel.buffer.size()));
+    }
+}
+
+void SerialBridge::releaseChannel(Channel& channel)
+{
+    for (auto& fileDescriptor: channel.pipe)
+    {
+        if (fileDescriptor != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, fileDescriptor);
+        fileDescriptor = INVALID_FILE_DESCRIPTOR;
+    }
+}
+
+bool SerialBridge::forward(Channel& channel)
+{
+    while (true)
+    {
+        // Backpressure: do not read more until the pending data is forwarded
+        if (!flush(channel))
+            return false;
+        if (getPendingCount(channel) > 0)
+            return true;
+
+        ssize_t count{0};
+        if (channel.spliceSource)
+        {
+            count = systemCall(::splice, channel.source, nullptr, channel.pipe[1], nullptr,
+                channel.buffer.size(), SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+            if ((count < 0) && (errno == EINVAL))
+            {
+                // Source does not support splice()
+                channel.spliceSource = false;
+                continue;
+            }
+
+            if (count > 0)
+                channel.pipeCount += static_cast<size_t>(count);
+        }
+        else
+        {
+            count = systemCall(::read, channel.source, channel.buffer.data(), channel.buffer.size());
+            if (count > 0)
+            {
+                channel.bufferBegin = 0;
+                channel.bufferEnd = static_cast<size_t>(count);
+            }
+        }
+
+        // Serial port reports no data as zero, socket reports end-of-file
+        if (count == 0)
+            return !channel.sourceEndOfFile;
+        if (count < 0)
+            return ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+    }
+}
+
+bool SerialBridge::flush(Channel& channel)
+{
+    while (true)
+    {
+        if (channel.bufferBegin < channel.bufferEnd)
+        {
+            const auto count{systemCall(::write, channel.destination, channel.buffer.data() + channel.bufferBegin,
+                channel.bufferEnd - channel.bufferBegin)};
+            if (count > 0)
+            {
+                channel.bufferBegin += static_cast<size_t>(count);
+                channel.statistics.byteCount += static_cast<uint64_t>(count);
+                channel.statistics.copiedByteCount += static_cast<uint64_t>(count);
+                continue;
+            }
+        }
+        else if (channel.pipeCount == 0)
+        {
+            return true;
+        }
+        else if (channel.spliceDestination)
+        {
+            const auto count{systemCall(::splice, channel.pipe[0], nullptr, channel.destination, nullptr,
+                channel.pipeCount, SPLICE_F_NONBLOCK | SPLICE_F_MOVE)};
+            if (count > 0)
+            {
+                channel.pipeCount -= static_cast<size_t>(count);
+                channel.statistics.byteCount += static_cast<uint64_t>(count);
+                channel.statistics.splicedByteCount += static_cast<uint64_t>(count);
+                continue;
+            }
+
+            if ((count < 0) && (errno == EINVAL))
+            {
+                // Destination does not support splice()
+                channel.spliceDestination = false;
+                continue;
+            }
+        }
+        else
+        {
+            // Move data from the pipe into the buffer for a plain write
+            const auto count{systemCall(::read, channel.pipe[0], channel.buffer.data(), std::min(channel.pipeCount, channel.buffer.size()))};
+            if (count <= 0)
+                return false;
+
+            channel.pipeCount -= static_cast<size_t>(count);
+            channel.bufferBegin = 0;
+            channel.bufferEnd = static_cast<size_t>(count);
+            continue;
+        }
+
+        // Destination is full
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            ++channel.statistics.stallCount;
+            return true;
+        }
+        return false;
+    }
+}
+
+void SerialBridge::drain(std::chrono::milliseconds timeout, bool serialPortHangUp, bool socketHangUp)
+{
+    // Nothing can be forwarded to a side which hung up
+    Channel* channels[2]{&serialToSocket, &socketToSerial};
+    bool draining[2]{!socketHangUp, !serialPortHangUp};
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (true)
+    {
+        struct pollfd descriptors[2]{};
+        size_t indices[2]{};
+        nfds_t descriptorCount{0};
+        for (size_t index{0}; index < 2; ++index)
+        {
+            auto& channel{*channels[index]};
+            draining[index] = (draining[index] && forward(channel) && (getPendingCount(channel) > 0));
+            if (draining[index])
+            {
+                descriptors[descriptorCount] = {channel.destination, POLLOUT, 0};
+                indices[descriptorCount++] = index;
+            }
+        }
+
+        const auto now{std::chrono::steady_clock::now()};
+        if ((descriptorCount == 0) || (now >= deadline))
+            break;
+
+        const auto remaining{std::chrono::ceil<std::chrono::milliseconds>(deadline - now)};
+        if (systemCall(::poll, descriptors, descriptorCount, static_cast<int>(remaining.count())) < 0)
+            break;
+
+        for (nfds_t descriptor{0}; descriptor < descriptorCount; ++descriptor)
+        {
+            if ((descriptors[descriptor].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0)
+                draining[indices[descriptor]] = false;
+        }
+    }
+
+    discard(serialToSocket);
+    discard(socketToSerial);
+}
+
+void SerialBridge::discard(Channel& channel)
+{
+    // Pipe content is left behind as the inactive bridge never forwards again
+    channel.statistics.droppedByteCount += getPendingCount(channel);
+    channel.pipeCount = 0;
+    channel.bufferBegin = 0;
+    channel.bufferEnd = 0;
+}
+
+size_t SerialBridge::getPendingCount(const Channel& channel) const
+{
+    return (channel.pipeCount + (channel.bufferEnd - channel.bufferBegin));
+}
+
+void SerialBridge::updateInterest()
+{
+    const auto serialPortHandle{serialPort.getNativeHandle()};
+    updateInterest(serialPortHandle,
+        ((getPendingCount(serialToSocket) == 0) ? EPOLLIN : 0U) | ((getPendingCount(socketToSerial) > 0) ? EPOLLOUT : 0U),
+        serialPortEvents);
+    updateInterest(socket,
+        ((getPendingCount(socketToSerial) == 0) ? EPOLLIN : 0U) | ((getPendingCount(serialToSocket) > 0) ? EPOLLOUT : 0U),
+        socketEvents);
+}
+
+void SerialBridge::updateInterest(int fileDescriptor, uint32_t events, uint32_t& currentEvents)
+{
+    if (events == currentEvents)
+        return;
+
+    struct epoll_event event{};
+    event.events = events;
+    event.data.fd = fileDescriptor;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_MOD, fileDescriptor, &event);
+    currentEvents = events;
+}
+
+END_NAMESPACE_LIBSERIAL
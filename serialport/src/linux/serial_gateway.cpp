@@ -0,0 +1,373 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_gateway.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Event loop identifier of the stop event
+     *
+     */
+    constexpr uint64_t STOP_EVENT_ID{std::numeric_limits<uint64_t>::max()};
+
+    /**
+     * @brief Time limit of forwarding the remaining data after a hang-up when waiting indefinitely
+     *
+     */
+    constexpr std::chrono::milliseconds DEFAULT_DRAIN_TIMEOUT{1000};
+
+    /**
+     * @brief Get the size of the pending data of a direction
+     *
+     * @param bufferBegin Offset of the pending data
+     * @param bufferEnd End of the pending data
+     * @return size_t Size of the pending data
+     */
+    inline size_t getPendingCount(size_t bufferBegin, size_t bufferEnd)
+    {
+        return (bufferEnd - bufferBegin);
+    }
+} // namespace
+
+SerialGateway::SerialGateway() :
+    eventLoop{INVALID_FILE_DESCRIPTOR}, stopEvent{INVALID_FILE_DESCRIPTOR}, stopped{false},
+    activeRouteCount{0}, endpoints{}, directions{}, activeRoutes{}, events(1)
+{
+    eventLoop = systemCall(::epoll_create1, EPOLL_CLOEXEC);
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((eventLoop == INVALID_FILE_DESCRIPTOR) || (stopEvent == INVALID_FILE_DESCRIPTOR))
+    {
+        if (eventLoop != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, eventLoop);
+        if (stopEvent != INVALID_FILE_DESCRIPTOR)
+            systemCall(::close, stopEvent);
+        throw std::runtime_error("Unable to create event loop");
+    }
+
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = STOP_EVENT_ID;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_ADD, stopEvent, &event);
+}
+
+SerialGateway::~SerialGateway() noexcept
+{
+    systemCall(::close, eventLoop);
+    systemCall(::close, stopEvent);
+}
+
+size_t SerialGateway::addRoute(SerialPort& first, SerialPort& second, Transform firstToSecond, Transform secondToFirst)
+{
+    if (!first.isOpen() || !second.isOpen())
+        throw std::runtime_error("Serial port is not open");
+
+    // Each serial port may only be read by a single route
+    const auto firstHandle{first.getNativeHandle()};
+    const auto secondHandle{second.getNativeHandle()};
+    if (firstHandle == secondHandle)
+        throw std::runtime_error("Serial port is already routed");
+    for (const auto& endpoint: endpoints)
+    {
+        if (activeRoutes[endpoint.route] &&
+            ((endpoint.fileDescriptor == firstHandle) || (endpoint.fileDescriptor == secondHandle)))
+            throw std::runtime_error("Serial port is already routed");
+    }
+
+    const auto route{activeRoutes.size()};
+    const auto firstEndpoint{endpoints.size()};
+    const auto secondEndpoint{firstEndpoint + 1};
+    const auto firstDirection{directions.size()};
+    const auto secondDirection{firstDirection + 1};
+
+    endpoints.push_back(Endpoint{firstHandle, 0, firstDirection, secondDirection, route});
+    endpoints.push_back(Endpoint{secondHandle, 0, secondDirection, firstDirection, route});
+
+    // Buffers hold twice the read size so transforms may expand the data in place
+    directions.push_back(Direction{firstEndpoint, secondEndpoint, std::move(firstToSecond),
+        std::vector<char>(getBufferSize(first) * 2), 0, 0, GatewayDirectionStatistics{}});
+    directions.push_back(Direction{secondEndpoint, firstEndpoint, std::move(secondToFirst),
+        std::vector<char>(getBufferSize(second) * 2), 0, 0, GatewayDirectionStatistics{}});
+    directions[firstDirection].statistics.bufferSize = directions[firstDirection].buffer.size() / 2;
+    directions[secondDirection].statistics.bufferSize = directions[secondDirection].buffer.size() / 2;
+
+    activeRoutes.push_back(true);
+    ++activeRouteCount;
+    events.resize(endpoints.size() + 1);
+
+    for (const auto endpoint: {firstEndpoint, secondEndpoint})
+    {
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = endpoint;
+        systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_ADD, endpoints[endpoint].fileDescriptor, &event);
+        endpoints[endpoint].events = EPOLLIN;
+    }
+    return route;
+}
+
+size_t SerialGateway::getRouteCount() const
+{
+    return activeRoutes.size();
+}
+
+bool SerialGateway::poll(std::chrono::milliseconds timeout)
+{
+    // Do nothing on a stopped gateway
+    if (stopped || (activeRouteCount == 0))
+        return false;
+
+    const auto count{systemCall(::epoll_wait, eventLoop, events.data(), static_cast<int>(events.size()),
+        static_cast<int>(timeout.count()))};
+    for (int index{0}; index < count; ++index)
+    {
+        const auto& event{events[static_cast<size_t>(index)]};
+        if (event.data.u64 == STOP_EVENT_ID)
+        {
+            stopped = true;
+            for (auto& direction: directions)
+            {
+                if (activeRoutes[endpoints[direction.source].route])
+                    discard(direction);
+            }
+            return false;
+        }
+
+        // Route may have been deactivated by an earlier event
+        const auto endpointIndex{static_cast<size_t>(event.data.u64)};
+        const auto& endpoint{endpoints[endpointIndex]};
+        if (!activeRoutes[endpoint.route])
+            continue;
+
+        bool active{true};
+        if ((event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0)
+            active &= forward(directions[endpoint.outgoing]);
+        if ((event.events & EPOLLOUT) != 0)
+            active &= forward(directions[endpoint.incoming]);
+
+        // Hang-up of either serial port ends the route once remaining data is forwarded
+        const auto hangUp{(event.events & (EPOLLHUP | EPOLLERR)) != 0};
+        if (!active || hangUp)
+        {
+            drain(endpointIndex, (timeout.count() < 0) ? DEFAULT_DRAIN_TIMEOUT : timeout, hangUp);
+            deactivateRoute(endpoint.route);
+            continue;
+        }
+
+        updateInterest(directions[endpoint.outgoing].source);
+        updateInterest(directions[endpoint.outgoing].destination);
+    }
+    return (activeRouteCount > 0);
+}
+
+void SerialGateway::run()
+{
+    while (poll(std::chrono::milliseconds{-1}));
+}
+
+void SerialGateway::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+GatewayRouteStatistics SerialGateway::getStatistics(size_t route) const
+{
+    if (route >= activeRoutes.size())
+        throw std::out_of_range("Route index out of range");
+
+    GatewayRouteStatistics result{};
+    result.active = activeRoutes[route];
+    result.firstToSecond = directions[route * 2].statistics;
+    result.secondToFirst = directions[route * 2 + 1].statistics;
+    return result;
+}
+
+size_t SerialGateway::getBufferSize(const SerialPort& serialPort)
+{
+    double characterTime{0.0};
+    try
+    {
+        characterTime = calculateTime(serialPort.getBaudRate(), serialPort.getCharacterSize(),
+            serialPort.getParity(), serialPort.getStopBit());
+    }
+    catch (const std::out_of_range&)
+    {
+        // Unknown baud rate
+        return MAX_GATEWAY_BUFFER_SIZE;
+    }
+
+    if (!std::isfinite(characterTime) || (characterTime <= 0.0))
+        return MIN_GATEWAY_BUFFER_SIZE;
+
+    // Number of characters received within the buffer time
+    const auto size{static_cast<size_t>(std::ceil(GATEWAY_BUFFER_TIME / characterTime))};
+    return std::min(std::max(size, MIN_GATEWAY_BUFFER_SIZE), MAX_GATEWAY_BUFFER_SIZE);
+}
+
+bool SerialGateway::forward(Direction& direction)
+{
+    const auto readSize{direction.buffer.size() / 2};
+    while (true)
+    {
+        // Backpressure: do not read more until the pending data is forwarded
+        if (!flush(direction))
+            return false;
+        if (getPendingCount(direction.bufferBegin, direction.bufferEnd) > 0)
+            return true;
+
+        const auto count{systemCall(::read, endpoints[direction.source].fileDescriptor, direction.buffer.data(), readSize)};
+
+        // Serial port reports no data as zero
+        if (count == 0)
+            return true;
+        if (count < 0)
+            return ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+
+        auto size{static_cast<size_t>(count)};
+        direction.statistics.receivedCount += size;
+        if (direction.transform)
+            size = std::min(direction.transform(direction.buffer.data(), size, direction.buffer.size()), direction.buffer.size());
+
+        direction.bufferBegin = 0;
+        direction.bufferEnd = size;
+    }
+}
+
+bool SerialGateway::flush(Direction& direction)
+{
+    while (direction.bufferBegin < direction.bufferEnd)
+    {
+        const auto count{systemCall(::write, endpoints[direction.destination].fileDescriptor,
+            direction.buffer.data() + direction.bufferBegin, direction.bufferEnd - direction.bufferBegin)};
+        if (count > 0)
+        {
+            direction.bufferBegin += static_cast<size_t>(count);
+            direction.statistics.transmittedCount += static_cast<uint64_t>(count);
+            continue;
+        }
+
+        // Destination is full
+        if ((count == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            ++direction.statistics.stallCount;
+            return true;
+        }
+        return false;
+    }
+
+    direction.bufferBegin = 0;
+    direction.bufferEnd = 0;
+    return true;
+}
+
+void SerialGateway::updateInterest(size_t endpoint)
+{
+    auto& current{endpoints[endpoint]};
+    const auto& outgoing{directions[current.outgoing]};
+    const auto& incoming{directions[current.incoming]};
+    const uint32_t interest{
+        ((getPendingCount(outgoing.bufferBegin, outgoing.bufferEnd) == 0) ? EPOLLIN : 0U) |
+        ((getPendingCount(incoming.bufferBegin, incoming.bufferEnd) > 0) ? EPOLLOUT : 0U)};
+    if (interest == current.events)
+        return;
+
+    struct epoll_event event{};
+    event.events = interest;
+    event.data.u64 = endpoint;
+    systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_MOD, current.fileDescriptor, &event);
+    current.events = interest;
+}
+
+void SerialGateway::drain(size_t endpoint, std::chrono::milliseconds timeout, bool hangUp)
+{
+    // Nothing can be forwarded to a serial port which hung up
+    Direction* routeDirections[2]{&directions[endpoints[endpoint].outgoing], &directions[endpoints[endpoint].incoming]};
+    bool draining[2]{true, !hangUp};
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (true)
+    {
+        struct pollfd descriptors[2]{};
+        size_t indices[2]{};
+        nfds_t descriptorCount{0};
+        for (size_t index{0}; index < 2; ++index)
+        {
+            auto& direction{*routeDirections[index]};
+            draining[index] = (draining[index] && forward(direction) &&
+                (getPendingCount(direction.bufferBegin, direction.bufferEnd) > 0));
+            if (draining[index])
+            {
+                descriptors[descriptorCount] = {endpoints[direction.destination].fileDescriptor, POLLOUT, 0};
+                indices[descriptorCount++] = index;
+            }
+        }
+
+        const auto now{std::chrono::steady_clock::now()};
+        if ((descriptorCount == 0) || (now >= deadline))
+            break;
+
+        const auto remaining{std::chrono::ceil<std::chrono::milliseconds>(deadline - now)};
+        if (systemCall(::poll, descriptors, descriptorCount, static_cast<int>(remaining.count())) < 0)
+            break;
+
+        for (nfds_t descriptor{0}; descriptor < descriptorCount; ++descriptor)
+        {
+            if ((descriptors[descriptor].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0)
+                draining[indices[descriptor]] = false;
+        }
+    }
+
+    discard(*routeDirections[0]);
+    discard(*routeDirections[1]);
+}
+
+void SerialGateway::discard(Direction& direction)
+{
+    direction.statistics.droppedByteCount += getPendingCount(direction.bufferBegin, direction.bufferEnd);
+    direction.bufferBegin = 0;
+    direction.bufferEnd = 0;
+}
+
+void SerialGateway::deactivateRoute(size_t route)
+{
+    for (const auto endpoint: {route * 2, route * 2 + 1})
+        systemCall(::epoll_ctl, eventLoop, EPOLL_CTL_DEL, endpoints[endpoint].fileDescriptor, nullptr);
+
+    activeRoutes[route] = false;
+    --activeRouteCount;
+}
+
+END_NAMESPACE_LIBSERIAL
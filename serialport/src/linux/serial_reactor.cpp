@@ -0,0 +1,413 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_reactor.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Shard index of no shard
+     *
+     */
+    static constexpr size_t NO_SHARD{SIZE_MAX};
+
+    /**
+     * @brief Event loop identifier of the wakeup event
+     *
+     */
+    static constexpr uint64_t WAKEUP_EVENT_ID{UINT64_MAX};
+
+    /**
+     * @brief Minimum load difference per balance interval worth a migration
+     *
+     */
+    static constexpr uint64_t MIN_STEAL_LOAD{4};
+} // namespace
+
+SerialReactor::SerialReactor(EventHandler eventHandler, const ReactorOptions& options) :
+    eventHandler{std::move(eventHandler)}, options{options}, ports{}, shards{}, stopped{true}
+{
+    if (options.balanceInterval.count() <= 0)
+        throw std::out_of_range("Invalid balance interval");
+
+    auto shardCount{options.shardCount};
+    if (shardCount == 0)
+        shardCount = std::max(1U, std::thread::hardware_concurrency());
+
+    for (size_t index{0}; index < shardCount; ++index)
+    {
+        auto shard{std::make_unique<Shard>()};
+        shard->eventLoop = systemCall(::epoll_create1, EPOLL_CLOEXEC);
+        shard->wakeupEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKEUP_EVENT_ID;
+        if ((shard->eventLoop == INVALID_FILE_DESCRIPTOR) || (shard->wakeupEvent == INVALID_FILE_DESCRIPTOR) ||
+            (systemCall(::epoll_ctl, shard->eventLoop, EPOLL_CTL_ADD, shard->wakeupEvent, &event) != 0))
+        {
+            // Destructor is not called for a partially constructed reactor
+            shards.push_back(std::move(shard));
+            for (const auto& created: shards)
+            {
+                if (created->eventLoop != INVALID_FILE_DESCRIPTOR)
+                    systemCall(::close, created->eventLoop);
+                if (created->wakeupEvent != INVALID_FILE_DESCRIPTOR)
+                    systemCall(::close, created->wakeupEvent);
+            }
+            throw std::runtime_error("Unable to create event loop");
+        }
+
+        shard->stealRequest = NO_SHARD;
+        shard->portCount = 0;
+        shard->eventCount = 0;
+        shard->load = 0;
+        shard->stolenCount = 0;
+        shard->donatedCount = 0;
+        shard->wakeupCount = 0;
+        shard->busyTime = 0;
+        shards.push_back(std::move(shard));
+    }
+}
+
+SerialReactor::~SerialReactor() noexcept
+{
+    stop();
+    for (const auto& shard: shards)
+    {
+        systemCall(::close, shard->eventLoop);
+        systemCall(::close, shard->wakeupEvent);
+    }
+}
+
+size_t SerialReactor::addPort(SerialPort& serialPort)
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+    if (isRunning())
+        throw std::runtime_error("Reactor is running");
+
+    const auto index{ports.size()};
+    const auto shardIndex{index % shards.size()};
+    auto port{std::make_unique<Port>()};
+    port->serialPort = &serialPort;
+    port->fileDescriptor = serialPort.getNativeHandle();
+    port->shard = shardIndex;
+    port->eventCount = 0;
+    port->load = 0;
+    port->failed = false;
+    ports.push_back(std::move(port));
+
+    auto& shard{*shards[shardIndex]};
+    if (!watch(shard, index))
+    {
+        ports.pop_back();
+        throw std::runtime_error("Unable to add serial port");
+    }
+    shard.ports.push_back(index);
+    shard.portCount.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+size_t SerialReactor::getPortCount() const
+{
+    return ports.size();
+}
+
+size_t SerialReactor::getShardCount() const
+{
+    return shards.size();
+}
+
+size_t SerialReactor::getShard(size_t port) const
+{
+    if (port >= ports.size())
+        throw std::out_of_range("Invalid port index");
+
+    return ports[port]->shard.load(std::memory_order_acquire);
+}
+
+void SerialReactor::start()
+{
+    if (isRunning())
+        throw std::runtime_error("Reactor is running");
+
+    stopped = false;
+    const auto cpuCount{std::max(1U, std::thread::hardware_concurrency())};
+    for (size_t index{0}; index < shards.size(); ++index)
+    {
+        // Any shard may end up owning every port and the wakeup event
+        auto& shard{*shards[index]};
+        shard.events.resize(ports.size() + 1);
+        try
+        {
+            shard.thread = std::thread{&SerialReactor::run, this, index};
+        }
+        catch (const std::system_error&)
+        {
+            stop();
+            throw std::runtime_error("Unable to start reactor thread");
+        }
+
+        if (options.bindShards)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(index % cpuCount, &cpuSet);
+            if (::pthread_setaffinity_np(shard.thread.native_handle(), sizeof(cpuSet), &cpuSet) != 0)
+            {
+                stop();
+                throw std::runtime_error("Unable to set CPU affinity");
+            }
+        }
+    }
+}
+
+void SerialReactor::stop()
+{
+    stopped = true;
+    for (const auto& shard: shards)
+    {
+        if (!shard->thread.joinable())
+            continue;
+
+        wake(*shard);
+        shard->thread.join();
+    }
+}
+
+bool SerialReactor::isRunning() const
+{
+    return std::any_of(shards.begin(), shards.end(), [](const std::unique_ptr<Shard>& shard)
+    {
+        return shard->thread.joinable();
+    });
+}
+
+ShardStatistics SerialReactor::getStatistics(size_t shard) const
+{
+    if (shard >= shards.size())
+        throw std::out_of_range("Invalid shard index");
+
+    const auto& source{*shards[shard]};
+    ShardStatistics statistics{};
+    statistics.portCount = source.portCount.load(std::memory_order_relaxed);
+    statistics.eventCount = source.eventCount.load(std::memory_order_relaxed);
+    statistics.load = source.load.load(std::memory_order_relaxed);
+    statistics.stolenCount = source.stolenCount.load(std::memory_order_relaxed);
+    statistics.donatedCount = source.donatedCount.load(std::memory_order_relaxed);
+    statistics.wakeupCount = source.wakeupCount.load(std::memory_order_relaxed);
+    statistics.busyTime = std::chrono::nanoseconds{source.busyTime.load(std::memory_order_relaxed)};
+    return statistics;
+}
+
+void SerialReactor::run(size_t index)
+{
+    auto& shard{*shards[index]};
+    auto intervalStart{std::chrono::steady_clock::now()};
+    uint64_t intervalEventCount{0};
+    while (!stopped.load(std::memory_order_acquire))
+    {
+        auto now{std::chrono::steady_clock::now()};
+        if ((now - intervalStart) >= options.balanceInterval)
+        {
+            balance(index, intervalEventCount);
+            intervalEventCount = 0;
+            intervalStart = now;
+        }
+
+        // Ports migrate only between two polls
+        adopt(shard);
+        const auto thief{shard.stealRequest.exchange(NO_SHARD, std::memory_order_acq_rel)};
+        if (thief != NO_SHARD)
+            donate(shard, thief);
+
+        // Idle shards still wake up at the end of the balance interval
+        const auto remaining{std::chrono::ceil<std::chrono::milliseconds>(intervalStart + options.balanceInterval - now)};
+        const auto timeout{static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0))};
+        const auto count{systemCall(::epoll_wait, shard.eventLoop, shard.events.data(),
+            static_cast<int>(shard.events.size()), timeout)};
+        if (count <= 0)
+            continue;
+
+        now = std::chrono::steady_clock::now();
+        uint64_t eventCount{0};
+        for (int position{0}; position < count; ++position)
+        {
+            const auto& event{shard.events[static_cast<size_t>(position)]};
+            if (event.data.u64 == WAKEUP_EVENT_ID)
+            {
+                uint64_t value{0};
+                systemCall(::read, shard.wakeupEvent, &value, sizeof(value));
+                shard.wakeupCount.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Epoll event bits equal the poll event bits
+            const auto portIndex{static_cast<size_t>(event.data.u64)};
+            auto& port{*ports[portIndex]};
+            if (eventHandler)
+                eventHandler(portIndex, *port.serialPort, static_cast<short>(event.events));
+            ++port.eventCount;
+            ++eventCount;
+
+            // Hung up port would be reported by every wait
+            if ((event.events & (EPOLLHUP | EPOLLERR)) != 0)
+            {
+                port.failed = true;
+                systemCall(::epoll_ctl, shard.eventLoop, EPOLL_CTL_DEL, port.fileDescriptor, nullptr);
+            }
+        }
+
+        if (eventCount != 0)
+        {
+            const auto busyTime{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now)};
+            shard.eventCount.fetch_add(eventCount, std::memory_order_relaxed);
+            shard.busyTime.fetch_add(busyTime.count(), std::memory_order_relaxed);
+            intervalEventCount += eventCount;
+        }
+    }
+}
+
+void SerialReactor::adopt(Shard& shard)
+{
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    if (shard.inbox.empty())
+        return;
+
+    // Port which can not be watched is not polled, like a hung up one
+    for (const auto port: shard.inbox)
+        ports[port]->failed = !watch(shard, port);
+
+    shard.ports.insert(shard.ports.end(), shard.inbox.begin(), shard.inbox.end());
+    shard.portCount.fetch_add(shard.inbox.size(), std::memory_order_relaxed);
+    shard.stolenCount.fetch_add(shard.inbox.size(), std::memory_order_relaxed);
+    shard.inbox.clear();
+}
+
+void SerialReactor::donate(Shard& shard, size_t thief)
+{
+    if (shard.ports.size() < 2)
+        return;
+
+    const auto load{shard.load.load(std::memory_order_relaxed)};
+    const auto thiefLoad{shards[thief]->load.load(std::memory_order_relaxed)};
+    if (load <= thiefLoad)
+        return;
+
+    // Busiest port which does not turn the thief into the busier shard, idle ports do not help
+    const auto limit{(load - thiefLoad) / 2};
+    auto best{shard.ports.size()};
+    uint64_t bestLoad{0};
+    for (size_t position{0}; position < shard.ports.size(); ++position)
+    {
+        const auto& port{*ports[shard.ports[position]]};
+        if (!port.failed && (port.load > bestLoad) && (port.load <= limit))
+        {
+            best = position;
+            bestLoad = port.load;
+        }
+    }
+    if (best == shard.ports.size())
+        return;
+
+    const auto portIndex{shard.ports[best]};
+    systemCall(::epoll_ctl, shard.eventLoop, EPOLL_CTL_DEL, ports[portIndex]->fileDescriptor, nullptr);
+    shard.ports[best] = shard.ports.back();
+    shard.ports.pop_back();
+    shard.load.store(load - bestLoad, std::memory_order_relaxed);
+    shard.portCount.fetch_sub(1, std::memory_order_relaxed);
+    shard.donatedCount.fetch_add(1, std::memory_order_relaxed);
+    ports[portIndex]->shard.store(thief, std::memory_order_release);
+
+    // Inbox mutex orders the port state before its use by the thief
+    auto& target{*shards[thief]};
+    {
+        std::lock_guard<std::mutex> lock{target.mutex};
+        target.inbox.push_back(portIndex);
+    }
+    wake(target);
+}
+
+void SerialReactor::balance(size_t index, uint64_t eventCount)
+{
+    auto& shard{*shards[index]};
+    for (const auto port: shard.ports)
+    {
+        ports[port]->load = ports[port]->eventCount;
+        ports[port]->eventCount = 0;
+    }
+    shard.load.store(eventCount, std::memory_order_relaxed);
+
+    if (!options.workStealing)
+        return;
+
+    // Busiest shard with a port to spare
+    auto victim{NO_SHARD};
+    uint64_t victimLoad{0};
+    for (size_t other{0}; other < shards.size(); ++other)
+    {
+        const auto otherLoad{shards[other]->load.load(std::memory_order_relaxed)};
+        if ((other != index) && (otherLoad > victimLoad) && (shards[other]->portCount.load(std::memory_order_relaxed) > 1))
+        {
+            victim = other;
+            victimLoad = otherLoad;
+        }
+    }
+    if ((victim == NO_SHARD) || (victimLoad < ((2 * eventCount) + MIN_STEAL_LOAD)))
+        return;
+
+    // Single outstanding request per victim
+    auto expected{NO_SHARD};
+    if (shards[victim]->stealRequest.compare_exchange_strong(expected, index, std::memory_order_acq_rel))
+        wake(*shards[victim]);
+}
+
+bool SerialReactor::watch(Shard& shard, size_t port)
+{
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = port;
+    return (systemCall(::epoll_ctl, shard.eventLoop, EPOLL_CTL_ADD, ports[port]->fileDescriptor, &event) == 0);
+}
+
+void SerialReactor::wake(Shard& shard)
+{
+    const uint64_t value{1};
+    systemCall(::write, shard.wakeupEvent, &value, sizeof(value));
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,298 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_stream.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+SerialStreamBuf::SerialStreamBuf(SerialPort& serialPort, size_t inputBufferSize, size_t outputBufferSize) :
+    std::streambuf{}, serialPort{serialPort}, inputBuffer(inputBufferSize), outputBuffer(outputBufferSize),
+    readTimeout{DEFAULT_STREAM_TIMEOUT}, writeTimeout{DEFAULT_STREAM_TIMEOUT}, error{}, statistics{}
+{
+    if ((inputBufferSize == 0) && (outputBufferSize == 0))
+        throw std::out_of_range("Invalid buffer size");
+
+    // Empty get area and a put area spanning the whole output buffer
+    if (!inputBuffer.empty())
+        setg(inputBuffer.data(), inputBuffer.data(), inputBuffer.data());
+    if (!outputBuffer.empty())
+        setp(outputBuffer.data(), outputBuffer.data() + outputBuffer.size());
+}
+
+SerialStreamBuf::~SerialStreamBuf() noexcept
+{
+    flushBuffer();
+}
+
+std::chrono::milliseconds SerialStreamBuf::getReadTimeout() const
+{
+    return readTimeout;
+}
+
+void SerialStreamBuf::setReadTimeout(std::chrono::milliseconds readTimeout)
+{
+    this->readTimeout = readTimeout;
+}
+
+std::chrono::milliseconds SerialStreamBuf::getWriteTimeout() const
+{
+    return writeTimeout;
+}
+
+void SerialStreamBuf::setWriteTimeout(std::chrono::milliseconds writeTimeout)
+{
+    this->writeTimeout = writeTimeout;
+}
+
+const std::error_code& SerialStreamBuf::getError() const
+{
+    return error;
+}
+
+SerialStreamStatistics SerialStreamBuf::getStatistics() const
+{
+    return statistics;
+}
+
+SerialStreamBuf::int_type SerialStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    if (inputBuffer.empty())
+    {
+        error = make_error_code(SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+        return traits_type::eof();
+    }
+
+    const auto size{receive(inputBuffer.data(), inputBuffer.size())};
+    if (size == 0)
+        return traits_type::eof();
+
+    setg(inputBuffer.data(), inputBuffer.data(), inputBuffer.data() + size);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize SerialStreamBuf::xsgetn(char_type* buffer, std::streamsize count)
+{
+    std::streamsize total{0};
+    while (total < count)
+    {
+        // Buffered data first
+        const auto buffered{std::min<std::streamsize>(count - total, egptr() - gptr())};
+        if (buffered > 0)
+        {
+            std::memcpy(buffer + total, gptr(), static_cast<size_t>(buffered));
+            gbump(static_cast<int>(buffered));
+            total += buffered;
+            continue;
+        }
+
+        // Large reads bypass the input buffer
+        const auto remaining{static_cast<size_t>(count - total)};
+        if (!inputBuffer.empty() && (remaining >= inputBuffer.size()))
+        {
+            const auto size{receive(buffer + total, remaining)};
+            if (size == 0)
+                break;
+
+            total += static_cast<std::streamsize>(size);
+        }
+        else if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+        {
+            break;
+        }
+    }
+    return total;
+}
+
+std::streamsize SerialStreamBuf::showmanyc()
+{
+    return static_cast<std::streamsize>(serialPort.getInputQueueCount());
+}
+
+SerialStreamBuf::int_type SerialStreamBuf::overflow(int_type character)
+{
+    if (outputBuffer.empty())
+    {
+        error = make_error_code(SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+        return traits_type::eof();
+    }
+
+    if (!flushBuffer())
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(character);
+        pbump(1);
+    }
+    return traits_type::not_eof(character);
+}
+
+std::streamsize SerialStreamBuf::xsputn(const char_type* buffer, std::streamsize count)
+{
+    if (outputBuffer.empty())
+    {
+        error = make_error_code(SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+        return 0;
+    }
+
+    // Small writes are buffered
+    if (count <= (epptr() - pptr()))
+    {
+        std::memcpy(pptr(), buffer, static_cast<size_t>(count));
+        pbump(static_cast<int>(count));
+        return count;
+    }
+
+    if (!flushBuffer())
+        return 0;
+
+    // Large writes bypass the output buffer
+    if (static_cast<size_t>(count) >= outputBuffer.size())
+        return static_cast<std::streamsize>(transmit(buffer, static_cast<size_t>(count)));
+
+    std::memcpy(pptr(), buffer, static_cast<size_t>(count));
+    pbump(static_cast<int>(count));
+    return count;
+}
+
+int SerialStreamBuf::sync()
+{
+    return (flushBuffer() ? 0 : -1);
+}
+
+size_t SerialStreamBuf::receive(char* buffer, size_t size)
+{
+    const auto infinite{readTimeout.count() < 0};
+    const auto deadline{std::chrono::steady_clock::now() + std::max(readTimeout, std::chrono::milliseconds{0})};
+    while (true)
+    {
+        // Single read of all the available data
+        const auto result{serialPort.read(buffer, size, error)};
+        if (result > 0)
+        {
+            ++statistics.readCount;
+            return result;
+        }
+
+        if ((error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)) || !wait(POLLIN, deadline, infinite))
+            return 0;
+    }
+}
+
+size_t SerialStreamBuf::transmit(const char* buffer, size_t size)
+{
+    const auto infinite{writeTimeout.count() < 0};
+    const auto deadline{std::chrono::steady_clock::now() + std::max(writeTimeout, std::chrono::milliseconds{0})};
+    size_t total{0};
+    while (total < size)
+    {
+        const auto result{serialPort.write(buffer + total, size - total, error)};
+        if (result > 0)
+        {
+            ++statistics.writeCount;
+            total += result;
+            continue;
+        }
+
+        if ((error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)) || !wait(POLLOUT, deadline, infinite))
+            break;
+    }
+    return total;
+}
+
+bool SerialStreamBuf::flushBuffer()
+{
+    const auto size{static_cast<size_t>(pptr() - pbase())};
+    if (size == 0)
+        return true;
+
+    // Unwritten rest is kept at the start of the output buffer
+    const auto written{transmit(pbase(), size)};
+    std::memmove(outputBuffer.data(), outputBuffer.data() + written, size - written);
+    setp(outputBuffer.data(), outputBuffer.data() + outputBuffer.size());
+    pbump(static_cast<int>(size - written));
+    return (written == size);
+}
+
+bool SerialStreamBuf::wait(short events, std::chrono::steady_clock::time_point deadline, bool infinite)
+{
+    int timeout{-1};
+    if (!infinite)
+    {
+        const auto remaining{std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())};
+        if (remaining.count() <= 0)
+        {
+            error = std::make_error_code(std::errc::timed_out);
+            ++statistics.timeoutCount;
+            return false;
+        }
+        timeout = static_cast<int>(remaining.count());
+    }
+
+    // Hang-up and errors are reported by the following read or write
+    struct pollfd descriptor{serialPort.getNativeHandle(), events, 0};
+    if (systemCall(::poll, &descriptor, 1, timeout) < 0)
+    {
+        error = std::error_code{errno, std::system_category()};
+        return false;
+    }
+    return true;
+}
+
+SerialIStream::SerialIStream(SerialPort& serialPort, size_t bufferSize, std::chrono::milliseconds timeout) :
+    std::istream{nullptr}, streamBuf{serialPort, bufferSize, 0}
+{
+    streamBuf.setReadTimeout(timeout);
+    rdbuf(&streamBuf);
+}
+
+SerialStreamBuf& SerialIStream::getStreamBuf()
+{
+    return streamBuf;
+}
+
+SerialOStream::SerialOStream(SerialPort& serialPort, size_t bufferSize, std::chrono::milliseconds timeout) :
+    std::ostream{nullptr}, streamBuf{serialPort, 0, bufferSize}
+{
+    streamBuf.setWriteTimeout(timeout);
+    rdbuf(&streamBuf);
+}
+
+SerialStreamBuf& SerialOStream::getStreamBuf()
+{
+    return streamBuf;
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -19,18 +19,52 @@
     SPDX-License-Identifier: GPL-3.0-or-later
 */
 
+#include <cerrno>
 #include <iostream>
 #include <stdexcept>
+#include <system_error>
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
 #include <serialport/properties.hpp>
 #include <serialport/linux/serialport_impl.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+namespace
+{
+
+/**
+ * @brief Get the error code of a failed read/write system call
+ *
+ * @return std::error_code Would-block, hang-up or system error
+ */
+std::error_code getIoError() noexcept
+{
+    switch (errno)
+    {
+        case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+        case EWOULDBLOCK:
+#endif // EWOULDBLOCK
+            return SerialError::SERIAL_ERROR_WOULD_BLOCK;
+
+        case EIO:
+        case ENXIO:
+        case ENODEV:
+            return SerialError::SERIAL_ERROR_HANGUP;
+
+        default:
+            return getLastError();
+    }
+}
+
+} // namespace
+
 SerialPortImpl::SerialPortImpl() :
     SerialPortImpl(DEFAULT_PORT_NAME)
 {
@@ -42,7 +76,7 @@ SerialPortImpl::SerialPortImpl(const std::string& portName, BaudRate baudRate,
     StopBit stopBit) :
     fileDescriptor{INVALID_FILE_DESCRIPTOR}, openMode(std::ios_base::in | std::ios_base::out),
     portName{portName}, baudRate{baudRate}, characterSize{characterSize},
-    flowControl{flowControl}, parity{parity}, stopBit{stopBit}
+    flowControl{flowControl}, parity{parity}, stopBit{stopBit}, mutex{}
 {
 
 }
@@ -65,72 +99,59 @@ bool SerialPortImpl::isOpen() const
 
 void SerialPortImpl::open(std::ios_base::openmode openMode)
 {
-    // Do nothing on an open port
-    if (isOpen())
-        return;
-
-    // Prepare open mode
-    int descriptorFlags{O_NOCTTY | O_NONBLOCK};
-    if (openMode == (std::ios_base::in | std::ios_base::out))
-        descriptorFlags |= O_RDWR;
-    else if (openMode == std::ios_base::in)
-        descriptorFlags |= O_RDONLY;
-    else if (openMode == std::ios_base::out)
-        descriptorFlags |= O_WRONLY;
-    else
-        throw std::runtime_error("Unsupported open mode");
-
-    // Store open mode
-    this->openMode = openMode;
-
-    // Open serial port
-    fileDescriptor = systemCall(::open, portName.c_str(), descriptorFlags);
+    std::error_code error{};
+    if (const auto failure{openPort(openMode, nullptr, error)})
+        throw std::system_error(error, failure);
+}
 
-    // Is serial port open?
-    if (!isOpen())
-        throw std::runtime_error("Unable to open serial port");
+void SerialPortImpl::open(const NativePortSettings& nativePortSettings, std::ios_base::openmode openMode)
+{
+    std::error_code error{};
+    if (const auto failure{openPort(openMode, &nativePortSettings, error)})
+        throw std::system_error(error, failure);
+}
 
-    // Store current port settings
-    if (!getPortSettings(portSettings))
-    {
-        // Close serial port and reset file descriptor
-        systemCall(::close, fileDescriptor);
-        fileDescriptor = INVALID_FILE_DESCRIPTOR;
-        throw std::runtime_error("Unable to get port settings");
-    }
+void SerialPortImpl::open(std::ios_base::openmode openMode, std::error_code& error) noexcept
+{
+    openPort(openMode, nullptr, error);
+}
 
-    // Set exclusive mode
-    if (!setExclusive(true))
-        throw std::runtime_error("Unable to set exclusive mode");
+void SerialPortImpl::close()
+{
+    std::error_code error{};
+    close(error);
 
-    // Apply new port settings
-    try
-    {
-        updatePortSettings();
-    }
-    catch(...)
-    {
-        close();
-        throw;
-    }
+    // Throw if restoring previous settings failed
+    if (error)
+        throw std::system_error(error, "Unable to set port settings");
 }
 
-void SerialPortImpl::close()
+void SerialPortImpl::close(std::error_code& error) noexcept
 {
+    error.clear();
+
     // Do nothing on a closed port
     if (!isOpen())
         return;
 
     // Restore previous serial port settings
-    auto settingsReset = setPortSettings(portSettings);
+    if (!setPortSettings(portSettings))
+        error = getLastError();
 
     // Close serial port and reset file descriptor
     systemCall(::close, fileDescriptor);
     fileDescriptor = INVALID_FILE_DESCRIPTOR;
+}
 
-    // Throw if restoring previous settings failed
-    if (!settingsReset)
-        throw std::runtime_error("Unable to set port settings");
+void SerialPortImpl::abandon() noexcept
+{
+    // Do nothing on a closed port
+    if (!isOpen())
+        return;
+
+    // Close serial port and reset file descriptor
+    systemCall(::close, fileDescriptor);
+    fileDescriptor = INVALID_FILE_DESCRIPTOR;
 }
 
 bool SerialPortImpl::setExclusive(bool exclusive)
@@ -151,6 +172,35 @@ size_t SerialPortImpl::read(char* buffer, size_t size) const
     return (isOpen() ? systemCall(::read, fileDescriptor, buffer, size) : 0);
 }
 
+size_t SerialPortImpl::read(char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    // Fail on a closed port
+    if (!isOpen())
+    {
+        error = SerialError::SERIAL_ERROR_NOT_OPEN;
+        return 0;
+    }
+
+    const auto result{systemCall(::read, fileDescriptor, buffer, size)};
+    if (result > 0)
+    {
+        error.clear();
+        return static_cast<size_t>(result);
+    }
+
+    // Empty non-blocking read is either no data or a hang-up
+    if (result == 0)
+    {
+        if (size == 0)
+            error.clear();
+        else
+            error = (isHungUp() ? SerialError::SERIAL_ERROR_HANGUP : SerialError::SERIAL_ERROR_WOULD_BLOCK);
+    }
+    else
+        error = getIoError();
+    return 0;
+}
+
 size_t SerialPortImpl::read(std::string& buffer) const
 {
     // Do nothing on a closed port
@@ -189,6 +239,63 @@ size_t SerialPortImpl::write(const char* buffer, size_t size) const
     return (isOpen() ? systemCall(::write, fileDescriptor, buffer, size) : 0);
 }
 
+size_t SerialPortImpl::write(const char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    // Fail on a closed port
+    if (!isOpen())
+    {
+        error = SerialError::SERIAL_ERROR_NOT_OPEN;
+        return 0;
+    }
+
+    const auto result{systemCall(::write, fileDescriptor, buffer, size)};
+    if (result > 0)
+    {
+        error.clear();
+        return static_cast<size_t>(result);
+    }
+
+    if (result == 0)
+    {
+        if (size == 0)
+            error.clear();
+        else
+            error = SerialError::SERIAL_ERROR_WOULD_BLOCK;
+    }
+    else
+        error = getIoError();
+    return 0;
+}
+
+size_t SerialPortImpl::writeAll(const char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error) const noexcept
+{
+    error.clear();
+    size_t total{0};
+    while (total < size)
+    {
+        total += write(buffer + total, size - total, error);
+        if (!error)
+            continue;
+        if (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)
+            break;
+
+        // Hang-up and errors are reported by the following write
+        struct pollfd descriptor{fileDescriptor, POLLOUT, 0};
+        const auto result{systemCall(::poll, &descriptor, 1, (timeout.count() < 0) ? -1 : static_cast<int>(timeout.count()))};
+        if (result < 0)
+        {
+            error = std::error_code{errno, std::system_category()};
+            break;
+        }
+        if (result == 0)
+        {
+            error = std::make_error_code(std::errc::timed_out);
+            break;
+        }
+    }
+    return total;
+}
+
 size_t SerialPortImpl::write(const std::string& buffer) const
 {
     return (isOpen() ? systemCall(::write, fileDescriptor, buffer.c_str(), buffer.size()) : 0);
@@ -243,6 +350,16 @@ std::string SerialPortImpl::getPortName() const
     return portName;
 }
 
+NativeHandle SerialPortImpl::getNativeHandle() const
+{
+    return fileDescriptor;
+}
+
+std::shared_mutex& SerialPortImpl::getMutex() const noexcept
+{
+    return mutex;
+}
+
 void SerialPortImpl::setPortName(const std::string& portName)
 {
     this->portName = portName;
@@ -264,6 +381,19 @@ void SerialPortImpl::setBaudRate(BaudRate baudRate)
     updatePortSettings();
 }
 
+void SerialPortImpl::setBaudRate(BaudRate baudRate, std::error_code& error) noexcept
+{
+    // Baud rate supported?
+    if (!LibSerial::isBaudRateSupported(baudRate))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    this->baudRate = baudRate;
+    updatePortSettings(error);
+}
+
 CharacterSize SerialPortImpl::getCharacterSize() const
 {
     return characterSize;
@@ -279,6 +409,19 @@ void SerialPortImpl::setCharacterSize(CharacterSize characterSize)
     updatePortSettings();
 }
 
+void SerialPortImpl::setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept
+{
+    // Character size supported?
+    if (!LibSerial::isCharacterSizeSupported(characterSize))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    this->characterSize = characterSize;
+    updatePortSettings(error);
+}
+
 FlowControl SerialPortImpl::getFlowControl() const
 {
     return flowControl;
@@ -295,6 +438,20 @@ void SerialPortImpl::setFlowControl(FlowControl flowControl)
     updatePortSettings();
 }
 
+void SerialPortImpl::setFlowControl(FlowControl flowControl, std::error_code& error) noexcept
+{
+    // Flow control supported?
+    if (!LibSerial::isFlowControlSupported(flowControl))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    drain();
+    this->flowControl = flowControl;
+    updatePortSettings(error);
+}
+
 Parity SerialPortImpl::getParity() const
 {
     return parity;
@@ -311,6 +468,20 @@ void SerialPortImpl::setParity(Parity parity)
     updatePortSettings();
 }
 
+void SerialPortImpl::setParity(Parity parity, std::error_code& error) noexcept
+{
+    // Parity supported?
+    if (!LibSerial::isParitySupported(parity))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    drain();
+    this->parity = parity;
+    updatePortSettings(error);
+}
+
 StopBit SerialPortImpl::getStopBit() const
 {
     return stopBit;
@@ -327,6 +498,20 @@ void SerialPortImpl::setStopBit(StopBit stopBit)
     updatePortSettings();
 }
 
+void SerialPortImpl::setStopBit(StopBit stopBit, std::error_code& error) noexcept
+{
+    // Stop bit supported?
+    if (!LibSerial::isStopBitSupported(stopBit))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    drain();
+    this->stopBit = stopBit;
+    updatePortSettings(error);
+}
+
 bool SerialPortImpl::getControlLine(ControlLine controlLine) const
 {
     // Do nothing on a closed port
@@ -358,23 +543,129 @@ void SerialPortImpl::reopen()
     open(openMode);
 }
 
+const char* SerialPortImpl::openPort(std::ios_base::openmode openMode,
+    const NativePortSettings* nativePortSettings, std::error_code& error) noexcept
+{
+    error.clear();
+
+    // Do nothing on an open port
+    if (isOpen())
+        return nullptr;
+
+    // Prepare open mode
+    int descriptorFlags{O_NOCTTY | O_NONBLOCK};
+    if (openMode == (std::ios_base::in | std::ios_base::out))
+        descriptorFlags |= O_RDWR;
+    else if (openMode == std::ios_base::in)
+        descriptorFlags |= O_RDONLY;
+    else if (openMode == std::ios_base::out)
+        descriptorFlags |= O_WRONLY;
+    else
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return "Unsupported open mode";
+    }
+
+    // Store open mode
+    this->openMode = openMode;
+
+    // Open serial port
+    fileDescriptor = systemCall(::open, portName.c_str(), descriptorFlags);
+
+    // Is serial port open?
+    if (!isOpen())
+    {
+        error = getLastError();
+        return "Unable to open serial port";
+    }
+
+    // Store current port settings
+    if (!getPortSettings(portSettings))
+    {
+        // Close serial port and reset file descriptor
+        error = getLastError();
+        abandon();
+        return "Unable to get port settings";
+    }
+
+    // Set exclusive mode and apply new port settings
+    const char* failure{nullptr};
+    if (!setExclusive(true))
+    {
+        error = getLastError();
+        failure = "Unable to set exclusive mode";
+    }
+    else if (nativePortSettings != nullptr)
+    {
+        // Apply precomputed port settings on top of the stored ones
+        struct termios portSettings{this->portSettings};
+        preparePortSettings(portSettings, *nativePortSettings);
+        if (!setPortSettings(portSettings))
+        {
+            error = getLastError();
+            failure = "Unable to set port settings";
+        }
+    }
+    else
+        failure = updatePortSettings(error);
+
+    // Restore previous port settings and close serial port on failure
+    if (failure != nullptr)
+    {
+        std::error_code closeError{};
+        close(closeError);
+    }
+    return failure;
+}
+
 void SerialPortImpl::updatePortSettings() const
 {
+    std::error_code error{};
+    if (const auto failure{updatePortSettings(error)})
+        throw std::system_error(error, failure);
+}
+
+const char* SerialPortImpl::updatePortSettings(std::error_code& error) const noexcept
+{
+    error.clear();
+
     // Do nothing on a closed port
     if (!isOpen())
-        return;
+        return nullptr;
+
+    // Properties passed to the constructor are not validated
+    if (!LibSerial::isBaudRateSupported(baudRate) || !LibSerial::isCharacterSizeSupported(characterSize) ||
+        !LibSerial::isFlowControlSupported(flowControl) || !LibSerial::isParitySupported(parity) ||
+        !LibSerial::isStopBitSupported(stopBit))
+    {
+        error = SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+        return "Port settings not supported";
+    }
 
     // Get port settings
     struct termios portSettings{};
     if (!getPortSettings(portSettings))
-        throw std::runtime_error("Unable to get port settings");
+    {
+        error = getLastError();
+        return "Unable to get port settings";
+    }
 
     // Update port settings
     preparePortSettings(portSettings);
 
     // Apply port settings
     if (!setPortSettings(portSettings))
-        throw std::runtime_error("Unable to set port settings");
+    {
+        error = getLastError();
+        return "Unable to set port settings";
+    }
+    return nullptr;
+}
+
+bool SerialPortImpl::isHungUp() const noexcept
+{
+    struct pollfd descriptor{fileDescriptor, POLLIN, 0};
+    return ((systemCall(::poll, &descriptor, 1, 0) > 0) && ((descriptor.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0));
 }
 
 bool SerialPortImpl::getPortSettings(struct termios& portSettings) const
@@ -901,6 +1192,21 @@ void SerialPortImpl::preparePortSettings(struct termios& portSettings) const
     portSettings.c_cc[VWERASE] = _POSIX_VDISABLE;
 }
 
+void SerialPortImpl::preparePortSettings(struct termios& portSettings, const NativePortSettings& nativePortSettings) const
+{
+    portSettings.c_iflag = (portSettings.c_iflag & ~nativePortSettings.inputFlagsClear) | nativePortSettings.inputFlagsSet;
+    portSettings.c_oflag = (portSettings.c_oflag & ~nativePortSettings.outputFlagsClear) | nativePortSettings.outputFlagsSet;
+    portSettings.c_cflag = (portSettings.c_cflag & ~nativePortSettings.controlFlagsClear) | nativePortSettings.controlFlagsSet;
+    portSettings.c_lflag = (portSettings.c_lflag & ~nativePortSettings.localFlagsClear) | nativePortSettings.localFlagsSet;
+    cfsetspeed(&portSettings, nativePortSettings.speed);
+
+    for (size_t index{0}; index < NCCS; ++index)
+    {
+        if ((nativePortSettings.controlCharacterMask & (1ULL << index)) != 0)
+            portSettings.c_cc[index] = nativePortSettings.controlCharacters[index];
+    }
+}
+
 bool SerialPortImpl::setPortSettings(const struct termios& portSettings) const
 {
     return (systemCall(tcsetattr, fileDescriptor, TCSANOW, &portSettings) == 0);
@@ -0,0 +1,408 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serialport_pump.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Poll timeout while reading of a serial port is paused in milli-seconds
+     *
+     */
+    static constexpr int STALL_TIMEOUT{1};
+
+    /**
+     * @brief Get the steady clock time
+     *
+     * @return int64_t Steady clock time in nano-seconds
+     */
+    inline int64_t getTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Get the histogram bucket of a latency
+     *
+     * @param latency Latency in nano-seconds
+     * @return size_t Histogram bucket
+     */
+    inline size_t getBucket(int64_t latency)
+    {
+        const auto microseconds{static_cast<uint64_t>(latency) / 1000U};
+        if (microseconds == 0)
+            return 0;
+
+        const auto bucket{static_cast<size_t>(64 - __builtin_clzll(microseconds))};
+        return std::min(bucket, PUMP_HISTOGRAM_SIZE - 1);
+    }
+} // namespace
+
+SerialPortPump::SerialPortPump(const PumpOptions& options) :
+    options{options}, queueMask{options.queueSize - 1}, ports{}, descriptors{},
+    wakeupEvent{INVALID_FILE_DESCRIPTOR}, stopped{true}, wakeupTime{0}, wakeupCount{0},
+    receivedCount{0}, transmittedCount{0}, stallCount{0}, errorCount{0}, maxWakeupLatency{0},
+    wakeupLatencyHistogram{}, thread{}
+{
+    if (options.chunkSize == 0)
+        throw std::out_of_range("Invalid chunk size");
+    if ((options.queueSize == 0) || ((options.queueSize & queueMask) != 0))
+        throw std::out_of_range("Invalid queue size");
+    if ((options.cpu < -1) || (options.cpu >= CPU_SETSIZE))
+        throw std::out_of_range("Invalid CPU");
+    if ((options.priority < 0) || (options.priority > ::sched_get_priority_max(SCHED_FIFO)))
+        throw std::out_of_range("Invalid priority");
+
+    for (auto& bucket: wakeupLatencyHistogram)
+        bucket.store(0, std::memory_order_relaxed);
+
+    wakeupEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeupEvent == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create event");
+}
+
+SerialPortPump::~SerialPortPump() noexcept
+{
+    stop();
+    systemCall(::close, wakeupEvent);
+}
+
+size_t SerialPortPump::addPort(SerialPort& serialPort)
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+    if (isRunning())
+        throw std::runtime_error("Pump is running");
+
+    auto port{std::make_unique<Port>()};
+    port->serialPort = &serialPort;
+    port->fileDescriptor = serialPort.getNativeHandle();
+    port->stalled = false;
+    port->failed = false;
+    allocate(port->receiveQueue);
+    allocate(port->transmitQueue);
+
+    ports.push_back(std::move(port));
+    return (ports.size() - 1);
+}
+
+size_t SerialPortPump::getPortCount() const
+{
+    return ports.size();
+}
+
+void SerialPortPump::start()
+{
+    if (isRunning())
+        throw std::runtime_error("Pump is running");
+
+    // Lock the preallocated queues before the pump thread touches them
+    if (options.lockMemory && (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+        throw std::runtime_error("Unable to lock memory");
+
+    descriptors.assign(ports.size() + 1, {INVALID_FILE_DESCRIPTOR, 0, 0});
+    stopped = false;
+    try
+    {
+        thread = std::thread{&SerialPortPump::run, this};
+    }
+    catch (const std::system_error&)
+    {
+        stopped = true;
+        throw std::runtime_error("Unable to start pump thread");
+    }
+
+    if (options.cpu >= 0)
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(static_cast<size_t>(options.cpu), &cpuSet);
+        if (::pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet) != 0)
+        {
+            stop();
+            throw std::runtime_error("Unable to set CPU affinity");
+        }
+    }
+
+    if (options.priority > 0)
+    {
+        struct sched_param parameters{};
+        parameters.sched_priority = options.priority;
+        if (::pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &parameters) != 0)
+        {
+            stop();
+            throw std::runtime_error("Unable to set real-time priority");
+        }
+    }
+}
+
+void SerialPortPump::stop()
+{
+    if (!thread.joinable())
+        return;
+
+    stopped = true;
+    const uint64_t value{1};
+    systemCall(::write, wakeupEvent, &value, sizeof(value));
+    thread.join();
+}
+
+bool SerialPortPump::isRunning() const
+{
+    return thread.joinable();
+}
+
+size_t SerialPortPump::receive(size_t port, char* buffer, size_t size)
+{
+    if (port >= ports.size())
+        throw std::out_of_range("Invalid port index");
+
+    auto& queue{ports[port]->receiveQueue};
+    auto head{queue.head.load(std::memory_order_relaxed)};
+    const auto tail{queue.tail.load(std::memory_order_acquire)};
+
+    // Copy out of the chunks, a partially copied chunk is kept at the head
+    size_t count{0};
+    while ((count < size) && (head != tail))
+    {
+        const auto slot{head & queueMask};
+        const auto chunk{queue.data.get() + (slot * options.chunkSize)};
+        const auto copied{std::min(size - count, queue.sizes[slot] - queue.offset)};
+        std::memcpy(buffer + count, chunk + queue.offset, copied);
+        count += copied;
+        queue.offset += copied;
+        if (queue.offset == queue.sizes[slot])
+        {
+            queue.offset = 0;
+            ++head;
+        }
+    }
+    queue.head.store(head, std::memory_order_release);
+    return count;
+}
+
+bool SerialPortPump::send(size_t port, const char* data, size_t size)
+{
+    if (port >= ports.size())
+        throw std::out_of_range("Invalid port index");
+    if (size > options.chunkSize)
+        return false;
+    if (size == 0)
+        return true;
+
+    auto& queue{ports[port]->transmitQueue};
+    const auto tail{queue.tail.load(std::memory_order_relaxed)};
+    if ((tail - queue.head.load(std::memory_order_acquire)) >= options.queueSize)
+        return false;
+
+    const auto slot{tail & queueMask};
+    std::memcpy(queue.data.get() + (slot * options.chunkSize), data, size);
+    queue.sizes[slot] = size;
+    queue.tail.store(tail + 1, std::memory_order_seq_cst);
+
+    // Pump thread only waits for a port to become writable while its queue is not empty
+    if (queue.head.load(std::memory_order_seq_cst) == tail)
+    {
+        int64_t expected{0};
+        wakeupTime.compare_exchange_strong(expected, getTime(), std::memory_order_acq_rel);
+        const uint64_t value{1};
+        systemCall(::write, wakeupEvent, &value, sizeof(value));
+    }
+    return true;
+}
+
+PumpStatistics SerialPortPump::getStatistics() const
+{
+    PumpStatistics statistics{};
+    statistics.wakeupCount = wakeupCount.load(std::memory_order_relaxed);
+    statistics.receivedCount = receivedCount.load(std::memory_order_relaxed);
+    statistics.transmittedCount = transmittedCount.load(std::memory_order_relaxed);
+    statistics.stallCount = stallCount.load(std::memory_order_relaxed);
+    statistics.errorCount = errorCount.load(std::memory_order_relaxed);
+    statistics.maxWakeupLatency = std::chrono::nanoseconds{maxWakeupLatency.load(std::memory_order_relaxed)};
+    for (size_t bucket{0}; bucket < PUMP_HISTOGRAM_SIZE; ++bucket)
+        statistics.wakeupLatencyHistogram[bucket] = wakeupLatencyHistogram[bucket].load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void SerialPortPump::allocate(Queue& queue) const
+{
+    // Value-initialized storage is touched once, so locked pages are resident before the pump starts
+    queue.data = std::make_unique<char[]>(options.queueSize * options.chunkSize);
+    queue.sizes = std::make_unique<size_t[]>(options.queueSize);
+    queue.offset = 0;
+    queue.head.store(0, std::memory_order_relaxed);
+    queue.tail.store(0, std::memory_order_relaxed);
+}
+
+void SerialPortPump::run()
+{
+    while (!stopped.load(std::memory_order_acquire))
+    {
+        // Wait for data only with room in the receive queue and for writability only with data to transmit
+        bool paused{false};
+        for (size_t index{0}; index < ports.size(); ++index)
+        {
+            auto& port{*ports[index]};
+            short events{0};
+            if (!port.failed)
+            {
+                const auto& receiveQueue{port.receiveQueue};
+                const auto full{(receiveQueue.tail.load(std::memory_order_relaxed) -
+                    receiveQueue.head.load(std::memory_order_acquire)) >= options.queueSize};
+                if (full && !port.stalled)
+                    stallCount.fetch_add(1, std::memory_order_relaxed);
+                port.stalled = full;
+                paused |= full;
+                if (!full)
+                    events |= POLLIN;
+
+                const auto& transmitQueue{port.transmitQueue};
+                if (transmitQueue.tail.load(std::memory_order_seq_cst) != transmitQueue.head.load(std::memory_order_relaxed))
+                    events |= POLLOUT;
+            }
+
+            // Ports without interest are skipped, so a hang-up is not reported while paused
+            descriptors[index] = {((events != 0) ? port.fileDescriptor : INVALID_FILE_DESCRIPTOR), events, 0};
+        }
+        descriptors.back() = {wakeupEvent, POLLIN, 0};
+
+        if (systemCall(::poll, descriptors.data(), static_cast<nfds_t>(descriptors.size()), paused ? STALL_TIMEOUT : -1) < 0)
+            continue;
+
+        if ((descriptors.back().revents & POLLIN) != 0)
+        {
+            uint64_t value{0};
+            systemCall(::read, wakeupEvent, &value, sizeof(value));
+            recordWakeup();
+
+            // Sent data is written right away instead of waiting for writability first
+            for (auto& port: ports)
+            {
+                if (!port->failed)
+                    transmit(*port);
+            }
+        }
+
+        for (size_t index{0}; index < ports.size(); ++index)
+        {
+            auto& port{*ports[index]};
+            const auto revents{descriptors[index].revents};
+            if (((revents & POLLOUT) != 0) && !port.failed)
+                transmit(port);
+            if (((revents & (POLLIN | POLLHUP | POLLERR)) != 0) && !port.failed)
+                receive(port);
+        }
+    }
+}
+
+void SerialPortPump::receive(Port& port)
+{
+    auto& queue{port.receiveQueue};
+    while (true)
+    {
+        const auto tail{queue.tail.load(std::memory_order_relaxed)};
+        if ((tail - queue.head.load(std::memory_order_acquire)) >= options.queueSize)
+            return;
+
+        // Data is read straight into the next free chunk
+        const auto slot{tail & queueMask};
+        std::error_code error{};
+        const auto result{port.serialPort->read(queue.data.get() + (slot * options.chunkSize), options.chunkSize, error)};
+        if (error)
+        {
+            if (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)
+            {
+                port.failed = true;
+                errorCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        receivedCount.fetch_add(result, std::memory_order_relaxed);
+        queue.sizes[slot] = result;
+        queue.tail.store(tail + 1, std::memory_order_release);
+        if (result < options.chunkSize)
+            return;
+    }
+}
+
+void SerialPortPump::transmit(Port& port)
+{
+    auto& queue{port.transmitQueue};
+    auto head{queue.head.load(std::memory_order_relaxed)};
+    const auto tail{queue.tail.load(std::memory_order_acquire)};
+    while (head != tail)
+    {
+        const auto slot{head & queueMask};
+        std::error_code error{};
+        const auto result{port.serialPort->write(queue.data.get() + (slot * options.chunkSize) + queue.offset,
+            queue.sizes[slot] - queue.offset, error)};
+        if (error)
+        {
+            if (error != SerialError::SERIAL_ERROR_WOULD_BLOCK)
+            {
+                port.failed = true;
+                errorCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+
+        transmittedCount.fetch_add(result, std::memory_order_relaxed);
+        queue.offset += result;
+        if (queue.offset < queue.sizes[slot])
+            break;
+
+        queue.offset = 0;
+        ++head;
+    }
+    queue.head.store(head, std::memory_order_seq_cst);
+}
+
+void SerialPortPump::recordWakeup()
+{
+    const auto time{wakeupTime.exchange(0, std::memory_order_acq_rel)};
+    if (time == 0)
+        return;
+
+    const auto latency{std::max<int64_t>(0, getTime() - time)};
+    wakeupCount.fetch_add(1, std::memory_order_relaxed);
+    wakeupLatencyHistogram[getBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+    if (latency > maxWakeupLatency.load(std::memory_order_relaxed))
+        maxWakeupLatency.store(latency, std::memory_order_relaxed);
+}
+
+END_NAMESPACE_LIBSERIAL
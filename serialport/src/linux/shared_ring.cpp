@@ -0,0 +1,415 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/shared_ring.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Shared ring header
+ *
+ * @note Positions are monotonic byte counters, the ring offset is the
+ *   position masked by the capacity. The reserve position is advanced before
+ *   the ring data is overwritten and the commit position after, which lets
+ *   subscribers detect data overwritten while it was being copied.
+ */
+struct SharedRingHeader
+{
+    /**
+     * @brief Magic value marking an initialized ring
+     *
+     */
+    std::atomic<uint32_t> magic;
+
+    /**
+     * @brief Ring layout version
+     *
+     */
+    uint32_t version;
+
+    /**
+     * @brief Ring capacity in bytes
+     *
+     */
+    uint64_t capacity;
+
+    /**
+     * @brief Position up to which the ring data is valid
+     *
+     */
+    alignas(64) std::atomic<uint64_t> commitPosition;
+
+    /**
+     * @brief Position up to which the ring data may be overwritten
+     *
+     */
+    alignas(64) std::atomic<uint64_t> reservePosition;
+
+    /**
+     * @brief Futex word incremented on every commit
+     *
+     */
+    alignas(64) std::atomic<uint32_t> sequence;
+
+    /**
+     * @brief Number of waiting subscribers
+     *
+     */
+    std::atomic<uint32_t> waiters;
+};
+
+namespace
+{
+
+/**
+ * @brief Shared ring magic value
+ *
+ */
+constexpr uint32_t SHARED_RING_MAGIC{0x4C535252};
+
+/**
+ * @brief Shared ring layout version
+ *
+ */
+constexpr uint32_t SHARED_RING_VERSION{1};
+
+/**
+ * @brief Offset of the ring data in the mapping
+ *
+ */
+constexpr size_t SHARED_RING_DATA_OFFSET{4096};
+
+static_assert(sizeof(SharedRingHeader) <= SHARED_RING_DATA_OFFSET, "Shared ring header too large");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared ring requires lock-free 64-bit atomics");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex word must be 32-bit");
+
+/**
+ * @brief Round the capacity up to a power of two
+ *
+ * @param capacity Requested capacity
+ * @return size_t Power of two capacity
+ */
+size_t roundCapacity(size_t capacity)
+{
+    size_t result{64};
+    while (result < capacity)
+        result <<= 1;
+    return result;
+}
+
+/**
+ * @brief Wait on a shared futex word
+ *
+ * @param word Futex word
+ * @param value Expected value
+ * @param timeout Relative timeout
+ * @return int Result of the system call
+ */
+int futexWait(std::atomic<uint32_t>* word, uint32_t value, const struct timespec* timeout)
+{
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, value, timeout, nullptr, 0));
+}
+
+/**
+ * @brief Wake up all waiters on a shared futex word
+ *
+ * @param word Futex word
+ * @return int Result of the system call
+ */
+int futexWake(std::atomic<uint32_t>* word)
+{
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0));
+}
+
+} // namespace
+
+SharedRingPublisher::SharedRingPublisher(SerialPort& serialPort, const std::string& name, size_t capacity, mode_t mode) :
+    serialPort{serialPort}, name{name}, capacity{roundCapacity(capacity)},
+    mappingSize{SHARED_RING_DATA_OFFSET + this->capacity}, header{nullptr}, data{nullptr}
+{
+    // Create shared memory object, an existing ring may still be mapped by its publisher and subscribers
+    const auto fileDescriptor{systemCall(::shm_open, name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode)};
+    if (fileDescriptor == INVALID_FILE_DESCRIPTOR)
+    {
+        if (errno == EEXIST)
+            throw std::runtime_error("Shared memory object already exists");
+        throw std::runtime_error("Unable to create shared memory object");
+    }
+
+    // Permissions are not masked by the umask
+    if ((systemCall(::fchmod, fileDescriptor, mode) != 0) ||
+        (systemCall(::ftruncate, fileDescriptor, static_cast<off_t>(mappingSize)) != 0))
+    {
+        systemCall(::close, fileDescriptor);
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("Unable to resize shared memory object");
+    }
+
+    auto mapping{::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0)};
+    systemCall(::close, fileDescriptor);
+    if (mapping == MAP_FAILED)
+    {
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("Unable to map shared memory object");
+    }
+
+    // Initialize header, the magic value is published last
+    header = new (mapping) SharedRingHeader{};
+    header->version = SHARED_RING_VERSION;
+    header->capacity = this->capacity;
+    header->commitPosition.store(0);
+    header->reservePosition.store(0);
+    header->sequence.store(0);
+    header->waiters.store(0);
+    data = static_cast<char*>(mapping) + SHARED_RING_DATA_OFFSET;
+    header->magic.store(SHARED_RING_MAGIC, std::memory_order_release);
+}
+
+SharedRingPublisher::~SharedRingPublisher() noexcept
+{
+    ::munmap(header, mappingSize);
+    ::shm_unlink(name.c_str());
+}
+
+size_t SharedRingPublisher::pump(std::chrono::milliseconds timeout)
+{
+    // Do nothing on a closed port
+    if (!serialPort.isOpen())
+        return 0;
+
+    // Wait for the data
+    struct pollfd descriptor{serialPort.getNativeHandle(), POLLIN, 0};
+    if (systemCall(::poll, &descriptor, 1, static_cast<int>(timeout.count())) <= 0)
+        return 0;
+
+    // Read directly into the ring until the serial port is drained
+    size_t result{0};
+    const auto mask{capacity - 1};
+    while (true)
+    {
+        const auto position{header->commitPosition.load(std::memory_order_relaxed)};
+        const auto offset{static_cast<size_t>(position & mask)};
+        const auto size{std::min(capacity - offset, capacity / 2)};
+
+        header->reservePosition.store(position + size, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const auto count{serialPort.read(data + offset, size)};
+        if ((count == 0) || (count == static_cast<size_t>(-1)))
+        {
+            header->reservePosition.store(position, std::memory_order_relaxed);
+            break;
+        }
+
+        header->commitPosition.store(position + count, std::memory_order_release);
+        header->reservePosition.store(position + count, std::memory_order_relaxed);
+        result += count;
+    }
+
+    if (result > 0)
+        notify();
+    return result;
+}
+
+size_t SharedRingPublisher::publish(const char* buffer, size_t size)
+{
+    // Only the most recent data fits into the ring
+    const auto skipped{(size > capacity) ? (size - capacity) : 0};
+    auto position{header->commitPosition.load(std::memory_order_relaxed) + skipped};
+    const auto mask{capacity - 1};
+
+    header->reservePosition.store(position + (size - skipped), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Copy data with a wrap-around
+    for (size_t index{skipped}; index < size;)
+    {
+        const auto offset{static_cast<size_t>(position & mask)};
+        const auto count{std::min(size - index, capacity - offset)};
+        std::memcpy(data + offset, buffer + index, count);
+        index += count;
+        position += count;
+    }
+
+    header->commitPosition.store(position, std::memory_order_release);
+    notify();
+    return size;
+}
+
+std::string SharedRingPublisher::getName() const
+{
+    return name;
+}
+
+size_t SharedRingPublisher::getCapacity() const
+{
+    return capacity;
+}
+
+uint64_t SharedRingPublisher::getPosition() const
+{
+    return header->commitPosition.load(std::memory_order_acquire);
+}
+
+void SharedRingPublisher::notify()
+{
+    // Only subscribers which announced themselves need a system call
+    header->sequence.fetch_add(1);
+    if (header->waiters.load() > 0)
+        futexWake(&header->sequence);
+}
+
+SharedRingSubscriber::SharedRingSubscriber(const std::string& name) :
+    capacity{0}, mappingSize{0}, header{nullptr}, data{nullptr}, position{0}, lostCount{0}
+{
+    const auto fileDescriptor{systemCall(::shm_open, name.c_str(), O_RDWR | O_CLOEXEC, 0)};
+    if (fileDescriptor == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to open shared memory object");
+
+    struct stat status{};
+    if ((systemCall(::fstat, fileDescriptor, &status) != 0) || (static_cast<size_t>(status.st_size) <= SHARED_RING_DATA_OFFSET))
+    {
+        systemCall(::close, fileDescriptor);
+        throw std::runtime_error("Invalid shared memory object");
+    }
+
+    mappingSize = static_cast<size_t>(status.st_size);
+    auto mapping{::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0)};
+    systemCall(::close, fileDescriptor);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("Unable to map shared memory object");
+
+    header = static_cast<SharedRingHeader*>(mapping);
+    if ((header->magic.load(std::memory_order_acquire) != SHARED_RING_MAGIC) || (header->version != SHARED_RING_VERSION) ||
+        ((SHARED_RING_DATA_OFFSET + header->capacity) != mappingSize))
+    {
+        ::munmap(mapping, mappingSize);
+        throw std::runtime_error("Invalid shared memory object");
+    }
+
+    capacity = static_cast<size_t>(header->capacity);
+    data = static_cast<const char*>(mapping) + SHARED_RING_DATA_OFFSET;
+    position = header->commitPosition.load(std::memory_order_acquire);
+}
+
+SharedRingSubscriber::~SharedRingSubscriber() noexcept
+{
+    ::munmap(header, mappingSize);
+}
+
+size_t SharedRingSubscriber::read(char* buffer, size_t size, std::chrono::milliseconds timeout)
+{
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    const auto mask{capacity - 1};
+    while (size > 0)
+    {
+        const auto commitPosition{header->commitPosition.load(std::memory_order_acquire)};
+        if (commitPosition == position)
+        {
+            if (!wait(deadline))
+                return 0;
+            continue;
+        }
+
+        // Skip data already overwritten by the publisher
+        if ((commitPosition - position) > capacity)
+        {
+            lostCount += (commitPosition - capacity) - position;
+            position = commitPosition - capacity;
+        }
+
+        // Copy data with a wrap-around
+        const auto count{static_cast<size_t>(std::min<uint64_t>(size, commitPosition - position))};
+        const auto offset{static_cast<size_t>(position & mask)};
+        const auto first{std::min(count, capacity - offset)};
+        std::memcpy(buffer, data + offset, first);
+        std::memcpy(buffer + first, data, count - first);
+
+        // Discard the copy if the publisher overwrote it in the meantime
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto reservePosition{header->reservePosition.load(std::memory_order_relaxed)};
+        if ((reservePosition - position) > capacity)
+        {
+            lostCount += (reservePosition - capacity) - position;
+            position = reservePosition - capacity;
+            continue;
+        }
+
+        position += count;
+        return count;
+    }
+    return 0;
+}
+
+size_t SharedRingSubscriber::getAvailable() const
+{
+    const auto commitPosition{header->commitPosition.load(std::memory_order_acquire)};
+    return static_cast<size_t>(std::min<uint64_t>(commitPosition - position, capacity));
+}
+
+uint64_t SharedRingSubscriber::getLostCount() const
+{
+    return lostCount;
+}
+
+bool SharedRingSubscriber::wait(std::chrono::steady_clock::time_point deadline)
+{
+    // Announce the waiter before the final check to avoid a lost wake-up
+    header->waiters.fetch_add(1);
+    while (true)
+    {
+        const auto sequence{header->sequence.load()};
+        if (header->commitPosition.load() != position)
+            break;
+
+        const auto remaining{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now())};
+        if (remaining.count() <= 0)
+        {
+            header->waiters.fetch_sub(1);
+            return false;
+        }
+
+        auto timeout{toTimespec(remaining)};
+        futexWait(&header->sequence, sequence, &timeout);
+    }
+    header->waiters.fetch_sub(1);
+    return true;
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,272 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/enumerator.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/supervisor.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+SerialPortSupervisor::SerialPortSupervisor(SerialPort& serialPort) :
+    SerialPortSupervisor(serialPort, nullptr)
+{
+
+}
+
+SerialPortSupervisor::SerialPortSupervisor(SerialPort& serialPort, PortLocator portLocator) :
+    serialPort{serialPort}, portLocator{std::move(portLocator)}, identity{},
+    openMode{std::ios_base::in | std::ios_base::out}, exclusive{true},
+    state{serialPort.isOpen() ? SupervisorState::SUPERVISOR_STATE_OPEN : SupervisorState::SUPERVISOR_STATE_CLOSED},
+    retryInterval{100}, disconnectTime{}, statistics{}
+{
+    // Capture identity of an already open serial port
+    if (isConnected() && !Enumerator::findPortInfo(serialPort.getPortName(), identity))
+    {
+        identity.portName = Enumerator::fileNameToSerialPort(serialPort.getPortName());
+        identity.fileName = Enumerator::serialPortToFileName(serialPort.getPortName());
+    }
+}
+
+void SerialPortSupervisor::open(std::ios_base::openmode openMode)
+{
+    // Open serial port and store open mode for reconnects
+    serialPort.open(openMode);
+    if (!serialPort.setExclusive(exclusive))
+    {
+        serialPort.close();
+        throw std::runtime_error("Unable to set exclusive mode");
+    }
+    this->openMode = openMode;
+    state = SupervisorState::SUPERVISOR_STATE_OPEN;
+
+    // Capture identity of the device
+    identity = PortInfo{};
+    Enumerator::refreshPortInfoCache();
+    if (!Enumerator::findPortInfo(serialPort.getPortName(), identity))
+    {
+        identity.portName = Enumerator::fileNameToSerialPort(serialPort.getPortName());
+        identity.fileName = Enumerator::serialPortToFileName(serialPort.getPortName());
+    }
+}
+
+void SerialPortSupervisor::close()
+{
+    // Closed port is not reconnected
+    state = SupervisorState::SUPERVISOR_STATE_CLOSED;
+    serialPort.close();
+}
+
+bool SerialPortSupervisor::isConnected() const
+{
+    return (state == SupervisorState::SUPERVISOR_STATE_OPEN);
+}
+
+SupervisorState SerialPortSupervisor::getState() const
+{
+    return state;
+}
+
+bool SerialPortSupervisor::setExclusive(bool exclusive)
+{
+    // Serial port opens in exclusive mode, so the mode is reapplied on every open
+    this->exclusive = exclusive;
+    return (!isConnected() || serialPort.setExclusive(exclusive));
+}
+
+bool SerialPortSupervisor::checkConnection()
+{
+    // Do nothing on a disconnected or closed port
+    if (!isConnected())
+        return false;
+
+    // Check for a hang-up without waiting
+    struct pollfd descriptor{serialPort.getNativeHandle(), POLLIN, 0};
+    if ((systemCall(::poll, &descriptor, 1, 0) > 0) && ((descriptor.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0))
+        disconnect();
+
+    return isConnected();
+}
+
+size_t SerialPortSupervisor::read(char* buffer, size_t size)
+{
+    // Try to reconnect a disconnected port, a closed one stays closed
+    if (!isConnected() && !attemptReconnect())
+        return 0;
+
+    const auto result{serialPort.read(buffer, size)};
+    handleResult(result, size);
+    return ((isConnected() && (result != static_cast<size_t>(-1))) ? result : 0);
+}
+
+size_t SerialPortSupervisor::write(const char* buffer, size_t size)
+{
+    // Try to reconnect a disconnected port, a closed one stays closed
+    if (!isConnected() && !attemptReconnect())
+        return 0;
+
+    const auto result{serialPort.write(buffer, size)};
+    handleResult(result, size);
+    return ((isConnected() && (result != static_cast<size_t>(-1))) ? result : 0);
+}
+
+bool SerialPortSupervisor::reconnect(std::chrono::milliseconds timeout)
+{
+    // Do nothing on a connected or closed port
+    if (state != SupervisorState::SUPERVISOR_STATE_DISCONNECTED)
+        return isConnected();
+
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (!attemptReconnect())
+    {
+        const auto now{std::chrono::steady_clock::now()};
+        if (now >= deadline)
+            return false;
+
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(retryInterval, deadline - now));
+    }
+    return true;
+}
+
+std::chrono::milliseconds SerialPortSupervisor::getRetryInterval() const
+{
+    return retryInterval;
+}
+
+void SerialPortSupervisor::setRetryInterval(std::chrono::milliseconds retryInterval)
+{
+    this->retryInterval = retryInterval;
+}
+
+const PortInfo& SerialPortSupervisor::getIdentity() const
+{
+    return identity;
+}
+
+SupervisorStatistics SerialPortSupervisor::getStatistics() const
+{
+    return statistics;
+}
+
+void SerialPortSupervisor::handleResult(size_t result, size_t size)
+{
+    if (result == static_cast<size_t>(-1))
+    {
+        // Errors reported by a device which has disappeared
+        switch (errno)
+        {
+            case EIO:
+            case ENXIO:
+            case ENODEV:
+            case EBADF:
+                disconnect();
+                break;
+
+            default:
+                break;
+        }
+    }
+    else if ((result == 0) && (size > 0))
+    {
+        // Empty result may be a hang-up
+        checkConnection();
+    }
+}
+
+void SerialPortSupervisor::disconnect()
+{
+    // Settings of a disappeared device can not be restored
+    state = SupervisorState::SUPERVISOR_STATE_DISCONNECTED;
+    serialPort.abandon();
+
+    ++statistics.disconnectCount;
+    disconnectTime = std::chrono::steady_clock::now();
+}
+
+bool SerialPortSupervisor::attemptReconnect()
+{
+    // Only a detected disconnect is recovered from
+    if (state != SupervisorState::SUPERVISOR_STATE_DISCONNECTED)
+        return false;
+
+    const auto fileName{locatePort()};
+    if (fileName.empty())
+    {
+        ++statistics.failedAttemptCount;
+        return false;
+    }
+
+    try
+    {
+        // Settings are retained by the closed serial port, the exclusive mode is not
+        serialPort.setPortName(fileName);
+        serialPort.open(openMode);
+        if (!serialPort.setExclusive(exclusive))
+            throw std::runtime_error("Unable to set exclusive mode");
+    }
+    catch (const std::exception&)
+    {
+        serialPort.abandon();
+        ++statistics.failedAttemptCount;
+        return false;
+    }
+
+    state = SupervisorState::SUPERVISOR_STATE_OPEN;
+
+    // Update reconnect statistics
+    const auto latency{std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - disconnectTime)};
+    ++statistics.reconnectCount;
+    statistics.lastReconnectLatency = latency;
+    statistics.maxReconnectLatency = std::max(statistics.maxReconnectLatency, latency);
+    statistics.totalReconnectLatency += latency;
+    return true;
+}
+
+std::string SerialPortSupervisor::locatePort() const
+{
+    // User supplied locator takes precedence
+    if (portLocator)
+        return portLocator();
+
+    // Locate device by its stable identity
+    if (identity.hasStableIdentity())
+    {
+        Enumerator::refreshPortInfoCache();
+        for (const auto& portInfo: Enumerator::getPortInfoCache())
+        {
+            if (portInfo.isSameDevice(identity))
+                return portInfo.fileName;
+        }
+        return {};
+    }
+
+    // Fall back to the original file name
+    return ((::access(identity.fileName.c_str(), F_OK) == 0) ? identity.fileName : std::string());
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/timer_wheel.hpp>
+#include <serialport/linux/timer_dispatcher.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TimerDispatcher::TimerDispatcher(ExpiryHandler expiryHandler, std::chrono::microseconds resolution, size_t slotCount, size_t levelCount) :
+    wheel{resolution, slotCount, levelCount}, expiryHandler{std::move(expiryHandler)}, timer{INVALID_FILE_DESCRIPTOR},
+    programmedExpiry{std::chrono::steady_clock::time_point::max()}, statistics{}
+{
+    // Steady clock is the monotonic clock
+    timer = systemCall(::timerfd_create, CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create timer");
+}
+
+TimerDispatcher::~TimerDispatcher() noexcept
+{
+    systemCall(::close, timer);
+}
+
+NativeHandle TimerDispatcher::getNativeHandle() const
+{
+    return timer;
+}
+
+TimerId TimerDispatcher::arm(std::chrono::steady_clock::time_point deadline, uint64_t data)
+{
+    const auto timerId{wheel.arm(deadline, data)};
+    ++statistics.armCount;
+
+    // Later timers are picked up when the programmed expiry passes
+    const auto expiry{wheel.getExpiry(timerId)};
+    if (expiry < programmedExpiry)
+        program(expiry);
+    return timerId;
+}
+
+TimerId TimerDispatcher::arm(std::chrono::microseconds timeout, uint64_t data)
+{
+    return arm(std::chrono::steady_clock::now() + timeout, data);
+}
+
+TimerId TimerDispatcher::rearm(TimerId timerId, std::chrono::microseconds timeout, uint64_t data)
+{
+    wheel.cancel(timerId);
+    return arm(timeout, data);
+}
+
+bool TimerDispatcher::cancel(TimerId timerId)
+{
+    // Cancelled timer leaves at most a spurious wakeup behind
+    return wheel.cancel(timerId);
+}
+
+size_t TimerDispatcher::dispatch()
+{
+    uint64_t expirations{0};
+    systemCall(::read, timer, &expirations, sizeof(expirations));
+    ++statistics.dispatchCount;
+
+    // One-shot timerfd is disarmed once its expiry has passed
+    const auto now{std::chrono::steady_clock::now()};
+    if (programmedExpiry <= now)
+        programmedExpiry = std::chrono::steady_clock::time_point::max();
+
+    const auto count{wheel.advance(now, [this](TimerId timerId, uint64_t data)
+    {
+        if (expiryHandler)
+            expiryHandler(timerId, data);
+    })};
+    statistics.expiredCount += count;
+
+    const auto nextExpiry{wheel.getNextExpiry()};
+    if (nextExpiry != programmedExpiry)
+        program(nextExpiry);
+    return count;
+}
+
+size_t TimerDispatcher::getActiveCount() const
+{
+    return wheel.getActiveCount();
+}
+
+TimerDispatcherStatistics TimerDispatcher::getStatistics() const
+{
+    return statistics;
+}
+
+void TimerDispatcher::program(std::chrono::steady_clock::time_point expiry)
+{
+    // Zero expiry disarms the timerfd, an absolute time in the past fires immediately
+    struct itimerspec specification{};
+    if (expiry != std::chrono::steady_clock::time_point::max())
+        specification.it_value = toTimespec(std::max(expiry.time_since_epoch(), std::chrono::steady_clock::duration{1}));
+
+    if (systemCall(::timerfd_settime, timer, TFD_TIMER_ABSTIME, &specification, nullptr) != 0)
+        throw std::runtime_error("Unable to set timer");
+
+    programmedExpiry = expiry;
+    ++statistics.programCount;
+}
+
+END_NAMESPACE_LIBSERIAL
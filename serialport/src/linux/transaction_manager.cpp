@@ -0,0 +1,411 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/timer_wheel.hpp>
+#include <serialport/linux/transaction_manager.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TransactionManager::TransactionManager(SerialPort& serialPort, RequestCorrelator requestCorrelator,
+    ResponseCorrelator responseCorrelator, size_t window, size_t bufferSize) :
+    serialPort{serialPort}, requestCorrelator{std::move(requestCorrelator)}, responseCorrelator{std::move(responseCorrelator)},
+    window{window}, stopEvent{INVALID_FILE_DESCRIPTOR}, stopped{false}, failed{false}, transactions{}, freeTransactions{}, queue{},
+    inFlight{}, transmitIndex{INVALID_INDEX}, transmitOffset{0}, timers{}, buffer(bufferSize), bufferEnd{0},
+    byteTime{0.0}, statisticsTime{}, statistics{}
+{
+    if (!serialPort.isOpen())
+        throw std::runtime_error("Serial port is not open");
+    if ((window == 0) || (bufferSize == 0))
+        throw std::out_of_range("Invalid transaction window or buffer size");
+
+    resetStatistics();
+
+    stopEvent = systemCall(::eventfd, 0U, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopEvent == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to create event");
+}
+
+TransactionManager::~TransactionManager() noexcept
+{
+    systemCall(::close, stopEvent);
+}
+
+void TransactionManager::submit(std::string request, Completion completion, std::chrono::milliseconds timeout, unsigned retryCount)
+{
+    // Reuse a free slab entry
+    size_t index{transactions.size()};
+    if (!freeTransactions.empty())
+    {
+        index = freeTransactions.back();
+        freeTransactions.pop_back();
+    }
+    else
+    {
+        transactions.emplace_back();
+    }
+
+    auto& transaction{transactions[index]};
+    transaction.key = requestCorrelator(request);
+    transaction.request = std::move(request);
+    transaction.completion = std::move(completion);
+    transaction.timeout = timeout;
+    transaction.retryCount = retryCount;
+    transaction.timer = INVALID_TIMER_ID;
+    ++statistics.submittedCount;
+
+    if (failed)
+    {
+        finish(index, TransactionStatus::TRANSACTION_IO_ERROR, std::string_view());
+        return;
+    }
+
+    queue.push_back(index);
+    transmit();
+}
+
+size_t TransactionManager::poll(std::chrono::milliseconds timeout)
+{
+    // Nothing to wait for on a failed serial port
+    if (failed)
+        return 0;
+
+    const auto failedCount{statistics.failedCount};
+    transmit();
+
+    // Wake up for the earliest deadline
+    const auto now{std::chrono::steady_clock::now()};
+    const auto deadline{std::min(now + timeout, timers.getNextExpiry())};
+    const auto remaining{toTimespec(std::max(std::chrono::steady_clock::duration::zero(), deadline - now))};
+
+    const auto events{static_cast<short>(POLLIN | ((transmitIndex != INVALID_INDEX) ? POLLOUT : 0))};
+    struct pollfd descriptors[2]{{serialPort.getNativeHandle(), events, 0}, {stopEvent, POLLIN, 0}};
+    if (failed || (systemCall(::ppoll, descriptors, 2, &remaining, nullptr) < 0))
+        return static_cast<size_t>(statistics.failedCount - failedCount);
+
+    // Responses take precedence over deadlines expiring at the same time
+    size_t count{0};
+    if ((descriptors[0].revents & POLLIN) != 0)
+        count += receive();
+
+    // Data received before a hang-up is still matched
+    if (!failed && ((descriptors[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0))
+        fail();
+
+    if ((descriptors[1].revents & POLLIN) != 0)
+    {
+        uint64_t value{0};
+        systemCall(::read, stopEvent, &value, sizeof(value));
+        stopped = true;
+    }
+
+    if (!failed)
+    {
+        timers.advance(std::chrono::steady_clock::now(), [this, &count](TimerId, uint64_t index)
+        {
+            count += expire(static_cast<size_t>(index));
+        });
+        transmit();
+    }
+    return count + static_cast<size_t>(statistics.failedCount - failedCount);
+}
+
+void TransactionManager::run()
+{
+    stopped = false;
+    while (!stopped && !failed)
+        poll(std::chrono::milliseconds{1000});
+}
+
+void TransactionManager::stop()
+{
+    const uint64_t value{1};
+    systemCall(::write, stopEvent, &value, sizeof(value));
+}
+
+void TransactionManager::cancelAll()
+{
+    finishAll(TransactionStatus::TRANSACTION_CANCELLED);
+}
+
+bool TransactionManager::isFailed() const
+{
+    return failed;
+}
+
+size_t TransactionManager::getInFlightCount() const
+{
+    return inFlight.size();
+}
+
+size_t TransactionManager::getQueuedCount() const
+{
+    return queue.size();
+}
+
+size_t TransactionManager::getWindow() const
+{
+    return window;
+}
+
+void TransactionManager::setWindow(size_t window)
+{
+    if (window == 0)
+        throw std::out_of_range("Invalid transaction window");
+
+    this->window = window;
+}
+
+TransactionStatistics TransactionManager::getStatistics() const
+{
+    return statistics;
+}
+
+double TransactionManager::getTransmitUtilisation() const
+{
+    const auto elapsed{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statisticsTime).count()};
+    return ((elapsed > 0.0) ? ((static_cast<double>(statistics.transmittedCount) * byteTime) / elapsed) : 0.0);
+}
+
+double TransactionManager::getReceiveUtilisation() const
+{
+    const auto elapsed{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statisticsTime).count()};
+    return ((elapsed > 0.0) ? ((static_cast<double>(statistics.receivedCount) * byteTime) / elapsed) : 0.0);
+}
+
+void TransactionManager::resetStatistics()
+{
+    byteTime = calculateTime(serialPort.getBaudRate(), serialPort.getCharacterSize(), serialPort.getParity(),
+        serialPort.getStopBit());
+    statisticsTime = std::chrono::steady_clock::now();
+    statistics = TransactionStatistics{};
+}
+
+void TransactionManager::transmit()
+{
+    while (true)
+    {
+        if (transmitIndex == INVALID_INDEX)
+        {
+            if (queue.empty() || (inFlight.size() >= window))
+                return;
+
+            // Keys must be unique among the transactions in flight
+            const auto index{queue.front()};
+            if (inFlight.count(transactions[index].key) != 0)
+                return;
+
+            queue.pop_front();
+            inFlight.emplace(transactions[index].key, index);
+            statistics.maxInFlightCount = std::max(statistics.maxInFlightCount, inFlight.size());
+            transmitIndex = index;
+            transmitOffset = 0;
+
+            // Writing the request may not stall beyond the wire time of the queued data and the timeout
+            auto& transaction{transactions[index]};
+            const auto pending{serialPort.getOutputQueueCount() + transaction.request.size()};
+            transaction.transmitTime = std::chrono::steady_clock::now();
+            transaction.timer = timers.arm(transaction.transmitTime + transaction.timeout +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::milli>(static_cast<double>(pending) * byteTime)), index);
+        }
+
+        auto& transaction{transactions[transmitIndex]};
+        if (transmitOffset < transaction.request.size())
+        {
+            std::error_code error{};
+            const auto count{serialPort.write(transaction.request.data() + transmitOffset,
+                transaction.request.size() - transmitOffset, error)};
+            if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+            {
+                fail();
+                return;
+            }
+            if (count == 0)
+                return;
+
+            transmitOffset += count;
+            statistics.transmittedCount += count;
+            continue;
+        }
+
+        // Deadline starts once the request left the transmit queue
+        const auto pending{serialPort.getOutputQueueCount()};
+        transaction.transmitTime = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(static_cast<double>(pending) * byteTime));
+        timers.cancel(transaction.timer);
+        transaction.timer = timers.arm(transaction.transmitTime + transaction.timeout, transmitIndex);
+        transmitIndex = INVALID_INDEX;
+    }
+}
+
+size_t TransactionManager::receive()
+{
+    std::error_code error{};
+    const auto count{serialPort.read(buffer.data() + bufferEnd, buffer.size() - bufferEnd, error)};
+    if (error && (error != SerialError::SERIAL_ERROR_WOULD_BLOCK))
+    {
+        fail();
+        return 0;
+    }
+    if (count == 0)
+        return 0;
+
+    bufferEnd += count;
+    statistics.receivedCount += count;
+
+    // Extract and match all complete responses
+    size_t completed{0};
+    size_t begin{0};
+    while (begin < bufferEnd)
+    {
+        uint64_t key{0};
+        const std::string_view data(buffer.data() + begin, bufferEnd - begin);
+        const auto size{responseCorrelator(data, key)};
+        if ((size == 0) || (size > data.size()))
+            break;
+
+        // Responses to requests still being transmitted are not expected
+        const auto transaction{inFlight.find(key)};
+        if ((transaction == inFlight.end()) || (transaction->second == transmitIndex))
+        {
+            ++statistics.unmatchedCount;
+        }
+        else
+        {
+            finish(transaction->second, TransactionStatus::TRANSACTION_COMPLETED, data.substr(0, size));
+            ++completed;
+        }
+        begin += size;
+    }
+
+    // Keep the incomplete response at the start of the buffer
+    if (begin > 0)
+    {
+        std::memmove(buffer.data(), buffer.data() + begin, bufferEnd - begin);
+        bufferEnd -= begin;
+    }
+    if (bufferEnd == buffer.size())
+    {
+        statistics.discardedCount += bufferEnd;
+        bufferEnd = 0;
+    }
+    return completed;
+}
+
+size_t TransactionManager::expire(size_t index)
+{
+    auto& transaction{transactions[index]};
+    transaction.timer = INVALID_TIMER_ID;
+
+    // Partially written request can not be retransmitted
+    if ((transaction.retryCount == 0) || (index == transmitIndex))
+    {
+        finish(index, TransactionStatus::TRANSACTION_TIMEOUT, std::string_view());
+        return 1;
+    }
+
+    // Retransmit ahead of the queued requests
+    --transaction.retryCount;
+    ++statistics.retryCount;
+    inFlight.erase(transaction.key);
+    queue.push_front(index);
+    return 0;
+}
+
+void TransactionManager::finish(size_t index, TransactionStatus status, std::string_view response)
+{
+    auto& transaction{transactions[index]};
+    if (transaction.timer != INVALID_TIMER_ID)
+        timers.cancel(transaction.timer);
+
+    const auto entry{inFlight.find(transaction.key)};
+    if ((entry != inFlight.end()) && (entry->second == index))
+        inFlight.erase(entry);
+    if (transmitIndex == index)
+        transmitIndex = INVALID_INDEX;
+
+    switch (status)
+    {
+        case TransactionStatus::TRANSACTION_COMPLETED:
+        {
+            const auto roundTripTime{std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - transaction.transmitTime)};
+            ++statistics.completedCount;
+            statistics.maxRoundTripTime = std::max(statistics.maxRoundTripTime, roundTripTime);
+            statistics.totalRoundTripTime += roundTripTime;
+            break;
+        }
+
+        case TransactionStatus::TRANSACTION_TIMEOUT:
+            ++statistics.timeoutCount;
+            break;
+
+        case TransactionStatus::TRANSACTION_IO_ERROR:
+            ++statistics.failedCount;
+            break;
+
+        case TransactionStatus::TRANSACTION_CANCELLED:
+        default:
+            ++statistics.cancelledCount;
+            break;
+    }
+
+    // Completion may submit new transactions which reuse the slab entry
+    auto completion{std::move(transaction.completion)};
+    transaction.completion = nullptr;
+    transaction.request.clear();
+    transaction.timer = INVALID_TIMER_ID;
+    freeTransactions.push_back(index);
+    if (completion)
+        completion(status, response);
+}
+
+void TransactionManager::finishAll(TransactionStatus status)
+{
+    while (!queue.empty())
+    {
+        const auto index{queue.front()};
+        queue.pop_front();
+        finish(index, status, std::string_view());
+    }
+    while (!inFlight.empty())
+        finish(inFlight.begin()->second, status, std::string_view());
+}
+
+void TransactionManager::fail()
+{
+    failed = true;
+    finishAll(TransactionStatus::TRANSACTION_IO_ERROR);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,229 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/modbus.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Fixed inter-character timeout above 19200 baud
+     *
+     */
+    constexpr std::chrono::microseconds FIXED_INTER_CHARACTER_TIMEOUT{750};
+
+    /**
+     * @brief Fixed inter-frame delay above 19200 baud
+     *
+     */
+    constexpr std::chrono::microseconds FIXED_INTER_FRAME_DELAY{1750};
+
+    /**
+     * @brief Size of a frame with a byte count at the given offset
+     *
+     * @param frame Received part of the frame
+     * @param size Size of the received part
+     * @param offset Offset of the byte count
+     * @return size_t Size of the complete frame or 0 if the byte count was not received yet
+     */
+    inline size_t getCountedFrameSize(const char* frame, size_t size, size_t offset)
+    {
+        if (size <= offset)
+            return 0;
+
+        return (offset + 1 + static_cast<uint8_t>(frame[offset]) + 2);
+    }
+
+    /**
+     * @brief Size of a request frame
+     *
+     * @param frame Received part of the frame
+     * @param size Size of the received part
+     * @return size_t Size of the complete frame, 0 or size_t(-1)
+     */
+    size_t getRequestSize(const char* frame, size_t size)
+    {
+        switch (static_cast<ModbusFunction>(frame[1]))
+        {
+            case ModbusFunction::MODBUS_READ_COILS:
+            case ModbusFunction::MODBUS_READ_DISCRETE_INPUTS:
+            case ModbusFunction::MODBUS_READ_HOLDING_REGISTERS:
+            case ModbusFunction::MODBUS_READ_INPUT_REGISTERS:
+            case ModbusFunction::MODBUS_WRITE_SINGLE_COIL:
+            case ModbusFunction::MODBUS_WRITE_SINGLE_REGISTER:
+            case ModbusFunction::MODBUS_DIAGNOSTICS:
+                return 8;
+
+            case ModbusFunction::MODBUS_READ_EXCEPTION_STATUS:
+            case ModbusFunction::MODBUS_GET_COMM_EVENT_COUNTER:
+            case ModbusFunction::MODBUS_GET_COMM_EVENT_LOG:
+            case ModbusFunction::MODBUS_REPORT_SERVER_ID:
+                return 4;
+
+            case ModbusFunction::MODBUS_WRITE_MULTIPLE_COILS:
+            case ModbusFunction::MODBUS_WRITE_MULTIPLE_REGISTERS:
+                return getCountedFrameSize(frame, size, 6);
+
+            case ModbusFunction::MODBUS_READ_FILE_RECORD:
+            case ModbusFunction::MODBUS_WRITE_FILE_RECORD:
+                return getCountedFrameSize(frame, size, 2);
+
+            case ModbusFunction::MODBUS_MASK_WRITE_REGISTER:
+                return 10;
+
+            case ModbusFunction::MODBUS_READ_WRITE_MULTIPLE_REGISTERS:
+                return getCountedFrameSize(frame, size, 10);
+
+            case ModbusFunction::MODBUS_READ_FIFO_QUEUE:
+                return 6;
+
+            default:
+                return static_cast<size_t>(-1);
+        }
+    }
+
+    /**
+     * @brief Size of a response frame
+     *
+     * @param frame Received part of the frame
+     * @param size Size of the received part
+     * @return size_t Size of the complete frame, 0 or size_t(-1)
+     */
+    size_t getResponseSize(const char* frame, size_t size)
+    {
+        if ((static_cast<uint8_t>(frame[1]) & MODBUS_EXCEPTION_FLAG) != 0)
+            return 5;
+
+        switch (static_cast<ModbusFunction>(frame[1]))
+        {
+            case ModbusFunction::MODBUS_READ_COILS:
+            case ModbusFunction::MODBUS_READ_DISCRETE_INPUTS:
+            case ModbusFunction::MODBUS_READ_HOLDING_REGISTERS:
+            case ModbusFunction::MODBUS_READ_INPUT_REGISTERS:
+            case ModbusFunction::MODBUS_GET_COMM_EVENT_LOG:
+            case ModbusFunction::MODBUS_REPORT_SERVER_ID:
+            case ModbusFunction::MODBUS_READ_FILE_RECORD:
+            case ModbusFunction::MODBUS_WRITE_FILE_RECORD:
+            case ModbusFunction::MODBUS_READ_WRITE_MULTIPLE_REGISTERS:
+                return getCountedFrameSize(frame, size, 2);
+
+            case ModbusFunction::MODBUS_WRITE_SINGLE_COIL:
+            case ModbusFunction::MODBUS_WRITE_SINGLE_REGISTER:
+            case ModbusFunction::MODBUS_DIAGNOSTICS:
+            case ModbusFunction::MODBUS_GET_COMM_EVENT_COUNTER:
+            case ModbusFunction::MODBUS_WRITE_MULTIPLE_COILS:
+            case ModbusFunction::MODBUS_WRITE_MULTIPLE_REGISTERS:
+                return 8;
+
+            case ModbusFunction::MODBUS_READ_EXCEPTION_STATUS:
+                return 5;
+
+            case ModbusFunction::MODBUS_MASK_WRITE_REGISTER:
+                return 10;
+
+            case ModbusFunction::MODBUS_READ_FIFO_QUEUE:
+                // FIFO byte count is a 16-bit value
+                return ((size < 4) ? 0 : (4 + static_cast<size_t>(readModbusValue(frame + 2)) + 2));
+
+            default:
+                return static_cast<size_t>(-1);
+        }
+    }
+} // namespace
+
+ModbusTiming calculateModbusTiming(BaudRate baudRate, CharacterSize characterSize, Parity parity, StopBit stopBit)
+{
+    const auto characterTime{calculateTime(baudRate, characterSize, parity, stopBit)};
+
+    ModbusTiming timing{};
+    timing.characterTime = std::chrono::microseconds{static_cast<long>(std::ceil(characterTime * 1000.0))};
+
+    // Fixed timing relieves the receiver from handling short timeouts at high baud rates
+    if (characterTime < calculateTime(BaudRate::BAUD_RATE_19200, characterSize, parity, stopBit))
+    {
+        timing.interCharacterTimeout = FIXED_INTER_CHARACTER_TIMEOUT;
+        timing.interFrameDelay = FIXED_INTER_FRAME_DELAY;
+    }
+    else
+    {
+        timing.interCharacterTimeout = std::chrono::microseconds{static_cast<long>(std::ceil(characterTime * 1500.0))};
+        timing.interFrameDelay = std::chrono::microseconds{static_cast<long>(std::ceil(characterTime * 3500.0))};
+    }
+    return timing;
+}
+
+size_t getModbusFrameSize(const char* frame, size_t size, bool request)
+{
+    // Function code is needed to determine the size
+    if (size < 2)
+        return 0;
+
+    return (request ? getRequestSize(frame, size) : getResponseSize(frame, size));
+}
+
+size_t appendModbusCrc(char* frame, size_t size)
+{
+    // CRC is transmitted low byte first
+    const auto crc{Crc16Modbus::calculate(frame, size)};
+    frame[size] = static_cast<char>(crc & 0xFFU);
+    frame[size + 1] = static_cast<char>(crc >> 8);
+    return (size + 2);
+}
+
+bool checkModbusCrc(const char* frame, size_t size)
+{
+    if (size < MODBUS_MIN_FRAME_SIZE)
+        return false;
+
+    const auto crc{Crc16Modbus::calculate(frame, size - 2)};
+    return ((static_cast<uint8_t>(frame[size - 2]) == (crc & 0xFFU)) &&
+        (static_cast<uint8_t>(frame[size - 1]) == (crc >> 8)));
+}
+
+void packModbusBits(const bool* values, size_t count, char* data)
+{
+    for (size_t byte{0}; byte < ((count + 7) / 8); ++byte)
+    {
+        uint8_t packed{0U};
+        for (size_t bit{0}; (bit < 8) && (((byte * 8) + bit) < count); ++bit)
+        {
+            if (values[(byte * 8) + bit])
+                packed = static_cast<uint8_t>(packed | (1U << bit));
+        }
+        data[byte] = static_cast<char>(packed);
+    }
+}
+
+void unpackModbusBits(const char* data, size_t count, bool* values)
+{
+    for (size_t index{0}; index < count; ++index)
+        values[index] = ((static_cast<uint8_t>(data[index / 8]) & (1U << (index % 8))) != 0);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -19,6 +19,9 @@
     SPDX-License-Identifier: GPL-3.0-or-later
 */
 
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <stdexcept>
 #include <serialport/namespace.hpp>
 #include <serialport/properties.hpp>
@@ -32,6 +35,232 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+namespace
+{
+
+/**
+ * @brief Baud rate numbers indexed by the baud rate
+ *
+ */
+constexpr unsigned long BAUD_RATE_VALUES[]{0U, 50U, 75U, 110U, 134U, 150U, 200U, 300U, 600U, 1200U,
+    1800U, 2400U, 4800U, 9600U, 14400U, 19200U, 38400U, 56000U, 57600U, 115200U, 128000U, 230400U,
+    256000U, 460800U, 500000U, 576000U, 921600U, 1000000U, 1152000U, 1500000U, 2000000U, 2500000U,
+    3000000U, 3500000U, 4000000U};
+
+/**
+ * @brief Flow control names indexed by the flow control
+ *
+ */
+constexpr std::string_view FLOW_CONTROL_NAMES[]{"Hardware", "Software", "None"};
+
+/**
+ * @brief Flow control link specification tokens indexed by the flow control
+ *
+ */
+constexpr std::string_view FLOW_CONTROL_TOKENS[]{"rtscts", "xonxoff", "none"};
+
+/**
+ * @brief Parity names indexed by the parity, first letters are the link
+ *   specification tokens
+ *
+ */
+constexpr std::string_view PARITY_NAMES[]{"None", "Odd", "Even", "Mark", "Space"};
+
+/**
+ * @brief Stop bit names indexed by the stop bit
+ *
+ */
+constexpr std::string_view STOP_BIT_NAMES[]{"One", "One and a half", "Two"};
+
+/**
+ * @brief Stop bit link specification tokens indexed by the stop bit
+ *
+ */
+constexpr std::string_view STOP_BIT_TOKENS[]{"1", "1.5", "2"};
+
+static_assert(std::size(BAUD_RATE_VALUES) == static_cast<size_t>(BaudRate::BAUD_RATE_MAX) + 1, "Baud rate table size mismatch");
+static_assert(std::size(FLOW_CONTROL_NAMES) == static_cast<size_t>(FlowControl::FLOW_CONTROL_MAX) + 1, "Flow control table size mismatch");
+static_assert(std::size(FLOW_CONTROL_TOKENS) == std::size(FLOW_CONTROL_NAMES), "Flow control table size mismatch");
+static_assert(std::size(PARITY_NAMES) == static_cast<size_t>(Parity::PARITY_TYPE_MAX) + 1, "Parity table size mismatch");
+static_assert(std::size(STOP_BIT_NAMES) == static_cast<size_t>(StopBit::STOP_BIT_MAX) + 1, "Stop bit table size mismatch");
+static_assert(std::size(STOP_BIT_TOKENS) == std::size(STOP_BIT_NAMES), "Stop bit table size mismatch");
+
+/**
+ * @brief Number of bits of a perfect hash slot index
+ *
+ */
+constexpr unsigned PERFECT_HASH_BITS{7};
+
+/**
+ * @brief Perfect hash table mapping keys to their table index
+ *
+ */
+struct PerfectHash
+{
+    /**
+     * @brief Hash seed without collisions between the keys
+     *
+     */
+    uint32_t seed;
+
+    /**
+     * @brief Key index incremented by one or zero for an empty slot
+     *
+     */
+    unsigned char slots[1U << PERFECT_HASH_BITS];
+};
+
+/**
+ * @brief Convert an ASCII letter to lower case
+ *
+ * @param character Character
+ * @return char Lower case character
+ */
+constexpr char toLower(char character)
+{
+    return (((character >= 'A') && (character <= 'Z')) ? static_cast<char>(character - 'A' + 'a') : character);
+}
+
+/**
+ * @brief Multiplicative hash of a number
+ *
+ * @param value Number
+ * @param seed Hash seed
+ * @return uint32_t Slot index
+ */
+constexpr uint32_t hashValue(unsigned long value, uint32_t seed)
+{
+    return (static_cast<uint32_t>(static_cast<uint32_t>(value) * seed) >> (32U - PERFECT_HASH_BITS));
+}
+
+/**
+ * @brief Case-insensitive FNV-1a hash of a token
+ *
+ * @param token Token
+ * @param seed Hash seed
+ * @return uint32_t Slot index
+ */
+constexpr uint32_t hashToken(std::string_view token, uint32_t seed)
+{
+    uint32_t hash{seed};
+    for (const auto character: token)
+        hash = (hash ^ static_cast<unsigned char>(toLower(character))) * 16777619U;
+    return (hash >> (32U - PERFECT_HASH_BITS));
+}
+
+/**
+ * @brief Search for a hash seed without collisions and build the perfect hash table
+ *
+ * @tparam Key Key type
+ * @tparam Count Number of keys
+ * @tparam Hash Hash function type
+ * @param keys Keys indexed by their value
+ * @param first Index of the first key to include
+ * @param hash Hash function
+ * @return PerfectHash Perfect hash table or a table with zero seed if no seed was found
+ */
+template<typename Key, size_t Count, typename Hash>
+constexpr PerfectHash makePerfectHash(const Key (&keys)[Count], size_t first, Hash hash)
+{
+    for (uint32_t seed{0x9E3779B1U}, attempt{0}; attempt < 65536U; seed += 2U, ++attempt)
+    {
+        PerfectHash table{seed, {}};
+        bool collision{false};
+        for (size_t index{first}; (index < Count) && !collision; ++index)
+        {
+            auto& slot{table.slots[hash(keys[index], seed)]};
+            collision = (slot != 0);
+            slot = static_cast<unsigned char>(index + 1);
+        }
+
+        if (!collision)
+            return table;
+    }
+    return PerfectHash{0, {}};
+}
+
+/**
+ * @brief Perfect hash of the baud rate numbers, custom baud rate excluded
+ *
+ */
+constexpr PerfectHash BAUD_RATE_HASH{makePerfectHash(BAUD_RATE_VALUES, 1, hashValue)};
+
+/**
+ * @brief Perfect hash of the flow control tokens
+ *
+ */
+constexpr PerfectHash FLOW_CONTROL_HASH{makePerfectHash(FLOW_CONTROL_TOKENS, 0, hashToken)};
+
+/**
+ * @brief Perfect hash of the parity letters
+ *
+ */
+constexpr PerfectHash PARITY_HASH{makePerfectHash(PARITY_NAMES, 0,
+    [](std::string_view name, uint32_t seed) { return hashToken(name.substr(0, 1), seed); })};
+
+/**
+ * @brief Perfect hash of the stop bit tokens
+ *
+ */
+constexpr PerfectHash STOP_BIT_HASH{makePerfectHash(STOP_BIT_TOKENS, 0, hashToken)};
+
+static_assert(BAUD_RATE_HASH.seed != 0, "No perfect hash of the baud rates");
+static_assert(FLOW_CONTROL_HASH.seed != 0, "No perfect hash of the flow controls");
+static_assert(PARITY_HASH.seed != 0, "No perfect hash of the parities");
+static_assert(STOP_BIT_HASH.seed != 0, "No perfect hash of the stop bits");
+
+/**
+ * @brief Compare tokens case-insensitively
+ *
+ * @param token Token
+ * @param key Lower case key
+ * @return true Tokens are equal
+ * @return false Tokens differ
+ */
+bool isSameToken(std::string_view token, std::string_view key)
+{
+    if (token.size() != key.size())
+        return false;
+
+    for (size_t index{0}; index < token.size(); ++index)
+    {
+        if (toLower(token[index]) != toLower(key[index]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Find the table index of a token
+ *
+ * @tparam Count Number of tokens
+ * @param table Perfect hash table
+ * @param tokens Tokens
+ * @param token Token to find
+ * @param length Length of the table tokens to compare
+ * @return size_t Table index or Count if the token is not found
+ */
+template<size_t Count>
+size_t findToken(const PerfectHash& table, const std::string_view (&tokens)[Count], std::string_view token, size_t length)
+{
+    const auto slot{table.slots[hashToken(token, table.seed)]};
+    return (((slot != 0) && isSameToken(token, tokens[slot - 1].substr(0, length))) ? (slot - 1U) : Count);
+}
+
+/**
+ * @brief Check for a link specification field separator
+ *
+ * @param character Character
+ * @return true Character is a separator
+ * @return false Character is not a separator
+ */
+bool isSeparator(char character)
+{
+    return ((character == ',') || (character == '-'));
+}
+
+} // namespace
+
 bool isBaudRateSupported(BaudRate baudRate)
 {
     switch (baudRate)
@@ -287,148 +516,17 @@ int getBaudRateValue(BaudRate baudRate)
 
 unsigned long getBaudRate(BaudRate baudRate)
 {
-    switch (baudRate)
-    {
-        case BaudRate::BAUD_RATE_50:
-            return 50U;
-            break;
-
-        case BaudRate::BAUD_RATE_75:
-            return 75U;
-            break;
-
-        case BaudRate::BAUD_RATE_110:
-            return 110U;
-            break;
-
-        case BaudRate::BAUD_RATE_134:
-            return 134U;
-            break;
-
-        case BaudRate::BAUD_RATE_150:
-            return 150U;
-            break;
-
-        case BaudRate::BAUD_RATE_200:
-            return 200U;
-            break;
-
-        case BaudRate::BAUD_RATE_300:
-            return 300U;
-            break;
-
-        case BaudRate::BAUD_RATE_600:
-            return 600U;
-            break;
-
-        case BaudRate::BAUD_RATE_1200:
-            return 1200U;
-            break;
-
-        case BaudRate::BAUD_RATE_1800:
-            return 1800U;
-            break;
-
-        case BaudRate::BAUD_RATE_2400:
-            return 2400U;
-            break;
-
-        case BaudRate::BAUD_RATE_4800:
-            return 4800U;
-            break;
-
-        case BaudRate::BAUD_RATE_9600:
-            return 9600U;
-            break;
-
-        case BaudRate::BAUD_RATE_14400:
-            return 14400U;
-            break;
-
-        case BaudRate::BAUD_RATE_19200:
-            return 19200U;
-            break;
-
-        case BaudRate::BAUD_RATE_38400:
-            return 38400U;
-            break;
-
-        case BaudRate::BAUD_RATE_56000:
-            return 56000U;
-            break;
-
-        case BaudRate::BAUD_RATE_57600:
-            return 57600U;
-            break;
-
-        case BaudRate::BAUD_RATE_115200:
-            return 115200U;
-            break;
-
-        case BaudRate::BAUD_RATE_128000:
-            return 128000U;
-            break;
-
-        case BaudRate::BAUD_RATE_230400:
-            return 230400U;
-            break;
-
-        case BaudRate::BAUD_RATE_256000:
-            return 256000U;
-            break;
-
-        case BaudRate::BAUD_RATE_460800:
-            return 460800U;
-            break;
-
-        case BaudRate::BAUD_RATE_500000:
-            return 500000U;
-            break;
-
-        case BaudRate::BAUD_RATE_576000:
-            return 576000U;
-            break;
+    const auto index{static_cast<size_t>(baudRate)};
+    if ((index >= std::size(BAUD_RATE_VALUES)) || (BAUD_RATE_VALUES[index] == 0))
+        throw std::out_of_range("Baud rate out of range");
 
-        case BaudRate::BAUD_RATE_921600:
-            return 921600U;
-            break;
-
-        case BaudRate::BAUD_RATE_1000000:
-            return 1000000U;
-            break;
-
-        case BaudRate::BAUD_RATE_1152000:
-            return 1152000U;
-            break;
-
-        case BaudRate::BAUD_RATE_1500000:
-            return 1500000U;
-            break;
-
-        case BaudRate::BAUD_RATE_2000000:
-            return 2000000U;
-            break;
-
-        case BaudRate::BAUD_RATE_2500000:
-            return 2500000U;
-            break;
-
-        case BaudRate::BAUD_RATE_3000000:
-            return 3000000U;
-            break;
-
-        case BaudRate::BAUD_RATE_3500000:
-            return 3500000U;
-            break;
-
-        case BaudRate::BAUD_RATE_4000000:
-            return 4000000U;
-            break;
+    return BAUD_RATE_VALUES[index];
+}
 
-        default:
-            throw std::out_of_range("Baud rate out of range");
-            break;
-    }
+BaudRate findBaudRate(unsigned long baudRate) noexcept
+{
+    const auto slot{BAUD_RATE_HASH.slots[hashValue(baudRate, BAUD_RATE_HASH.seed)]};
+    return (((slot != 0) && (BAUD_RATE_VALUES[slot - 1] == baudRate)) ? static_cast<BaudRate>(slot - 1) : BaudRate::BAUD_RATE_CUSTOM);
 }
 
 bool isCharacterSizeSupported(CharacterSize characterSize)
@@ -538,24 +636,16 @@ bool isFlowControlSupported(FlowControl flowControl)
 
 std::string getFlowControlName(FlowControl flowControl)
 {
-    switch (flowControl)
-    {
-        case FlowControl::FLOW_CONTROL_HARDWARE:
-            return "Hardware";
-            break;
-
-        case FlowControl::FLOW_CONTROL_SOFTWARE:
-            return "Software";
-            break;
+    return std::string{getFlowControlNameView(flowControl)};
+}
 
-        case FlowControl::FLOW_CONTROL_NONE:
-            return "None";
-            break;
+std::string_view getFlowControlNameView(FlowControl flowControl)
+{
+    const auto index{static_cast<size_t>(flowControl)};
+    if (index >= std::size(FLOW_CONTROL_NAMES))
+        throw std::out_of_range("Flow control out of range");
 
-        default:
-            throw std::out_of_range("Flow control out of range");
-            break;
-    }
+    return FLOW_CONTROL_NAMES[index];
 }
 
 bool isParitySupported(Parity parity)
@@ -578,32 +668,16 @@ bool isParitySupported(Parity parity)
 
 std::string getParityName(Parity parity)
 {
-    switch (parity)
-    {
-        case Parity::PARITY_TYPE_ODD:
-            return "Odd";
-            break;
-
-        case Parity::PARITY_TYPE_EVEN:
-            return "Even";
-            break;
-
-        case Parity::PARITY_TYPE_MARK:
-            return "Mark";
-            break;
-
-        case Parity::PARITY_TYPE_SPACE:
-            return "Space";
-            break;
+    return std::string{getParityNameView(parity)};
+}
 
-        case Parity::PARITY_TYPE_NONE:
-            return "None";
-            break;
+std::string_view getParityNameView(Parity parity)
+{
+    const auto index{static_cast<size_t>(parity)};
+    if (index >= std::size(PARITY_NAMES))
+        throw std::out_of_range("Parity out of range");
 
-        default:
-            throw std::out_of_range("Parity out of range");
-            break;
-    }
+    return PARITY_NAMES[index];
 }
 
 bool isStopBitSupported(StopBit stopBit)
@@ -629,24 +703,16 @@ bool isStopBitSupported(StopBit stopBit)
 
 std::string getStopBitName(StopBit stopBit)
 {
-    switch (stopBit)
-    {
-        case StopBit::STOP_BIT_ONE_HALF:
-            return "One and a half";
-            break;
-
-        case StopBit::STOP_BIT_TWO:
-            return "Two";
-            break;
+    return std::string{getStopBitNameView(stopBit)};
+}
 
-        case StopBit::STOP_BIT_ONE:
-            return "One";
-            break;
+std::string_view getStopBitNameView(StopBit stopBit)
+{
+    const auto index{static_cast<size_t>(stopBit)};
+    if (index >= std::size(STOP_BIT_NAMES))
+        throw std::out_of_range("Stop bit out of range");
 
-        default:
-            throw std::out_of_range("Stop bit out of range");
-            break;
-    }
+    return STOP_BIT_NAMES[index];
 }
 
 double calculateTime(BaudRate baudRate, CharacterSize characterSize, Parity parity, StopBit stopBit)
@@ -708,6 +774,102 @@ double calculateTime(BaudRate baudRate, CharacterSize characterSize, Parity pari
     return ((static_cast<double>(bits) * 1000) / LibSerial::getBaudRate(baudRate));
 }
 
+bool parseLinkSpec(std::string_view spec, LinkSpec& linkSpec) noexcept
+{
+    LinkSpec result{};
+
+    // Baud rate number, at most ten digits
+    size_t position{0};
+    unsigned long baudRate{0};
+    while ((position < spec.size()) && (position < 10) && (spec[position] >= '0') && (spec[position] <= '9'))
+        baudRate = (baudRate * 10U) + static_cast<unsigned long>(spec[position++] - '0');
+
+    if ((position == 0) || ((position < spec.size()) && !isSeparator(spec[position])))
+        return false;
+
+    result.baudRate = findBaudRate(baudRate);
+    if (result.baudRate == BaudRate::BAUD_RATE_CUSTOM)
+        return false;
+
+    // Frame as character size, parity letter and stop bits
+    if (position < spec.size())
+    {
+        const auto frame{spec.substr(position + 1, spec.find_first_of(",-", position + 1) - position - 1)};
+        position += frame.size() + 1;
+        if ((frame.size() < 3) || (frame[0] < '5') || (frame[0] > '8'))
+            return false;
+
+        const auto parity{findToken(PARITY_HASH, PARITY_NAMES, frame.substr(1, 1), 1)};
+        const auto stopBit{findToken(STOP_BIT_HASH, STOP_BIT_TOKENS, frame.substr(2), std::string_view::npos)};
+        if ((parity == std::size(PARITY_NAMES)) || (stopBit == std::size(STOP_BIT_TOKENS)))
+            return false;
+
+        result.characterSize = static_cast<CharacterSize>(frame[0] - '5');
+        result.parity = static_cast<Parity>(parity);
+        result.stopBit = static_cast<StopBit>(stopBit);
+    }
+
+    // Flow control
+    if (position < spec.size())
+    {
+        const auto flowControl{findToken(FLOW_CONTROL_HASH, FLOW_CONTROL_TOKENS, spec.substr(position + 1), std::string_view::npos)};
+        if (flowControl == std::size(FLOW_CONTROL_TOKENS))
+            return false;
+
+        result.flowControl = static_cast<FlowControl>(flowControl);
+    }
+
+    linkSpec = result;
+    return true;
+}
+
+size_t formatLinkSpec(const LinkSpec& linkSpec, char* buffer, size_t size) noexcept
+{
+    const auto baudRate{static_cast<size_t>(linkSpec.baudRate)};
+    const auto characterSize{static_cast<size_t>(linkSpec.characterSize)};
+    const auto parity{static_cast<size_t>(linkSpec.parity)};
+    const auto stopBit{static_cast<size_t>(linkSpec.stopBit)};
+    const auto flowControl{static_cast<size_t>(linkSpec.flowControl)};
+    if ((baudRate == 0) || (baudRate >= std::size(BAUD_RATE_VALUES)) ||
+        (characterSize > static_cast<size_t>(CharacterSize::CHARACTER_SIZE_MAX)) ||
+        (parity >= std::size(PARITY_NAMES)) || (stopBit >= std::size(STOP_BIT_TOKENS)) ||
+        (flowControl >= std::size(FLOW_CONTROL_TOKENS)))
+        return 0;
+
+    char text[MAX_LINK_SPEC_SIZE];
+    size_t length{0};
+
+    // Baud rate number
+    char digits[10];
+    size_t count{0};
+    for (auto value{BAUD_RATE_VALUES[baudRate]}; value != 0; value /= 10U)
+        digits[count++] = static_cast<char>('0' + (value % 10U));
+    while (count > 0)
+        text[length++] = digits[--count];
+
+    // Frame
+    text[length++] = ',';
+    text[length++] = static_cast<char>('5' + characterSize);
+    text[length++] = PARITY_NAMES[parity][0];
+    std::memcpy(text + length, STOP_BIT_TOKENS[stopBit].data(), STOP_BIT_TOKENS[stopBit].size());
+    length += STOP_BIT_TOKENS[stopBit].size();
+
+    // Flow control
+    if (linkSpec.flowControl != FlowControl::FLOW_CONTROL_NONE)
+    {
+        text[length++] = ',';
+        std::memcpy(text + length, FLOW_CONTROL_TOKENS[flowControl].data(), FLOW_CONTROL_TOKENS[flowControl].size());
+        length += FLOW_CONTROL_TOKENS[flowControl].size();
+    }
+
+    if ((buffer == nullptr) || (length >= size))
+        return 0;
+
+    std::memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    return length;
+}
+
 ControlLine operator~(const ControlLine& l)
 {
     return (static_cast<ControlLine>((~static_cast<unsigned char>(l)) & static_cast<unsigned char>(ControlLine::LINE_ALL)));
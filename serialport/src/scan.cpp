@@ -0,0 +1,214 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+    #define LIBSERIAL_SCAN_X86
+    #include <immintrin.h>
+#endif // (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Scan function finding the first occurrence of either of two bytes
+     *
+     */
+    typedef size_t (*ScanFunction)(const char* data, size_t size, char first, char second);
+
+    /**
+     * @brief Scan the data byte at a time
+     *
+     * @param data Data to scan
+     * @param size Size of the data
+     * @param first First byte to find
+     * @param second Second byte to find
+     * @return size_t Offset of the first matching byte or size if not found
+     */
+    size_t scanScalar(const char* data, size_t size, char first, char second)
+    {
+        for (size_t index{0}; index < size; ++index)
+        {
+            if ((data[index] == first) || (data[index] == second))
+                return index;
+        }
+        return size;
+    }
+
+#ifdef LIBSERIAL_SCAN_X86
+    /**
+     * @brief Scan the data 16 bytes at a time
+     *
+     * @param data Data to scan
+     * @param size Size of the data
+     * @param first First byte to find
+     * @param second Second byte to find
+     * @return size_t Offset of the first matching byte or size if not found
+     */
+    size_t scanSse2(const char* data, size_t size, char first, char second)
+    {
+        const auto firstMask{_mm_set1_epi8(first)};
+        const auto secondMask{_mm_set1_epi8(second)};
+
+        size_t index{0};
+        for (; (index + 16) <= size; index += 16)
+        {
+            const auto block{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index))};
+            const auto matches{_mm_or_si128(_mm_cmpeq_epi8(block, firstMask), _mm_cmpeq_epi8(block, secondMask))};
+            const auto mask{static_cast<unsigned int>(_mm_movemask_epi8(matches))};
+            if (mask != 0)
+                return (index + static_cast<size_t>(__builtin_ctz(mask)));
+        }
+        return (index + scanScalar(data + index, size - index, first, second));
+    }
+
+    /**
+     * @brief Scan the data 32 bytes at a time
+     *
+     * @param data Data to scan
+     * @param size Size of the data
+     * @param first First byte to find
+     * @param second Second byte to find
+     * @return size_t Offset of the first matching byte or size if not found
+     */
+    __attribute__((target("avx2")))
+    size_t scanAvx2(const char* data, size_t size, char first, char second)
+    {
+        const auto firstMask{_mm256_set1_epi8(first)};
+        const auto secondMask{_mm256_set1_epi8(second)};
+
+        size_t index{0};
+        for (; (index + 32) <= size; index += 32)
+        {
+            const auto block{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index))};
+            const auto matches{_mm256_or_si256(_mm256_cmpeq_epi8(block, firstMask), _mm256_cmpeq_epi8(block, secondMask))};
+            const auto mask{static_cast<unsigned int>(_mm256_movemask_epi8(matches))};
+            if (mask != 0)
+                return (index + static_cast<size_t>(__builtin_ctz(mask)));
+        }
+        return (index + scanSse2(data + index, size - index, first, second));
+    }
+#endif // LIBSERIAL_SCAN_X86
+
+    /**
+     * @brief Get the scan function of a scan implementation
+     *
+     * @param scanImplementation Byte scan implementation
+     * @return ScanFunction Scan function
+     */
+    ScanFunction getScanFunction(ScanImplementation scanImplementation)
+    {
+        switch (scanImplementation)
+        {
+#ifdef LIBSERIAL_SCAN_X86
+            case ScanImplementation::SCAN_AVX2:
+                return scanAvx2;
+
+            case ScanImplementation::SCAN_SSE2:
+                return scanSse2;
+#endif // LIBSERIAL_SCAN_X86
+
+            case ScanImplementation::SCAN_SCALAR:
+            default:
+                return scanScalar;
+        }
+    }
+
+    /**
+     * @brief Select the fastest scan implementation supported by the processor
+     *
+     * @return ScanImplementation Byte scan implementation
+     */
+    ScanImplementation selectScanImplementation()
+    {
+        if (isScanImplementationSupported(ScanImplementation::SCAN_AVX2))
+            return ScanImplementation::SCAN_AVX2;
+        if (isScanImplementationSupported(ScanImplementation::SCAN_SSE2))
+            return ScanImplementation::SCAN_SSE2;
+        return ScanImplementation::SCAN_SCALAR;
+    }
+
+    /**
+     * @brief Byte scan implementation in use
+     *
+     */
+    std::atomic<ScanImplementation> currentImplementation{selectScanImplementation()};
+
+    /**
+     * @brief Scan function in use
+     *
+     */
+    std::atomic<ScanFunction> currentFunction{getScanFunction(currentImplementation.load())};
+} // namespace
+
+size_t findByte(const char* data, size_t size, char value)
+{
+    return currentFunction.load(std::memory_order_relaxed)(data, size, value, value);
+}
+
+size_t findEitherByte(const char* data, size_t size, char first, char second)
+{
+    return currentFunction.load(std::memory_order_relaxed)(data, size, first, second);
+}
+
+ScanImplementation getScanImplementation()
+{
+    return currentImplementation.load();
+}
+
+bool setScanImplementation(ScanImplementation scanImplementation)
+{
+    if (!isScanImplementationSupported(scanImplementation))
+        return false;
+
+    currentImplementation.store(scanImplementation);
+    currentFunction.store(getScanFunction(scanImplementation));
+    return true;
+}
+
+bool isScanImplementationSupported(ScanImplementation scanImplementation)
+{
+    switch (scanImplementation)
+    {
+        case ScanImplementation::SCAN_SCALAR:
+            return true;
+
+#ifdef LIBSERIAL_SCAN_X86
+        case ScanImplementation::SCAN_SSE2:
+            return true;
+
+        case ScanImplementation::SCAN_AVX2:
+            // Processor features may be queried before static initialization completes
+            __builtin_cpu_init();
+            return (__builtin_cpu_supports("avx2") != 0);
+#endif // LIBSERIAL_SCAN_X86
+
+        default:
+            return false;
+    }
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -20,8 +20,11 @@
 */
 
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <iostream>
+#include <system_error>
 #include <serialport/namespace.hpp>
 #include <serialport/properties.hpp>
 #include <serialport/serialport.hpp>
@@ -34,6 +37,21 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+namespace
+{
+    /**
+     * @brief Lock held by reads, writes and queries, which may run concurrently
+     *
+     */
+    typedef std::shared_lock<std::shared_mutex> SharedLock;
+
+    /**
+     * @brief Lock held by configuration changes, which wait for in-flight I/O
+     *
+     */
+    typedef std::unique_lock<std::shared_mutex> ExclusiveLock;
+} // namespace
+
 SerialPort::SerialPort() :
     impl{std::make_unique<SerialPortImpl>()}
 {
@@ -51,154 +69,292 @@ SerialPort::SerialPort(const std::string& portName,
 
 }
 
+SerialPort::SerialPort(SerialPort&& serialPort) noexcept :
+    impl{std::move(serialPort.impl)}
+{
+
+}
+
+SerialPort& SerialPort::operator=(SerialPort&& serialPort) noexcept
+{
+    if (this != &serialPort)
+    {
+        // Settings of a hung up device can not be restored
+        std::error_code error{};
+        if (impl)
+            impl->close(error);
+        impl = std::move(serialPort.impl);
+    }
+    return *this;
+}
+
 SerialPort::~SerialPort() noexcept
 {
-    impl->close();
+    // Settings of a hung up device can not be restored
+    std::error_code error{};
+    if (impl)
+        impl->close(error);
     impl.reset();
 }
 
 bool SerialPort::isOpen() const
 {
+    if (!impl)
+        return false;
+
+    SharedLock lock{impl->getMutex()};
     return impl->isOpen();
 }
 
 void SerialPort::open(std::ios_base::openmode openMode)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->open(openMode);
 }
 
+void SerialPort::open(const NativePortSettings& nativePortSettings, std::ios_base::openmode openMode)
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->open(nativePortSettings, openMode);
+}
+
+void SerialPort::open(std::ios_base::openmode openMode, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->open(openMode, error);
+}
+
 void SerialPort::close()
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->close();
 }
 
+void SerialPort::close(std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->close(error);
+}
+
+void SerialPort::abandon() noexcept
+{
+    if (!impl)
+        return;
+
+    ExclusiveLock lock{impl->getMutex()};
+    impl->abandon();
+}
+
 bool SerialPort::setExclusive(bool exclusive)
 {
+    ExclusiveLock lock{impl->getMutex()};
     return impl->setExclusive(exclusive);
 }
 
 size_t SerialPort::read(char* buffer, size_t size) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->read(buffer, size);
 }
 
+size_t SerialPort::read(char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    SharedLock lock{impl->getMutex()};
+    return impl->read(buffer, size, error);
+}
+
 size_t SerialPort::read(std::string& buffer) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->read(buffer);
 }
 
 bool SerialPort::write(char data) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->write(data);
 }
 
 size_t SerialPort::write(const char* buffer, size_t size) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->write(buffer, size);
 }
 
+size_t SerialPort::write(const char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    SharedLock lock{impl->getMutex()};
+    return impl->write(buffer, size, error);
+}
+
+size_t SerialPort::writeAll(const char* buffer, size_t size, std::chrono::milliseconds timeout, std::error_code& error) const noexcept
+{
+    SharedLock lock{impl->getMutex()};
+    return impl->writeAll(buffer, size, timeout, error);
+}
+
 size_t SerialPort::write(const std::string& buffer) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->write(buffer);
 }
 
 bool SerialPort::drain() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->drain();
 }
 
 bool SerialPort::flushInput() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->flushInput();
 }
 
 bool SerialPort::flushOutput() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->flushOutput();
 }
 
 bool SerialPort::flushInputOutput() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->flushInputOutput();
 }
 
 size_t SerialPort::getInputQueueCount() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getInputQueueCount();
 }
 
 size_t SerialPort::getOutputQueueCount() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getOutputQueueCount();
 }
 
 std::string SerialPort::getPortName() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getPortName();
 }
 
+NativeHandle SerialPort::getNativeHandle() const
+{
+    if (!impl)
+        return INVALID_FILE_DESCRIPTOR;
+
+    SharedLock lock{impl->getMutex()};
+    return impl->getNativeHandle();
+}
+
 void SerialPort::setPortName(const std::string& portName)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setPortName(portName);
 }
 
 BaudRate SerialPort::getBaudRate() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getBaudRate();
 }
 
 void SerialPort::setBaudRate(BaudRate baudRate)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setBaudRate(baudRate);
 }
 
+void SerialPort::setBaudRate(BaudRate baudRate, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->setBaudRate(baudRate, error);
+}
+
 CharacterSize SerialPort::getCharacterSize() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getCharacterSize();
 }
 
 void SerialPort::setCharacterSize(CharacterSize characterSize)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setCharacterSize(characterSize);
 }
 
+void SerialPort::setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->setCharacterSize(characterSize, error);
+}
+
 FlowControl SerialPort::getFlowControl() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getFlowControl();
 }
 
 void SerialPort::setFlowControl(FlowControl flowControl)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setFlowControl(flowControl);
 }
 
+void SerialPort::setFlowControl(FlowControl flowControl, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->setFlowControl(flowControl, error);
+}
+
 Parity SerialPort::getParity() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getParity();
 }
 
 void SerialPort::setParity(Parity parity)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setParity(parity);
 }
 
+void SerialPort::setParity(Parity parity, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->setParity(parity, error);
+}
+
 StopBit SerialPort::getStopBit() const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getStopBit();
 }
 
 void SerialPort::setStopBit(StopBit stopBit)
 {
+    ExclusiveLock lock{impl->getMutex()};
     impl->setStopBit(stopBit);
 }
 
+void SerialPort::setStopBit(StopBit stopBit, std::error_code& error) noexcept
+{
+    ExclusiveLock lock{impl->getMutex()};
+    impl->setStopBit(stopBit, error);
+}
+
 bool SerialPort::getControlLine(ControlLine controlLine) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->getControlLine(controlLine);
 }
 
 bool SerialPort::setControlLine(ControlLine controlLine, bool state) const
 {
+    SharedLock lock{impl->getMutex()};
     return impl->setControlLine(controlLine, state);
 }
 
@@ -0,0 +1,165 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_reader.hpp>
+#include <serialport/slip.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+SlipCodec::SlipCodec(SerialPort& serialPort, size_t maxFrameSize) :
+    serialPort{serialPort}, frameReader{serialPort, std::string(1, SLIP_END), getMaxEncodedSize(maxFrameSize) * 2},
+    frameBuffer(getMaxEncodedSize(maxFrameSize)), transmitBuffer(getMaxEncodedSize(maxFrameSize)), errorCount{0}
+{
+
+}
+
+bool SlipCodec::readFrame(std::string_view& frame)
+{
+    if (nextFrame(frame))
+        return true;
+
+    return ((frameReader.fill() > 0) && nextFrame(frame));
+}
+
+bool SlipCodec::nextFrame(std::string_view& frame)
+{
+    std::string_view encoded{};
+    while (frameReader.nextFrame(encoded))
+    {
+        // Skip empty frames between END bytes
+        if (encoded.empty())
+            continue;
+
+        // Encoded frame exceeding the maximum frame size
+        if (encoded.size() > frameBuffer.size())
+        {
+            ++errorCount;
+            continue;
+        }
+
+        const auto size{decode(encoded.data(), encoded.size(), frameBuffer.data())};
+        if (size == static_cast<size_t>(-1))
+        {
+            ++errorCount;
+            continue;
+        }
+
+        frame = std::string_view{frameBuffer.data(), size};
+        return true;
+    }
+    return false;
+}
+
+size_t SlipCodec::feed(const char* data, size_t size)
+{
+    return frameReader.feed(data, size);
+}
+
+bool SlipCodec::writeFrame(const char* data, size_t size, std::chrono::milliseconds timeout)
+{
+    const auto maxSize{getMaxEncodedSize(size)};
+    if (maxSize > transmitBuffer.size())
+        transmitBuffer.resize(maxSize);
+
+    // Frame is written whole, a partially written frame can not be resumed
+    const auto encodedSize{encode(data, size, transmitBuffer.data())};
+    std::error_code error{};
+    return (serialPort.writeAll(transmitBuffer.data(), encodedSize, timeout, error) == encodedSize);
+}
+
+unsigned long SlipCodec::getErrorCount() const
+{
+    return (errorCount + frameReader.getOverflowCount());
+}
+
+size_t SlipCodec::getMaxEncodedSize(size_t size)
+{
+    // Every byte escaped and the leading and trailing END bytes
+    return ((size * 2) + 2);
+}
+
+size_t SlipCodec::encode(const char* data, size_t size, char* output)
+{
+    // Leading END flushes any line noise received before the frame
+    size_t result{0};
+    output[result++] = SLIP_END;
+
+    size_t offset{0};
+    while (true)
+    {
+        const auto count{findEitherByte(data + offset, size - offset, SLIP_END, SLIP_ESC)};
+        std::memcpy(output + result, data + offset, count);
+        result += count;
+        offset += count;
+        if (offset == size)
+            break;
+
+        output[result++] = SLIP_ESC;
+        output[result++] = ((data[offset++] == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC);
+    }
+
+    output[result++] = SLIP_END;
+    return result;
+}
+
+size_t SlipCodec::decode(const char* data, size_t size, char* output)
+{
+    size_t result{0};
+    size_t offset{0};
+    while (true)
+    {
+        const auto count{findEitherByte(data + offset, size - offset, SLIP_END, SLIP_ESC)};
+        std::memcpy(output + result, data + offset, count);
+        result += count;
+        offset += count;
+        if (offset == size)
+            break;
+
+        // END within a frame or an incomplete/unknown escape sequence
+        if ((data[offset] == SLIP_END) || ((offset + 1) == size))
+            return static_cast<size_t>(-1);
+
+        switch (data[offset + 1])
+        {
+            case SLIP_ESC_END:
+                output[result++] = SLIP_END;
+                break;
+
+            case SLIP_ESC_ESC:
+                output[result++] = SLIP_ESC;
+                break;
+
+            default:
+                return static_cast<size_t>(-1);
+        }
+        offset += 2;
+    }
+    return result;
+}
+
+END_NAMESPACE_LIBSERIAL
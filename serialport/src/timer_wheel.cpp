@@ -0,0 +1,239 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <serialport/namespace.hpp>
+#include <serialport/timer_wheel.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TimerWheel::TimerWheel(std::chrono::microseconds resolution, size_t slotCount, size_t levelCount) :
+    origin{std::chrono::steady_clock::now()}, resolution{resolution}, currentTick{0}, slotCount{slotCount},
+    spans{}, levels(levelCount, 0), slots{}, timers{}, freeList{INVALID_INDEX}, activeCount{0}
+{
+    if ((resolution.count() <= 0) || (slotCount < 2) || (levelCount == 0) || (slotCount > (UINT32_MAX / levelCount)))
+        throw std::out_of_range("Invalid timer wheel dimensions");
+
+    // Only the range of the top level may saturate
+    spans.push_back(1);
+    for (size_t level{0}; level < levelCount; ++level)
+    {
+        if (spans.back() > (UINT64_MAX / slotCount))
+        {
+            if (level < (levelCount - 1))
+                throw std::out_of_range("Invalid timer wheel dimensions");
+            spans.push_back(UINT64_MAX);
+        }
+        else
+        {
+            spans.push_back(spans.back() * slotCount);
+        }
+    }
+    slots.assign(slotCount * levelCount, INVALID_INDEX);
+}
+
+TimerId TimerWheel::arm(std::chrono::steady_clock::time_point deadline, uint64_t data)
+{
+    // Reuse a free slab entry
+    uint32_t index{freeList};
+    if (index != INVALID_INDEX)
+    {
+        freeList = timers[index].previous;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(timers.size());
+        timers.push_back(Timer{0, 0, INVALID_INDEX, 0, INVALID_INDEX, INVALID_INDEX, false});
+    }
+
+    auto& timer{timers[index]};
+    timer.tick = std::max(toTick(deadline, true), currentTick);
+    timer.data = data;
+    timer.active = true;
+    link(index);
+
+    ++activeCount;
+    return getTimerId(index);
+}
+
+bool TimerWheel::cancel(TimerId timerId)
+{
+    const auto index{static_cast<uint32_t>(timerId & UINT32_MAX)};
+    const auto generation{static_cast<uint32_t>(timerId >> 32)};
+    if ((index >= timers.size()) || !timers[index].active || (timers[index].generation != generation))
+        return false;
+
+    release(index);
+    return true;
+}
+
+std::chrono::steady_clock::time_point TimerWheel::getNextExpiry() const
+{
+    if (activeCount == 0)
+        return std::chrono::steady_clock::time_point::max();
+
+    // Earliest timer of the first occupied slot of every level not cascaded yet
+    auto tick{UINT64_MAX};
+    const auto topLevel{levels.size() - 1};
+    for (size_t level{0}; level < topLevel; ++level)
+    {
+        if (levels[level] == 0)
+            continue;
+
+        const auto first{(currentTick + spans[level] - 1) / spans[level]};
+        for (auto position{first}; position < (first + slotCount); ++position)
+        {
+            auto index{slots[(level * slotCount) + (position % slotCount)]};
+            if (index == INVALID_INDEX)
+                continue;
+
+            for (; index != INVALID_INDEX; index = timers[index].next)
+                tick = std::min(tick, timers[index].tick);
+            break;
+        }
+    }
+
+    // Timers of the top level may be due in later revolutions
+    if (levels[topLevel] != 0)
+    {
+        for (size_t slot{topLevel * slotCount}; slot < slots.size(); ++slot)
+        {
+            for (auto index{slots[slot]}; index != INVALID_INDEX; index = timers[index].next)
+                tick = std::min(tick, timers[index].tick);
+        }
+    }
+    return (origin + (resolution * tick));
+}
+
+size_t TimerWheel::getActiveCount() const
+{
+    return activeCount;
+}
+
+std::chrono::steady_clock::time_point TimerWheel::getExpiry(TimerId timerId) const
+{
+    const auto index{static_cast<uint32_t>(timerId & UINT32_MAX)};
+    const auto generation{static_cast<uint32_t>(timerId >> 32)};
+    if ((index >= timers.size()) || !timers[index].active || (timers[index].generation != generation))
+        return std::chrono::steady_clock::time_point::max();
+
+    return (origin + (resolution * timers[index].tick));
+}
+
+std::chrono::microseconds TimerWheel::getResolution() const
+{
+    return resolution;
+}
+
+size_t TimerWheel::getLevelCount() const
+{
+    return levels.size();
+}
+
+size_t TimerWheel::getLowestLevel() const
+{
+    size_t level{0};
+    while ((level < levels.size()) && (levels[level] == 0))
+        ++level;
+    return level;
+}
+
+void TimerWheel::cascade(uint64_t tick)
+{
+    // Higher levels first, their timers may land in a lower level slot starting at the same tick
+    for (auto level{levels.size() - 1}; level > 0; --level)
+    {
+        if (((tick % spans[level]) != 0) || (levels[level] == 0))
+            continue;
+
+        auto& slot{slots[(level * slotCount) + ((tick / spans[level]) % slotCount)]};
+        auto index{slot};
+        slot = INVALID_INDEX;
+        while (index != INVALID_INDEX)
+        {
+            const auto next{timers[index].next};
+            --levels[level];
+            link(index);
+            index = next;
+        }
+    }
+}
+
+void TimerWheel::link(uint32_t index)
+{
+    // Lowest level whose range covers the remaining time, the top level takes the rest
+    auto& timer{timers[index]};
+    const auto delta{timer.tick - currentTick};
+    size_t level{0};
+    while (((level + 1) < levels.size()) && (delta >= spans[level + 1]))
+        ++level;
+
+    // Link at the head of the slot list
+    const auto slot{static_cast<uint32_t>((level * slotCount) + ((timer.tick / spans[level]) % slotCount))};
+    timer.slot = slot;
+    timer.previous = INVALID_INDEX;
+    timer.next = slots[slot];
+    if (timer.next != INVALID_INDEX)
+        timers[timer.next].previous = index;
+    slots[slot] = index;
+    ++levels[level];
+}
+
+uint64_t TimerWheel::toTick(std::chrono::steady_clock::time_point time, bool roundUp) const
+{
+    if (time <= origin)
+        return 0;
+
+    const auto elapsed{std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count()};
+    const auto period{std::chrono::duration_cast<std::chrono::nanoseconds>(resolution).count()};
+    return static_cast<uint64_t>(roundUp ? ((elapsed + period - 1) / period) : (elapsed / period));
+}
+
+TimerId TimerWheel::getTimerId(uint32_t index) const
+{
+    return ((static_cast<TimerId>(timers[index].generation) << 32) | index);
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    // Unlink from the slot list
+    auto& timer{timers[index]};
+    if (timer.previous != INVALID_INDEX)
+        timers[timer.previous].next = timer.next;
+    else
+        slots[timer.slot] = timer.next;
+    if (timer.next != INVALID_INDEX)
+        timers[timer.next].previous = timer.previous;
+    --levels[timer.slot / slotCount];
+
+    // Generation invalidates outstanding identifiers
+    timer.active = false;
+    ++timer.generation;
+    timer.previous = freeList;
+    timer.next = INVALID_INDEX;
+    freeList = index;
+    --activeCount;
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -20,13 +20,62 @@
 */
 
 #include <stdexcept>
+#include <system_error>
 #include <windows.h>
 #include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
 #include <serialport/properties.hpp>
 #include <serialport/windows/serialport_impl.hpp>
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+namespace
+{
+
+/**
+ * @brief Get the error code of a failed read/write call
+ *
+ * @return std::error_code Hang-up or system error
+ */
+std::error_code getIoError() noexcept
+{
+    switch (GetLastError())
+    {
+        case ERROR_DEVICE_NOT_CONNECTED:
+        case ERROR_BAD_COMMAND:
+        case ERROR_ACCESS_DENIED:
+        case ERROR_OPERATION_ABORTED:
+            return SerialError::SERIAL_ERROR_HANGUP;
+
+        default:
+            return getLastError();
+    }
+}
+
+/**
+ * @brief Translate an exception of the throwing API to an error code
+ *
+ * @return std::error_code Error code of the active exception
+ */
+std::error_code getExceptionError() noexcept
+{
+    try
+    {
+        throw;
+    }
+    catch (const std::out_of_range&)
+    {
+        return SerialError::SERIAL_ERROR_NOT_SUPPORTED;
+    }
+    catch (...)
+    {
+        const auto error{getLastError()};
+        return (error ? error : std::error_code(SerialError::SERIAL_ERROR_NOT_SUPPORTED));
+    }
+}
+
+} // namespace
+
 SerialPortImpl::SerialPortImpl() :
     SerialPortImpl(DEFAULT_PORT_NAME)
 {
@@ -38,7 +87,7 @@ SerialPortImpl::SerialPortImpl(const std::string& portName, BaudRate baudRate,
     StopBit stopBit) :
     fileDescriptor{INVALID_FILE_DESCRIPTOR}, openMode(std::ios_base::in | std::ios_base::out),
     portName{portName}, baudRate{baudRate}, characterSize{characterSize},
-    flowControl{flowControl}, parity{parity}, stopBit{stopBit}
+    flowControl{flowControl}, parity{parity}, stopBit{stopBit}, mutex{}
 {
 
 }
@@ -117,6 +166,37 @@ void SerialPortImpl::open(std::ios_base::openmode openMode)
     }
 }
 
+void SerialPortImpl::open(const NativePortSettings& nativePortSettings, std::ios_base::openmode openMode)
+{
+    // Do nothing on an open port
+    if (isOpen())
+        return;
+
+    // Device control block is applied as a whole after the regular open
+    open(openMode);
+    DCB portSettings{nativePortSettings};
+    portSettings.DCBlength = sizeof(DCB);
+    if (!setPortSettings(portSettings))
+    {
+        close();
+        throw std::runtime_error("Unable to set port settings");
+    }
+}
+
+void SerialPortImpl::open(std::ios_base::openmode openMode, std::error_code& error) noexcept
+{
+    // Configuration calls are not on the hot path
+    try
+    {
+        open(openMode);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 void SerialPortImpl::close()
 {
     // Do nothing on a closed port
@@ -136,6 +216,30 @@ void SerialPortImpl::close()
         throw std::runtime_error("Unable to set port settings");
 }
 
+void SerialPortImpl::close(std::error_code& error) noexcept
+{
+    try
+    {
+        close();
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
+void SerialPortImpl::abandon() noexcept
+{
+    // Do nothing on a closed port
+    if (!isOpen())
+        return;
+
+    // Close serial port and reset file descriptor
+    CloseHandle(fileDescriptor);
+    fileDescriptor = INVALID_FILE_DESCRIPTOR;
+}
+
 bool SerialPortImpl::setExclusive(bool exclusive)
 {
     // Do nothing on a closed port
@@ -156,6 +260,30 @@ size_t SerialPortImpl::read(char* buffer, size_t size) const
     return (ReadFile(fileDescriptor, buffer, size, &read, NULL) ? read : 0);
 }
 
+size_t SerialPortImpl::read(char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    // Fail on a closed port
+    if (!isOpen())
+    {
+        error = SerialError::SERIAL_ERROR_NOT_OPEN;
+        return 0;
+    }
+
+    DWORD read{0};
+    if (!ReadFile(fileDescriptor, buffer, size, &read, NULL))
+    {
+        error = getIoError();
+        return 0;
+    }
+
+    // Read timeouts return without data
+    if ((read == 0) && (size > 0))
+        error = SerialError::SERIAL_ERROR_WOULD_BLOCK;
+    else
+        error.clear();
+    return read;
+}
+
 size_t SerialPortImpl::read(std::string& buffer) const
 {
     // Do nothing on a closed port
@@ -206,6 +334,45 @@ size_t SerialPortImpl::write(const char* buffer, size_t size) const
     return (WriteFile(fileDescriptor, buffer, size, &written, NULL) ? written : 0);
 }
 
+size_t SerialPortImpl::write(const char* buffer, size_t size, std::error_code& error) const noexcept
+{
+    // Fail on a closed port
+    if (!isOpen())
+    {
+        error = SerialError::SERIAL_ERROR_NOT_OPEN;
+        return 0;
+    }
+
+    DWORD written{0};
+    if (!WriteFile(fileDescriptor, buffer, size, &written, NULL))
+    {
+        error = getIoError();
+        return 0;
+    }
+
+    if ((written == 0) && (size > 0))
+        error = SerialError::SERIAL_ERROR_WOULD_BLOCK;
+    else
+        error.clear();
+    return written;
+}
+
+size_t SerialPortImpl::writeAll(const char* buffer, size_t size, std::chrono::milliseconds, std::error_code& error) const noexcept
+{
+    // WriteFile() blocks for the configured write timeouts, writing nothing means they expired
+    error.clear();
+    size_t total{0};
+    while (total < size)
+    {
+        total += write(buffer + total, size - total, error);
+        if (error == SerialError::SERIAL_ERROR_WOULD_BLOCK)
+            error = std::make_error_code(std::errc::timed_out);
+        if (error)
+            break;
+    }
+    return total;
+}
+
 size_t SerialPortImpl::write(const std::string& buffer) const
 {
     // Do nothing on a closed port
@@ -266,6 +433,16 @@ std::string SerialPortImpl::getPortName() const
     return portName;
 }
 
+NativeHandle SerialPortImpl::getNativeHandle() const
+{
+    return fileDescriptor;
+}
+
+std::shared_mutex& SerialPortImpl::getMutex() const noexcept
+{
+    return mutex;
+}
+
 void SerialPortImpl::setPortName(const std::string& portName)
 {
     this->portName = portName;
@@ -287,6 +464,19 @@ void SerialPortImpl::setBaudRate(BaudRate baudRate)
     updatePortSettings();
 }
 
+void SerialPortImpl::setBaudRate(BaudRate baudRate, std::error_code& error) noexcept
+{
+    try
+    {
+        setBaudRate(baudRate);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 CharacterSize SerialPortImpl::getCharacterSize() const
 {
     return characterSize;
@@ -302,6 +492,19 @@ void SerialPortImpl::setCharacterSize(CharacterSize characterSize)
     updatePortSettings();
 }
 
+void SerialPortImpl::setCharacterSize(CharacterSize characterSize, std::error_code& error) noexcept
+{
+    try
+    {
+        setCharacterSize(characterSize);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 FlowControl SerialPortImpl::getFlowControl() const
 {
     return flowControl;
@@ -318,6 +521,19 @@ void SerialPortImpl::setFlowControl(FlowControl flowControl)
     updatePortSettings();
 }
 
+void SerialPortImpl::setFlowControl(FlowControl flowControl, std::error_code& error) noexcept
+{
+    try
+    {
+        setFlowControl(flowControl);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 Parity SerialPortImpl::getParity() const
 {
     return parity;
@@ -334,6 +550,19 @@ void SerialPortImpl::setParity(Parity parity)
     updatePortSettings();
 }
 
+void SerialPortImpl::setParity(Parity parity, std::error_code& error) noexcept
+{
+    try
+    {
+        setParity(parity);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 StopBit SerialPortImpl::getStopBit() const
 {
     return stopBit;
@@ -350,6 +579,19 @@ void SerialPortImpl::setStopBit(StopBit stopBit)
     updatePortSettings();
 }
 
+void SerialPortImpl::setStopBit(StopBit stopBit, std::error_code& error) noexcept
+{
+    try
+    {
+        setStopBit(stopBit);
+        error.clear();
+    }
+    catch (...)
+    {
+        error = getExceptionError();
+    }
+}
+
 bool SerialPortImpl::getControlLine(ControlLine controlLine) const
 {
     // Do nothing on a closed port
@@ -0,0 +1,207 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <serialport/namespace.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief PseudoTerminal class
+ *
+ * Pseudo-terminal pair used as a hardware independent serial port. The slave
+ * side is opened through SerialPort while the test drives the master side.
+ */
+class PseudoTerminal final
+{
+public:
+    /**
+     * @brief Construct a new PseudoTerminal object
+     *
+     * @throw std::runtime_error Unable to open pseudo-terminal
+     */
+    explicit PseudoTerminal();
+
+    /**
+     * @brief Copy-construct a new PseudoTerminal object
+     *
+     * @param pseudoTerminal Pseudo-terminal
+     */
+    PseudoTerminal(const PseudoTerminal& pseudoTerminal) = delete;
+
+    /**
+     * @brief Move-construct a new PseudoTerminal object
+     *
+     * @param pseudoTerminal Pseudo-terminal
+     */
+    PseudoTerminal(PseudoTerminal&& pseudoTerminal) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param pseudoTerminal Pseudo-terminal to copy-assign
+     * @return PseudoTerminal& Assigned pseudo-terminal
+     */
+    PseudoTerminal& operator=(const PseudoTerminal& pseudoTerminal) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param pseudoTerminal Pseudo-terminal to move-assign
+     * @return PseudoTerminal& Assigned pseudo-terminal
+     */
+    PseudoTerminal& operator=(PseudoTerminal&& pseudoTerminal) = delete;
+
+    /**
+     * @brief Destroy the PseudoTerminal object
+     *
+     */
+    ~PseudoTerminal() noexcept;
+
+    /**
+     * @brief Get the master file descriptor
+     *
+     * @return int Master file descriptor
+     */
+    int getMaster() const;
+
+    /**
+     * @brief Get the slave name
+     *
+     * @return std::string Slave name
+     */
+    std::string getSlaveName() const;
+
+    /**
+     * @brief Close the master side which hangs up the slave side
+     *
+     */
+    void closeMaster();
+
+    /**
+     * @brief Write data to the master side
+     *
+     * @param data Data
+     * @return size_t Size of the data actually written
+     */
+    size_t write(const std::string& data) const;
+
+    /**
+     * @brief Read data from the master side
+     *
+     * @param size Size of the data to read
+     * @param timeout Maximum time to wait for the data
+     * @return std::string Data actually read
+     */
+    std::string read(size_t size, std::chrono::milliseconds timeout = std::chrono::milliseconds{1000}) const;
+protected:
+    /**
+     * @brief Master file descriptor
+     *
+     */
+    int master;
+
+    /**
+     * @brief Slave name
+     *
+     */
+    std::string slaveName;
+};
+
+/**
+ * @brief NullModem class
+ *
+ * Connects the master sides of two pseudo-terminals from a background thread
+ * so the slave sides behave like two serial ports joined by a null-modem cable.
+ */
+class NullModem final
+{
+public:
+    /**
+     * @brief Construct a new NullModem object
+     *
+     * @param first First pseudo-terminal
+     * @param second Second pseudo-terminal
+     */
+    explicit NullModem(const PseudoTerminal& first, const PseudoTerminal& second);
+
+    /**
+     * @brief Copy-construct a new NullModem object
+     *
+     * @param nullModem Null-modem
+     */
+    NullModem(const NullModem& nullModem) = delete;
+
+    /**
+     * @brief Move-construct a new NullModem object
+     *
+     * @param nullModem Null-modem
+     */
+    NullModem(NullModem&& nullModem) = delete;
+
+    /**
+     * @brief Copy-assignment operator
+     *
+     * @param nullModem Null-modem to copy-assign
+     * @return NullModem& Assigned null-modem
+     */
+    NullModem& operator=(const NullModem& nullModem) = delete;
+
+    /**
+     * @brief Move-assignment operator
+     *
+     * @param nullModem Null-modem to move-assign
+     * @return NullModem& Assigned null-modem
+     */
+    NullModem& operator=(NullModem&& nullModem) = delete;
+
+    /**
+     * @brief Destroy the NullModem object
+     *
+     */
+    ~NullModem() noexcept;
+protected:
+    /**
+     * @brief Forward data between the master sides until stopped
+     *
+     * @param first First master file descriptor
+     * @param second Second master file descriptor
+     */
+    void forward(int first, int second);
+
+    /**
+     * @brief Stop flag
+     *
+     */
+    std::atomic<bool> stopped;
+
+    /**
+     * @brief Forwarding thread
+     *
+     */
+    std::thread thread;
+};
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,227 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/bus_scheduler.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Answer two byte poll requests of the responding devices until stopped
+ *
+ * @param terminal Pseudo terminal
+ * @param responding Addresses of the responding devices
+ * @param stopped Stop request
+ * @return std::thread Responder thread
+ */
+static std::thread respond(PseudoTerminal& terminal, std::string responding, std::atomic<bool>& stopped)
+{
+    return std::thread{[&terminal, responding, &stopped]()
+    {
+        while (!stopped)
+        {
+            const auto request{terminal.read(2, std::chrono::milliseconds{10})};
+            if ((request.size() == 2) && (responding.find(request[0]) != std::string::npos))
+                terminal.write(request.substr(0, 1) + "ok");
+        }
+    }};
+}
+
+TEST(BusSchedulerTest, ScheduleTest)
+{
+    SCOPED_TRACE("ScheduleTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    BusScheduler scheduler{serialPort};
+    scheduler.setResponseTimeout(std::chrono::milliseconds{5});
+
+    EXPECT_THROW(scheduler.addDevice("", 3, std::chrono::milliseconds{10}, 0, nullptr), std::out_of_range);
+    EXPECT_THROW(scheduler.addDevice("1?", 3, std::chrono::milliseconds{0}, 0, nullptr), std::out_of_range);
+    EXPECT_THROW(scheduler.getPeriod(0), std::out_of_range);
+
+    // Two responding devices and a silent one
+    size_t responses[3]{};
+    const auto handler{[&responses](size_t device, PollStatus status, std::string_view response)
+    {
+        if (status == PollStatus::POLL_COMPLETED)
+        {
+            EXPECT_EQ(response, std::string(1, static_cast<char>('1' + device)) + "ok");
+            ++responses[device];
+        }
+    }};
+    EXPECT_EQ(scheduler.addDevice("1?", 3, std::chrono::milliseconds{10}, 1, handler), 0U);
+    EXPECT_EQ(scheduler.addDevice("2?", 3, std::chrono::milliseconds{20}, 0, handler), 1U);
+    EXPECT_EQ(scheduler.addDevice("3?", 3, std::chrono::milliseconds{20}, 0, handler), 2U);
+    EXPECT_EQ(scheduler.getDeviceCount(), 3U);
+
+    const auto byteTime{calculateTime(BaudRate::BAUD_RATE_115200)};
+    EXPECT_NEAR(scheduler.getLoad(), (5.0 * byteTime) * (1.0 / 10.0 + 2.0 / 20.0), 1e-6);
+
+    std::atomic<bool> stopped{false};
+    auto thread{respond(terminal, "12", stopped)};
+    const auto end{std::chrono::steady_clock::now() + std::chrono::milliseconds{400}};
+    while (std::chrono::steady_clock::now() < end)
+        scheduler.poll(std::chrono::milliseconds{10});
+    stopped = true;
+    thread.join();
+
+    // Poll rates follow the poll periods
+    EXPECT_GT(scheduler.getPollRate(0), 70.0);
+    EXPECT_LT(scheduler.getPollRate(0), 110.0);
+    EXPECT_GT(scheduler.getPollRate(1), 35.0);
+    EXPECT_LT(scheduler.getPollRate(1), 55.0);
+
+    const auto statistics{scheduler.getDeviceStatistics(0)};
+    EXPECT_GE(responses[0] + 1, statistics.pollCount);
+    EXPECT_EQ(statistics.timeoutCount, 0U);
+    EXPECT_LE(statistics.totalJitter.count(), static_cast<long>(statistics.pollCount * 2000));
+    EXPECT_TRUE(scheduler.isOnline(0));
+
+    // Silent device backs off
+    const auto silent{scheduler.getDeviceStatistics(2)};
+    EXPECT_EQ(responses[2], 0U);
+    EXPECT_EQ(silent.responseCount, 0U);
+    EXPECT_LE(silent.pollCount, 7U);
+    EXPECT_FALSE(scheduler.isOnline(2));
+    EXPECT_EQ(scheduler.getBackoff(2), DEFAULT_BUS_MAX_BACKOFF);
+
+    const auto busStatistics{scheduler.getStatistics()};
+    EXPECT_EQ(busStatistics.pollCount, statistics.pollCount + scheduler.getDeviceStatistics(1).pollCount + silent.pollCount);
+    EXPECT_EQ(busStatistics.transmittedCount, busStatistics.pollCount * 2);
+    EXPECT_GT(scheduler.getUtilisation(), 0.0);
+}
+
+TEST(BusSchedulerTest, RecoveryTest)
+{
+    SCOPED_TRACE("RecoveryTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+
+    // Responses of variable size are completed by the extractor
+    BusScheduler scheduler{serialPort, [](std::string_view data) { return ((data.size() >= 3) ? size_t{3} : size_t{0}); }};
+    scheduler.setResponseTimeout(std::chrono::milliseconds{5});
+    scheduler.setMaxBackoff(4);
+    scheduler.setOfflineThreshold(2);
+    EXPECT_THROW(scheduler.setMaxBackoff(0), std::out_of_range);
+
+    PollStatus lastStatus{PollStatus::POLL_COMPLETED};
+    scheduler.addDevice("1?", 8, std::chrono::milliseconds{5}, 0, [&lastStatus](size_t, PollStatus status, std::string_view)
+    {
+        lastStatus = status;
+    });
+
+    const auto pollFor{[&scheduler](std::chrono::milliseconds duration)
+    {
+        const auto end{std::chrono::steady_clock::now() + duration};
+        while (std::chrono::steady_clock::now() < end)
+            scheduler.poll(std::chrono::milliseconds{5});
+    }};
+
+    // Device goes offline without responses
+    pollFor(std::chrono::milliseconds{100});
+    EXPECT_EQ(lastStatus, PollStatus::POLL_TIMEOUT);
+    EXPECT_FALSE(scheduler.isOnline(0));
+    EXPECT_EQ(scheduler.getBackoff(0), 4U);
+
+    // Single response restores the poll period
+    std::atomic<bool> stopped{false};
+    auto thread{respond(terminal, "1", stopped)};
+    pollFor(std::chrono::milliseconds{100});
+    stopped = true;
+    thread.join();
+    EXPECT_TRUE(scheduler.isOnline(0));
+    EXPECT_EQ(scheduler.getBackoff(0), 1U);
+    EXPECT_GT(scheduler.getDeviceStatistics(0).responseCount, 5U);
+}
+
+TEST(BusSchedulerTest, HangUpTest)
+{
+    SCOPED_TRACE("HangUpTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    BusScheduler scheduler{serialPort};
+    scheduler.setResponseTimeout(std::chrono::milliseconds{5000});
+
+    // Active poll ends on the hang-up
+    std::vector<PollStatus> results{};
+    scheduler.addDevice("1?", 3, std::chrono::milliseconds{10}, 0, [&results](size_t, PollStatus status, std::string_view)
+    {
+        results.push_back(status);
+    });
+    scheduler.poll(std::chrono::milliseconds{0});
+    EXPECT_EQ(terminal.read(2), "1?");
+    terminal.closeMaster();
+
+    // Event loop ends instead of spinning on the hung up port
+    const auto start{std::chrono::steady_clock::now()};
+    scheduler.run();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{1000});
+    EXPECT_TRUE(scheduler.isFailed());
+    EXPECT_EQ(results, (std::vector<PollStatus>{PollStatus::POLL_IO_ERROR}));
+    EXPECT_EQ(scheduler.poll(std::chrono::milliseconds{10}), 0U);
+
+    const auto statistics{scheduler.getStatistics()};
+    EXPECT_EQ(statistics.failedCount, 1U);
+    EXPECT_EQ(statistics.timeoutCount, 0U);
+    EXPECT_EQ(scheduler.getBackoff(0), 1U);
+}
+
+TEST(BusSchedulerTest, StalledWriteTest)
+{
+    SCOPED_TRACE("StalledWriteTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_4000000};
+    ASSERT_NO_THROW(serialPort.open());
+    BusScheduler scheduler{serialPort};
+    scheduler.setResponseTimeout(std::chrono::milliseconds{5});
+
+    // Request larger than the terminal buffer which the peer never reads times out
+    std::vector<PollStatus> results{};
+    scheduler.addDevice(std::string(64 * 1024, 'x'), 3, std::chrono::seconds{10}, 0,
+        [&results](size_t, PollStatus status, std::string_view)
+    {
+        results.push_back(status);
+    });
+    const auto end{std::chrono::steady_clock::now() + std::chrono::milliseconds{2000}};
+    while (results.empty() && (std::chrono::steady_clock::now() < end))
+        scheduler.poll(std::chrono::milliseconds{10});
+    EXPECT_EQ(results, (std::vector<PollStatus>{PollStatus::POLL_TIMEOUT}));
+    EXPECT_FALSE(scheduler.isFailed());
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,122 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/busy_poll_reader.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(BusyPollReaderTest, ReadTest)
+{
+    SCOPED_TRACE("ReadTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+    ASSERT_THROW(BusyPollReader(serialPort, std::chrono::nanoseconds{-1}), std::out_of_range);
+
+    BusyPollReader reader{serialPort, std::chrono::milliseconds{1}};
+    reader.setAdaptive(false);
+    ASSERT_EQ(reader.getSpinBudget(), std::chrono::milliseconds{1});
+    char buffer[16];
+    std::error_code error{};
+
+    // Available data is read while spinning
+    ASSERT_EQ(terminal.write("spin"), 4U);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{100}, error), 4U);
+    ASSERT_FALSE(error);
+    ASSERT_EQ(std::string(buffer, 4), "spin");
+
+    // Data arriving after the spin budget is read after blocking
+    std::thread writer{[&terminal]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        terminal.write("sleep");
+    }};
+    ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{1000}, error), 5U);
+    writer.join();
+    ASSERT_FALSE(error);
+    ASSERT_EQ(std::string(buffer, 5), "sleep");
+
+    // No data within the timeout
+    ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{5}, error), 0U);
+    ASSERT_EQ(error, std::errc::timed_out);
+
+    const auto statistics{reader.getStatistics()};
+    ASSERT_EQ(statistics.readCount, 2U);
+    ASSERT_EQ(statistics.spinCount, 1U);
+    ASSERT_EQ(statistics.sleepCount, 2U);
+    ASSERT_EQ(statistics.timeoutCount, 1U);
+    ASSERT_GE(statistics.spinTime, std::chrono::milliseconds{2});
+    ASSERT_GE(statistics.sleepTime, std::chrono::milliseconds{15});
+
+    // Hang-up is reported while blocking
+    terminal.closeMaster();
+    ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{100}, error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_HANGUP);
+    reader.resetStatistics();
+    ASSERT_EQ(reader.getStatistics().readCount, 0U);
+}
+
+TEST(BusyPollReaderTest, AdaptiveTest)
+{
+    SCOPED_TRACE("AdaptiveTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+    BusyPollReader reader{serialPort, std::chrono::milliseconds{1}};
+    ASSERT_TRUE(reader.isAdaptive());
+    char buffer[16];
+    std::error_code error{};
+
+    // Long waits stop spinning
+    for (int index{0}; index < 8; ++index)
+        ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{5}, error), 0U);
+    ASSERT_EQ(reader.getSpinBudget(), std::chrono::nanoseconds{0});
+
+    // Short waits resume spinning within the maximum spin budget
+    for (int index{0}; index < 64; ++index)
+    {
+        ASSERT_EQ(terminal.write("x"), 1U);
+        ASSERT_EQ(reader.read(buffer, sizeof(buffer), std::chrono::milliseconds{100}, error), 1U);
+    }
+    ASSERT_GT(reader.getSpinBudget(), std::chrono::nanoseconds{0});
+    ASSERT_LE(reader.getSpinBudget(), reader.getMaxSpinBudget());
+
+    // Fixed spin budget
+    reader.setAdaptive(false);
+    ASSERT_EQ(reader.getSpinBudget(), std::chrono::milliseconds{1});
+    reader.setMaxSpinBudget(std::chrono::microseconds{10});
+    ASSERT_EQ(reader.getSpinBudget(), std::chrono::microseconds{10});
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,309 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/cmux.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Encode a frame into a string
+ *
+ * @param mode Framing mode
+ * @param address Address field
+ * @param control Control field
+ * @param data Information field
+ * @return std::string Encoded frame
+ */
+static std::string encode(CmuxMode mode, uint8_t address, uint8_t control, const std::string& data)
+{
+    std::string result(CmuxMultiplexer::getMaxEncodedSize(mode, data.size()), '\0');
+    result.resize(CmuxMultiplexer::encodeFrame(mode, address, control, data.data(), data.size(), result.data()));
+    return result;
+}
+
+/**
+ * @brief Poll two multiplexers alternately until a condition holds
+ *
+ * @tparam Condition Condition type
+ * @param first First multiplexer
+ * @param second Second multiplexer
+ * @param condition Condition
+ * @return true Condition holds
+ * @return false Timeout
+ */
+template<typename Condition>
+static bool pump(CmuxMultiplexer& first, CmuxMultiplexer& second, Condition condition)
+{
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{10}};
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        first.poll(std::chrono::milliseconds{1});
+        second.poll(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
+/**
+ * @brief Transfer data over a channel while the receiver only reads once flow control stopped the sender
+ *
+ * @param sender Sending multiplexer
+ * @param receiver Receiving multiplexer
+ * @param dlci Data link connection identifier
+ * @param data Data
+ * @return std::string Received data
+ */
+static std::string transfer(CmuxMultiplexer& sender, CmuxMultiplexer& receiver, uint8_t dlci, const std::string& data)
+{
+    auto& output{sender.getChannel(dlci)};
+    auto& input{receiver.getChannel(dlci)};
+    std::string result{};
+    size_t offset{0};
+    bool stopped{false};
+    pump(sender, receiver, [&]()
+    {
+        offset += output.write(data.data() + offset, data.size() - offset);
+        stopped = (stopped || output.isFlowStopped());
+        if (stopped)
+        {
+            std::string chunk{};
+            input.read(chunk);
+            result += chunk;
+        }
+        return (result.size() >= data.size());
+    });
+    return result;
+}
+
+TEST(CmuxTest, FrameTest)
+{
+    SCOPED_TRACE("FrameTest");
+
+    // SABM and UA of the control channel
+    EXPECT_EQ(encode(CmuxMode::CMUX_MODE_BASIC, 0x03, 0x3F, ""), "\xF9\x03\x3F\x01\x1C\xF9");
+    EXPECT_EQ(encode(CmuxMode::CMUX_MODE_BASIC, 0x03, 0x73, ""), "\xF9\x03\x73\x01\xD7\xF9");
+
+    // Two byte length field
+    const std::string data(200, 'x');
+    const auto frame{encode(CmuxMode::CMUX_MODE_BASIC, 0x07, 0xEF, data)};
+    EXPECT_EQ(frame.size(), data.size() + 7);
+    EXPECT_EQ(frame.substr(3, 2), std::string("\x90\x01", 2));
+
+    // Control octet transparency
+    const auto escaped{encode(CmuxMode::CMUX_MODE_ADVANCED, 0x07, 0xEF, "\x7E\x7D")};
+    EXPECT_EQ(escaped.substr(0, 7), "\x7E\x07\xEF\x7D\x5E\x7D\x5D");
+    EXPECT_EQ(escaped.back(), '\x7E');
+    EXPECT_LE(escaped.size(), CmuxMultiplexer::getMaxEncodedSize(CmuxMode::CMUX_MODE_ADVANCED, 2));
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    EXPECT_THROW(CmuxMultiplexer{serialPort}, std::runtime_error);
+    ASSERT_NO_THROW(serialPort.open());
+    EXPECT_THROW(CmuxMultiplexer(serialPort, CmuxMode::CMUX_MODE_BASIC, 8), std::out_of_range);
+
+    // Peer does not respond
+    CmuxMultiplexer multiplexer{serialPort};
+    EXPECT_FALSE(multiplexer.connect(std::chrono::milliseconds{50}));
+    EXPECT_EQ(terminal.read(6), "\xF9\x03\x3F\x01\x1C\xF9");
+    EXPECT_FALSE(multiplexer.isConnected());
+    EXPECT_FALSE(multiplexer.openChannel(1));
+    EXPECT_THROW(multiplexer.openChannel(0), std::out_of_range);
+    EXPECT_THROW(multiplexer.getChannel(1), std::out_of_range);
+
+    // Channel accepted after the peer started the session
+    terminal.write("\xF9\x03\x3F\x01\x1C\xF9" "\xF9\x07\x3F\x01\xDE\xF9");
+    for (size_t index{0}; (index < 10) && !multiplexer.isConnected(); ++index)
+        multiplexer.poll(std::chrono::milliseconds{10});
+    EXPECT_TRUE(multiplexer.isConnected());
+    EXPECT_EQ(terminal.read(12), "\xF9\x03\x73\x01\xD7\xF9" "\xF9\x07\x73\x01\x15\xF9");
+    EXPECT_TRUE(multiplexer.getChannel(1).isOpen());
+}
+
+TEST(CmuxTest, BasicTest)
+{
+    SCOPED_TRACE("BasicTest");
+
+    PseudoTerminal firstTerminal{};
+    PseudoTerminal secondTerminal{};
+    NullModem nullModem{firstTerminal, secondTerminal};
+    SerialPort firstPort{firstTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    SerialPort secondPort{secondTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(firstPort.open());
+    ASSERT_NO_THROW(secondPort.open());
+    CmuxMultiplexer initiator{firstPort};
+    CmuxMultiplexer responder{secondPort};
+
+    // Responder serviced by its own thread while the initiator blocks
+    std::thread thread{[&responder]() { responder.run(); }};
+    EXPECT_TRUE(initiator.connect());
+    EXPECT_TRUE(initiator.openChannel(1));
+    EXPECT_TRUE(initiator.openChannel(2, true));
+    responder.stop();
+    thread.join();
+    EXPECT_TRUE(responder.isConnected());
+
+    // Modem status of the opened channels
+    auto& first{initiator.getChannel(1)};
+    auto& second{responder.getChannel(1)};
+    EXPECT_TRUE(pump(initiator, responder, [&]() { return (first.getControlLine(ControlLine::LINE_DSR) &&
+        second.getControlLine(ControlLine::LINE_DSR)); }));
+    EXPECT_TRUE(first.setControlLine(ControlLine::LINE_DTR, false));
+    EXPECT_FALSE(first.setControlLine(ControlLine::LINE_CTS, false));
+    EXPECT_TRUE(pump(initiator, responder, [&]() { return !second.getControlLine(ControlLine::LINE_DSR); }));
+    EXPECT_TRUE(second.getControlLine(ControlLine::LINE_CTS));
+
+    // Bulk data stopped and resumed by flow control
+    std::string data(256 * 1024, '\0');
+    for (size_t index{0}; index < data.size(); ++index)
+        data[index] = static_cast<char>(index * 7);
+    EXPECT_EQ(transfer(initiator, responder, 1, data), data);
+    EXPECT_GE(first.getStatistics().flowStopCount, 1U);
+    EXPECT_GE(second.getStatistics().flowOffCount, 1U);
+    EXPECT_EQ(second.getStatistics().droppedCount, 0U);
+    EXPECT_EQ(second.getStatistics().receivedCount, data.size());
+
+    // Pseudo terminal backed channel
+    auto& terminalChannel{initiator.getChannel(2)};
+    SerialPort terminalPort{terminalChannel.getPortName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(terminalPort.open());
+    EXPECT_EQ(terminalPort.write("AT\r"), 3U);
+    std::string received{};
+    EXPECT_TRUE(pump(initiator, responder, [&]()
+    {
+        std::string chunk{};
+        responder.getChannel(2).read(chunk);
+        received += chunk;
+        return (received.size() >= 3);
+    }));
+    EXPECT_EQ(received, "AT\r");
+    EXPECT_EQ(responder.getChannel(2).write("OK\r\n"), 4U);
+    received.clear();
+    EXPECT_TRUE(pump(initiator, responder, [&]()
+    {
+        std::string chunk{};
+        terminalPort.read(chunk);
+        received += chunk;
+        return (received.size() >= 4);
+    }));
+    EXPECT_EQ(received, "OK\r\n");
+    terminalPort.close();
+
+    // Close a channel and the session
+    thread = std::thread{[&responder]() { responder.run(); }};
+    EXPECT_TRUE(initiator.closeChannel(1));
+    EXPECT_FALSE(first.isOpen());
+    EXPECT_EQ(first.write("x", 1), 0U);
+    EXPECT_TRUE(initiator.disconnect());
+    EXPECT_FALSE(initiator.isConnected());
+    responder.stop();
+    thread.join();
+    EXPECT_FALSE(responder.isConnected());
+    EXPECT_FALSE(responder.getChannel(2).isOpen());
+    EXPECT_EQ(initiator.getStatistics().frameCheckErrorCount, 0U);
+    EXPECT_EQ(responder.getStatistics().invalidFrameCount, 0U);
+}
+
+TEST(CmuxTest, AdvancedTest)
+{
+    SCOPED_TRACE("AdvancedTest");
+
+    PseudoTerminal firstTerminal{};
+    PseudoTerminal secondTerminal{};
+    NullModem nullModem{firstTerminal, secondTerminal};
+    SerialPort firstPort{firstTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    SerialPort secondPort{secondTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(firstPort.open());
+    ASSERT_NO_THROW(secondPort.open());
+    CmuxMultiplexer initiator{firstPort, CmuxMode::CMUX_MODE_ADVANCED, 64};
+    CmuxMultiplexer responder{secondPort, CmuxMode::CMUX_MODE_ADVANCED, 64};
+
+    // Channels of the peer are refused
+    responder.setAcceptChannels(false);
+    std::thread thread{[&responder]() { responder.run(); }};
+    EXPECT_TRUE(initiator.connect());
+    EXPECT_FALSE(initiator.openChannel(5));
+    responder.stop();
+    thread.join();
+    responder.setAcceptChannels(true);
+    thread = std::thread{[&responder]() { responder.run(); }};
+    EXPECT_TRUE(initiator.openChannel(5));
+    EXPECT_TRUE(initiator.openChannel(6));
+    responder.stop();
+    thread.join();
+
+    // Every byte value on two channels in both directions
+    std::string data(64 * 1024, '\0');
+    for (size_t index{0}; index < data.size(); ++index)
+        data[index] = static_cast<char>(index);
+    EXPECT_EQ(transfer(initiator, responder, 5, data), data);
+    EXPECT_EQ(transfer(responder, initiator, 6, data), data);
+
+    const auto statistics{responder.getStatistics()};
+    EXPECT_EQ(statistics.frameCheckErrorCount, 0U);
+    EXPECT_EQ(statistics.invalidFrameCount, 0U);
+    EXPECT_GE(statistics.receivedFrameCount, data.size() / 64);
+}
+
+TEST(CmuxTest, HangUpTest)
+{
+    SCOPED_TRACE("HangUpTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    CmuxMultiplexer multiplexer{serialPort};
+
+    // Session and a channel started by the peer
+    terminal.write("\xF9\x03\x3F\x01\x1C\xF9" "\xF9\x07\x3F\x01\xDE\xF9");
+    for (size_t index{0}; (index < 10) && !multiplexer.isConnected(); ++index)
+        multiplexer.poll(std::chrono::milliseconds{10});
+    ASSERT_TRUE(multiplexer.isConnected());
+    EXPECT_EQ(terminal.read(12), "\xF9\x03\x73\x01\xD7\xF9" "\xF9\x07\x73\x01\x15\xF9");
+    auto& channel{multiplexer.getChannel(1)};
+    EXPECT_TRUE(channel.isOpen());
+    terminal.closeMaster();
+
+    // Event loop ends instead of spinning on the hung up port
+    const auto start{std::chrono::steady_clock::now()};
+    multiplexer.run();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{1000});
+    EXPECT_TRUE(multiplexer.isFailed());
+    EXPECT_FALSE(multiplexer.isConnected());
+    EXPECT_FALSE(channel.isOpen());
+    EXPECT_EQ(channel.write("x", 1), 0U);
+
+    // Failed multiplexer does not connect again
+    EXPECT_FALSE(multiplexer.connect(std::chrono::milliseconds{50}));
+    EXPECT_EQ(multiplexer.poll(std::chrono::milliseconds{10}), 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,168 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/cobs.hpp>
+
+#ifdef __linux__
+    #include <serialport_test/test_pseudo_terminal.hpp>
+#endif // __linux__
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Encode a frame into a string
+ *
+ * @param data Frame data
+ * @return std::string Encoded frame
+ */
+static std::string encodeCobs(const std::string& data)
+{
+    std::string result(CobsCodec::getMaxEncodedSize(data.size()), '\0');
+    result.resize(CobsCodec::encode(data.data(), data.size(), result.data()));
+    return result;
+}
+
+TEST(CobsCodecTest, EncodeFunctionTest)
+{
+    SCOPED_TRACE("EncodeFunctionTest");
+
+    // Examples from the COBS paper and Wikipedia
+    EXPECT_EQ(encodeCobs(std::string{}), std::string("\x01\x00", 2));
+    EXPECT_EQ(encodeCobs(std::string("\x00", 1)), std::string("\x01\x01\x00", 3));
+    EXPECT_EQ(encodeCobs(std::string("\x00\x00", 2)), std::string("\x01\x01\x01\x00", 4));
+    EXPECT_EQ(encodeCobs(std::string("\x11\x22\x00\x33", 4)), std::string("\x03\x11\x22\x02\x33\x00", 6));
+    EXPECT_EQ(encodeCobs(std::string("\x11\x00\x00\x00", 4)), std::string("\x02\x11\x01\x01\x01\x00", 6));
+
+    // Full blocks of 254 non-zero bytes
+    const std::string block(254, 'x');
+    EXPECT_EQ(encodeCobs(block), "\xFF" + block + std::string("\x00", 1));
+    EXPECT_EQ(encodeCobs(block + "y"), "\xFF" + block + "\x02y" + std::string("\x00", 1));
+    EXPECT_EQ(encodeCobs(block + std::string("\x00", 1)), "\xFF" + block + std::string("\x01\x01\x00", 3));
+}
+
+TEST(CobsCodecTest, DecodeFunctionTest)
+{
+    SCOPED_TRACE("DecodeFunctionTest");
+
+    std::vector<std::string> frames{std::string{}, std::string("\x00", 1), std::string(254, 'x'),
+        std::string(1000, 'y') + std::string(3, '\0') + std::string(600, 'z')};
+    std::string binary{};
+    for (size_t index{0}; index < 1024; ++index)
+        binary += static_cast<char>(index * 31);
+    frames.push_back(binary);
+
+    for (const auto& frame: frames)
+    {
+        const auto encoded{encodeCobs(frame)};
+        EXPECT_EQ(encoded.find('\0'), encoded.size() - 1);
+        EXPECT_LE(encoded.size(), CobsCodec::getMaxEncodedSize(frame.size()));
+
+        std::string decoded(encoded.size(), '\0');
+        decoded.resize(CobsCodec::decode(encoded.data(), encoded.size() - 1, decoded.data()));
+        EXPECT_EQ(decoded, frame);
+    }
+
+    // Invalid code bytes
+    char output[16];
+    EXPECT_EQ(CobsCodec::decode("\x05\x11", 2, output), static_cast<size_t>(-1));
+    EXPECT_EQ(CobsCodec::decode("\x03\x11\x00", 3, output), static_cast<size_t>(-1));
+    EXPECT_EQ(CobsCodec::decode("\x00", 1, output), static_cast<size_t>(-1));
+}
+
+TEST(CobsCodecTest, StreamTest)
+{
+    SCOPED_TRACE("StreamTest");
+
+    SerialPort serialPort{};
+    CobsCodec cobsCodec{serialPort, 64};
+
+    // Line noise, valid frames, invalid frame and an oversized frame
+    const std::string data{std::string("\x00\x00", 2) + encodeCobs(std::string("\x01\x00\x02", 3)) +
+        std::string("\x07\x11\x00", 3) + encodeCobs(std::string(500, 'x')) + encodeCobs("last")};
+    std::vector<std::string> frames{};
+    std::string_view frame{};
+    for (size_t offset{0}; offset < data.size();)
+    {
+        offset += cobsCodec.feed(data.data() + offset, std::min<size_t>(7, data.size() - offset));
+        while (cobsCodec.nextFrame(frame))
+            frames.emplace_back(frame);
+    }
+    EXPECT_EQ(frames, (std::vector<std::string>{std::string("\x01\x00\x02", 3), "last"}));
+    EXPECT_EQ(cobsCodec.getErrorCount(), 2U);
+}
+
+#ifdef __linux__
+TEST(CobsCodecTest, SerialPortTest)
+{
+    SCOPED_TRACE("SerialPortTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    CobsCodec cobsCodec{serialPort};
+    const std::string frame{"\x00\x01\x02\x00", 4};
+    EXPECT_TRUE(cobsCodec.writeFrame(frame.data(), frame.size()));
+    EXPECT_EQ(terminal.read(6), encodeCobs(frame));
+
+    terminal.write(encodeCobs(frame));
+    std::string_view received{};
+    bool result{false};
+    for (size_t attempt{0}; (attempt < 1000) && !result; ++attempt)
+        result = cobsCodec.readFrame(received);
+    EXPECT_TRUE(result);
+    EXPECT_EQ(received, frame);
+}
+
+TEST(CobsCodecTest, LargeFrameTest)
+{
+    SCOPED_TRACE("LargeFrameTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    // Frame larger than the terminal buffer is written whole while the peer reads
+    CobsCodec cobsCodec{serialPort};
+    std::string frame(256 * 1024, '\0');
+    for (size_t index{0}; index < frame.size(); ++index)
+        frame[index] = static_cast<char>(index * 7);
+    const auto encoded{encodeCobs(frame)};
+    bool written{false};
+    std::thread writer{[&cobsCodec, &frame, &written]() { written = cobsCodec.writeFrame(frame.data(), frame.size()); }};
+    EXPECT_EQ(terminal.read(encoded.size(), std::chrono::milliseconds{10000}), encoded);
+    writer.join();
+    EXPECT_TRUE(written);
+
+    // Peer which stops reading fails the frame after the timeout
+    EXPECT_FALSE(cobsCodec.writeFrame(frame.data(), frame.size(), std::chrono::milliseconds{20}));
+}
+#endif // __linux__
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,118 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <string>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/crc.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Check value input of the CRC catalogue
+ *
+ */
+static const std::string CHECK_INPUT{"123456789"};
+
+/**
+ * @brief Compare table and bitwise calculation of a CRC over all sizes and alignments
+ *
+ * @tparam CrcType CRC type
+ * @param data Data
+ */
+template<typename CrcType>
+static void compareImplementations(const std::string& data)
+{
+    for (size_t offset{0}; offset < 8; ++offset)
+    {
+        for (size_t size{0}; (offset + size) <= data.size(); size += ((size < 80) ? 1 : 37))
+        {
+            EXPECT_EQ(CrcType::calculate(data.data() + offset, size), CrcType::calculateBitwise(data.data() + offset, size));
+        }
+    }
+
+    // Incremental update
+    auto crc{CrcType::initialize()};
+    crc = CrcType::update(crc, data.data(), 13);
+    crc = CrcType::update(crc, data.data() + 13, data.size() - 13);
+    EXPECT_EQ(CrcType::finalize(crc), CrcType::calculate(data.data(), data.size()));
+}
+
+TEST(CrcTest, CheckValueTest)
+{
+    SCOPED_TRACE("CheckValueTest");
+
+    const auto data{CHECK_INPUT.data()};
+    const auto size{CHECK_INPUT.size()};
+    EXPECT_EQ(Crc8::calculate(data, size), 0xF4U);
+    EXPECT_EQ(Crc8Maxim::calculate(data, size), 0xA1U);
+    EXPECT_EQ(Crc16Modbus::calculate(data, size), 0x4B37U);
+    EXPECT_EQ(Crc16CcittFalse::calculate(data, size), 0x29B1U);
+    EXPECT_EQ(Crc16Kermit::calculate(data, size), 0x2189U);
+    EXPECT_EQ(Crc16X25::calculate(data, size), 0x906EU);
+    EXPECT_EQ(Crc32::calculate(data, size), 0xCBF43926U);
+    EXPECT_EQ(Crc32c::calculate(data, size), 0xE3069283U);
+    EXPECT_EQ(Crc32Bzip2::calculate(data, size), 0xFC891918U);
+    EXPECT_EQ(Crc64Xz::calculate(data, size), 0x995DC9BBDF1939FAU);
+
+    // Unusual widths and mixed reflection (CRC-5/USB, CRC-12/UMTS, CRC-24/OPENPGP)
+    EXPECT_EQ((Crc<5, 0x05, 0x1F, true, true, 0x1F>::calculate(data, size)), 0x19U);
+    EXPECT_EQ((Crc<12, 0x80F, 0x000, false, true, 0x000>::calculate(data, size)), 0xDAFU);
+    EXPECT_EQ((Crc<24, 0x864CFB, 0xB704CE, false, false, 0x000000>::calculate(data, size)), 0x21CF02U);
+
+    // Compile-time evaluation
+    static_assert(Crc16Modbus::calculateBitwise("123456789", 9) == 0x4B37U, "CRC-16/MODBUS check value");
+    static_assert(Crc32::finalize(Crc32::initialize()) == 0U, "CRC-32 of empty data");
+}
+
+TEST(CrcTest, ImplementationTest)
+{
+    SCOPED_TRACE("ImplementationTest");
+
+    std::string data(1000, '\0');
+    for (size_t index{0}; index < data.size(); ++index)
+        data[index] = static_cast<char>((index * 131) ^ (index >> 3));
+
+    const auto implementation{getCrcImplementation()};
+    for (const auto crcImplementation: {CrcImplementation::CRC_SLICING_BY_8, CrcImplementation::CRC_HARDWARE})
+    {
+        if (!setCrcImplementation(crcImplementation))
+        {
+            EXPECT_FALSE(isCrcImplementationSupported(crcImplementation));
+            continue;
+        }
+        EXPECT_EQ(getCrcImplementation(), crcImplementation);
+
+        compareImplementations<Crc32>(data);
+        compareImplementations<Crc32c>(data);
+    }
+    EXPECT_TRUE(setCrcImplementation(implementation));
+
+    compareImplementations<Crc8>(data);
+    compareImplementations<Crc8Maxim>(data);
+    compareImplementations<Crc16Modbus>(data);
+    compareImplementations<Crc16CcittFalse>(data);
+    compareImplementations<Crc32Bzip2>(data);
+    compareImplementations<Crc64Xz>(data);
+    compareImplementations<Crc<12, 0x80F, 0x000, false, true, 0x000>>(data);
+}
+
+END_NAMESPACE_LIBSERIAL
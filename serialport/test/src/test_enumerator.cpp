@@ -19,8 +19,16 @@
     SPDX-License-Identifier: GPL-3.0-or-later
 */
 
+#include <cstdio>
 #include <string>
 #include <vector>
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <ftw.h>
+    #include <stdlib.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif // __linux__
 #include <gtest/gtest.h>
 #include <serialport/namespace.hpp>
 #include <serialport/properties.hpp>
@@ -28,6 +36,68 @@
 
 BEGIN_NAMESPACE_LIBSERIAL
 
+#ifdef __linux__
+/**
+ * @brief Create a directory including its missing parents
+ *
+ * @param path Directory path
+ */
+static void makeDirectories(const std::string& path)
+{
+    for (auto position{path.find('/', 1)}; position != std::string::npos; position = path.find('/', position + 1))
+        ::mkdir(path.substr(0, position).c_str(), 0755);
+    ::mkdir(path.c_str(), 0755);
+}
+
+/**
+ * @brief Create a sysfs attribute file
+ *
+ * @param path Attribute path
+ * @param value Attribute value, written with a trailing newline like the sysfs does
+ */
+static void writeAttribute(const std::string& path, const std::string& value)
+{
+    const auto fileDescriptor{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    ASSERT_NE(fileDescriptor, INVALID_FILE_DESCRIPTOR);
+    const auto line{value + "\n"};
+    ASSERT_EQ(::write(fileDescriptor, line.data(), line.size()), static_cast<ssize_t>(line.size()));
+    ::close(fileDescriptor);
+}
+
+/**
+ * @brief Remove a directory tree
+ *
+ * @param path Directory path
+ */
+static void removeDirectories(const std::string& path)
+{
+    ::nftw(path.c_str(), [](const char* entry, const struct stat*, int, struct FTW*) { return std::remove(entry); },
+        16, FTW_DEPTH | FTW_PHYS);
+}
+
+/**
+ * @brief Directory tree removed when leaving the scope, also after a failed assertion
+ *
+ */
+struct DirectoryGuard final
+{
+    /**
+     * @brief Destroy the DirectoryGuard object and remove the directory tree
+     *
+     */
+    ~DirectoryGuard() noexcept
+    {
+        removeDirectories(path);
+    }
+
+    /**
+     * @brief Directory path
+     *
+     */
+    std::string path;
+};
+#endif // __linux__
+
 TEST(EnumeratorTest, UpdateSerialPortListFunctionTest)
 {
     SCOPED_TRACE("UpdateSerialPortListFunctionTest");
@@ -68,4 +138,135 @@ TEST(EnumeratorTest, FileNameToSerialPortFunctionTest)
     ASSERT_EQ(Enumerator::fileNameToSerialPort(serialPort), serialPort);
 }
 
+TEST(EnumeratorTest, UpdatePortInfoListFunctionTest)
+{
+    SCOPED_TRACE("UpdatePortInfoListFunctionTest");
+
+    std::vector<PortInfo> list{};
+    Enumerator::updatePortInfoList(list);
+    for (const auto& portInfo: list)
+    {
+        ASSERT_FALSE(portInfo.portName.empty());
+        ASSERT_EQ(portInfo.fileName, Enumerator::serialPortToFileName(portInfo.portName));
+        ASSERT_EQ(portInfo.isUsb(), ((portInfo.vendorId != 0) || (portInfo.productId != 0)));
+    }
+
+    // Refreshing collects the cache once and keeps the generation while the list is unchanged
+    const auto generation{Enumerator::refreshPortInfoCache()};
+    ASSERT_GT(generation, 0U);
+    ASSERT_EQ(Enumerator::getPortInfoGeneration(), generation);
+    const auto nextGeneration{Enumerator::refreshPortInfoCache()};
+    ASSERT_GE(nextGeneration, generation);
+    ASSERT_EQ(Enumerator::getPortInfoGeneration(), nextGeneration);
+
+    PortInfo portInfo{};
+    ASSERT_FALSE(Enumerator::findPortInfo("serialport-no-such-port", portInfo));
+    ASSERT_TRUE(portInfo.portName.empty());
+}
+
+#ifdef __linux__
+TEST(EnumeratorTest, SysfsPortInfoFunctionTest)
+{
+    SCOPED_TRACE("SysfsPortInfoFunctionTest");
+
+    char rootTemplate[]{"/tmp/serialport_sysfs_XXXXXX"};
+    ASSERT_NE(::mkdtemp(rootTemplate), nullptr);
+    const std::string root{rootTemplate};
+    const DirectoryGuard guard{root};
+    const auto ttyClass{root + "/class/tty/"};
+    const auto usbDevice{root + "/devices/usb1/1-1"};
+    const auto usbInterface{usbDevice + "/1-1:1.2"};
+    const auto uart{root + "/devices/platform/serial8250"};
+
+    // USB serial converter on the third interface of its device
+    makeDirectories(usbInterface + "/ttyUSB7");
+    makeDirectories(root + "/drivers/ftdi_sio");
+    writeAttribute(usbDevice + "/idVendor", "0403");
+    writeAttribute(usbDevice + "/idProduct", "6001");
+    writeAttribute(usbDevice + "/serial", "A1B2C3");
+    writeAttribute(usbDevice + "/manufacturer", "FTDI");
+    writeAttribute(usbDevice + "/product", "FT232R USB UART");
+    writeAttribute(usbInterface + "/bInterfaceNumber", "02");
+    ASSERT_EQ(::symlink((root + "/drivers/ftdi_sio").c_str(), (usbInterface + "/ttyUSB7/driver").c_str()), 0);
+    makeDirectories(ttyClass + "ttyUSB7");
+    ASSERT_EQ(::symlink((usbInterface + "/ttyUSB7").c_str(), (ttyClass + "ttyUSB7/device").c_str()), 0);
+
+    // Legacy UART with and without hardware present, virtual terminal without a device
+    makeDirectories(uart);
+    makeDirectories(ttyClass + "ttyS0");
+    makeDirectories(ttyClass + "ttyS1");
+    makeDirectories(ttyClass + "tty0");
+    ASSERT_EQ(::symlink(uart.c_str(), (ttyClass + "ttyS0/device").c_str()), 0);
+    ASSERT_EQ(::symlink(uart.c_str(), (ttyClass + "ttyS1/device").c_str()), 0);
+    writeAttribute(ttyClass + "ttyS0/type", "4");
+    writeAttribute(ttyClass + "ttyS1/type", "0");
+
+    // Persistent link of the USB serial converter relative to its device node
+    const auto byId{root + "/serial/by-id/"};
+    const auto byIdPath{byId + "usb-FTDI_FT232R_USB_UART_A1B2C3-if02-port0"};
+    makeDirectories(byId);
+    writeAttribute(root + "/ttyUSB7", "");
+    ASSERT_EQ(::symlink("../../ttyUSB7", byIdPath.c_str()), 0);
+
+    std::vector<PortInfo> list{};
+    ASSERT_TRUE(Enumerator::updatePortInfoList(list, ttyClass, byId));
+    ASSERT_EQ(list.size(), 2U);
+
+    ASSERT_EQ(list[0].portName, "ttyS0");
+    ASSERT_EQ(list[0].fileName, Enumerator::serialPortToFileName("ttyS0"));
+    ASSERT_FALSE(list[0].isUsb());
+    ASSERT_FALSE(list[0].hasStableIdentity());
+    ASSERT_EQ(list[0].interfaceNumber, -1);
+
+    ASSERT_EQ(list[1].portName, "ttyUSB7");
+    ASSERT_EQ(list[1].fileName, Enumerator::serialPortToFileName("ttyUSB7"));
+    ASSERT_EQ(list[1].vendorId, 0x0403U);
+    ASSERT_EQ(list[1].productId, 0x6001U);
+    ASSERT_EQ(list[1].serialNumber, "A1B2C3");
+    ASSERT_EQ(list[1].manufacturer, "FTDI");
+    ASSERT_EQ(list[1].product, "FT232R USB UART");
+    ASSERT_EQ(list[1].interfaceNumber, 2);
+    ASSERT_EQ(list[1].driver, "ftdi_sio");
+    ASSERT_EQ(list[1].byIdPath, byIdPath);
+    ASSERT_TRUE(list[1].isUsb());
+    ASSERT_TRUE(list[1].hasStableIdentity());
+    ASSERT_TRUE(list[1].isSameDevice(list[1]));
+
+    // Missing tty class directory
+    list.clear();
+    ASSERT_FALSE(Enumerator::updatePortInfoList(list, root + "/missing/", byId));
+    ASSERT_TRUE(list.empty());
+}
+#endif // __linux__
+
+TEST(EnumeratorTest, PortInfoCacheFunctionTest)
+{
+    SCOPED_TRACE("PortInfoCacheFunctionTest");
+
+    const auto list{Enumerator::getPortInfoCache()};
+    const auto generation{Enumerator::getPortInfoGeneration()};
+    ASSERT_GT(generation, 0);
+
+    // Generation does not change if the list has not changed
+    ASSERT_EQ(Enumerator::refreshPortInfoCache(), generation);
+    ASSERT_EQ(Enumerator::getPortInfoGeneration(), generation);
+    ASSERT_EQ(Enumerator::getPortInfoCache(), list);
+
+    for (const auto& portInfo: list)
+    {
+        PortInfo cachedPortInfo{};
+        ASSERT_TRUE(Enumerator::findPortInfo(portInfo.portName, cachedPortInfo));
+        ASSERT_EQ(cachedPortInfo, portInfo);
+        ASSERT_TRUE(Enumerator::findPortInfo(portInfo.fileName, cachedPortInfo));
+        ASSERT_EQ(cachedPortInfo, portInfo);
+    }
+
+    PortInfo portInfo{};
+#ifdef __linux__
+    ASSERT_FALSE(Enumerator::findPortInfo("ttyUSB-", portInfo));
+#elif defined(_WIN32) || defined(_WIN64)
+    ASSERT_FALSE(Enumerator::findPortInfo("COM-", portInfo));
+#endif // __linux__
+}
+
 END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,153 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <string>
+#include <system_error>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(ErrorTest, CategoryTest)
+{
+    SCOPED_TRACE("CategoryTest");
+
+    const std::error_code wouldBlock{SerialError::SERIAL_ERROR_WOULD_BLOCK};
+    ASSERT_EQ(wouldBlock.category(), getSerialErrorCategory());
+    ASSERT_STREQ(wouldBlock.category().name(), "serial");
+    ASSERT_EQ(wouldBlock, std::errc::operation_would_block);
+    ASSERT_EQ(std::error_code(SerialError::SERIAL_ERROR_NOT_OPEN), std::errc::bad_file_descriptor);
+    ASSERT_EQ(std::error_code(SerialError::SERIAL_ERROR_NOT_SUPPORTED), std::errc::invalid_argument);
+
+    // Hang-up is a distinct condition
+    const std::error_code hangup{SerialError::SERIAL_ERROR_HANGUP};
+    ASSERT_NE(hangup, std::errc::operation_would_block);
+    ASSERT_NE(hangup, wouldBlock);
+    ASSERT_FALSE(hangup.message().empty());
+}
+
+TEST(ErrorTest, OpenTest)
+{
+    SCOPED_TRACE("OpenTest");
+
+    // Operating system errors are reported in the system category
+    std::error_code error{};
+    SerialPort missing{"/dev/libserial-missing"};
+    missing.open(std::ios_base::in | std::ios_base::out, error);
+    ASSERT_FALSE(missing.isOpen());
+    ASSERT_EQ(error, std::errc::no_such_file_or_directory);
+
+    // Throwing API attaches the same error
+    try
+    {
+        missing.open();
+        FAIL();
+    }
+    catch (const std::system_error& exception)
+    {
+        ASSERT_EQ(exception.code(), std::errc::no_such_file_or_directory);
+    }
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName(), BaudRate::BAUD_RATE_CUSTOM};
+    port.open(std::ios_base::in | std::ios_base::app, error);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+
+    // Unsupported settings passed to the constructor fail the open
+    port.open(std::ios_base::in | std::ios_base::out, error);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+    ASSERT_FALSE(port.isOpen());
+
+    port.setBaudRate(BaudRate::BAUD_RATE_9600, error);
+    ASSERT_FALSE(error);
+    port.open(std::ios_base::in | std::ios_base::out, error);
+    ASSERT_FALSE(error);
+    ASSERT_TRUE(port.isOpen());
+
+    // Unsupported properties are rejected
+    port.setStopBit(StopBit::STOP_BIT_ONE_HALF, error);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+    ASSERT_EQ(port.getStopBit(), StopBit::STOP_BIT_ONE);
+    port.setParity(Parity::PARITY_TYPE_EVEN, error);
+    ASSERT_FALSE(error);
+    ASSERT_EQ(port.getParity(), Parity::PARITY_TYPE_EVEN);
+
+    port.close(error);
+    ASSERT_FALSE(error);
+    ASSERT_FALSE(port.isOpen());
+}
+
+TEST(ErrorTest, ReadWriteTest)
+{
+    SCOPED_TRACE("ReadWriteTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    char buffer[64];
+    std::error_code error{};
+
+    // Closed port
+    ASSERT_EQ(port.read(buffer, sizeof(buffer), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_NOT_OPEN);
+    ASSERT_EQ(port.write(buffer, sizeof(buffer), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_NOT_OPEN);
+
+    port.open(std::ios_base::in | std::ios_base::out, error);
+    ASSERT_FALSE(error);
+
+    // No data available
+    ASSERT_EQ(port.read(buffer, sizeof(buffer), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_WOULD_BLOCK);
+    ASSERT_EQ(port.read(buffer, 0, error), 0U);
+    ASSERT_FALSE(error);
+
+    // Data in both directions
+    const std::string data{"error code"};
+    ASSERT_EQ(port.write(data.data(), data.size(), error), data.size());
+    ASSERT_FALSE(error);
+    ASSERT_EQ(terminal.read(data.size()), data);
+    ASSERT_EQ(terminal.write(data), data.size());
+    size_t size{0};
+    for (int attempt{0}; (attempt < 100) && (size < data.size()); ++attempt)
+    {
+        size += port.read(buffer + size, sizeof(buffer) - size, error);
+        ASSERT_TRUE(!error || (error == SerialError::SERIAL_ERROR_WOULD_BLOCK));
+    }
+    ASSERT_EQ(std::string(buffer, size), data);
+
+    // Hang-up is distinct from no data
+    terminal.closeMaster();
+    ASSERT_EQ(port.read(buffer, sizeof(buffer), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_HANGUP);
+    ASSERT_EQ(port.write(data.data(), data.size(), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_HANGUP);
+
+    // Settings of a hung up port can not be restored
+    port.close(error);
+    ASSERT_TRUE(error);
+    ASSERT_FALSE(port.isOpen());
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_decoder.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Calculate the additive checksum of data
+ *
+ * @param data Data
+ * @return char Checksum
+ */
+static char calculateChecksum(std::string_view data)
+{
+    unsigned char result{0};
+    for (const auto value: data)
+        result = static_cast<unsigned char>(result + static_cast<unsigned char>(value));
+    return static_cast<char>(result);
+}
+
+/**
+ * @brief Get the test frame layout: sync, big endian 16-bit payload length, payload, checksum
+ *
+ * @return FrameLayout Frame layout
+ */
+static FrameLayout getTestLayout()
+{
+    FrameLayout result{};
+    result.syncPattern = "\xAA\x55";
+    result.lengthOffset = 2;
+    result.lengthSize = 2;
+    result.lengthEndianness = Endianness::ENDIANNESS_BIG;
+    result.lengthAdjustment = 5;
+    result.maxFrameSize = 300;
+    result.validator = [](std::string_view frame)
+    {
+        return (calculateChecksum(frame.substr(0, frame.size() - 1)) == frame.back());
+    };
+    return result;
+}
+
+/**
+ * @brief Build a test frame
+ *
+ * @param payload Payload
+ * @return std::string Frame
+ */
+static std::string buildFrame(const std::string& payload)
+{
+    std::string result{"\xAA\x55"};
+    result += static_cast<char>(payload.size() >> 8);
+    result += static_cast<char>(payload.size() & 0xFF);
+    result += payload;
+    result += calculateChecksum(result);
+    return result;
+}
+
+/**
+ * @brief Feed data to a frame decoder in chunks and collect all frames
+ *
+ * @param frameDecoder Frame decoder
+ * @param data Data
+ * @param chunkSize Chunk size
+ * @return std::vector<std::string> Frames
+ */
+static std::vector<std::string> collectFrames(FrameDecoder& frameDecoder, const std::string& data, size_t chunkSize)
+{
+    std::vector<std::string> result{};
+    std::string_view frame{};
+    for (size_t offset{0}; offset < data.size();)
+    {
+        offset += frameDecoder.feed(data.data() + offset, std::min(chunkSize, data.size() - offset));
+        while (frameDecoder.nextFrame(frame))
+            result.emplace_back(frame);
+    }
+    return result;
+}
+
+TEST(FrameDecoderTest, InvalidLayoutTest)
+{
+    SCOPED_TRACE("InvalidLayoutTest");
+
+    SerialPort serialPort{};
+    auto frameLayout{getTestLayout()};
+    frameLayout.lengthSize = 0;
+    EXPECT_THROW(FrameDecoder(serialPort, frameLayout), std::runtime_error);
+    frameLayout.lengthSize = 9;
+    EXPECT_THROW(FrameDecoder(serialPort, frameLayout), std::runtime_error);
+    frameLayout.lengthSize = 2;
+    frameLayout.maxFrameSize = 3;
+    EXPECT_THROW(FrameDecoder(serialPort, frameLayout), std::runtime_error);
+    EXPECT_EQ(getTestLayout().getHeaderSize(), 4U);
+}
+
+TEST(FrameDecoderTest, ChunkSizeTest)
+{
+    SCOPED_TRACE("ChunkSizeTest");
+
+    SerialPort serialPort{};
+    std::vector<std::string> expected{};
+    std::string data{};
+    for (size_t index{0}; index < 200; ++index)
+    {
+        expected.push_back(buildFrame(std::string(index % 256, static_cast<char>(index))));
+        data += expected.back();
+    }
+
+    // Same frames regardless of how the data arrives
+    for (const size_t chunkSize: {1U, 3U, 17U, 4096U})
+    {
+        FrameDecoder frameDecoder{serialPort, getTestLayout(), 1024};
+        EXPECT_EQ(collectFrames(frameDecoder, data, chunkSize), expected);
+        EXPECT_EQ(frameDecoder.getFrameCount(), expected.size());
+        EXPECT_EQ(frameDecoder.getResyncCount(), 0U);
+        EXPECT_EQ(frameDecoder.getDiscardedCount(), 0U);
+        EXPECT_EQ(frameDecoder.getBufferedSize(), 0U);
+    }
+}
+
+TEST(FrameDecoderTest, ResyncTest)
+{
+    SCOPED_TRACE("ResyncTest");
+
+    SerialPort serialPort{};
+    auto corrupted{buildFrame("corrupted")};
+    corrupted[6] = 'X';
+
+    // Garbage, false sync pattern, corrupted frame and oversized length
+    const std::string data{"garbage\xAA" + buildFrame("first") + "\xAA\x55\xFF\xFF" + corrupted +
+        buildFrame("second") + "\xAA" + buildFrame("third")};
+    for (const size_t chunkSize: {1U, 5U, 4096U})
+    {
+        FrameDecoder frameDecoder{serialPort, getTestLayout()};
+        EXPECT_EQ(collectFrames(frameDecoder, data, chunkSize),
+            (std::vector<std::string>{buildFrame("first"), buildFrame("second"), buildFrame("third")}));
+        EXPECT_EQ(frameDecoder.getResyncCount(), 2U);
+        EXPECT_EQ(frameDecoder.getDiscardedCount(), 8U + 4U + corrupted.size() + 1U);
+        EXPECT_EQ(frameDecoder.getFrameLayout().lengthSize, 2U);
+    }
+}
+
+TEST(FrameDecoderTest, LittleEndianTest)
+{
+    SCOPED_TRACE("LittleEndianTest");
+
+    // Type byte followed by a little endian 24-bit frame size and no sync pattern
+    SerialPort serialPort{};
+    FrameLayout frameLayout{};
+    frameLayout.lengthOffset = 1;
+    frameLayout.lengthSize = 3;
+    frameLayout.maxFrameSize = 100;
+    FrameDecoder frameDecoder{serialPort, frameLayout};
+
+    const std::string first{"\x01\x06\x00\x00" "ab", 6};
+    const std::string second{"\x02\x04\x00\x00", 4};
+    const std::string invalid{"\x03\x00\x01\x00", 4};
+    EXPECT_EQ(collectFrames(frameDecoder, first + invalid + second, 2), (std::vector<std::string>{first, second}));
+    EXPECT_EQ(frameDecoder.getResyncCount(), 4U);
+
+    frameDecoder.reset();
+    EXPECT_EQ(frameDecoder.getBufferedSize(), 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
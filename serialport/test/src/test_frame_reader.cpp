@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/frame_reader.hpp>
+
+#ifdef __linux__
+    #include <serialport_test/test_pseudo_terminal.hpp>
+#endif // __linux__
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Feed data to a frame reader in chunks and collect all frames
+ *
+ * @param frameReader Frame reader
+ * @param data Data
+ * @param chunkSize Chunk size
+ * @return std::vector<std::string> Frames
+ */
+static std::vector<std::string> collectFrames(FrameReader& frameReader, const std::string& data, size_t chunkSize)
+{
+    std::vector<std::string> result{};
+    std::string_view frame{};
+    for (size_t offset{0}; offset < data.size();)
+    {
+        offset += frameReader.feed(data.data() + offset, std::min(chunkSize, data.size() - offset));
+        while (frameReader.nextFrame(frame))
+            result.emplace_back(frame);
+    }
+    return result;
+}
+
+TEST(FrameReaderTest, SingleByteDelimiterTest)
+{
+    SCOPED_TRACE("SingleByteDelimiterTest");
+
+    SerialPort serialPort{};
+    EXPECT_THROW(FrameReader(serialPort, ""), std::runtime_error);
+
+    const std::string data{"$GPGGA,1*00\n\n$GPRMC,2*11\npartial"};
+    const std::vector<std::string> expected{"$GPGGA,1*00", "", "$GPRMC,2*11"};
+    for (const size_t chunkSize: {1U, 3U, 7U, 64U})
+    {
+        FrameReader frameReader{serialPort};
+        EXPECT_EQ(frameReader.getDelimiter(), "\n");
+        EXPECT_EQ(collectFrames(frameReader, data, chunkSize), expected);
+        EXPECT_EQ(frameReader.getFrameCount(), 3U);
+        EXPECT_EQ(frameReader.getBufferedSize(), 7U);
+
+        frameReader.reset();
+        EXPECT_EQ(frameReader.getBufferedSize(), 0U);
+    }
+}
+
+TEST(FrameReaderTest, MultiByteDelimiterTest)
+{
+    SCOPED_TRACE("MultiByteDelimiterTest");
+
+    SerialPort serialPort{};
+    const std::string data{"AT\r\nOK\r\r\n+CSQ: 20,0\r\n\r\n"};
+    const std::vector<std::string> expected{"AT", "OK\r", "+CSQ: 20,0", ""};
+    for (const size_t chunkSize: {1U, 2U, 5U, 64U})
+    {
+        FrameReader frameReader{serialPort, "\r\n"};
+        EXPECT_EQ(collectFrames(frameReader, data, chunkSize), expected);
+        EXPECT_EQ(frameReader.getBufferedSize(), 0U);
+    }
+}
+
+TEST(FrameReaderTest, OverflowTest)
+{
+    SCOPED_TRACE("OverflowTest");
+
+    SerialPort serialPort{};
+    FrameReader frameReader{serialPort, "\r\n", 16};
+    const std::string data{"short\r\n" + std::string(100, 'x') + "\r\nnext\r\n"};
+    const std::vector<std::string> expected{"short", "next"};
+    EXPECT_EQ(collectFrames(frameReader, data, 5), expected);
+    EXPECT_EQ(frameReader.getOverflowCount(), 1U);
+    EXPECT_EQ(frameReader.getFrameCount(), 2U);
+}
+
+TEST(FrameReaderTest, LongFrameTest)
+{
+    SCOPED_TRACE("LongFrameTest");
+
+    // Long frames spanning many reads are scanned only once
+    SerialPort serialPort{};
+    FrameReader frameReader{serialPort};
+    std::string data{};
+    for (size_t index{0}; index < 64; ++index)
+        data += std::string(index * 97, static_cast<char>('a' + (index % 26))) + "\n";
+
+    const auto frames{collectFrames(frameReader, data, 1000)};
+    ASSERT_EQ(frames.size(), 64U);
+    for (size_t index{0}; index < frames.size(); ++index)
+        EXPECT_EQ(frames[index], std::string(index * 97, static_cast<char>('a' + (index % 26))));
+}
+
+#ifdef __linux__
+TEST(FrameReaderTest, SerialPortTest)
+{
+    SCOPED_TRACE("SerialPortTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    FrameReader frameReader{serialPort};
+    std::string_view frame{};
+    EXPECT_FALSE(frameReader.readFrame(frame));
+
+    EXPECT_EQ(terminal.write("first\nsec"), 9U);
+    EXPECT_EQ(terminal.write("ond\n"), 4U);
+
+    std::vector<std::string> frames{};
+    for (size_t attempt{0}; (attempt < 1000) && (frames.size() < 2); ++attempt)
+    {
+        if (frameReader.readFrame(frame))
+            frames.emplace_back(frame);
+    }
+    EXPECT_EQ(frames, (std::vector<std::string>{"first", "second"}));
+}
+#endif // __linux__
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,216 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <poll.h>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Size of the data transferred in each direction
+     *
+     */
+    static constexpr size_t TRANSFER_SIZE{64 * 1024};
+
+    /**
+     * @brief Maximum duration of a transfer
+     *
+     */
+    static constexpr std::chrono::seconds TRANSFER_TIMEOUT{20};
+
+    /**
+     * @brief Make a test pattern
+     *
+     * @param seed Pattern seed
+     * @return std::string Test pattern
+     */
+    std::string makePattern(unsigned seed)
+    {
+        std::string pattern(TRANSFER_SIZE, '\0');
+        for (size_t index{0}; index < pattern.size(); ++index)
+            pattern[index] = static_cast<char>((index * 31U + seed) & 0xFFU);
+        return pattern;
+    }
+
+    /**
+     * @brief Wait for a serial port event
+     *
+     * @param serialPort Serial port
+     * @param events Poll events
+     */
+    void waitFor(const SerialPort& serialPort, short events)
+    {
+        struct pollfd descriptor{serialPort.getNativeHandle(), events, 0};
+        ::poll(&descriptor, 1, 10);
+    }
+
+    /**
+     * @brief Write all the data from a writer thread
+     *
+     * @param serialPort Serial port
+     * @param data Data
+     * @return true All the data written
+     * @return false Write failed or timed out
+     */
+    bool writeAll(const SerialPort& serialPort, const std::string& data)
+    {
+        const auto deadline{std::chrono::steady_clock::now() + TRANSFER_TIMEOUT};
+        size_t offset{0};
+        while ((offset < data.size()) && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::error_code error{};
+            offset += serialPort.write(data.data() + offset, std::min<size_t>(data.size() - offset, 1024), error);
+            if (error == SerialError::SERIAL_ERROR_WOULD_BLOCK)
+                waitFor(serialPort, POLLOUT);
+            else if (error)
+                return false;
+        }
+        return (offset == data.size());
+    }
+
+    /**
+     * @brief Read all the data from a reader thread
+     *
+     * @param serialPort Serial port
+     * @param size Size of the data
+     * @return std::string Data read
+     */
+    std::string readAll(const SerialPort& serialPort, size_t size)
+    {
+        const auto deadline{std::chrono::steady_clock::now() + TRANSFER_TIMEOUT};
+        std::string data(size, '\0');
+        size_t offset{0};
+        while ((offset < size) && (std::chrono::steady_clock::now() < deadline))
+        {
+            std::error_code error{};
+            // Settings are only changed between I/O calls
+            const auto stopBit{serialPort.getStopBit()};
+            if ((stopBit != StopBit::STOP_BIT_ONE) && (stopBit != StopBit::STOP_BIT_TWO))
+                break;
+
+            offset += serialPort.read(&data[offset], size - offset, error);
+            if (error == SerialError::SERIAL_ERROR_WOULD_BLOCK)
+                waitFor(serialPort, POLLIN);
+            else if (error)
+                break;
+        }
+        data.resize(offset);
+        return data;
+    }
+
+    /**
+     * @brief Transfer the test patterns in both directions over a null-modem
+     *   with a reader and a writer thread per serial port
+     *
+     * @param first First serial port
+     * @param second Second serial port
+     * @param configure Function called repeatedly from the calling thread during the transfer
+     */
+    void transfer(SerialPort& first, SerialPort& second, const std::function<void()>& configure)
+    {
+        const auto firstPattern{makePattern(1)};
+        const auto secondPattern{makePattern(2)};
+        std::atomic<int> running{4};
+        bool firstWritten{false};
+        bool secondWritten{false};
+        std::string firstReceived{};
+        std::string secondReceived{};
+
+        std::thread threads[]
+        {
+            std::thread{[&]() { firstWritten = writeAll(first, firstPattern); --running; }},
+            std::thread{[&]() { secondWritten = writeAll(second, secondPattern); --running; }},
+            std::thread{[&]() { firstReceived = readAll(first, secondPattern.size()); --running; }},
+            std::thread{[&]() { secondReceived = readAll(second, firstPattern.size()); --running; }}
+        };
+
+        while (running > 0)
+        {
+            if (configure)
+                configure();
+            std::this_thread::yield();
+        }
+        for (auto& thread: threads)
+            thread.join();
+
+        ASSERT_TRUE(firstWritten);
+        ASSERT_TRUE(secondWritten);
+        ASSERT_TRUE(firstReceived == secondPattern);
+        ASSERT_TRUE(secondReceived == firstPattern);
+    }
+} // namespace
+
+TEST(FullDuplexTest, ReadWriteTest)
+{
+    SCOPED_TRACE("ReadWriteTest");
+
+    PseudoTerminal firstTerminal{};
+    PseudoTerminal secondTerminal{};
+    NullModem nullModem{firstTerminal, secondTerminal};
+    SerialPort first{firstTerminal.getSlaveName()};
+    SerialPort second{secondTerminal.getSlaveName()};
+    first.open();
+    second.open();
+
+    // Concurrent reads and writes do not wait for each other
+    transfer(first, second, nullptr);
+}
+
+TEST(FullDuplexTest, ConfigurationTest)
+{
+    SCOPED_TRACE("ConfigurationTest");
+
+    PseudoTerminal firstTerminal{};
+    PseudoTerminal secondTerminal{};
+    NullModem nullModem{firstTerminal, secondTerminal};
+    SerialPort first{firstTerminal.getSlaveName()};
+    SerialPort second{secondTerminal.getSlaveName()};
+    first.open();
+    second.open();
+
+    // Configuration changes are serialized against in-flight I/O
+    unsigned changeCount{0};
+    transfer(first, second, [&]()
+    {
+        const auto baudRate{((changeCount % 2) == 0) ? BaudRate::BAUD_RATE_115200 : BaudRate::BAUD_RATE_9600};
+        first.setBaudRate(baudRate);
+        second.setStopBit(((changeCount % 2) == 0) ? StopBit::STOP_BIT_TWO : StopBit::STOP_BIT_ONE);
+        if ((first.getBaudRate() == baudRate) && first.isOpen() && second.isOpen())
+            ++changeCount;
+    });
+    ASSERT_GT(changeCount, 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
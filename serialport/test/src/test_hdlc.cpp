@@ -0,0 +1,208 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/hdlc.hpp>
+
+#ifdef __linux__
+    #include <serialport_test/test_pseudo_terminal.hpp>
+#endif // __linux__
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Encode a frame into a string
+ *
+ * @param data Frame data
+ * @param frameCheck Frame check sequence
+ * @return std::string Encoded frame
+ */
+static std::string encodeHdlc(const std::string& data, HdlcFrameCheck frameCheck)
+{
+    std::string result(HdlcCodec::getMaxEncodedSize(data.size(), frameCheck), '\0');
+    result.resize(HdlcCodec::encode(data.data(), data.size(), result.data(), frameCheck));
+    return result;
+}
+
+/**
+ * @brief Feed data to a HDLC codec in chunks and collect all frames
+ *
+ * @param hdlcCodec HDLC codec
+ * @param data Data
+ * @param chunkSize Chunk size
+ * @return std::vector<std::string> Frames
+ */
+static std::vector<std::string> collectFrames(HdlcCodec& hdlcCodec, const std::string& data, size_t chunkSize)
+{
+    std::vector<std::string> result{};
+    std::string_view frame{};
+    for (size_t offset{0}; offset < data.size();)
+    {
+        offset += hdlcCodec.feed(data.data() + offset, std::min(chunkSize, data.size() - offset));
+        while (hdlcCodec.nextFrame(frame))
+            result.emplace_back(frame);
+    }
+    return result;
+}
+
+TEST(HdlcCodecTest, FrameCheckFunctionTest)
+{
+    SCOPED_TRACE("FrameCheckFunctionTest");
+
+    // Check values of CRC-16/X-25 and CRC-32
+    const std::string check{"123456789"};
+    EXPECT_EQ(HdlcCodec::calculateFrameCheck(check.data(), check.size(), HdlcFrameCheck::HDLC_FRAME_CHECK_16), 0x906EU);
+    EXPECT_EQ(HdlcCodec::calculateFrameCheck(check.data(), check.size(), HdlcFrameCheck::HDLC_FRAME_CHECK_32), 0xCBF43926U);
+    EXPECT_EQ(HdlcCodec::calculateFrameCheck(check.data(), 0, HdlcFrameCheck::HDLC_FRAME_CHECK_16), 0x0000U);
+    EXPECT_EQ(HdlcCodec::getFrameCheckSize(HdlcFrameCheck::HDLC_FRAME_CHECK_16), 2U);
+    EXPECT_EQ(HdlcCodec::getFrameCheckSize(HdlcFrameCheck::HDLC_FRAME_CHECK_32), 4U);
+}
+
+TEST(HdlcCodecTest, EncodeFunctionTest)
+{
+    SCOPED_TRACE("EncodeFunctionTest");
+
+    EXPECT_EQ(encodeHdlc("123456789", HdlcFrameCheck::HDLC_FRAME_CHECK_16), "\x7E" "123456789\x6E\x90\x7E");
+    EXPECT_EQ(encodeHdlc("123456789", HdlcFrameCheck::HDLC_FRAME_CHECK_32), "\x7E" "123456789\x26\x39\xF4\xCB\x7E");
+
+    // Flag and escape bytes within data are escaped
+    const auto encoded{encodeHdlc("a\x7E" "b\x7D", HdlcFrameCheck::HDLC_FRAME_CHECK_16)};
+    EXPECT_EQ(encoded.substr(0, 7), "\x7E" "a\x7D\x5E" "b\x7D\x5D");
+    EXPECT_EQ(encoded.find('\x7E', 1), encoded.size() - 1);
+}
+
+TEST(HdlcCodecTest, DecodeTest)
+{
+    SCOPED_TRACE("DecodeTest");
+
+    std::string binary{};
+    for (size_t index{0}; index < 1000; ++index)
+        binary += static_cast<char>(index * 7);
+
+    SerialPort serialPort{};
+    for (const auto frameCheck: {HdlcFrameCheck::HDLC_FRAME_CHECK_16, HdlcFrameCheck::HDLC_FRAME_CHECK_32})
+    {
+        const std::vector<std::string> expected{"first", binary, std::string("\x7E\x7D\x7E", 3), "x"};
+        std::string data{};
+        for (const auto& frame: expected)
+            data += encodeHdlc(frame, frameCheck);
+
+        for (const size_t chunkSize: {1U, 3U, 64U, 8192U})
+        {
+            HdlcCodec hdlcCodec{serialPort, frameCheck, 1024, 256};
+            EXPECT_EQ(hdlcCodec.getFrameCheck(), frameCheck);
+            EXPECT_EQ(collectFrames(hdlcCodec, data, chunkSize), expected);
+            EXPECT_TRUE(hdlcCodec.isIdle());
+
+            const auto statistics{hdlcCodec.getStatistics()};
+            EXPECT_EQ(statistics.frameCount, expected.size());
+            EXPECT_EQ(statistics.crcErrorCount, 0U);
+            EXPECT_EQ(statistics.idleFlagCount, expected.size());
+        }
+    }
+}
+
+TEST(HdlcCodecTest, ErrorTest)
+{
+    SCOPED_TRACE("ErrorTest");
+
+    SerialPort serialPort{};
+    HdlcCodec hdlcCodec{serialPort, HdlcFrameCheck::HDLC_FRAME_CHECK_16, 16};
+
+    auto corrupted{encodeHdlc("corrupted", HdlcFrameCheck::HDLC_FRAME_CHECK_16)};
+    corrupted[3] = 'X';
+
+    // Noise before the first flag, idle flags, abort, runt, CRC error and oversized frame
+    const std::string data{"noise\x7E\x7E\x7E" "aborted\x7D\x7E" + encodeHdlc("one", HdlcFrameCheck::HDLC_FRAME_CHECK_16) +
+        "\x01\x7E" + corrupted + encodeHdlc(std::string(40, 'x'), HdlcFrameCheck::HDLC_FRAME_CHECK_16) +
+        encodeHdlc("two", HdlcFrameCheck::HDLC_FRAME_CHECK_16) + "\x7E\x7E" "partial"};
+    EXPECT_EQ(collectFrames(hdlcCodec, data, 5), (std::vector<std::string>{"one", "two"}));
+    EXPECT_FALSE(hdlcCodec.isIdle());
+
+    const auto statistics{hdlcCodec.getStatistics()};
+    EXPECT_EQ(statistics.frameCount, 2U);
+    EXPECT_EQ(statistics.abortCount, 1U);
+    EXPECT_EQ(statistics.runtCount, 1U);
+    EXPECT_EQ(statistics.crcErrorCount, 1U);
+    EXPECT_EQ(statistics.overflowCount, 1U);
+    EXPECT_EQ(statistics.idleFlagCount, 9U);
+
+    hdlcCodec.reset();
+    EXPECT_TRUE(hdlcCodec.isIdle());
+}
+
+#ifdef __linux__
+TEST(HdlcCodecTest, SerialPortTest)
+{
+    SCOPED_TRACE("SerialPortTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    HdlcCodec hdlcCodec{serialPort, HdlcFrameCheck::HDLC_FRAME_CHECK_32};
+    const std::string frame{"\x7E" "frame\x7D"};
+    const auto encoded{encodeHdlc(frame, HdlcFrameCheck::HDLC_FRAME_CHECK_32)};
+    EXPECT_TRUE(hdlcCodec.writeFrame(frame.data(), frame.size()));
+    EXPECT_EQ(terminal.read(encoded.size()), encoded);
+
+    terminal.write(encoded);
+    std::string_view received{};
+    bool result{false};
+    for (size_t attempt{0}; (attempt < 1000) && !result; ++attempt)
+        result = hdlcCodec.readFrame(received);
+    EXPECT_TRUE(result);
+    EXPECT_EQ(received, frame);
+}
+
+TEST(HdlcCodecTest, LargeFrameTest)
+{
+    SCOPED_TRACE("LargeFrameTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    // Frame larger than the terminal buffer is written whole while the peer reads
+    HdlcCodec hdlcCodec{serialPort, HdlcFrameCheck::HDLC_FRAME_CHECK_16};
+    std::string frame(256 * 1024, '\0');
+    for (size_t index{0}; index < frame.size(); ++index)
+        frame[index] = static_cast<char>(index * 7);
+    const auto encoded{encodeHdlc(frame, HdlcFrameCheck::HDLC_FRAME_CHECK_16)};
+    bool written{false};
+    std::thread writer{[&hdlcCodec, &frame, &written]() { written = hdlcCodec.writeFrame(frame.data(), frame.size()); }};
+    EXPECT_EQ(terminal.read(encoded.size(), std::chrono::milliseconds{10000}), encoded);
+    writer.join();
+    EXPECT_TRUE(written);
+
+    // Peer which stops reading fails the frame after the timeout
+    EXPECT_FALSE(hdlcCodec.writeFrame(frame.data(), frame.size(), std::chrono::milliseconds{20}));
+}
+#endif // __linux__
+
+END_NAMESPACE_LIBSERIAL
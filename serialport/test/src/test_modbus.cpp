@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(ModbusTest, TimingTest)
+{
+    SCOPED_TRACE("TimingTest");
+
+    // 12 bit times per character with even parity including the idle bit of calculateTime
+    const auto slowTiming{calculateModbusTiming(BaudRate::BAUD_RATE_9600, CharacterSize::CHARACTER_SIZE_8,
+        Parity::PARITY_TYPE_EVEN, StopBit::STOP_BIT_ONE)};
+    EXPECT_EQ(slowTiming.characterTime.count(), 1250);
+    EXPECT_EQ(slowTiming.interCharacterTimeout.count(), 1875);
+    EXPECT_EQ(slowTiming.interFrameDelay.count(), 4375);
+
+    // Fixed timing above 19200 baud
+    const auto fastTiming{calculateModbusTiming(BaudRate::BAUD_RATE_115200, CharacterSize::CHARACTER_SIZE_8,
+        Parity::PARITY_TYPE_NONE, StopBit::STOP_BIT_ONE)};
+    EXPECT_EQ(fastTiming.characterTime.count(), 96);
+    EXPECT_EQ(fastTiming.interCharacterTimeout.count(), 750);
+    EXPECT_EQ(fastTiming.interFrameDelay.count(), 1750);
+}
+
+TEST(ModbusTest, CrcTest)
+{
+    SCOPED_TRACE("CrcTest");
+
+    char frame[8]{'\x01', '\x03', '\x00', '\x00', '\x00', '\x0A'};
+    EXPECT_EQ(appendModbusCrc(frame, 6), 8U);
+    EXPECT_EQ(static_cast<uint8_t>(frame[6]), 0xC5U);
+    EXPECT_EQ(static_cast<uint8_t>(frame[7]), 0xCDU);
+    EXPECT_TRUE(checkModbusCrc(frame, 8));
+
+    frame[3] = '\x01';
+    EXPECT_FALSE(checkModbusCrc(frame, 8));
+    EXPECT_FALSE(checkModbusCrc(frame, 3));
+}
+
+TEST(ModbusTest, FrameSizeTest)
+{
+    SCOPED_TRACE("FrameSizeTest");
+
+    // Requests
+    EXPECT_EQ(getModbusFrameSize("\x01", 1, true), 0U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x03", 2, true), 8U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x11", 2, true), 4U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x10\x00\x00\x00\x02", 6, true), 0U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x10\x00\x00\x00\x02\x04", 7, true), 13U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x16", 2, true), 10U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x2B", 2, true), static_cast<size_t>(-1));
+
+    // Responses
+    EXPECT_EQ(getModbusFrameSize("\x01\x03\x04", 3, false), 9U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x83", 2, false), 5U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x10", 2, false), 8U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x07", 2, false), 5U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x18\x00\x06", 4, false), 12U);
+    EXPECT_EQ(getModbusFrameSize("\x01\x2B", 2, false), static_cast<size_t>(-1));
+}
+
+TEST(ModbusTest, BitPackingTest)
+{
+    SCOPED_TRACE("BitPackingTest");
+
+    const bool values[10]{true, false, true, true, false, false, true, false, false, true};
+    char data[2]{};
+    packModbusBits(values, 10, data);
+    EXPECT_EQ(static_cast<uint8_t>(data[0]), 0x4DU);
+    EXPECT_EQ(static_cast<uint8_t>(data[1]), 0x02U);
+
+    bool unpacked[10]{};
+    unpackModbusBits(data, 10, unpacked);
+    for (size_t index{0}; index < 10; ++index)
+        EXPECT_EQ(unpacked[index], values[index]);
+}
+
+END_NAMESPACE_LIBSERIAL
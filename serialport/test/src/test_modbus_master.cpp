@@ -0,0 +1,223 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_master.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Append the Modbus CRC to a frame
+ *
+ * @param frame Frame without the CRC
+ * @return std::string Frame including the CRC
+ */
+static std::string makeFrame(std::string frame)
+{
+    frame.resize(frame.size() + 2);
+    appendModbusCrc(&frame[0], frame.size() - 2);
+    return frame;
+}
+
+/**
+ * @brief Answer a single request on the master side of a pseudo-terminal
+ *
+ * @param terminal Pseudo-terminal
+ * @param requestSize Size of the expected request
+ * @param response Response written after the request was received
+ * @param request Received request
+ * @return std::thread Responder thread
+ */
+static std::thread respond(PseudoTerminal& terminal, size_t requestSize, std::string response, std::string& request)
+{
+    return std::thread{[&terminal, requestSize, response, &request]()
+    {
+        request = terminal.read(requestSize);
+        if (!response.empty())
+            terminal.write(response);
+    }};
+}
+
+TEST(ModbusMasterTest, ReadRegistersTest)
+{
+    SCOPED_TRACE("ReadRegistersTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    ModbusMaster master{serialPort};
+
+    // Response of another unit precedes the matching response
+    std::string request;
+    auto thread{respond(terminal, 8, makeFrame(std::string("\x02\x03\x02\x00\x01", 5)) +
+        makeFrame(std::string("\x01\x03\x04\x12\x34\xAB\xCD", 7)), request)};
+    uint16_t values[2]{};
+    EXPECT_EQ(master.readHoldingRegisters(1, 0x0010, 2, values), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(request, makeFrame(std::string("\x01\x03\x00\x10\x00\x02", 6)));
+    EXPECT_EQ(values[0], 0x1234U);
+    EXPECT_EQ(values[1], 0xABCDU);
+
+    // Coils
+    thread = respond(terminal, 8, makeFrame(std::string("\x01\x01\x02\x4D\x02", 5)), request);
+    bool coils[10]{};
+    EXPECT_EQ(master.readCoils(1, 0x0000, 10, coils), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_TRUE(coils[0]);
+    EXPECT_FALSE(coils[1]);
+    EXPECT_TRUE(coils[9]);
+
+    // Byte count not matching the request
+    thread = respond(terminal, 8, makeFrame(std::string("\x01\x04\x02\x00\x01", 5)), request);
+    EXPECT_EQ(master.readInputRegisters(1, 0x0000, 2, values), ModbusStatus::MODBUS_INVALID_FRAME);
+    thread.join();
+
+    const auto statistics{master.getLink().getStatistics()};
+    EXPECT_EQ(statistics.transmittedCount, 3U);
+    EXPECT_EQ(statistics.receivedCount, 4U);
+    EXPECT_EQ(statistics.earlyCompletionCount, 4U);
+}
+
+TEST(ModbusMasterTest, WriteTest)
+{
+    SCOPED_TRACE("WriteTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    ModbusMaster master{serialPort};
+
+    std::string request;
+    auto thread{respond(terminal, 8, makeFrame(std::string("\x01\x05\x00\x07\xFF\x00", 6)), request)};
+    EXPECT_EQ(master.writeSingleCoil(1, 0x0007, true), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(request, makeFrame(std::string("\x01\x05\x00\x07\xFF\x00", 6)));
+
+    const uint16_t values[2]{0x0102, 0x0304};
+    thread = respond(terminal, 13, makeFrame(std::string("\x01\x10\x00\x20\x00\x02", 6)), request);
+    EXPECT_EQ(master.writeMultipleRegisters(1, 0x0020, 2, values), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(request, makeFrame(std::string("\x01\x10\x00\x20\x00\x02\x04\x01\x02\x03\x04", 11)));
+
+    // Echo not matching the request
+    thread = respond(terminal, 8, makeFrame(std::string("\x01\x06\x00\x01\x00\x02", 6)), request);
+    EXPECT_EQ(master.writeSingleRegister(1, 0x0001, 0x0003), ModbusStatus::MODBUS_INVALID_FRAME);
+    thread.join();
+
+    // Broadcast is not answered
+    master.setTurnaroundDelay(std::chrono::milliseconds{5});
+    thread = respond(terminal, 8, std::string(), request);
+    EXPECT_EQ(master.writeSingleRegister(MODBUS_BROADCAST_ADDRESS, 0x0001, 0x0003), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(request.size(), 8U);
+    EXPECT_EQ(master.readHoldingRegisters(MODBUS_BROADCAST_ADDRESS, 0, 1, const_cast<uint16_t*>(values)),
+        ModbusStatus::MODBUS_INVALID_REQUEST);
+
+    // Protocol limits
+    EXPECT_EQ(master.writeMultipleRegisters(1, 0, 0, values), ModbusStatus::MODBUS_INVALID_REQUEST);
+    EXPECT_EQ(master.writeMultipleRegisters(1, 0, MODBUS_MAX_WRITE_REGISTERS + 1, values), ModbusStatus::MODBUS_INVALID_REQUEST);
+}
+
+TEST(ModbusMasterTest, ErrorTest)
+{
+    SCOPED_TRACE("ErrorTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    ModbusMaster master{serialPort};
+    master.setResponseTimeout(std::chrono::milliseconds{50});
+
+    // Exception response
+    std::string request;
+    auto thread{respond(terminal, 8, makeFrame(std::string("\x01\x83\x02", 3)), request)};
+    uint16_t value{};
+    EXPECT_EQ(master.readHoldingRegisters(1, 0x1000, 1, &value), ModbusStatus::MODBUS_EXCEPTION);
+    thread.join();
+    EXPECT_EQ(master.getLastException(), ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS);
+
+    // Corrupted response
+    auto response{makeFrame(std::string("\x01\x03\x02\x00\x01", 5))};
+    response[4] = '\x02';
+    thread = respond(terminal, 8, response, request);
+    EXPECT_EQ(master.readHoldingRegisters(1, 0x0000, 1, &value), ModbusStatus::MODBUS_CRC_ERROR);
+    thread.join();
+
+    // Truncated response ends with the inter-frame delay
+    thread = respond(terminal, 8, std::string("\x01\x03\x02\x00", 4), request);
+    EXPECT_EQ(master.readHoldingRegisters(1, 0x0000, 1, &value), ModbusStatus::MODBUS_INVALID_FRAME);
+    thread.join();
+
+    // No response
+    const auto start{std::chrono::steady_clock::now()};
+    EXPECT_EQ(master.readHoldingRegisters(2, 0x0000, 1, &value), ModbusStatus::MODBUS_TIMEOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{50});
+    EXPECT_EQ(terminal.read(8).size(), 8U);
+}
+
+TEST(ModbusMasterTest, TransactTest)
+{
+    SCOPED_TRACE("TransactTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    ModbusMaster master{serialPort};
+
+    // Read device identification response size is only known from the inter-frame delay
+    std::string request;
+    const std::string identification{"\x0E\x01\x01\x00\x00\x01\x00\x04" "ACME", 12};
+    auto thread{respond(terminal, 7, makeFrame(std::string("\x01\x2B", 2) + identification), request)};
+    std::string_view response;
+    EXPECT_EQ(master.encapsulatedInterfaceTransport(1, 0x0E, "\x01\x00", 2, response), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(request, makeFrame(std::string("\x01\x2B\x0E\x01\x00", 5)));
+    EXPECT_EQ(response, identification.substr(1));
+    EXPECT_EQ(master.getLink().getStatistics().earlyCompletionCount, 0U);
+
+    // FIFO queue
+    thread = respond(terminal, 6, makeFrame(std::string("\x01\x18\x00\x06\x00\x02\x01\xB8\x12\x84", 10)), request);
+    uint16_t values[MODBUS_MAX_FIFO_COUNT]{};
+    uint16_t count{};
+    EXPECT_EQ(master.readFifoQueue(1, 0x04DE, values, count), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(count, 2U);
+    EXPECT_EQ(values[0], 0x01B8U);
+    EXPECT_EQ(values[1], 0x1284U);
+
+    // Diagnostics echo
+    thread = respond(terminal, 8, makeFrame(std::string("\x01\x08\x00\x00\xA5\x37", 6)), request);
+    uint16_t result{};
+    EXPECT_EQ(master.diagnostics(1, 0x0000, 0xA537, result), ModbusStatus::MODBUS_SUCCESS);
+    thread.join();
+    EXPECT_EQ(result, 0xA537U);
+}
+
+END_NAMESPACE_LIBSERIAL
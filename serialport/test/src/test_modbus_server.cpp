@@ -0,0 +1,200 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/modbus.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/modbus_master.hpp>
+#include <serialport/linux/modbus_server.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(ModbusServerTest, ServeTest)
+{
+    SCOPED_TRACE("ServeTest");
+
+    PseudoTerminal masterTerminal{};
+    PseudoTerminal serverTerminal{};
+    NullModem nullModem{masterTerminal, serverTerminal};
+    SerialPort masterPort{masterTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    SerialPort serverPort{serverTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(masterPort.open());
+    ASSERT_NO_THROW(serverPort.open());
+    EXPECT_THROW(ModbusServer(serverPort, MODBUS_BROADCAST_ADDRESS, 1, 1, 1, 1), std::out_of_range);
+
+    ModbusServer server{serverPort, 17, 20, 8, 16, 4};
+    ModbusMaster master{masterPort};
+
+    // Input register refreshed by the read hook, writes recorded by the write hook
+    uint16_t refreshCount{0};
+    uint16_t lastWriteAddress{0};
+    server.setReadHook([&server, &refreshCount](ModbusFunction function, uint16_t, uint16_t)
+    {
+        if (function == ModbusFunction::MODBUS_READ_INPUT_REGISTERS)
+            server.getInputRegisters()[0] = ++refreshCount;
+        return ModbusException::MODBUS_EXCEPTION_NONE;
+    });
+    server.setWriteHook([&lastWriteAddress](ModbusFunction, uint16_t address, uint16_t)
+    {
+        lastWriteAddress = address;
+        return ((address == 15) ? ModbusException::MODBUS_SERVER_DEVICE_FAILURE : ModbusException::MODBUS_EXCEPTION_NONE);
+    });
+    server.getDiscreteInputs()[3] = true;
+    std::thread thread{[&server]() { server.run(); }};
+
+    // Registers
+    const uint16_t written[3]{0x1111, 0x2222, 0x3333};
+    uint16_t values[4]{};
+    EXPECT_EQ(master.writeMultipleRegisters(17, 4, 3, written), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.readHoldingRegisters(17, 4, 3, values), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(values[0], 0x1111U);
+    EXPECT_EQ(values[2], 0x3333U);
+    EXPECT_EQ(master.maskWriteRegister(17, 5, 0x00F2, 0x0025), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.readWriteMultipleRegisters(17, 5, 1, values, 0, 1, written), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(values[0], 0x0027U);
+    EXPECT_EQ(lastWriteAddress, 0U);
+    EXPECT_EQ(master.readInputRegisters(17, 0, 1, values), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.readInputRegisters(17, 0, 1, values), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(values[0], 2U);
+
+    // Coils and discrete inputs
+    const bool coils[3]{true, false, true};
+    bool bits[8]{};
+    EXPECT_EQ(master.writeMultipleCoils(17, 9, 3, coils), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.writeSingleCoil(17, 10, true), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.readCoils(17, 9, 3, bits), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_TRUE(bits[0] && bits[1] && bits[2]);
+    EXPECT_EQ(master.readDiscreteInputs(17, 0, 8, bits), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_TRUE(bits[3]);
+    EXPECT_FALSE(bits[4]);
+
+    // Exceptions
+    EXPECT_EQ(master.readHoldingRegisters(17, 14, 3, values), ModbusStatus::MODBUS_EXCEPTION);
+    EXPECT_EQ(master.getLastException(), ModbusException::MODBUS_ILLEGAL_DATA_ADDRESS);
+    EXPECT_EQ(master.writeSingleRegister(17, 15, 1), ModbusStatus::MODBUS_EXCEPTION);
+    EXPECT_EQ(master.getLastException(), ModbusException::MODBUS_SERVER_DEVICE_FAILURE);
+    uint8_t exceptionStatus{};
+    EXPECT_EQ(master.readExceptionStatus(17, exceptionStatus), ModbusStatus::MODBUS_EXCEPTION);
+    EXPECT_EQ(master.getLastException(), ModbusException::MODBUS_ILLEGAL_FUNCTION);
+
+    // Serial line functions
+    uint16_t result{};
+    uint16_t status{};
+    uint16_t eventCount{};
+    std::string_view serverId;
+    EXPECT_EQ(master.diagnostics(17, 0x0000, 0x55AA, result), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(result, 0x55AAU);
+    EXPECT_EQ(master.reportServerId(17, serverId), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(serverId, std::string_view("\x11\xFF", 2));
+    EXPECT_EQ(master.getCommEventCounter(17, status, eventCount), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(eventCount, 12U);
+
+    // Broadcast and other units
+    master.setTurnaroundDelay(std::chrono::milliseconds{5});
+    master.setResponseTimeout(std::chrono::milliseconds{20});
+    EXPECT_EQ(master.writeSingleRegister(MODBUS_BROADCAST_ADDRESS, 0, 0xBEEF), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(master.readHoldingRegisters(18, 0, 1, values), ModbusStatus::MODBUS_TIMEOUT);
+    EXPECT_EQ(master.readHoldingRegisters(17, 0, 1, values), ModbusStatus::MODBUS_SUCCESS);
+    EXPECT_EQ(values[0], 0xBEEFU);
+
+    server.stop();
+    thread.join();
+
+    const auto statistics{server.getStatistics()};
+    EXPECT_EQ(statistics.requestCount, 18U);
+    EXPECT_EQ(statistics.broadcastCount, 1U);
+    EXPECT_EQ(statistics.exceptionCount, 3U);
+    EXPECT_EQ(statistics.ignoredCount, 1U);
+    EXPECT_EQ(statistics.responseCount, 17U);
+}
+
+TEST(ModbusServerTest, StopTest)
+{
+    SCOPED_TRACE("StopTest");
+
+    PseudoTerminal serverTerminal{};
+    SerialPort serverPort{serverTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serverPort.open());
+
+    ModbusServer server{serverPort, 1, 0, 0, 1, 0};
+
+    // Stop requested before the thread enters run() is not lost
+    server.stop();
+    auto start{std::chrono::steady_clock::now()};
+    std::thread thread{[&server]() { server.run(); }};
+    thread.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{500});
+
+    // Stop ends an idle wait without waiting for the receive timeout
+    thread = std::thread{[&server]() { server.run(); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    start = std::chrono::steady_clock::now();
+    server.stop();
+    thread.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{500});
+    EXPECT_EQ(server.getStatistics().requestCount, 0U);
+}
+
+TEST(ModbusServerTest, BackToBackTest)
+{
+    SCOPED_TRACE("BackToBackTest");
+
+    PseudoTerminal masterTerminal{};
+    PseudoTerminal serverTerminal{};
+    NullModem nullModem{masterTerminal, serverTerminal};
+    SerialPort masterPort{masterTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    SerialPort serverPort{serverTerminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(masterPort.open());
+    ASSERT_NO_THROW(serverPort.open());
+
+    ModbusServer server{serverPort, 1, 0, 0, MODBUS_MAX_READ_REGISTERS, 0};
+    ModbusMaster master{masterPort};
+    std::thread thread{[&server]() { server.run(); }};
+
+    // Back-to-back reads of the maximum number of holding registers
+    constexpr unsigned long REQUEST_COUNT{200};
+    uint16_t values[MODBUS_MAX_READ_REGISTERS]{};
+    for (unsigned long index{0}; index < REQUEST_COUNT; ++index)
+    {
+        server.getHoldingRegisters()[0] = static_cast<uint16_t>(index);
+        ASSERT_EQ(master.readHoldingRegisters(1, 0, MODBUS_MAX_READ_REGISTERS, values), ModbusStatus::MODBUS_SUCCESS);
+        EXPECT_EQ(values[0], index);
+    }
+
+    server.stop();
+    thread.join();
+
+    // Response latency is measured by benchmark_modbus_server, wall-clock bounds do not hold under sanitizers
+    const auto statistics{server.getStatistics()};
+    EXPECT_EQ(statistics.responseCount, REQUEST_COUNT);
+    EXPECT_EQ(statistics.requestCount, REQUEST_COUNT);
+    EXPECT_GT(statistics.maxResponseLatency.count(), 0);
+}
+
+END_NAMESPACE_LIBSERIAL
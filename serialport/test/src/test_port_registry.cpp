@@ -0,0 +1,235 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/timer_wheel.hpp>
+#include <serialport/linux/port_registry.hpp>
+#include <serialport/linux/timer_dispatcher.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(PortRegistryTest, MoveTest)
+{
+    SCOPED_TRACE("MoveTest");
+
+    PseudoTerminal terminal{};
+    SerialPort first{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    first.open();
+    const auto handle{first.getNativeHandle()};
+
+    // Moved serial port keeps its descriptor and settings
+    SerialPort second{std::move(first)};
+    ASSERT_FALSE(first.isOpen());
+    ASSERT_EQ(first.getNativeHandle(), INVALID_FILE_DESCRIPTOR);
+    ASSERT_TRUE(second.isOpen());
+    ASSERT_EQ(second.getNativeHandle(), handle);
+    ASSERT_EQ(second.getBaudRate(), BaudRate::BAUD_RATE_115200);
+    ASSERT_EQ(second.write("move", 4), 4U);
+    ASSERT_EQ(terminal.read(4), "move");
+
+    // Move-assignment closes the assigned serial port
+    PseudoTerminal other{};
+    SerialPort third{other.getSlaveName()};
+    third.open();
+    third = std::move(second);
+    ASSERT_EQ(third.getNativeHandle(), handle);
+    ASSERT_NE(::fcntl(handle, F_GETFD), -1);
+    first = std::move(third);
+    ASSERT_EQ(first.getNativeHandle(), handle);
+
+    // Destroying a hung up serial port does not throw
+    auto port{std::make_unique<SerialPort>(std::move(first))};
+    terminal.closeMaster();
+    port.reset();
+}
+
+TEST(PortRegistryTest, HandleTest)
+{
+    SCOPED_TRACE("HandleTest");
+
+    PortRegistry registry{4};
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals{};
+    std::vector<PortHandle> handles{};
+    for (int port{0}; port < 4; ++port)
+    {
+        terminals.push_back(std::make_unique<PseudoTerminal>());
+        handles.push_back(registry.add(SerialPort{terminals.back()->getSlaveName()}));
+        ASSERT_NE(handles.back(), INVALID_PORT_HANDLE);
+        ASSERT_EQ(registry.getHandle(static_cast<size_t>(port)), handles.back());
+    }
+    ASSERT_EQ(registry.getSize(), 4U);
+    ASSERT_FALSE(registry.contains(INVALID_PORT_HANDLE));
+    ASSERT_THROW(registry.getHandle(4), std::out_of_range);
+
+    // Removed port is returned and its handle is rejected
+    auto removed{registry.remove(handles[1])};
+    ASSERT_EQ(removed.getPortName(), terminals[1]->getSlaveName());
+    ASSERT_FALSE(registry.contains(handles[1]));
+    ASSERT_THROW(registry.getPort(handles[1]), std::out_of_range);
+    ASSERT_THROW(registry.remove(handles[1]), std::out_of_range);
+    ASSERT_EQ(registry.getSize(), 3U);
+
+    // Remaining handles still refer to their ports
+    for (const auto port: {0, 2, 3})
+    {
+        ASSERT_TRUE(registry.contains(handles[port]));
+        ASSERT_EQ(registry.getPort(handles[port]).getPortName(), terminals[port]->getSlaveName());
+    }
+
+    // Reused slot gets a new handle
+    const auto handle{registry.add(std::move(removed))};
+    ASSERT_NE(handle, handles[1]);
+    ASSERT_EQ(static_cast<uint32_t>(handle), static_cast<uint32_t>(handles[1]));
+    ASSERT_FALSE(registry.contains(handles[1]));
+    ASSERT_EQ(registry.getPort(handle).getPortName(), terminals[1]->getSlaveName());
+}
+
+TEST(PortRegistryTest, PollTest)
+{
+    SCOPED_TRACE("PollTest");
+
+    PortRegistry registry{};
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals{};
+    std::vector<PortHandle> handles{};
+    std::error_code error{};
+    for (int port{0}; port < 3; ++port)
+    {
+        terminals.push_back(std::make_unique<PseudoTerminal>());
+        handles.push_back(registry.add(SerialPort{terminals.back()->getSlaveName()}));
+        registry.open(handles.back(), std::ios_base::in | std::ios_base::out, error);
+        ASSERT_FALSE(error);
+    }
+
+    // Closed ports are not polled
+    registry.close(handles[2], error);
+    ASSERT_FALSE(error);
+    terminals[2]->write("closed");
+    ASSERT_EQ(registry.poll(std::chrono::milliseconds{0}, nullptr), 0U);
+
+    // Only ports with data are reported
+    ASSERT_EQ(terminals[1]->write("registry"), 8U);
+    std::vector<PortHandle> ready{};
+    ASSERT_EQ(registry.poll(std::chrono::milliseconds{1000}, [&ready](PortHandle handle, short events)
+    {
+        ASSERT_NE(events & POLLIN, 0);
+        ready.push_back(handle);
+    }), 1U);
+    ASSERT_EQ(ready, std::vector<PortHandle>{handles[1]});
+
+    // Counters are updated by reads and writes
+    char buffer[16];
+    ASSERT_EQ(registry.read(handles[1], buffer, sizeof(buffer), error), 8U);
+    ASSERT_EQ(std::string(buffer, 8), "registry");
+    ASSERT_EQ(registry.write(handles[0], "data", 4, error), 4U);
+    ASSERT_EQ(terminals[0]->read(4), "data");
+    ASSERT_EQ(registry.read(handles[0], buffer, sizeof(buffer), error), 0U);
+    ASSERT_EQ(error, SerialError::SERIAL_ERROR_WOULD_BLOCK);
+    ASSERT_EQ(registry.getCounters(handles[1]).receivedCount, 8U);
+    ASSERT_EQ(registry.getCounters(handles[0]).transmittedCount, 4U);
+    ASSERT_EQ(registry.getCounters(handles[0]).errorCount, 0U);
+
+    // Hang-up is reported and the port may be removed from the handler
+    terminals[0]->closeMaster();
+    ASSERT_EQ(registry.poll(std::chrono::milliseconds{1000}, [&registry](PortHandle handle, short events)
+    {
+        ASSERT_NE(events & POLLHUP, 0);
+        ASSERT_TRUE(registry.isHungUp(handle));
+        registry.remove(handle);
+    }), 1U);
+    ASSERT_FALSE(registry.contains(handles[0]));
+    ASSERT_EQ(registry.getSize(), 2U);
+
+    const auto counters{registry.getTotalCounters()};
+    ASSERT_EQ(counters.receivedCount, 8U);
+    ASSERT_EQ(counters.transmittedCount, 0U);
+    registry.resetCounters();
+    ASSERT_EQ(registry.getCounters(handles[1]).receivedCount, 0U);
+}
+
+TEST(PortRegistryTest, TimerTest)
+{
+    SCOPED_TRACE("TimerTest");
+
+    PortRegistry registry{};
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals{};
+    std::vector<PortHandle> handles{};
+    std::error_code error{};
+    for (int port{0}; port < 2; ++port)
+    {
+        terminals.push_back(std::make_unique<PseudoTerminal>());
+        handles.push_back(registry.add(SerialPort{terminals.back()->getSlaveName()}));
+        registry.open(handles.back(), std::ios_base::in | std::ios_base::out, error);
+        ASSERT_FALSE(error);
+    }
+
+    // Inter-byte timeout of every port is re-armed on every received chunk
+    std::vector<PortHandle> timedOut{};
+    TimerDispatcher dispatcher{[&timedOut](TimerId, uint64_t data)
+    {
+        timedOut.push_back(static_cast<PortHandle>(data));
+    }};
+    std::vector<TimerId> timers{};
+    for (const auto handle: handles)
+        timers.push_back(dispatcher.arm(std::chrono::milliseconds{50}, handle));
+
+    const auto eventHandler{[&](PortHandle handle, short)
+    {
+        char buffer[16];
+        std::error_code readError{};
+        registry.read(handle, buffer, sizeof(buffer), readError);
+        const auto port{(handle == handles[0]) ? 0U : 1U};
+        timers[port] = dispatcher.rearm(timers[port], std::chrono::milliseconds{50}, handle);
+    }};
+
+    // Active port does not time out, the silent one does
+    for (int byte{0}; byte < 10; ++byte)
+    {
+        ASSERT_EQ(terminals[0]->write("x"), 1U);
+        const auto deadline{std::chrono::steady_clock::now() + std::chrono::milliseconds{10}};
+        while (std::chrono::steady_clock::now() < deadline)
+            registry.poll(std::chrono::milliseconds{10}, eventHandler, dispatcher);
+    }
+    ASSERT_EQ(timedOut, std::vector<PortHandle>{handles[1]});
+    ASSERT_EQ(registry.getCounters(handles[0]).receivedCount, 10U);
+
+    // Active port times out once it falls silent
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{1}};
+    while ((timedOut.size() < 2) && (std::chrono::steady_clock::now() < deadline))
+        ASSERT_EQ(registry.poll(std::chrono::milliseconds{100}, eventHandler, dispatcher), 0U);
+    ASSERT_EQ(timedOut, (std::vector<PortHandle>{handles[1], handles[0]}));
+    ASSERT_EQ(dispatcher.getActiveCount(), 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -20,6 +20,8 @@
 */
 
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <gtest/gtest.h>
 #include <serialport/namespace.hpp>
 #include <serialport/properties.hpp>
@@ -282,6 +284,10 @@ TEST(PropertiesTest, GetFlowControlNameFunctionTest)
     ASSERT_EQ(getFlowControlName(FlowControl::FLOW_CONTROL_HARDWARE), "Hardware");
     ASSERT_EQ(getFlowControlName(FlowControl::FLOW_CONTROL_SOFTWARE), "Software");
     ASSERT_EQ(getFlowControlName(FlowControl::FLOW_CONTROL_NONE), "None");
+
+    // Allocation-free variant
+    ASSERT_THROW(getFlowControlNameView(static_cast<FlowControl>(static_cast<unsigned char>(FlowControl::FLOW_CONTROL_MAX) + 1)), std::out_of_range);
+    ASSERT_EQ(getFlowControlNameView(FlowControl::FLOW_CONTROL_HARDWARE), std::string_view{"Hardware"});
 }
 
 TEST(PropertiesTest, IsParitySupportedFunctionTest)
@@ -306,6 +312,15 @@ TEST(PropertiesTest, GetParityNameFunctionTest)
     ASSERT_EQ(getParityName(Parity::PARITY_TYPE_EVEN), "Even");
     ASSERT_EQ(getParityName(Parity::PARITY_TYPE_MARK), "Mark");
     ASSERT_EQ(getParityName(Parity::PARITY_TYPE_SPACE), "Space");
+
+    // Name is a std::string usable in string expressions
+    const std::string name = getParityName(Parity::PARITY_TYPE_EVEN);
+    ASSERT_EQ("p=" + getParityName(Parity::PARITY_TYPE_ODD), "p=Odd");
+    ASSERT_EQ(name, "Even");
+
+    // Allocation-free variant
+    ASSERT_THROW(getParityNameView(static_cast<Parity>(static_cast<unsigned char>(Parity::PARITY_TYPE_MAX) + 1)), std::out_of_range);
+    ASSERT_EQ(getParityNameView(Parity::PARITY_TYPE_MARK), std::string_view{"Mark"});
 }
 
 TEST(PropertiesTest, IsStopBitSupportedFunctionTest)
@@ -332,6 +347,108 @@ TEST(PropertiesTest, GetStopBitNameFunctionTest)
     ASSERT_EQ(getStopBitName(StopBit::STOP_BIT_ONE), "One");
     ASSERT_EQ(getStopBitName(StopBit::STOP_BIT_ONE_HALF), "One and a half");
     ASSERT_EQ(getStopBitName(StopBit::STOP_BIT_TWO), "Two");
+
+    // Allocation-free variant
+    ASSERT_THROW(getStopBitNameView(static_cast<StopBit>(static_cast<unsigned char>(StopBit::STOP_BIT_MAX) + 1)), std::out_of_range);
+    ASSERT_EQ(getStopBitNameView(StopBit::STOP_BIT_ONE_HALF), std::string_view{"One and a half"});
+}
+
+TEST(PropertiesTest, FindBaudRateFunctionTest)
+{
+    SCOPED_TRACE("FindBaudRateFunctionTest");
+
+    // Every baud rate number maps back to its baud rate
+    for (auto value{static_cast<unsigned char>(BaudRate::BAUD_RATE_50)}; value <= static_cast<unsigned char>(BaudRate::BAUD_RATE_MAX); ++value)
+        ASSERT_EQ(findBaudRate(getBaudRate(static_cast<BaudRate>(value))), static_cast<BaudRate>(value));
+
+    ASSERT_EQ(findBaudRate(0U), BaudRate::BAUD_RATE_CUSTOM);
+    ASSERT_EQ(findBaudRate(115201U), BaudRate::BAUD_RATE_CUSTOM);
+    ASSERT_EQ(findBaudRate(115200U + (1UL << 32)), BaudRate::BAUD_RATE_CUSTOM);
+}
+
+TEST(PropertiesTest, ParseLinkSpecFunctionTest)
+{
+    SCOPED_TRACE("ParseLinkSpecFunctionTest");
+
+    LinkSpec linkSpec{};
+    ASSERT_TRUE(parseLinkSpec("921600,8E1,rtscts", linkSpec));
+    ASSERT_EQ(linkSpec.baudRate, BaudRate::BAUD_RATE_921600);
+    ASSERT_EQ(linkSpec.characterSize, CharacterSize::CHARACTER_SIZE_8);
+    ASSERT_EQ(linkSpec.parity, Parity::PARITY_TYPE_EVEN);
+    ASSERT_EQ(linkSpec.stopBit, StopBit::STOP_BIT_ONE);
+    ASSERT_EQ(linkSpec.flowControl, FlowControl::FLOW_CONTROL_HARDWARE);
+
+    ASSERT_TRUE(parseLinkSpec("9600-7o2-XonXoff", linkSpec));
+    ASSERT_EQ(linkSpec.baudRate, BaudRate::BAUD_RATE_9600);
+    ASSERT_EQ(linkSpec.characterSize, CharacterSize::CHARACTER_SIZE_7);
+    ASSERT_EQ(linkSpec.parity, Parity::PARITY_TYPE_ODD);
+    ASSERT_EQ(linkSpec.stopBit, StopBit::STOP_BIT_TWO);
+    ASSERT_EQ(linkSpec.flowControl, FlowControl::FLOW_CONTROL_SOFTWARE);
+
+    // Omitted fields keep their default values
+    ASSERT_TRUE(parseLinkSpec("115200-5S1.5", linkSpec));
+    ASSERT_EQ(linkSpec.characterSize, CharacterSize::CHARACTER_SIZE_5);
+    ASSERT_EQ(linkSpec.parity, Parity::PARITY_TYPE_SPACE);
+    ASSERT_EQ(linkSpec.stopBit, StopBit::STOP_BIT_ONE_HALF);
+    ASSERT_EQ(linkSpec.flowControl, FlowControl::FLOW_CONTROL_DEFAULT);
+    ASSERT_TRUE(parseLinkSpec("50", linkSpec));
+    ASSERT_EQ(linkSpec.baudRate, BaudRate::BAUD_RATE_50);
+    ASSERT_EQ(linkSpec.parity, Parity::PARITY_TYPE_DEFAULT);
+
+    // Malformed specifications leave the link specification unchanged
+    const char* const malformed[]{"", ",8N1", "115201,8N1", "115200,", "115200,8N1,", "115200;8N1",
+        "115200,9N1", "115200,8X1", "115200,8N3", "115200,8N", "115200,8N1,rts", "115200,8N1,none,",
+        "11520000000000", "115200 ,8N1"};
+    for (const auto spec: malformed)
+    {
+        ASSERT_FALSE(parseLinkSpec(spec, linkSpec)) << spec;
+        ASSERT_EQ(linkSpec.baudRate, BaudRate::BAUD_RATE_50);
+    }
+}
+
+TEST(PropertiesTest, FormatLinkSpecFunctionTest)
+{
+    SCOPED_TRACE("FormatLinkSpecFunctionTest");
+
+    char buffer[MAX_LINK_SPEC_SIZE];
+    LinkSpec linkSpec{};
+    ASSERT_EQ(formatLinkSpec(linkSpec, buffer, sizeof(buffer)), 10U);
+    ASSERT_STREQ(buffer, "115200,8N1");
+
+    linkSpec = LinkSpec{BaudRate::BAUD_RATE_4000000, CharacterSize::CHARACTER_SIZE_8, Parity::PARITY_TYPE_MARK,
+        StopBit::STOP_BIT_ONE_HALF, FlowControl::FLOW_CONTROL_SOFTWARE};
+    ASSERT_EQ(formatLinkSpec(linkSpec, buffer, sizeof(buffer)), MAX_LINK_SPEC_SIZE - 1);
+    ASSERT_STREQ(buffer, "4000000,8M1.5,xonxoff");
+    ASSERT_EQ(formatLinkSpec(linkSpec, buffer, MAX_LINK_SPEC_SIZE - 1), 0U);
+
+    linkSpec.baudRate = BaudRate::BAUD_RATE_CUSTOM;
+    ASSERT_EQ(formatLinkSpec(linkSpec, buffer, sizeof(buffer)), 0U);
+
+    // Every combination survives a round trip
+    for (auto baudRate{static_cast<unsigned char>(BaudRate::BAUD_RATE_50)}; baudRate <= static_cast<unsigned char>(BaudRate::BAUD_RATE_MAX); ++baudRate)
+    {
+        for (auto parity{static_cast<unsigned char>(Parity::PARITY_TYPE_MIN)}; parity <= static_cast<unsigned char>(Parity::PARITY_TYPE_MAX); ++parity)
+        {
+            for (auto stopBit{static_cast<unsigned char>(StopBit::STOP_BIT_MIN)}; stopBit <= static_cast<unsigned char>(StopBit::STOP_BIT_MAX); ++stopBit)
+            {
+                for (auto flowControl{static_cast<unsigned char>(FlowControl::FLOW_CONTROL_MIN)}; flowControl <= static_cast<unsigned char>(FlowControl::FLOW_CONTROL_MAX); ++flowControl)
+                {
+                    const LinkSpec expected{static_cast<BaudRate>(baudRate), CharacterSize::CHARACTER_SIZE_6,
+                        static_cast<Parity>(parity), static_cast<StopBit>(stopBit), static_cast<FlowControl>(flowControl)};
+                    const auto length{formatLinkSpec(expected, buffer, sizeof(buffer))};
+                    ASSERT_GT(length, 0U);
+
+                    LinkSpec actual{};
+                    ASSERT_TRUE(parseLinkSpec(std::string_view(buffer, length), actual)) << buffer;
+                    ASSERT_EQ(actual.baudRate, expected.baudRate);
+                    ASSERT_EQ(actual.characterSize, expected.characterSize);
+                    ASSERT_EQ(actual.parity, expected.parity);
+                    ASSERT_EQ(actual.stopBit, expected.stopBit);
+                    ASSERT_EQ(actual.flowControl, expected.flowControl);
+                }
+            }
+        }
+    }
 }
 
 TEST(PropertiesTest, ControlLineSetTests)
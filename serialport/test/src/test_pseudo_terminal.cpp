@@ -0,0 +1,180 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+PseudoTerminal::PseudoTerminal() :
+    master{INVALID_FILE_DESCRIPTOR}, slaveName{}
+{
+    master = systemCall(::posix_openpt, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master == INVALID_FILE_DESCRIPTOR)
+        throw std::runtime_error("Unable to open pseudo-terminal");
+
+    if ((grantpt(master) != 0) || (unlockpt(master) != 0))
+    {
+        systemCall(::close, master);
+        throw std::runtime_error("Unable to unlock pseudo-terminal");
+    }
+
+    // Raw mode keeps the slave side transparent until opened
+    struct termios settings{};
+    if (systemCall(tcgetattr, master, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        systemCall(tcsetattr, master, TCSANOW, &settings);
+    }
+    slaveName = ptsname(master);
+}
+
+PseudoTerminal::~PseudoTerminal() noexcept
+{
+    closeMaster();
+}
+
+int PseudoTerminal::getMaster() const
+{
+    return master;
+}
+
+std::string PseudoTerminal::getSlaveName() const
+{
+    return slaveName;
+}
+
+void PseudoTerminal::closeMaster()
+{
+    if (master != INVALID_FILE_DESCRIPTOR)
+    {
+        systemCall(::close, master);
+        master = INVALID_FILE_DESCRIPTOR;
+    }
+}
+
+size_t PseudoTerminal::write(const std::string& data) const
+{
+    size_t result{0};
+    while (result < data.size())
+    {
+        const auto written{systemCall(::write, master, data.data() + result, data.size() - result)};
+        if (written > 0)
+        {
+            result += static_cast<size_t>(written);
+            continue;
+        }
+
+        if ((written < 0) && (errno != EAGAIN))
+            break;
+
+        struct pollfd descriptor{master, POLLOUT, 0};
+        if (systemCall(::poll, &descriptor, 1, 1000) <= 0)
+            break;
+    }
+    return result;
+}
+
+std::string PseudoTerminal::read(size_t size, std::chrono::milliseconds timeout) const
+{
+    std::string result{};
+    const auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (result.size() < size)
+    {
+        const auto remaining{std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())};
+        if (remaining.count() < 0)
+            break;
+
+        struct pollfd descriptor{master, POLLIN, 0};
+        if (systemCall(::poll, &descriptor, 1, static_cast<int>(remaining.count())) <= 0)
+            break;
+
+        char data[4096];
+        const auto count{systemCall(::read, master, data, std::min(sizeof(data), size - result.size()))};
+        if (count <= 0)
+            break;
+        result.append(data, static_cast<size_t>(count));
+    }
+    return result;
+}
+
+NullModem::NullModem(const PseudoTerminal& first, const PseudoTerminal& second) :
+    stopped{false}, thread{}
+{
+    thread = std::thread{&NullModem::forward, this, first.getMaster(), second.getMaster()};
+}
+
+NullModem::~NullModem() noexcept
+{
+    stopped = true;
+    thread.join();
+}
+
+void NullModem::forward(int first, int second)
+{
+    struct pollfd descriptors[2]{{first, POLLIN, 0}, {second, POLLIN, 0}};
+    while (!stopped)
+    {
+        if (systemCall(::poll, descriptors, 2, 10) <= 0)
+            continue;
+
+        for (size_t index{0}; index < 2; ++index)
+        {
+            if ((descriptors[index].revents & POLLIN) == 0)
+                continue;
+
+            char data[4096];
+            const auto count{systemCall(::read, descriptors[index].fd, data, sizeof(data))};
+            if (count <= 0)
+                continue;
+
+            // Master sides are non-blocking
+            const auto destination{descriptors[1 - index].fd};
+            ssize_t written{0};
+            while (written < count)
+            {
+                const auto result{systemCall(::write, destination, data + written, static_cast<size_t>(count - written))};
+                if (result > 0)
+                {
+                    written += result;
+                    continue;
+                }
+
+                struct pollfd descriptor{destination, POLLOUT, 0};
+                if ((errno != EAGAIN) || (systemCall(::poll, &descriptor, 1, 1000) <= 0))
+                    break;
+            }
+        }
+    }
+}
+
+END_NAMESPACE_LIBSERIAL
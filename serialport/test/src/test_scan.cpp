@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <string>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/scan.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(ScanTest, FindByteFunctionTest)
+{
+    SCOPED_TRACE("FindByteFunctionTest");
+
+    const auto implementation{getScanImplementation()};
+    for (const auto scanImplementation: {ScanImplementation::SCAN_SCALAR, ScanImplementation::SCAN_SSE2, ScanImplementation::SCAN_AVX2})
+    {
+        if (!setScanImplementation(scanImplementation))
+        {
+            EXPECT_FALSE(isScanImplementationSupported(scanImplementation));
+            continue;
+        }
+        EXPECT_EQ(getScanImplementation(), scanImplementation);
+
+        // Every position within and after a vector block
+        for (size_t size{0}; size < 100; ++size)
+        {
+            std::string data(size, 'a');
+            EXPECT_EQ(findByte(data.data(), data.size(), '\n'), size);
+            for (size_t position{0}; position < size; ++position)
+            {
+                data[position] = '\n';
+                EXPECT_EQ(findByte(data.data(), data.size(), '\n'), position);
+                data[position] = 'a';
+            }
+        }
+
+        // Bytes with the most significant bit set
+        const std::string binary{"\x01\x02\xFF\x80\x00\xC0", 6};
+        EXPECT_EQ(findByte(binary.data(), binary.size(), '\x00'), 4U);
+        EXPECT_EQ(findByte(binary.data(), binary.size(), '\xC0'), 5U);
+        EXPECT_EQ(findByte(binary.data(), binary.size(), '\x80'), 3U);
+    }
+    EXPECT_TRUE(setScanImplementation(implementation));
+}
+
+TEST(ScanTest, FindEitherByteFunctionTest)
+{
+    SCOPED_TRACE("FindEitherByteFunctionTest");
+
+    const auto implementation{getScanImplementation()};
+    for (const auto scanImplementation: {ScanImplementation::SCAN_SCALAR, ScanImplementation::SCAN_SSE2, ScanImplementation::SCAN_AVX2})
+    {
+        if (!setScanImplementation(scanImplementation))
+            continue;
+
+        std::string data(200, 'x');
+        EXPECT_EQ(findEitherByte(data.data(), data.size(), '\x7E', '\x7D'), data.size());
+        data[150] = '\x7D';
+        data[170] = '\x7E';
+        EXPECT_EQ(findEitherByte(data.data(), data.size(), '\x7E', '\x7D'), 150U);
+        EXPECT_EQ(findEitherByte(data.data() + 151, data.size() - 151, '\x7E', '\x7D'), 19U);
+        EXPECT_EQ(findEitherByte(data.data(), 150, '\x7E', '\x7D'), 150U);
+    }
+    EXPECT_TRUE(setScanImplementation(implementation));
+    EXPECT_TRUE(isScanImplementationSupported(ScanImplementation::SCAN_SCALAR));
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,227 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_bridge.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Read data from a socket
+ *
+ * @param socket Socket
+ * @param size Size of the data to read
+ * @return std::string Data actually read
+ */
+static std::string readSocket(int socket, size_t size)
+{
+    std::string result{};
+    char buffer[4096];
+    while (result.size() < size)
+    {
+        const auto count{::recv(socket, buffer, std::min(sizeof(buffer), size - result.size()), 0)};
+        if (count <= 0)
+            break;
+        result.append(buffer, static_cast<size_t>(count));
+    }
+    return result;
+}
+
+/**
+ * @brief Get test data with all byte values
+ *
+ * @param size Size of the data
+ * @return std::string Test data
+ */
+static std::string getBridgeData(size_t size)
+{
+    std::string result(size, '\0');
+    for (size_t index{0}; index < size; ++index)
+        result[index] = static_cast<char>((index * 7) ^ (index >> 8));
+    return result;
+}
+
+TEST(SerialBridgeTest, SocketPairTest)
+{
+    SCOPED_TRACE("SocketPairTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    ASSERT_NO_THROW(port.open());
+
+    int sockets[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    SerialBridge bridge{port, sockets[0]};
+    ASSERT_TRUE(bridge.isActive());
+    std::thread thread{[&bridge]() { bridge.run(); }};
+
+    // Serial port to socket
+    const std::string request{"AT+CSQ\r"};
+    ASSERT_EQ(terminal.write(request), request.size());
+    ASSERT_EQ(readSocket(sockets[1], request.size()), request);
+
+    // Socket to serial port with backpressure from the small terminal buffer
+    const auto data{getBridgeData(256 * 1024)};
+    std::thread writer{[&sockets, &data]()
+    {
+        size_t index{0};
+        while (index < data.size())
+        {
+            const auto count{::send(sockets[1], data.data() + index, data.size() - index, 0)};
+            if (count <= 0)
+                break;
+            index += static_cast<size_t>(count);
+        }
+    }};
+    ASSERT_EQ(terminal.read(data.size(), std::chrono::milliseconds{10000}), data);
+    writer.join();
+
+    bridge.stop();
+    thread.join();
+    ASSERT_FALSE(bridge.isActive());
+
+    const auto statistics{bridge.getStatistics()};
+    ASSERT_EQ(statistics.serialToSocket.byteCount, request.size());
+    ASSERT_EQ(statistics.socketToSerial.byteCount, data.size());
+    ASSERT_EQ(statistics.socketToSerial.splicedByteCount + statistics.socketToSerial.copiedByteCount, data.size());
+    ASSERT_GT(statistics.socketToSerial.throughput, 0.0);
+    ASSERT_GT(statistics.elapsed.count(), 0);
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+TEST(SerialBridgeTest, HangUpTest)
+{
+    SCOPED_TRACE("HangUpTest");
+
+    // Peer sends more than the terminal buffer accepts and closes before the bridge runs
+    const auto data{getBridgeData(128 * 1024)};
+    {
+        PseudoTerminal terminal{};
+        SerialPort port{terminal.getSlaveName()};
+        ASSERT_NO_THROW(port.open());
+
+        int sockets[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+        SerialBridge bridge{port, sockets[0]};
+        ASSERT_EQ(::send(sockets[1], data.data(), data.size(), 0), static_cast<ssize_t>(data.size()));
+        ::close(sockets[1]);
+
+        // Data already sent is still forwarded after the hang-up
+        std::thread thread{[&bridge]() { bridge.run(); }};
+        ASSERT_EQ(terminal.read(data.size(), std::chrono::milliseconds{10000}), data);
+        thread.join();
+        ASSERT_FALSE(bridge.isActive());
+
+        const auto statistics{bridge.getStatistics()};
+        ASSERT_EQ(statistics.socketToSerial.byteCount, data.size());
+        ASSERT_EQ(statistics.socketToSerial.droppedByteCount, 0U);
+        ::close(sockets[0]);
+    }
+
+    // Data the terminal does not accept within the timeout is counted as dropped
+    {
+        PseudoTerminal terminal{};
+        SerialPort port{terminal.getSlaveName()};
+        ASSERT_NO_THROW(port.open());
+
+        int sockets[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+        SerialBridge bridge{port, sockets[0]};
+        ASSERT_EQ(::send(sockets[1], data.data(), data.size(), 0), static_cast<ssize_t>(data.size()));
+        ::close(sockets[1]);
+
+        ASSERT_FALSE(bridge.poll(std::chrono::milliseconds{50}));
+        const auto statistics{bridge.getStatistics()};
+        ASSERT_LT(statistics.socketToSerial.byteCount, data.size());
+        ASSERT_GT(statistics.socketToSerial.droppedByteCount, 0U);
+        ::close(sockets[0]);
+    }
+}
+
+TEST(SerialBridgeTest, TcpLoopbackTest)
+{
+    SCOPED_TRACE("TcpLoopbackTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    ASSERT_NO_THROW(port.open());
+
+    // Listen on an ephemeral loopback port
+    const auto server{::socket(AF_INET, SOCK_STREAM, 0)};
+    ASSERT_NE(server, INVALID_FILE_DESCRIPTOR);
+    struct sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize{sizeof(address)};
+    ASSERT_EQ(::bind(server, reinterpret_cast<struct sockaddr*>(&address), addressSize), 0);
+    ASSERT_EQ(::listen(server, 1), 0);
+    ASSERT_EQ(::getsockname(server, reinterpret_cast<struct sockaddr*>(&address), &addressSize), 0);
+
+    const auto client{SerialBridge::connectTcp("127.0.0.1", ntohs(address.sin_port))};
+    ASSERT_NE(client, INVALID_FILE_DESCRIPTOR);
+    const auto peer{::accept(server, nullptr, nullptr)};
+    ASSERT_NE(peer, INVALID_FILE_DESCRIPTOR);
+
+    SerialBridge bridge{port, client};
+    std::thread thread{[&bridge]() { bridge.run(); }};
+
+    const std::string response{"+CSQ: 23,99\r\n"};
+    ASSERT_EQ(::send(peer, response.data(), response.size(), 0), static_cast<ssize_t>(response.size()));
+    ASSERT_EQ(terminal.read(response.size()), response);
+
+    const std::string data{getBridgeData(1024)};
+    ASSERT_EQ(terminal.write(data), data.size());
+    ASSERT_EQ(readSocket(peer, data.size()), data);
+
+    // Peer closing the connection ends the bridge
+    ::close(peer);
+    thread.join();
+    ASSERT_FALSE(bridge.isActive());
+
+    ::close(client);
+    ::close(server);
+}
+
+TEST(SerialBridgeTest, ConnectFailureTest)
+{
+    SCOPED_TRACE("ConnectFailureTest");
+
+    ASSERT_EQ(SerialBridge::connectUnix("/nonexistent/libserial.sock"), INVALID_FILE_DESCRIPTOR);
+    ASSERT_EQ(SerialBridge::connectUnix(std::string(512, 'x')), INVALID_FILE_DESCRIPTOR);
+
+    SerialPort port{};
+    ASSERT_THROW(SerialBridge(port, INVALID_FILE_DESCRIPTOR), std::runtime_error);
+}
+
+END_NAMESPACE_LIBSERIAL
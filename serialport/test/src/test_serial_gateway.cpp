@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_gateway.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(SerialGatewayTest, ForwardTest)
+{
+    SCOPED_TRACE("ForwardTest");
+
+    PseudoTerminal firstTerminal{};
+    PseudoTerminal secondTerminal{};
+    SerialPort firstPort{firstTerminal.getSlaveName()};
+    SerialPort secondPort{secondTerminal.getSlaveName()};
+    ASSERT_NO_THROW(firstPort.open());
+    ASSERT_NO_THROW(secondPort.open());
+
+    // Upper-case data in one direction and duplicate every byte in the other
+    SerialGateway gateway{};
+    const auto route{gateway.addRoute(firstPort, secondPort,
+        [](char* data, size_t size, size_t)
+        {
+            for (size_t index{0}; index < size; ++index)
+                data[index] = static_cast<char>(std::toupper(static_cast<unsigned char>(data[index])));
+            return size;
+        },
+        [](char* data, size_t size, size_t capacity)
+        {
+            EXPECT_GE(capacity, size * 2);
+            for (size_t index{size}; index > 0; --index)
+            {
+                data[index * 2 - 1] = data[index - 1];
+                data[index * 2 - 2] = data[index - 1];
+            }
+            return size * 2;
+        })};
+    EXPECT_EQ(route, 0U);
+    EXPECT_EQ(gateway.getRouteCount(), 1U);
+    std::thread thread{[&gateway]() { gateway.run(); }};
+
+    EXPECT_EQ(firstTerminal.write("gateway"), 7U);
+    EXPECT_EQ(secondTerminal.read(7), "GATEWAY");
+    EXPECT_EQ(secondTerminal.write("abc"), 3U);
+    EXPECT_EQ(firstTerminal.read(6), "aabbcc");
+
+    gateway.stop();
+    thread.join();
+
+    const auto statistics{gateway.getStatistics(route)};
+    EXPECT_TRUE(statistics.active);
+    EXPECT_EQ(statistics.firstToSecond.receivedCount, 7U);
+    EXPECT_EQ(statistics.firstToSecond.transmittedCount, 7U);
+    EXPECT_EQ(statistics.secondToFirst.receivedCount, 3U);
+    EXPECT_EQ(statistics.secondToFirst.transmittedCount, 6U);
+    EXPECT_THROW(gateway.getStatistics(1), std::out_of_range);
+}
+
+TEST(SerialGatewayTest, MultipleRouteTest)
+{
+    SCOPED_TRACE("MultipleRouteTest");
+
+    constexpr size_t routeCount{8};
+    std::vector<PseudoTerminal> terminals(routeCount * 2);
+    std::vector<SerialPortPtr> ports{};
+    for (const auto& terminal: terminals)
+    {
+        ports.push_back(std::make_shared<SerialPort>(terminal.getSlaveName()));
+        ASSERT_NO_THROW(ports.back()->open());
+    }
+
+    SerialGateway gateway{};
+    for (size_t route{0}; route < routeCount; ++route)
+        EXPECT_EQ(gateway.addRoute(*ports[route * 2], *ports[route * 2 + 1]), route);
+
+    // Serial port may only be used by a single route
+    EXPECT_THROW(gateway.addRoute(*ports[0], *ports[3]), std::runtime_error);
+    EXPECT_THROW(gateway.addRoute(*ports[0], *ports[0]), std::runtime_error);
+    SerialPort closedPort{};
+    EXPECT_THROW(gateway.addRoute(closedPort, *ports[1]), std::runtime_error);
+
+    std::thread thread{[&gateway]() { gateway.run(); }};
+    for (size_t route{0}; route < routeCount; ++route)
+    {
+        const std::string data{"route " + std::to_string(route)};
+        EXPECT_EQ(terminals[route * 2 + 1].write(data), data.size());
+        EXPECT_EQ(terminals[route * 2].read(data.size()), data);
+    }
+
+    // Data stalled on the unread peer until the first serial port stops accepting more
+    std::string data(256 * 1024, '\0');
+    for (size_t index{0}; index < data.size(); ++index)
+        data[index] = static_cast<char>(index * 7);
+    const auto written{terminals[0].write(data)};
+    EXPECT_GT(written, 0U);
+    EXPECT_LT(written, data.size());
+
+    // Hang-up ends only the affected route once the data pending for its peer arrived
+    terminals[0].closeMaster();
+    const auto received{terminals[1].read(written, std::chrono::milliseconds{1500})};
+    EXPECT_GT(received.size(), 0U);
+    EXPECT_EQ(received, data.substr(0, received.size()));
+    EXPECT_EQ(terminals[3].write("alive"), 5U);
+    EXPECT_EQ(terminals[2].read(5), "alive");
+
+    gateway.stop();
+    thread.join();
+    const auto statistics{gateway.getStatistics(0)};
+    EXPECT_FALSE(statistics.active);
+    EXPECT_EQ(statistics.firstToSecond.transmittedCount, received.size());
+    EXPECT_EQ(statistics.firstToSecond.transmittedCount, statistics.firstToSecond.receivedCount);
+    EXPECT_EQ(statistics.firstToSecond.droppedByteCount, 0U);
+    EXPECT_TRUE(gateway.getStatistics(1).active);
+
+    // Settings of a hung-up serial port can not be restored
+    ports[0]->abandon();
+}
+
+TEST(SerialGatewayTest, BufferSizeTest)
+{
+    SCOPED_TRACE("BufferSizeTest");
+
+    SerialPort slowPort{"", BaudRate::BAUD_RATE_9600};
+    SerialPort fastPort{"", BaudRate::BAUD_RATE_921600};
+    SerialPort fastestPort{"", BaudRate::BAUD_RATE_4000000};
+
+    const auto slowSize{SerialGateway::getBufferSize(slowPort)};
+    const auto fastSize{SerialGateway::getBufferSize(fastPort)};
+    EXPECT_EQ(slowSize, MIN_GATEWAY_BUFFER_SIZE);
+    EXPECT_GT(fastSize, slowSize);
+    EXPECT_LE(SerialGateway::getBufferSize(fastestPort), MAX_GATEWAY_BUFFER_SIZE);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,221 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_reactor.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Number of ports of the serial reactor tests
+     *
+     */
+    static constexpr size_t TEST_PORT_COUNT{4};
+
+    /**
+     * @brief Serial ports of the serial reactor tests with their received data counters
+     *
+     */
+    struct TestPorts
+    {
+        /**
+         * @brief Construct a new TestPorts object with open serial ports
+         *
+         */
+        TestPorts() :
+            terminals{}, serialPorts{}, receivedCounts{}, handlerCounts{}, overlapCount{0}
+        {
+            for (size_t port{0}; port < TEST_PORT_COUNT; ++port)
+            {
+                terminals.push_back(std::make_unique<PseudoTerminal>());
+                serialPorts.push_back(std::make_unique<SerialPort>(terminals.back()->getSlaveName()));
+                serialPorts.back()->open();
+                receivedCounts[port] = 0;
+                handlerCounts[port] = 0;
+            }
+        }
+
+        /**
+         * @brief Event handler reading the data of a ready port
+         *
+         * @param port Port index
+         * @param serialPort Serial port
+         */
+        void handle(size_t port, SerialPort& serialPort)
+        {
+            // Events of a port are never handled by two threads at once
+            if (handlerCounts[port].fetch_add(1) != 0)
+                ++overlapCount;
+
+            char buffer[256];
+            std::error_code error{};
+            receivedCounts[port] += serialPort.read(buffer, sizeof(buffer), error);
+            handlerCounts[port].fetch_sub(1);
+        }
+
+        /**
+         * @brief Pseudo terminals
+         *
+         */
+        std::vector<std::unique_ptr<PseudoTerminal>> terminals;
+
+        /**
+         * @brief Serial ports
+         *
+         */
+        std::vector<std::unique_ptr<SerialPort>> serialPorts;
+
+        /**
+         * @brief Size of the received data of each port
+         *
+         */
+        std::array<std::atomic<size_t>, TEST_PORT_COUNT> receivedCounts;
+
+        /**
+         * @brief Number of event handlers running for each port
+         *
+         */
+        std::array<std::atomic<int>, TEST_PORT_COUNT> handlerCounts;
+
+        /**
+         * @brief Number of overlapping event handlers of a port
+         *
+         */
+        std::atomic<int> overlapCount;
+    };
+} // namespace
+
+TEST(SerialReactorTest, DispatchTest)
+{
+    SCOPED_TRACE("DispatchTest");
+
+    ReactorOptions options{};
+    options.balanceInterval = std::chrono::milliseconds{0};
+    ASSERT_THROW(SerialReactor(nullptr, options), std::out_of_range);
+
+    TestPorts ports{};
+    options.balanceInterval = DEFAULT_REACTOR_BALANCE_INTERVAL;
+    options.shardCount = 2;
+    SerialReactor reactor{[&ports](size_t port, SerialPort& serialPort, short)
+    {
+        ports.handle(port, serialPort);
+    }, options};
+    ASSERT_EQ(reactor.getShardCount(), 2U);
+    ASSERT_THROW(reactor.getStatistics(2), std::out_of_range);
+
+    // Closed serial ports are rejected, open ones are assigned to the shards in turn
+    SerialPort closedPort{ports.terminals[0]->getSlaveName()};
+    ASSERT_THROW(reactor.addPort(closedPort), std::runtime_error);
+    for (size_t port{0}; port < TEST_PORT_COUNT; ++port)
+    {
+        ASSERT_EQ(reactor.addPort(*ports.serialPorts[port]), port);
+        ASSERT_EQ(reactor.getShard(port), port % 2);
+    }
+    ASSERT_THROW(reactor.getShard(TEST_PORT_COUNT), std::out_of_range);
+
+    reactor.start();
+    ASSERT_TRUE(reactor.isRunning());
+    ASSERT_THROW(reactor.start(), std::runtime_error);
+    ASSERT_THROW(reactor.addPort(*ports.serialPorts[0]), std::runtime_error);
+
+    // Every port is served by its shard
+    for (size_t port{0}; port < TEST_PORT_COUNT; ++port)
+        ASSERT_EQ(ports.terminals[port]->write("reactor"), 7U);
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+    for (size_t port{0}; port < TEST_PORT_COUNT; ++port)
+    {
+        while ((ports.receivedCounts[port] < 7) && (std::chrono::steady_clock::now() < deadline))
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        ASSERT_EQ(ports.receivedCounts[port], 7U);
+    }
+
+    reactor.stop();
+    ASSERT_FALSE(reactor.isRunning());
+    for (size_t shard{0}; shard < reactor.getShardCount(); ++shard)
+    {
+        const auto statistics{reactor.getStatistics(shard)};
+        ASSERT_EQ(statistics.portCount, 2U);
+        ASSERT_GE(statistics.eventCount, 2U);
+        ASSERT_GE(statistics.wakeupCount, 1U);
+    }
+}
+
+TEST(SerialReactorTest, StealTest)
+{
+    SCOPED_TRACE("StealTest");
+
+    // Both busy ports start on the first shard
+    TestPorts ports{};
+    ReactorOptions options{};
+    options.shardCount = 2;
+    SerialReactor reactor{[&ports](size_t port, SerialPort& serialPort, short)
+    {
+        ports.handle(port, serialPort);
+    }, options};
+    for (size_t port{0}; port < TEST_PORT_COUNT; ++port)
+        reactor.addPort(*ports.serialPorts[port]);
+    reactor.start();
+
+    // Idle shard steals one of the busy ports
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+    size_t sentCount{0};
+    while ((reactor.getStatistics(1).stolenCount == 0) && (std::chrono::steady_clock::now() < deadline))
+    {
+        sentCount += ports.terminals[0]->write("x");
+        sentCount += ports.terminals[2]->write("x");
+        std::this_thread::sleep_for(std::chrono::microseconds{200});
+    }
+    ASSERT_NE(reactor.getShard(0), reactor.getShard(2));
+
+    // Migrated port keeps being served without losing data
+    for (int byte{0}; byte < 100; ++byte)
+    {
+        sentCount += ports.terminals[0]->write("x");
+        sentCount += ports.terminals[2]->write("x");
+        std::this_thread::sleep_for(std::chrono::microseconds{200});
+    }
+    while (((ports.receivedCounts[0] + ports.receivedCounts[2]) < sentCount) && (std::chrono::steady_clock::now() < deadline))
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    reactor.stop();
+
+    ASSERT_EQ(ports.receivedCounts[0] + ports.receivedCounts[2], sentCount);
+    ASSERT_EQ(ports.overlapCount, 0);
+    const auto busyStatistics{reactor.getStatistics(0)};
+    const auto idleStatistics{reactor.getStatistics(1)};
+    ASSERT_EQ(busyStatistics.donatedCount, idleStatistics.stolenCount);
+    ASSERT_EQ(busyStatistics.portCount + idleStatistics.portCount, TEST_PORT_COUNT);
+    ASSERT_GT(idleStatistics.eventCount, 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
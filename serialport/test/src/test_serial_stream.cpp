@@ -0,0 +1,132 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/error.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serial_stream.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(SerialStreamTest, InputTest)
+{
+    SCOPED_TRACE("InputTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+    ASSERT_THROW(SerialStreamBuf(serialPort, 0, 0), std::out_of_range);
+    ASSERT_THROW(SerialIStream(serialPort, 0), std::out_of_range);
+
+    // Lines and formatted values of a single chunk are parsed from the input buffer
+    SerialIStream input{serialPort, 64, std::chrono::milliseconds{1000}};
+    ASSERT_EQ(terminal.write("first line\nsecond line\n42 3.5\n"), 30U);
+    std::string line{};
+    ASSERT_TRUE(std::getline(input, line));
+    ASSERT_EQ(line, "first line");
+    ASSERT_TRUE(std::getline(input, line));
+    ASSERT_EQ(line, "second line");
+    int integer{0};
+    double real{0.0};
+    ASSERT_TRUE(input >> integer >> real);
+    ASSERT_EQ(integer, 42);
+    ASSERT_EQ(real, 3.5);
+    ASSERT_EQ(input.getStreamBuf().getStatistics().readCount, 1U);
+
+    // Large reads bypass the input buffer instead of reading byte by byte
+    std::string pattern(10000, '\0');
+    for (size_t index{0}; index < pattern.size(); ++index)
+        pattern[index] = static_cast<char>('a' + (index % 26));
+    ASSERT_EQ(terminal.write(pattern), pattern.size());
+    std::string data(pattern.size() + 1, '\0');
+    ASSERT_TRUE(input.read(&data[0], 1));
+    ASSERT_EQ(data[0], '\n');
+    ASSERT_TRUE(input.read(&data[0], static_cast<std::streamsize>(pattern.size())));
+    data.resize(pattern.size());
+    ASSERT_EQ(data, pattern);
+    ASSERT_LT(input.getStreamBuf().getStatistics().readCount, 100U);
+
+    // Timeout fails the stream instead of hanging
+    const auto start{std::chrono::steady_clock::now()};
+    input.getStreamBuf().setReadTimeout(std::chrono::milliseconds{50});
+    ASSERT_FALSE(std::getline(input, line));
+    ASSERT_TRUE(input.eof());
+    ASSERT_TRUE(input.fail());
+    ASSERT_FALSE(input.bad());
+    ASSERT_EQ(input.getStreamBuf().getError(), std::errc::timed_out);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{50});
+    ASSERT_EQ(input.getStreamBuf().getStatistics().timeoutCount, 1U);
+
+    // Stream is usable again once cleared
+    input.clear();
+    ASSERT_EQ(terminal.write("again\n"), 6U);
+    ASSERT_TRUE(std::getline(input, line));
+    ASSERT_EQ(line, "again");
+    ASSERT_FALSE(input.getStreamBuf().getError());
+}
+
+TEST(SerialStreamTest, OutputTest)
+{
+    SCOPED_TRACE("OutputTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+    ASSERT_THROW(SerialOStream(serialPort, 0), std::out_of_range);
+
+    // Formatted output is buffered until flushed
+    {
+        SerialOStream output{serialPort, 64, std::chrono::milliseconds{1000}};
+        output << "value " << 42 << ' ' << 3.5;
+        ASSERT_EQ(output.getStreamBuf().getStatistics().writeCount, 0U);
+        output << std::endl;
+        ASSERT_TRUE(output.good());
+        ASSERT_EQ(output.getStreamBuf().getStatistics().writeCount, 1U);
+        ASSERT_EQ(terminal.read(13), "value 42 3.5\n");
+
+        // Large writes bypass the output buffer, the rest is written by the destructor
+        const std::string data(1000, 'x');
+        output << data << "tail";
+        ASSERT_EQ(terminal.read(1000), data);
+    }
+    ASSERT_EQ(terminal.read(4), "tail");
+
+    // Input only stream buffer rejects output
+    SerialStreamBuf inputOnly{serialPort, 64, 0};
+    ASSERT_EQ(inputOnly.sputn("data", 4), 0);
+    ASSERT_EQ(inputOnly.getError(), SerialError::SERIAL_ERROR_NOT_SUPPORTED);
+
+    // Timeout of a write the other side does not drain fails the stream
+    SerialOStream output{serialPort, 64, std::chrono::milliseconds{50}};
+    const std::string block(4096, 'y');
+    for (int count{0}; (count < 1024) && output.good(); ++count)
+        output << block;
+    ASSERT_TRUE(output.bad());
+    ASSERT_EQ(output.getStreamBuf().getError(), std::errc::timed_out);
+}
+
+END_NAMESPACE_LIBSERIAL
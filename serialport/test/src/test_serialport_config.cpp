@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <termios.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serialport_config.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Configuration used by the tests
+ *
+ */
+typedef SerialPortConfig<BaudRate::BAUD_RATE_921600, CharacterSize::CHARACTER_SIZE_7,
+    Parity::PARITY_TYPE_EVEN, StopBit::STOP_BIT_TWO, FlowControl::FLOW_CONTROL_HARDWARE> TestConfig;
+
+static_assert(TestConfig::NATIVE_PORT_SETTINGS.speed == B921600, "Unexpected speed");
+static_assert((TestConfig::NATIVE_PORT_SETTINGS.controlFlagsSet & CSIZE) == CS7, "Unexpected character size");
+static_assert((TestConfig::NATIVE_PORT_SETTINGS.controlFlagsSet & (PARENB | PARODD | CMSPAR | CSTOPB | CRTSCTS)) ==
+    (PARENB | CSTOPB | CRTSCTS), "Unexpected control flags");
+static_assert((TestConfig::NATIVE_PORT_SETTINGS.inputFlagsSet & (INPCK | IGNPAR | IXON | IXOFF)) == INPCK,
+    "Unexpected input flags");
+
+/**
+ * @brief Get the termios settings of an open serial port
+ *
+ * @param serialPort Serial port
+ * @return struct termios Serial port settings
+ */
+static struct termios getTermios(const SerialPort& serialPort)
+{
+    struct termios portSettings{};
+    EXPECT_EQ(tcgetattr(serialPort.getNativeHandle(), &portSettings), 0);
+    return portSettings;
+}
+
+TEST(SerialPortConfigTest, ValueTest)
+{
+    SCOPED_TRACE("ValueTest");
+
+    // Compile-time speeds agree with the runtime lookup
+    for (auto value{static_cast<unsigned>(BaudRate::BAUD_RATE_MIN)}; value <= static_cast<unsigned>(BaudRate::BAUD_RATE_MAX); ++value)
+    {
+        const auto baudRate{static_cast<BaudRate>(value)};
+        ASSERT_EQ(isBaudRateSupported(baudRate), getBaudRateSpeed(baudRate) != B0);
+        if (isBaudRateSupported(baudRate))
+        {
+            ASSERT_EQ(static_cast<speed_t>(getBaudRateValue(baudRate)), getBaudRateSpeed(baudRate));
+        }
+    }
+
+    // Compile-time character sizes agree with the runtime lookup
+    for (auto value{static_cast<unsigned>(CharacterSize::CHARACTER_SIZE_MIN)}; value <= static_cast<unsigned>(CharacterSize::CHARACTER_SIZE_MAX); ++value)
+    {
+        const auto characterSize{static_cast<CharacterSize>(value)};
+        ASSERT_TRUE(isCharacterSizeSupported(characterSize));
+        ASSERT_EQ(static_cast<tcflag_t>(getCharacterSizeValue(characterSize)), getCharacterSizeFlags(characterSize));
+    }
+}
+
+TEST(SerialPortConfigTest, SettingsTest)
+{
+    SCOPED_TRACE("SettingsTest");
+
+    PseudoTerminal terminal{};
+    const Parity parities[]{Parity::PARITY_TYPE_NONE, Parity::PARITY_TYPE_ODD, Parity::PARITY_TYPE_EVEN,
+        Parity::PARITY_TYPE_MARK, Parity::PARITY_TYPE_SPACE};
+    const FlowControl flowControls[]{FlowControl::FLOW_CONTROL_HARDWARE, FlowControl::FLOW_CONTROL_SOFTWARE,
+        FlowControl::FLOW_CONTROL_NONE};
+    const StopBit stopBits[]{StopBit::STOP_BIT_ONE, StopBit::STOP_BIT_TWO};
+    const CharacterSize characterSizes[]{CharacterSize::CHARACTER_SIZE_5, CharacterSize::CHARACTER_SIZE_8};
+
+    // Precomputed settings match the runtime preparation for every combination
+    for (const auto parity: parities)
+    {
+        for (const auto flowControl: flowControls)
+        {
+            for (const auto stopBit: stopBits)
+            {
+                for (const auto characterSize: characterSizes)
+                {
+                    SerialPort port{terminal.getSlaveName(), BaudRate::BAUD_RATE_57600, characterSize, flowControl, parity, stopBit};
+                    ASSERT_NO_THROW(port.open());
+                    const auto expected{getTermios(port)};
+                    ASSERT_NO_THROW(port.close());
+
+                    ASSERT_NO_THROW(port.open(getNativePortSettings(BaudRate::BAUD_RATE_57600, characterSize, parity, stopBit, flowControl)));
+                    const auto actual{getTermios(port)};
+                    ASSERT_NO_THROW(port.close());
+
+                    ASSERT_EQ(actual.c_iflag, expected.c_iflag);
+                    ASSERT_EQ(actual.c_oflag, expected.c_oflag);
+                    ASSERT_EQ(actual.c_cflag, expected.c_cflag);
+                    ASSERT_EQ(actual.c_lflag, expected.c_lflag);
+                    ASSERT_EQ(cfgetispeed(&actual), cfgetispeed(&expected));
+                    ASSERT_EQ(cfgetospeed(&actual), cfgetospeed(&expected));
+                    ASSERT_EQ(std::memcmp(actual.c_cc, expected.c_cc, sizeof(actual.c_cc)), 0);
+                }
+            }
+        }
+    }
+}
+
+TEST(SerialPortConfigTest, OpenTest)
+{
+    SCOPED_TRACE("OpenTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    ASSERT_NO_THROW(TestConfig::open(port));
+    ASSERT_TRUE(port.isOpen());
+
+    // Properties follow the configuration
+    ASSERT_EQ(port.getBaudRate(), BaudRate::BAUD_RATE_921600);
+    ASSERT_EQ(port.getCharacterSize(), CharacterSize::CHARACTER_SIZE_7);
+    ASSERT_EQ(port.getParity(), Parity::PARITY_TYPE_EVEN);
+    ASSERT_EQ(port.getStopBit(), StopBit::STOP_BIT_TWO);
+    ASSERT_EQ(port.getFlowControl(), FlowControl::FLOW_CONTROL_HARDWARE);
+
+    const auto portSettings{getTermios(port)};
+    ASSERT_EQ(cfgetospeed(&portSettings), B921600);
+    ASSERT_NE(portSettings.c_cflag & CSTOPB, 0U);
+    ASSERT_NE(portSettings.c_iflag & INPCK, 0U);
+    ASSERT_EQ(portSettings.c_lflag & ICANON, 0U);
+
+    // Data passes through the configured port
+    const std::string data{"configured"};
+    ASSERT_EQ(port.write(data), data.size());
+    ASSERT_EQ(terminal.read(data.size()), data);
+
+    // Runtime changes still apply on top of the configuration
+    ASSERT_NO_THROW(port.setBaudRate(BaudRate::BAUD_RATE_9600));
+    const auto changedSettings{getTermios(port)};
+    ASSERT_EQ(cfgetospeed(&changedSettings), B9600);
+    ASSERT_NE(changedSettings.c_cflag & CSTOPB, 0U);
+
+    // Open port is not reconfigured
+    ASSERT_NO_THROW((SerialPortConfig<BaudRate::BAUD_RATE_115200>::open(port)));
+    ASSERT_EQ(port.getBaudRate(), BaudRate::BAUD_RATE_9600);
+    ASSERT_NO_THROW(port.close());
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,197 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/serialport_pump.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Receive data from a pump port until the size is reached or the timeout expires
+     *
+     * @param pump Serial port pump
+     * @param port Port index
+     * @param size Size of the data
+     * @return std::string Received data
+     */
+    std::string receiveAll(SerialPortPump& pump, size_t port, size_t size)
+    {
+        const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+        std::string data(size, '\0');
+        size_t count{0};
+        while ((count < size) && (std::chrono::steady_clock::now() < deadline))
+        {
+            const auto received{pump.receive(port, &data[count], size - count)};
+            if (received == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+            count += received;
+        }
+        data.resize(count);
+        return data;
+    }
+} // namespace
+
+TEST(SerialPortPumpTest, OptionsTest)
+{
+    SCOPED_TRACE("OptionsTest");
+
+    PumpOptions options{};
+    options.queueSize = 3;
+    ASSERT_THROW(SerialPortPump{options}, std::out_of_range);
+    options.queueSize = 4;
+    options.chunkSize = 0;
+    ASSERT_THROW(SerialPortPump{options}, std::out_of_range);
+    options.chunkSize = 16;
+    options.cpu = -2;
+    ASSERT_THROW(SerialPortPump{options}, std::out_of_range);
+    options.cpu = -1;
+    options.priority = -1;
+    ASSERT_THROW(SerialPortPump{options}, std::out_of_range);
+
+    // Closed serial ports are rejected
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    SerialPortPump pump{};
+    ASSERT_THROW(pump.addPort(serialPort), std::runtime_error);
+
+    // Ports are added while the pump is stopped
+    serialPort.open();
+    ASSERT_EQ(pump.addPort(serialPort), 0U);
+    pump.start();
+    ASSERT_TRUE(pump.isRunning());
+    ASSERT_THROW(pump.start(), std::runtime_error);
+    ASSERT_THROW(pump.addPort(serialPort), std::runtime_error);
+    pump.stop();
+    ASSERT_FALSE(pump.isRunning());
+    ASSERT_THROW(pump.receive(1, nullptr, 0), std::out_of_range);
+
+    // Real-time options depend on the privileges of the process
+    options.cpu = 0;
+    options.priority = 1;
+    SerialPortPump realTimePump{options};
+    try
+    {
+        realTimePump.start();
+        ASSERT_TRUE(realTimePump.isRunning());
+    }
+    catch (const std::runtime_error&)
+    {
+        ASSERT_FALSE(realTimePump.isRunning());
+    }
+}
+
+TEST(SerialPortPumpTest, ReceiveTest)
+{
+    SCOPED_TRACE("ReceiveTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+
+    PumpOptions options{};
+    options.chunkSize = 16;
+    options.queueSize = 4;
+    SerialPortPump pump{options};
+    const auto port{pump.addPort(serialPort)};
+    pump.start();
+
+    // Data is split into chunks and copied out across chunk boundaries
+    const std::string data{"serial port pump receive queue"};
+    ASSERT_EQ(terminal.write(data), data.size());
+    ASSERT_EQ(receiveAll(pump, port, data.size()), data);
+
+    // Full receive queue pauses reading without losing data
+    std::string pattern(options.chunkSize * options.queueSize * 4, '\0');
+    for (size_t index{0}; index < pattern.size(); ++index)
+        pattern[index] = static_cast<char>('a' + (index % 26));
+    ASSERT_EQ(terminal.write(pattern), pattern.size());
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_EQ(receiveAll(pump, port, pattern.size()), pattern);
+
+    const auto statistics{pump.getStatistics()};
+    ASSERT_EQ(statistics.receivedCount, data.size() + pattern.size());
+    ASSERT_GT(statistics.stallCount, 0U);
+    ASSERT_EQ(statistics.errorCount, 0U);
+
+    // Hang-up removes the serial port from the pump
+    terminal.closeMaster();
+    for (int attempt{0}; (attempt < 100) && (pump.getStatistics().errorCount == 0); ++attempt)
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    ASSERT_EQ(pump.getStatistics().errorCount, 1U);
+}
+
+TEST(SerialPortPumpTest, SendTest)
+{
+    SCOPED_TRACE("SendTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    serialPort.open();
+
+    PumpOptions options{};
+    options.chunkSize = 8;
+    options.queueSize = 2;
+    SerialPortPump pump{options};
+    const auto port{pump.addPort(serialPort)};
+
+    // Chunks larger than the chunk size and beyond the queue size are rejected
+    ASSERT_FALSE(pump.send(port, "too large chunk", 15));
+    ASSERT_TRUE(pump.send(port, "first ", 6));
+    ASSERT_TRUE(pump.send(port, "second ", 7));
+    ASSERT_FALSE(pump.send(port, "third", 5));
+
+    pump.start();
+    ASSERT_EQ(terminal.read(13), "first second ");
+
+    // Send into an empty queue wakes the pump thread, chunks are released after they are written
+    for (int index{0}; index < 10; ++index)
+    {
+        bool sent{false};
+        for (int attempt{0}; (attempt < 100) && !sent; ++attempt)
+        {
+            sent = pump.send(port, "ping", 4);
+            if (!sent)
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        ASSERT_TRUE(sent);
+        ASSERT_EQ(terminal.read(4), "ping");
+    }
+
+    pump.stop();
+    const auto statistics{pump.getStatistics()};
+    ASSERT_EQ(statistics.transmittedCount, 53U);
+    ASSERT_GT(statistics.wakeupCount, 0U);
+    ASSERT_EQ(std::accumulate(statistics.wakeupLatencyHistogram.begin(), statistics.wakeupLatencyHistogram.end(), uint64_t{0}),
+        statistics.wakeupCount);
+    ASSERT_GT(statistics.maxWakeupLatency.count(), 0);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,165 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/shared_ring.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Get a unique shared memory object name for the test
+ *
+ * @param test Test name
+ * @return std::string Shared memory object name
+ */
+static std::string getSharedRingName(const std::string& test)
+{
+    return ("/libserial-test-" + test + "-" + std::to_string(::getpid()));
+}
+
+TEST(SharedRingTest, FanOutTest)
+{
+    SCOPED_TRACE("FanOutTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    ASSERT_NO_THROW(port.open());
+
+    SharedRingPublisher publisher{port, getSharedRingName("FanOut"), 4096};
+    ASSERT_EQ(publisher.getCapacity(), 4096);
+    SharedRingSubscriber firstSubscriber{publisher.getName()};
+    SharedRingSubscriber secondSubscriber{publisher.getName()};
+    ASSERT_EQ(firstSubscriber.getAvailable(), 0);
+
+    const std::string data{"$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"};
+    ASSERT_EQ(terminal.write(data), data.size());
+
+    size_t published{0};
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{1}};
+    while ((published < data.size()) && (std::chrono::steady_clock::now() < deadline))
+        published += publisher.pump(std::chrono::milliseconds{100});
+    ASSERT_EQ(published, data.size());
+    ASSERT_EQ(publisher.getPosition(), data.size());
+
+    for (auto subscriber: {&firstSubscriber, &secondSubscriber})
+    {
+        ASSERT_EQ(subscriber->getAvailable(), data.size());
+        std::string received(data.size(), '\0');
+        ASSERT_EQ(subscriber->read(&received[0], received.size()), data.size());
+        ASSERT_EQ(received, data);
+        ASSERT_EQ(subscriber->getLostCount(), 0);
+        ASSERT_EQ(subscriber->read(&received[0], received.size()), 0);
+    }
+}
+
+TEST(SharedRingTest, WakeUpTest)
+{
+    SCOPED_TRACE("WakeUpTest");
+
+    SerialPort port{};
+    SharedRingPublisher publisher{port, getSharedRingName("WakeUp"), 4096};
+    SharedRingSubscriber subscriber{publisher.getName()};
+
+    std::string received(5, '\0');
+    size_t count{0};
+    std::thread thread{[&subscriber, &received, &count]()
+    {
+        count = subscriber.read(&received[0], received.size(), std::chrono::milliseconds{5000});
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_EQ(publisher.publish("hello", 5), 5);
+    thread.join();
+    ASSERT_EQ(count, 5);
+    ASSERT_EQ(received, "hello");
+
+    // Timeout expires without data
+    ASSERT_EQ(subscriber.read(&received[0], received.size(), std::chrono::milliseconds{10}), 0);
+}
+
+TEST(SharedRingTest, OverrunTest)
+{
+    SCOPED_TRACE("OverrunTest");
+
+    SerialPort port{};
+    SharedRingPublisher publisher{port, getSharedRingName("Overrun"), 64};
+    SharedRingSubscriber subscriber{publisher.getName()};
+
+    std::string data{};
+    for (size_t index{0}; index < 200; ++index)
+        data += static_cast<char>('A' + (index % 26));
+    ASSERT_EQ(publisher.publish(data.data(), 100), 100);
+    ASSERT_EQ(publisher.publish(data.data() + 100, 100), 100);
+
+    // Subscriber continues with the oldest data still available
+    std::string received(200, '\0');
+    const auto count{subscriber.read(&received[0], received.size())};
+    ASSERT_EQ(count, 64);
+    ASSERT_EQ(subscriber.getLostCount(), 136);
+    ASSERT_EQ(received.substr(0, count), data.substr(136));
+}
+
+TEST(SharedRingTest, InvalidNameTest)
+{
+    SCOPED_TRACE("InvalidNameTest");
+
+    ASSERT_THROW(SharedRingSubscriber{getSharedRingName("Missing")}, std::runtime_error);
+}
+
+TEST(SharedRingTest, ExistingRingTest)
+{
+    SCOPED_TRACE("ExistingRingTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    port.open();
+    const auto name{getSharedRingName("Existing")};
+    SharedRingPublisher publisher{port, name, 4096, 0640};
+    SharedRingSubscriber subscriber{name};
+
+    // Permissions are applied regardless of the umask
+    struct stat status{};
+    ASSERT_EQ(::stat(("/dev/shm" + name).c_str(), &status), 0);
+    ASSERT_EQ(status.st_mode & 0777, 0640U);
+
+    // Live ring is not truncated by a second publisher
+    SerialPort other{terminal.getSlaveName()};
+    ASSERT_THROW(SharedRingPublisher(other, name, 4096), std::runtime_error);
+    ASSERT_EQ(terminal.write("alive"), 5U);
+    size_t published{0};
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{1}};
+    while ((published < 5) && (std::chrono::steady_clock::now() < deadline))
+        published += publisher.pump(std::chrono::milliseconds{100});
+    ASSERT_EQ(published, 5U);
+    std::string received(5, '\0');
+    ASSERT_EQ(subscriber.read(&received[0], received.size()), 5);
+    ASSERT_EQ(received, "alive");
+}
+
+END_NAMESPACE_LIBSERIAL
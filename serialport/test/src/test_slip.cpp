@@ -0,0 +1,155 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/slip.hpp>
+
+#ifdef __linux__
+    #include <serialport_test/test_pseudo_terminal.hpp>
+#endif // __linux__
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Encode a frame into a string
+ *
+ * @param data Frame data
+ * @return std::string Encoded frame
+ */
+static std::string encodeSlip(const std::string& data)
+{
+    std::string result(SlipCodec::getMaxEncodedSize(data.size()), '\0');
+    result.resize(SlipCodec::encode(data.data(), data.size(), result.data()));
+    return result;
+}
+
+TEST(SlipCodecTest, EncodeFunctionTest)
+{
+    SCOPED_TRACE("EncodeFunctionTest");
+
+    EXPECT_EQ(encodeSlip(""), "\xC0\xC0");
+    EXPECT_EQ(encodeSlip("abc"), "\xC0" "abc\xC0");
+    EXPECT_EQ(encodeSlip("a\xC0" "b\xDB" "c"), "\xC0" "a\xDB\xDC" "b\xDB\xDD" "c\xC0");
+    EXPECT_EQ(encodeSlip("\xC0\xC0"), "\xC0\xDB\xDC\xDB\xDC\xC0");
+    EXPECT_EQ(SlipCodec::getMaxEncodedSize(2), 6U);
+}
+
+TEST(SlipCodecTest, DecodeFunctionTest)
+{
+    SCOPED_TRACE("DecodeFunctionTest");
+
+    std::string binary{};
+    for (size_t index{0}; index < 2048; ++index)
+        binary += static_cast<char>(index * 13);
+
+    for (const auto& frame: {std::string{}, std::string("\xDB\xC0\xDB"), binary})
+    {
+        const auto encoded{encodeSlip(frame)};
+        std::string decoded(encoded.size(), '\0');
+        decoded.resize(SlipCodec::decode(encoded.data() + 1, encoded.size() - 2, decoded.data()));
+        EXPECT_EQ(decoded, frame);
+    }
+
+    // Invalid escape sequences
+    char output[16];
+    EXPECT_EQ(SlipCodec::decode("a\xDB", 2, output), static_cast<size_t>(-1));
+    EXPECT_EQ(SlipCodec::decode("a\xDB" "b", 3, output), static_cast<size_t>(-1));
+    EXPECT_EQ(SlipCodec::decode("a\xC0" "b", 3, output), static_cast<size_t>(-1));
+}
+
+TEST(SlipCodecTest, StreamTest)
+{
+    SCOPED_TRACE("StreamTest");
+
+    SerialPort serialPort{};
+    SlipCodec slipCodec{serialPort, 64};
+
+    // Line noise, valid frames, invalid escape and an oversized frame
+    const std::string data{"noise" + encodeSlip("first\xC0") + "bad\xDB" "x\xC0" + encodeSlip(std::string(500, 'x')) +
+        encodeSlip("last")};
+    std::vector<std::string> frames{};
+    std::string_view frame{};
+    for (size_t offset{0}; offset < data.size();)
+    {
+        offset += slipCodec.feed(data.data() + offset, std::min<size_t>(7, data.size() - offset));
+        while (slipCodec.nextFrame(frame))
+            frames.emplace_back(frame);
+    }
+    EXPECT_EQ(frames, (std::vector<std::string>{"noise", "first\xC0", "last"}));
+    EXPECT_EQ(slipCodec.getErrorCount(), 2U);
+}
+
+#ifdef __linux__
+TEST(SlipCodecTest, SerialPortTest)
+{
+    SCOPED_TRACE("SerialPortTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    SlipCodec slipCodec{serialPort};
+    const std::string frame{"\xC0" "data\xDB"};
+    EXPECT_TRUE(slipCodec.writeFrame(frame.data(), frame.size()));
+    EXPECT_EQ(terminal.read(10), encodeSlip(frame));
+
+    terminal.write(encodeSlip(frame));
+    std::string_view received{};
+    bool result{false};
+    for (size_t attempt{0}; (attempt < 1000) && !result; ++attempt)
+        result = slipCodec.readFrame(received);
+    EXPECT_TRUE(result);
+    EXPECT_EQ(received, frame);
+}
+
+TEST(SlipCodecTest, LargeFrameTest)
+{
+    SCOPED_TRACE("LargeFrameTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName()};
+    ASSERT_NO_THROW(serialPort.open());
+
+    // Frame larger than the terminal buffer is written whole while the peer reads
+    SlipCodec slipCodec{serialPort};
+    std::string frame(256 * 1024, '\0');
+    for (size_t index{0}; index < frame.size(); ++index)
+        frame[index] = static_cast<char>(index * 7);
+    const auto encoded{encodeSlip(frame)};
+    bool written{false};
+    std::thread writer{[&slipCodec, &frame, &written]() { written = slipCodec.writeFrame(frame.data(), frame.size()); }};
+    EXPECT_EQ(terminal.read(encoded.size(), std::chrono::milliseconds{10000}), encoded);
+    writer.join();
+    EXPECT_TRUE(written);
+
+    // Peer which stops reading fails the frame after the timeout
+    EXPECT_FALSE(slipCodec.writeFrame(frame.data(), frame.size(), std::chrono::milliseconds{20}));
+}
+#endif // __linux__
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/supervisor.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(SupervisorTest, DisconnectDetectionTest)
+{
+    SCOPED_TRACE("DisconnectDetectionTest");
+
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    SerialPortSupervisor supervisor{port};
+    ASSERT_FALSE(supervisor.isConnected());
+    ASSERT_NO_THROW(supervisor.open());
+    ASSERT_TRUE(supervisor.isConnected());
+    ASSERT_EQ(supervisor.getIdentity().fileName, terminal.getSlaveName());
+    ASSERT_TRUE(supervisor.checkConnection());
+
+    // Data passes through a connected port
+    const std::string data{"supervised"};
+    ASSERT_EQ(terminal.write(data), data.size());
+    ASSERT_EQ(supervisor.write(data.data(), data.size()), data.size());
+    ASSERT_EQ(terminal.read(data.size()), data);
+
+    // Hang-up is detected and the port is closed without throwing
+    terminal.closeMaster();
+    char buffer[64];
+    while (supervisor.read(buffer, sizeof(buffer)) > 0);
+    ASSERT_FALSE(supervisor.isConnected());
+    ASSERT_FALSE(port.isOpen());
+    ASSERT_EQ(supervisor.getStatistics().disconnectCount, 1);
+
+    // Device does not reappear
+    supervisor.setRetryInterval(std::chrono::milliseconds{10});
+    ASSERT_FALSE(supervisor.reconnect(std::chrono::milliseconds{50}));
+    ASSERT_GT(supervisor.getStatistics().failedAttemptCount, 0);
+    ASSERT_EQ(supervisor.getStatistics().reconnectCount, 0);
+}
+
+TEST(SupervisorTest, ReconnectTest)
+{
+    SCOPED_TRACE("ReconnectTest");
+
+    auto terminal{std::make_unique<PseudoTerminal>()};
+    std::string location{};
+    SerialPort port{terminal->getSlaveName(), BaudRate::BAUD_RATE_9600};
+    SerialPortSupervisor supervisor{port, [&location]() { return location; }};
+    supervisor.setRetryInterval(std::chrono::milliseconds{10});
+    ASSERT_NO_THROW(supervisor.open());
+    ASSERT_TRUE(supervisor.setExclusive(false));
+
+    // Hang-up
+    terminal.reset();
+    ASSERT_FALSE(supervisor.checkConnection());
+    ASSERT_FALSE(supervisor.reconnect(std::chrono::milliseconds{20}));
+
+    // Device reappears under a different name
+    terminal = std::make_unique<PseudoTerminal>();
+    location = terminal->getSlaveName();
+    ASSERT_TRUE(supervisor.reconnect(std::chrono::milliseconds{1000}));
+    ASSERT_TRUE(supervisor.isConnected());
+    ASSERT_EQ(port.getPortName(), location);
+
+    const auto statistics{supervisor.getStatistics()};
+    ASSERT_EQ(statistics.disconnectCount, 1);
+    ASSERT_EQ(statistics.reconnectCount, 1);
+    ASSERT_GT(statistics.lastReconnectLatency.count(), 0);
+    ASSERT_EQ(statistics.maxReconnectLatency, statistics.lastReconnectLatency);
+    ASSERT_EQ(statistics.totalReconnectLatency, statistics.lastReconnectLatency);
+
+    // Settings and exclusive mode are preserved
+    struct termios settings{};
+    ASSERT_EQ(tcgetattr(port.getNativeHandle(), &settings), 0);
+    ASSERT_EQ(cfgetospeed(&settings), static_cast<speed_t>(B9600));
+    int exclusive{1};
+    ASSERT_EQ(ioctl(port.getNativeHandle(), TIOCGEXCL, &exclusive), 0);
+    ASSERT_EQ(exclusive, 0);
+
+    // Data passes through the reconnected port
+    const std::string data{"reconnected"};
+    ASSERT_EQ(supervisor.write(data.data(), data.size()), data.size());
+    ASSERT_EQ(terminal->read(data.size()), data);
+    ASSERT_NO_THROW(supervisor.close());
+
+    // Serial port opened without the supervisor is exclusive again
+    ASSERT_NO_THROW(port.open());
+    ASSERT_EQ(ioctl(port.getNativeHandle(), TIOCGEXCL, &exclusive), 0);
+    ASSERT_EQ(exclusive, 1);
+    ASSERT_NO_THROW(port.close());
+}
+
+TEST(SupervisorTest, ClosedPortTest)
+{
+    SCOPED_TRACE("ClosedPortTest");
+
+    // Never opened port is not opened by a read or a write although the device is present
+    PseudoTerminal terminal{};
+    SerialPort port{terminal.getSlaveName()};
+    SerialPortSupervisor supervisor{port, [&terminal]() { return terminal.getSlaveName(); }};
+    ASSERT_EQ(supervisor.getState(), SupervisorState::SUPERVISOR_STATE_CLOSED);
+    char buffer[64];
+    ASSERT_EQ(supervisor.read(buffer, sizeof(buffer)), 0U);
+    ASSERT_EQ(supervisor.write("data", 4), 0U);
+    ASSERT_FALSE(port.isOpen());
+    ASSERT_FALSE(supervisor.reconnect(std::chrono::milliseconds{20}));
+    ASSERT_FALSE(port.isOpen());
+
+    // Deliberately closed port stays closed
+    ASSERT_NO_THROW(supervisor.open());
+    ASSERT_EQ(supervisor.getState(), SupervisorState::SUPERVISOR_STATE_OPEN);
+    ASSERT_NO_THROW(supervisor.close());
+    ASSERT_EQ(supervisor.getState(), SupervisorState::SUPERVISOR_STATE_CLOSED);
+    ASSERT_EQ(terminal.write("closed"), 6U);
+    ASSERT_EQ(supervisor.read(buffer, sizeof(buffer)), 0U);
+    ASSERT_EQ(supervisor.write("data", 4), 0U);
+    ASSERT_FALSE(port.isOpen());
+    ASSERT_FALSE(supervisor.reconnect(std::chrono::milliseconds{20}));
+    ASSERT_FALSE(supervisor.checkConnection());
+
+    const auto statistics{supervisor.getStatistics()};
+    ASSERT_EQ(statistics.disconnectCount, 0);
+    ASSERT_EQ(statistics.reconnectCount, 0);
+    ASSERT_EQ(statistics.failedAttemptCount, 0);
+    ASSERT_EQ(statistics.totalReconnectLatency.count(), 0);
+}
+
+END_NAMESPACE_LIBSERIAL
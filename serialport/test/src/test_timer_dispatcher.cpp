@@ -0,0 +1,127 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <poll.h>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/timer_wheel.hpp>
+#include <serialport/linux/timer_dispatcher.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+namespace
+{
+    /**
+     * @brief Wait for the timer dispatcher to become readable
+     *
+     * @param timerDispatcher Timer dispatcher
+     * @param timeout Maximum time to wait
+     * @return true Timers are due
+     * @return false No timer is due within the timeout
+     */
+    bool waitTimers(const TimerDispatcher& timerDispatcher, std::chrono::milliseconds timeout)
+    {
+        struct pollfd descriptor{timerDispatcher.getNativeHandle(), POLLIN, 0};
+        return (::poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0);
+    }
+} // namespace
+
+TEST(TimerDispatcherTest, DispatchTest)
+{
+    SCOPED_TRACE("DispatchTest");
+
+    std::vector<uint64_t> expired{};
+    TimerDispatcher dispatcher{[&expired](TimerId, uint64_t data)
+    {
+        expired.push_back(data);
+    }};
+    ASSERT_FALSE(waitTimers(dispatcher, std::chrono::milliseconds{0}));
+
+    // Re-arming a timer later does not reprogram the timerfd
+    auto timerId{dispatcher.arm(std::chrono::milliseconds{20}, 1)};
+    ASSERT_EQ(dispatcher.getStatistics().programCount, 1U);
+    for (int byte{0}; byte < 100; ++byte)
+        timerId = dispatcher.rearm(timerId, std::chrono::milliseconds{20}, 1);
+    ASSERT_EQ(dispatcher.getStatistics().programCount, 1U);
+    ASSERT_EQ(dispatcher.getActiveCount(), 1U);
+
+    // Earlier timer reprograms the timerfd
+    dispatcher.arm(std::chrono::milliseconds{5}, 2);
+    ASSERT_EQ(dispatcher.getStatistics().programCount, 2U);
+
+    while (expired.size() < 2)
+    {
+        ASSERT_TRUE(waitTimers(dispatcher, std::chrono::milliseconds{1000}));
+        dispatcher.dispatch();
+    }
+    ASSERT_EQ(expired, (std::vector<uint64_t>{2, 1}));
+    ASSERT_EQ(dispatcher.getActiveCount(), 0U);
+
+    // Cancelled timer leaves a spurious wakeup and the timerfd is disarmed afterwards
+    dispatcher.cancel(dispatcher.arm(std::chrono::milliseconds{5}, 3));
+    ASSERT_TRUE(waitTimers(dispatcher, std::chrono::milliseconds{1000}));
+    ASSERT_EQ(dispatcher.dispatch(), 0U);
+    ASSERT_FALSE(waitTimers(dispatcher, std::chrono::milliseconds{30}));
+
+    const auto statistics{dispatcher.getStatistics()};
+    ASSERT_EQ(statistics.armCount, 103U);
+    ASSERT_EQ(statistics.expiredCount, 2U);
+    ASSERT_EQ(expired.size(), 2U);
+}
+
+TEST(TimerDispatcherTest, RearmTest)
+{
+    SCOPED_TRACE("RearmTest");
+
+    // Expiry handler re-arms a periodic timer
+    TimerDispatcher* self{nullptr};
+    size_t count{0};
+    TimerDispatcher dispatcher{[&self, &count](TimerId, uint64_t data)
+    {
+        if (++count < 5)
+            self->arm(std::chrono::milliseconds{2}, data);
+    }, std::chrono::microseconds{100}, 16, 3};
+    self = &dispatcher;
+
+    dispatcher.arm(std::chrono::milliseconds{2}, 0);
+    while (count < 5)
+    {
+        ASSERT_TRUE(waitTimers(dispatcher, std::chrono::milliseconds{1000}));
+        dispatcher.dispatch();
+    }
+    ASSERT_EQ(dispatcher.getActiveCount(), 0U);
+    ASSERT_FALSE(waitTimers(dispatcher, std::chrono::milliseconds{10}));
+
+    // Timer beyond the range of the wheel expires after its cascades
+    const auto start{std::chrono::steady_clock::now()};
+    dispatcher.arm(std::chrono::milliseconds{500}, 0);
+    while (count < 6)
+    {
+        ASSERT_TRUE(waitTimers(dispatcher, std::chrono::milliseconds{1000}));
+        dispatcher.dispatch();
+    }
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{500});
+}
+
+END_NAMESPACE_LIBSERIAL
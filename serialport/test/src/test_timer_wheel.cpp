@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/timer_wheel.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+TEST(TimerWheelTest, ExpiryTest)
+{
+    SCOPED_TRACE("ExpiryTest");
+
+    EXPECT_THROW(TimerWheel(std::chrono::microseconds{0}, 8), std::out_of_range);
+    EXPECT_THROW(TimerWheel(std::chrono::microseconds{1000}, 0), std::out_of_range);
+    EXPECT_THROW(TimerWheel(std::chrono::microseconds{1000}, 8, 0), std::out_of_range);
+    EXPECT_THROW(TimerWheel(std::chrono::microseconds{1000}, 256, 9), std::out_of_range);
+
+    TimerWheel wheel{std::chrono::microseconds{1000}, 8};
+    const auto start{std::chrono::steady_clock::now()};
+    EXPECT_EQ(wheel.getNextExpiry(), std::chrono::steady_clock::time_point::max());
+
+    // Timers spread over more than a revolution
+    wheel.arm(start + std::chrono::milliseconds{3}, 3);
+    wheel.arm(start + std::chrono::milliseconds{1}, 1);
+    wheel.arm(start + std::chrono::milliseconds{11}, 11);
+    const auto cancelled{wheel.arm(start + std::chrono::milliseconds{2}, 2)};
+    EXPECT_EQ(wheel.getActiveCount(), 4U);
+    EXPECT_TRUE(wheel.cancel(cancelled));
+    EXPECT_FALSE(wheel.cancel(cancelled));
+    EXPECT_EQ(wheel.getActiveCount(), 3U);
+    EXPECT_GE(wheel.getNextExpiry(), start + std::chrono::milliseconds{1});
+    EXPECT_LE(wheel.getNextExpiry(), start + std::chrono::milliseconds{2});
+
+    std::vector<uint64_t> expired{};
+    const auto expire{[&expired](TimerId, uint64_t data) { expired.push_back(data); }};
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds{4}, expire), 2U);
+    EXPECT_EQ(expired, (std::vector<uint64_t>{1, 3}));
+
+    // Timer of a later revolution is not expired by its slot
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds{9}, expire), 0U);
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds{13}, expire), 1U);
+    EXPECT_EQ(expired.back(), 11U);
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+}
+
+TEST(TimerWheelTest, RearmTest)
+{
+    SCOPED_TRACE("RearmTest");
+
+    TimerWheel wheel{std::chrono::microseconds{1000}, 4};
+    const auto start{std::chrono::steady_clock::now()};
+
+    // Identifier of a reused slab entry does not cancel the new timer
+    const auto first{wheel.arm(start + std::chrono::milliseconds{1}, 1)};
+    EXPECT_TRUE(wheel.cancel(first));
+    const auto second{wheel.arm(start + std::chrono::milliseconds{1}, 2)};
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(wheel.cancel(first));
+
+    // Expiry function re-arms its timer and cancels another one of the same slot
+    TimerId other{wheel.arm(start + std::chrono::milliseconds{1}, 3)};
+    size_t count{0};
+    const auto expire{[&](TimerId, uint64_t data)
+    {
+        ++count;
+        if (data == 3)
+        {
+            wheel.cancel(second);
+            wheel.arm(start + std::chrono::milliseconds{3}, 4);
+        }
+    }};
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds{2}, expire), 1U);
+    EXPECT_FALSE(wheel.cancel(other));
+    EXPECT_EQ(wheel.getActiveCount(), 1U);
+
+    // Overdue timers after a long pause
+    for (uint64_t data{10}; data < 20; ++data)
+        wheel.arm(start + std::chrono::milliseconds{data}, data);
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds{100}, expire), 11U);
+    EXPECT_EQ(count, 12U);
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+}
+
+TEST(TimerWheelTest, HierarchyTest)
+{
+    SCOPED_TRACE("HierarchyTest");
+
+    // Three levels of four slots cover 64 ticks, later timers wait in the top level
+    TimerWheel wheel{std::chrono::microseconds{1000}, 4, 3};
+    EXPECT_EQ(wheel.getLevelCount(), 3U);
+    const auto start{std::chrono::steady_clock::now()};
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> deadlineDistribution{0, 300};
+    std::uniform_int_distribution<int> stepDistribution{0, 20};
+    std::map<TimerId, std::chrono::steady_clock::time_point> armed{};
+    auto now{start};
+    size_t expiredCount{0};
+    const auto expire{[&](TimerId timerId, uint64_t)
+    {
+        // Every timer expires once, not before its deadline
+        const auto timer{armed.find(timerId)};
+        ASSERT_NE(timer, armed.end());
+        EXPECT_LE(timer->second, now);
+        armed.erase(timer);
+        ++expiredCount;
+    }};
+
+    for (int iteration{0}; iteration < 2000; ++iteration)
+    {
+        const auto timerId{wheel.arm(now + std::chrono::milliseconds{deadlineDistribution(generator)}, 0)};
+        armed.emplace(timerId, wheel.getExpiry(timerId));
+        if ((iteration % 3) == 0)
+        {
+            EXPECT_TRUE(wheel.cancel(armed.begin()->first));
+            EXPECT_EQ(wheel.getExpiry(armed.begin()->first), std::chrono::steady_clock::time_point::max());
+            armed.erase(armed.begin());
+        }
+
+        // Earliest expiry of all levels
+        auto nextExpiry{std::chrono::steady_clock::time_point::max()};
+        for (const auto& timer: armed)
+            nextExpiry = std::min(nextExpiry, timer.second);
+        EXPECT_EQ(wheel.getNextExpiry(), nextExpiry);
+
+        // No due timer is left behind
+        now += std::chrono::microseconds{stepDistribution(generator) * 100};
+        wheel.advance(now, expire);
+        for (const auto& timer: armed)
+            EXPECT_GT(timer.second, now);
+        EXPECT_EQ(wheel.getActiveCount(), armed.size());
+    }
+
+    // Far timers expire after the remaining revolutions
+    now += std::chrono::seconds{1};
+    wheel.advance(now, expire);
+    EXPECT_TRUE(armed.empty());
+    EXPECT_EQ(wheel.getActiveCount(), 0U);
+    EXPECT_GT(expiredCount, 0U);
+}
+
+END_NAMESPACE_LIBSERIAL
@@ -0,0 +1,220 @@
+/*
+    Copyright (C) 2020-2021  Blaž Zakrajšek
+
+    This file is part of libserial.
+
+    libserial is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libserial is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libserial.  If not, see <https://www.gnu.org/licenses/>.
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <serialport/namespace.hpp>
+#include <serialport/properties.hpp>
+#include <serialport/serialport.hpp>
+#include <serialport/linux/transaction_manager.hpp>
+#include <serialport_test/test_pseudo_terminal.hpp>
+
+BEGIN_NAMESPACE_LIBSERIAL
+
+/**
+ * @brief Correlation key of a request, its first byte
+ *
+ * @param request Request
+ * @return uint64_t Correlation key
+ */
+static uint64_t getRequestKey(std::string_view request)
+{
+    return static_cast<uint8_t>(request[0]);
+}
+
+/**
+ * @brief Extract a response of a key byte, a length byte and the payload
+ *
+ * @param data Received data
+ * @param key Correlation key
+ * @return size_t Size of the response or 0 if incomplete
+ */
+static size_t extractResponse(std::string_view data, uint64_t& key)
+{
+    if (data.size() < 2)
+        return 0;
+
+    key = static_cast<uint8_t>(data[0]);
+    return (2 + static_cast<uint8_t>(data[1]));
+}
+
+/**
+ * @brief Poll a transaction manager until a condition holds
+ *
+ * @tparam Condition Condition type
+ * @param manager Transaction manager
+ * @param condition Condition
+ */
+template<typename Condition>
+static void pollUntil(TransactionManager& manager, Condition condition)
+{
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{2}};
+    while (!condition() && (std::chrono::steady_clock::now() < deadline))
+        manager.poll(std::chrono::milliseconds{10});
+}
+
+TEST(TransactionManagerTest, PipelineTest)
+{
+    SCOPED_TRACE("PipelineTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    TransactionManager manager{serialPort, getRequestKey, extractResponse, 3};
+
+    std::vector<std::string> responses{};
+    for (char key{'a'}; key <= 'e'; ++key)
+    {
+        manager.submit(std::string(1, key) + "req", [&responses](TransactionStatus status, std::string_view response)
+        {
+            EXPECT_EQ(status, TransactionStatus::TRANSACTION_COMPLETED);
+            responses.emplace_back(response);
+        }, std::chrono::milliseconds{500});
+    }
+
+    // Window limits the requests in flight
+    EXPECT_EQ(terminal.read(12), "areqbreqcreq");
+    EXPECT_EQ(manager.getInFlightCount(), 3U);
+    EXPECT_EQ(manager.getQueuedCount(), 2U);
+
+    // Responses out of order, split across reads, including one without a request
+    terminal.write(std::string("c\x01" "Cz\x00" "a\x02" "A", 8));
+    pollUntil(manager, [&responses]() { return (responses.size() == 1); });
+    terminal.write("Ab\x01" "B");
+    pollUntil(manager, [&responses]() { return (responses.size() == 3); });
+    EXPECT_EQ(responses, (std::vector<std::string>{"c\x01" "C", "a\x02" "AA", "b\x01" "B"}));
+
+    EXPECT_EQ(terminal.read(8), "dreqereq");
+    terminal.write(std::string("e\x00" "d\x00", 4));
+    pollUntil(manager, [&responses]() { return (responses.size() == 5); });
+
+    const auto statistics{manager.getStatistics()};
+    EXPECT_EQ(statistics.submittedCount, 5U);
+    EXPECT_EQ(statistics.completedCount, 5U);
+    EXPECT_EQ(statistics.unmatchedCount, 1U);
+    EXPECT_EQ(statistics.maxInFlightCount, 3U);
+    EXPECT_EQ(statistics.transmittedCount, 20U);
+    EXPECT_EQ(statistics.receivedCount, 16U);
+    EXPECT_GT(manager.getTransmitUtilisation(), 0.0);
+    EXPECT_GT(manager.getReceiveUtilisation(), 0.0);
+    EXPECT_EQ(manager.getInFlightCount(), 0U);
+}
+
+TEST(TransactionManagerTest, RetryTest)
+{
+    SCOPED_TRACE("RetryTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    TransactionManager manager{serialPort, getRequestKey, extractResponse};
+
+    // Unanswered request is retransmitted once and then times out
+    std::vector<TransactionStatus> results{};
+    const auto completion{[&results](TransactionStatus status, std::string_view) { results.push_back(status); }};
+    const auto start{std::chrono::steady_clock::now()};
+    manager.submit("x1", completion, std::chrono::milliseconds{20}, 1);
+    pollUntil(manager, [&results]() { return !results.empty(); });
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{40});
+    EXPECT_EQ(results, (std::vector<TransactionStatus>{TransactionStatus::TRANSACTION_TIMEOUT}));
+    EXPECT_EQ(terminal.read(4), "x1x1");
+
+    // Request with the key of a request in flight waits for its completion
+    manager.submit("y1", completion, std::chrono::milliseconds{500});
+    manager.submit("y2", completion, std::chrono::milliseconds{500});
+    EXPECT_EQ(terminal.read(2), "y1");
+    EXPECT_EQ(manager.getQueuedCount(), 1U);
+    terminal.write(std::string("y\x00", 2));
+    pollUntil(manager, [&results]() { return (results.size() == 2); });
+    EXPECT_EQ(terminal.read(2), "y2");
+
+    manager.cancelAll();
+    EXPECT_EQ(results.back(), TransactionStatus::TRANSACTION_CANCELLED);
+
+    const auto statistics{manager.getStatistics()};
+    EXPECT_EQ(statistics.retryCount, 1U);
+    EXPECT_EQ(statistics.timeoutCount, 1U);
+    EXPECT_EQ(statistics.completedCount, 1U);
+    EXPECT_EQ(statistics.cancelledCount, 1U);
+}
+
+TEST(TransactionManagerTest, HangUpTest)
+{
+    SCOPED_TRACE("HangUpTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_115200};
+    ASSERT_NO_THROW(serialPort.open());
+    TransactionManager manager{serialPort, getRequestKey, extractResponse, 1};
+
+    // Request in flight and a queued request fail on the hang-up
+    std::vector<TransactionStatus> results{};
+    const auto completion{[&results](TransactionStatus status, std::string_view) { results.push_back(status); }};
+    manager.submit("a1", completion, std::chrono::milliseconds{5000});
+    manager.submit("b1", completion, std::chrono::milliseconds{5000});
+    EXPECT_EQ(terminal.read(2), "a1");
+    terminal.closeMaster();
+
+    // Event loop ends instead of spinning on the hung up port
+    const auto start{std::chrono::steady_clock::now()};
+    manager.run();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{1000});
+    EXPECT_TRUE(manager.isFailed());
+    EXPECT_EQ(results, (std::vector<TransactionStatus>(2, TransactionStatus::TRANSACTION_IO_ERROR)));
+
+    // Transactions submitted after the failure complete immediately
+    manager.submit("c1", completion, std::chrono::milliseconds{5});
+    EXPECT_EQ(results.size(), 3U);
+    EXPECT_EQ(results.back(), TransactionStatus::TRANSACTION_IO_ERROR);
+    EXPECT_EQ(manager.poll(std::chrono::milliseconds{10}), 0U);
+
+    const auto statistics{manager.getStatistics()};
+    EXPECT_EQ(statistics.failedCount, 3U);
+    EXPECT_EQ(statistics.timeoutCount, 0U);
+    EXPECT_EQ(manager.getInFlightCount(), 0U);
+    EXPECT_EQ(manager.getQueuedCount(), 0U);
+}
+
+TEST(TransactionManagerTest, StalledWriteTest)
+{
+    SCOPED_TRACE("StalledWriteTest");
+
+    PseudoTerminal terminal{};
+    SerialPort serialPort{terminal.getSlaveName(), BaudRate::BAUD_RATE_4000000};
+    ASSERT_NO_THROW(serialPort.open());
+    TransactionManager manager{serialPort, getRequestKey, extractResponse};
+
+    // Request larger than the terminal buffer which the peer never reads times out
+    std::vector<TransactionStatus> results{};
+    manager.submit(std::string(64 * 1024, 'x'), [&results](TransactionStatus status, std::string_view)
+    {
+        results.push_back(status);
+    }, std::chrono::milliseconds{5}, 3);
+    pollUntil(manager, [&results]() { return !results.empty(); });
+    EXPECT_EQ(results, (std::vector<TransactionStatus>{TransactionStatus::TRANSACTION_TIMEOUT}));
+    EXPECT_EQ(manager.getStatistics().retryCount, 0U);
+    EXPECT_FALSE(manager.isFailed());
+}
+
+END_NAMESPACE_LIBSERIAL